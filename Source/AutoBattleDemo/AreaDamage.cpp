@@ -0,0 +1,55 @@
+#include "AreaDamage.h"
+
+void FAreaDamageBatch::Reset(int32 NumEntities)
+{
+    Requests.Reset();
+    Touched.Reset();
+    if (Totals.Num() != NumEntities)
+    {
+        Totals.Init(0.0f, NumEntities);
+        BestRequest.Init(INDEX_NONE, NumEntities);
+    }
+}
+
+void FAreaDamageBatch::Add(const FAreaDamageRequest& Request)
+{
+    if (Request.Damage <= 0.0f || Request.Radius <= 0.0f || Request.TeamMask == 0) return;
+
+    Requests.Add(Request);
+    Stats.Requests++;
+}
+
+void FAreaDamageBatch::Accumulate(int32 EntityIndex, int32 RequestIndex)
+{
+    if (!Totals.IsValidIndex(EntityIndex)) return;
+
+    if (BestRequest[EntityIndex] == INDEX_NONE)
+    {
+        Touched.Add(EntityIndex);
+        BestRequest[EntityIndex] = RequestIndex;
+    }
+    else if (Requests[RequestIndex].Damage > Requests[BestRequest[EntityIndex]].Damage)
+    {
+        BestRequest[EntityIndex] = RequestIndex;
+    }
+    Totals[EntityIndex] += Requests[RequestIndex].Damage;
+    Stats.Contributions++;
+}
+
+void FAreaDamageBatch::Finish(TArray<FAreaDamageHit>& OutHits)
+{
+    Touched.Sort();
+    OutHits.Reserve(Touched.Num());
+    for (int32 EntityIndex : Touched)
+    {
+        OutHits.Add({ EntityIndex, Totals[EntityIndex], Requests[BestRequest[EntityIndex]].SourceIndex });
+
+        // 清回初始值，下一批不用整个数组重置
+        Totals[EntityIndex] = 0.0f;
+        BestRequest[EntityIndex] = INDEX_NONE;
+    }
+    Stats.Hits += Touched.Num();
+
+    Touched.Reset();
+    Requests.Reset();
+}
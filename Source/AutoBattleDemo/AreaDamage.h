@@ -0,0 +1,90 @@
+// AreaDamage.h：范围伤害（溅射、自爆）的批量结算
+// 一步里所有爆炸先攒成一批，统一在邻居格子上查询，按受击者累计总伤害后一次性交给模拟器扣血，
+// 不会每个爆炸都把全场实体扫一遍
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RTSCoreTypes.h"
+#include "CrowdAvoidance.h"
+
+// 一次爆炸
+struct FAreaDamageRequest
+{
+    int32 SourceIndex;   // 造成伤害的实体下标
+    FVector Center;
+    float Radius;        // 水平半径
+    float Damage;        // 范围内每个实体受到的伤害
+    uint8 TeamMask;      // 会受伤的阵营（1 << ETeam）
+};
+
+// 一个受击者这一批的总伤害
+struct FAreaDamageHit
+{
+    int32 VictimIndex;
+    float Amount;
+    int32 SourceIndex;   // 伤害最高的来源（一样高取先入队的），击杀和伤害统计都记在它上面
+};
+
+// 运行时计数
+struct FAreaDamageStats
+{
+    int64 Requests = 0;
+    int64 Contributions = 0;   // 爆炸命中实体的次数（同一个实体被几个爆炸同时炸到算几次）
+    int64 Hits = 0;            // 合并后的受击者数
+};
+
+/**
+ * 范围伤害批次
+ * 用法：每步 Reset -> Add(...)，结算时 Resolve；查询用的是这一步开始时建好的邻居格子
+ */
+class AUTOBATTLEDEMO_API FAreaDamageBatch
+{
+public:
+    // 阵营掩码
+    static uint8 TeamBit(ETeam Team) { return (uint8)(1 << (int32)Team); }
+
+    // 开始新的一批（NumEntities 为实体下标上限，累计数组按它分配）
+    void Reset(int32 NumEntities);
+
+    void Add(const FAreaDamageRequest& Request);
+
+    int32 Num() const { return Requests.Num(); }
+
+    /**
+     * 结算这一批：按入队顺序查询每个爆炸，伤害累加到受击者身上
+     * @param SpatialIndex 登记了所有可受击实体的邻居格子
+     * @param GetTeamMask Func(EntityIndex) -> uint8，实体所属阵营的掩码，不能受击的实体返回 0
+     * @param OutHits 每个受击者一条，按实体下标排序（与查询顺序无关）
+     */
+    template <typename FuncType>
+    void Resolve(const FCrowdAvoidance& SpatialIndex, FuncType GetTeamMask, TArray<FAreaDamageHit>& OutHits)
+    {
+        OutHits.Reset();
+        for (int32 r = 0; r < Requests.Num(); r++)
+        {
+            const FAreaDamageRequest& Request = Requests[r];
+            SpatialIndex.ForEachAgentInRadius(Request.Center, Request.Radius, [&](int32 EntityIndex, float DistSq)
+            {
+                if ((GetTeamMask(EntityIndex) & Request.TeamMask) == 0) return;
+                Accumulate(EntityIndex, r);
+            });
+        }
+        Finish(OutHits);
+    }
+
+    const FAreaDamageStats& GetStats() const { return Stats; }
+    void ResetStats() { Stats = FAreaDamageStats(); }
+
+private:
+    void Accumulate(int32 EntityIndex, int32 RequestIndex);
+    void Finish(TArray<FAreaDamageHit>& OutHits);
+
+    TArray<FAreaDamageRequest> Requests;
+
+    // 按实体下标的累计值，只有 Touched 里的项是这一批写过的
+    TArray<float> Totals;
+    TArray<int32> BestRequest;
+    TArray<int32> Touched;
+
+    FAreaDamageStats Stats;
+};
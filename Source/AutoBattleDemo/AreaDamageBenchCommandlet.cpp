@@ -0,0 +1,199 @@
+#include "AreaDamageBenchCommandlet.h"
+#include "AreaDamage.h"
+#include "HAL/PlatformTime.h"
+
+namespace
+{
+    // 战场边长（cm）
+    const float BenchFieldSize = 20000.0f;
+    const float BenchUnitHealth = 100.0f;
+    const float BenchJitter = 10.0f;
+
+    struct FBenchUnit
+    {
+        FVector Location;
+        ETeam Team;
+        float Health;
+    };
+
+    // 原来的做法：每个爆炸扫一遍所有实体（相当于 GetAllActorsOfClass + 距离判断），结果按同样的规则合并
+    void ResolveNaive(const TArray<FAreaDamageRequest>& Requests, const TArray<FBenchUnit>& Units, TArray<FAreaDamageHit>& OutHits)
+    {
+        TArray<float> Totals;
+        TArray<int32> Best;
+        Totals.Init(0.0f, Units.Num());
+        Best.Init(INDEX_NONE, Units.Num());
+
+        for (int32 r = 0; r < Requests.Num(); r++)
+        {
+            const FAreaDamageRequest& Request = Requests[r];
+            const float RadiusSq = Request.Radius * Request.Radius;
+            for (int32 u = 0; u < Units.Num(); u++)
+            {
+                const FBenchUnit& Unit = Units[u];
+                if (Unit.Health <= 0.0f || (FAreaDamageBatch::TeamBit(Unit.Team) & Request.TeamMask) == 0) continue;
+
+                const float DistSq = FMath::Square(Request.Center.X - Unit.Location.X) + FMath::Square(Request.Center.Y - Unit.Location.Y);
+                if (DistSq > RadiusSq) continue;
+
+                if (Best[u] == INDEX_NONE || Request.Damage > Requests[Best[u]].Damage)
+                {
+                    Best[u] = r;
+                }
+                Totals[u] += Request.Damage;
+            }
+        }
+
+        OutHits.Reset();
+        for (int32 u = 0; u < Units.Num(); u++)
+        {
+            if (Best[u] != INDEX_NONE)
+            {
+                OutHits.Add({ u, Totals[u], Requests[Best[u]].SourceIndex });
+            }
+        }
+    }
+
+    bool HitsEqual(const TArray<FAreaDamageHit>& A, const TArray<FAreaDamageHit>& B)
+    {
+        if (A.Num() != B.Num()) return false;
+        for (int32 i = 0; i < A.Num(); i++)
+        {
+            // 累加顺序一样，合计伤害按位相等
+            if (A[i].VictimIndex != B[i].VictimIndex || A[i].Amount != B[i].Amount || A[i].SourceIndex != B[i].SourceIndex) return false;
+        }
+        return true;
+    }
+}
+
+UAreaDamageBenchCommandlet::UAreaDamageBenchCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = false;
+    LogToConsole = true;
+}
+
+int32 UAreaDamageBenchCommandlet::Main(const FString& Params)
+{
+    // 1. 解析参数
+    int32 NumUnits = 10000;
+    int32 NumExplosions = 1000;
+    float Radius = 300.0f;
+    int32 NumSteps = 100;
+    int32 Seed = 1;
+    FParse::Value(*Params, TEXT("units="), NumUnits);
+    FParse::Value(*Params, TEXT("explosions="), NumExplosions);
+    FParse::Value(*Params, TEXT("radius="), Radius);
+    FParse::Value(*Params, TEXT("steps="), NumSteps);
+    FParse::Value(*Params, TEXT("seed="), Seed);
+    NumUnits = FMath::Max(NumUnits, 1);
+    NumExplosions = FMath::Max(NumExplosions, 0);
+    NumSteps = FMath::Max(NumSteps, 1);
+
+    // 2. 两个阵营的实体随机散在战场上
+    FRandomStream Random(Seed);
+    TArray<FBenchUnit> Units;
+    for (int32 u = 0; u < NumUnits; u++)
+    {
+        Units.Add({ FVector(Random.FRandRange(0.0f, BenchFieldSize), Random.FRandRange(0.0f, BenchFieldSize), 0.0f), (ETeam)(u & 1), BenchUnitHealth });
+    }
+
+    // 邻居格子和模拟里一样，用避让的默认参数（格子边长 = 分离距离）
+    FCrowdAvoidanceSettings Settings;
+    FCrowdAvoidance SpatialIndex;
+    FAreaDamageBatch Batch;
+
+    TArray<FAreaDamageRequest> Requests;
+    TArray<FAreaDamageHit> BatchedHits;
+    TArray<FAreaDamageHit> NaiveHits;
+    double IndexSeconds = 0.0;
+    double BatchedSeconds = 0.0;
+    double NaiveSeconds = 0.0;
+    int64 TotalHits = 0;
+    int32 MismatchStep = INDEX_NONE;
+
+    for (int32 Step = 0; Step < NumSteps; Step++)
+    {
+        // 3. 这一步的爆炸：随机位置，炸另一个阵营，伤害在 5~20 之间
+        Requests.Reset();
+        for (int32 e = 0; e < NumExplosions; e++)
+        {
+            const ETeam Team = (ETeam)Random.RandHelper(2);
+            const uint8 EnemyMask = FAreaDamageBatch::TeamBit(Team == ETeam::Player ? ETeam::Enemy : ETeam::Player);
+            const FVector Center(Random.FRandRange(0.0f, BenchFieldSize), Random.FRandRange(0.0f, BenchFieldSize), 0.0f);
+            Requests.Add({ NumUnits + e, Center, Radius, (float)(5 + Random.RandHelper(16)), EnemyMask });
+        }
+
+        // 4. 建邻居格子（模拟里每步本来就要建，单独计时）
+        double StartTime = FPlatformTime::Seconds();
+        SpatialIndex.Reset(Settings, FVector2D::ZeroVector, FVector2D(BenchFieldSize, BenchFieldSize));
+        for (int32 u = 0; u < Units.Num(); u++)
+        {
+            if (Units[u].Health > 0.0f)
+            {
+                SpatialIndex.AddAgent(u, Units[u].Location);
+            }
+        }
+        SpatialIndex.Finalize();
+        IndexSeconds += FPlatformTime::Seconds() - StartTime;
+
+        // 5. 批量结算
+        StartTime = FPlatformTime::Seconds();
+        Batch.Reset(Units.Num());
+        for (const FAreaDamageRequest& Request : Requests)
+        {
+            Batch.Add(Request);
+        }
+        Batch.Resolve(SpatialIndex, [&Units](int32 UnitIndex)
+        {
+            return Units[UnitIndex].Health > 0.0f ? FAreaDamageBatch::TeamBit(Units[UnitIndex].Team) : (uint8)0;
+        }, BatchedHits);
+        BatchedSeconds += FPlatformTime::Seconds() - StartTime;
+
+        // 6. 逐个爆炸全量扫描
+        StartTime = FPlatformTime::Seconds();
+        ResolveNaive(Requests, Units, NaiveHits);
+        NaiveSeconds += FPlatformTime::Seconds() - StartTime;
+
+        if (MismatchStep == INDEX_NONE && !HitsEqual(BatchedHits, NaiveHits))
+        {
+            MismatchStep = Step;
+        }
+
+        // 7. 扣血，活着的随便挪一挪（两边下一步看到的是同一份状态）
+        TotalHits += BatchedHits.Num();
+        for (const FAreaDamageHit& Hit : BatchedHits)
+        {
+            Units[Hit.VictimIndex].Health -= Hit.Amount;
+        }
+        for (FBenchUnit& Unit : Units)
+        {
+            Unit.Location.X = FMath::Clamp(Unit.Location.X + Random.FRandRange(-BenchJitter, BenchJitter), 0.0f, BenchFieldSize);
+            Unit.Location.Y = FMath::Clamp(Unit.Location.Y + Random.FRandRange(-BenchJitter, BenchJitter), 0.0f, BenchFieldSize);
+        }
+    }
+
+    // 8. 报告
+    int32 Survivors = 0;
+    for (const FBenchUnit& Unit : Units)
+    {
+        if (Unit.Health > 0.0f) Survivors++;
+    }
+
+    const FAreaDamageStats& Stats = Batch.GetStats();
+    UE_LOG(LogTemp, Display, TEXT("%d units, %d explosions/step (radius %.0f), %d steps: %lld victim hits, %.1f explosions per victim, %d units left"),
+        NumUnits, NumExplosions, Radius, NumSteps, TotalHits,
+        Stats.Hits > 0 ? (double)Stats.Contributions / Stats.Hits : 0.0, Survivors);
+    UE_LOG(LogTemp, Display, TEXT("Per-explosion scan: %.3f ms/step"), NaiveSeconds * 1000.0 / NumSteps);
+    UE_LOG(LogTemp, Display, TEXT("Batched:            %.3f ms/step (%.1fx), plus %.3f ms/step to build the shared neighbour grid"),
+        BatchedSeconds * 1000.0 / NumSteps, NaiveSeconds / FMath::Max(BatchedSeconds, 1e-9), IndexSeconds * 1000.0 / NumSteps);
+
+    if (MismatchStep != INDEX_NONE)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Batched damage totals differ from the per-explosion scan at step %d"), MismatchStep);
+        return 1;
+    }
+    UE_LOG(LogTemp, Display, TEXT("Damage totals identical: yes"));
+    return 0;
+}
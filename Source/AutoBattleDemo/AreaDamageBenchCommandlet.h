@@ -0,0 +1,20 @@
+// AreaDamageBenchCommandlet.h：范围伤害批量结算压测（和每个爆炸各扫一遍全场实体的做法对比）
+// 用法：UE4Editor-Cmd AutoBattleDemo.uproject -run=AreaDamageBench [-units=10000] [-explosions=1000] [-radius=300] [-steps=100] [-seed=1] -nullrhi
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "AreaDamageBenchCommandlet.generated.h"
+
+UCLASS()
+class AUTOBATTLEDEMO_API UAreaDamageBenchCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UAreaDamageBenchCommandlet();
+
+    // 每步同一批爆炸分别交给 FAreaDamageBatch 和逐个爆炸全量扫描处理，统计耗时，
+    // 并逐步比较两边每个受击者的合计伤害，不一致返回 1
+    virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,28 @@
+#include "AutoBattleStats.h"
+
+DEFINE_STAT(STAT_AutoBattle_FindPath);
+DEFINE_STAT(STAT_AutoBattle_DrawGridVisuals);
+DEFINE_STAT(STAT_AutoBattle_GridMemory);
+DEFINE_STAT(STAT_AutoBattle_SimGridMemory);
+DEFINE_STAT(STAT_AutoBattle_PathScratchMemory);
+
+DEFINE_STAT(STAT_AutoBattle_FindClosestEnemy);
+DEFINE_STAT(STAT_AutoBattle_MoveAlongPath);
+DEFINE_STAT(STAT_AutoBattle_PerformAttack);
+DEFINE_STAT(STAT_AutoBattle_TakeDamage);
+
+DEFINE_STAT(STAT_AutoBattle_SimStep);
+DEFINE_STAT(STAT_AutoBattle_SimAvoidance);
+DEFINE_STAT(STAT_AutoBattle_SimProjectiles);
+DEFINE_STAT(STAT_AutoBattle_SimReplans);
+DEFINE_STAT(STAT_AutoBattle_SimUnits);
+DEFINE_STAT(STAT_AutoBattle_SimTowers);
+DEFINE_STAT(STAT_AutoBattle_SimDamage);
+DEFINE_STAT(STAT_AutoBattle_UnitsTicked);
+
+DEFINE_STAT(STAT_AutoBattle_ApplySimulation);
+DEFINE_STAT(STAT_AutoBattle_TryBuyUnit);
+DEFINE_STAT(STAT_AutoBattle_HUDPaint);
+
+// 默认打开：开始 CSV 采集就会带上这一类
+CSV_DEFINE_CATEGORY_MODULE(AUTOBATTLEDEMO_API, AutoBattle, true);
@@ -0,0 +1,47 @@
+// AutoBattleStats.h：引擎的 stat 分组（stat AutoBattle）、内存计数和 CSV 性能分析分类
+// STATS 和 CSV_PROFILER 在 Shipping 下都是 0，这里的宏全部展开为空，不留任何开销
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+DECLARE_STATS_GROUP(TEXT("AutoBattle"), STATGROUP_AutoBattle, STATCAT_Advanced);
+
+// --- 寻路与网格 ---
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FindPath"), STAT_AutoBattle_FindPath, STATGROUP_AutoBattle, AUTOBATTLEDEMO_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("DrawGridVisuals"), STAT_AutoBattle_DrawGridVisuals, STATGROUP_AutoBattle, AUTOBATTLEDEMO_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Grid (scene)"), STAT_AutoBattle_GridMemory, STATGROUP_AutoBattle, AUTOBATTLEDEMO_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Grid (simulation copy)"), STAT_AutoBattle_SimGridMemory, STATGROUP_AutoBattle, AUTOBATTLEDEMO_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Path scratch (last search)"), STAT_AutoBattle_PathScratchMemory, STATGROUP_AutoBattle, AUTOBATTLEDEMO_API);
+
+// --- 单位逻辑（每个单位每步一次） ---
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FindClosestEnemy"), STAT_AutoBattle_FindClosestEnemy, STATGROUP_AutoBattle, AUTOBATTLEDEMO_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("MoveAlongPath"), STAT_AutoBattle_MoveAlongPath, STATGROUP_AutoBattle, AUTOBATTLEDEMO_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("PerformAttack"), STAT_AutoBattle_PerformAttack, STATGROUP_AutoBattle, AUTOBATTLEDEMO_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("TakeDamage"), STAT_AutoBattle_TakeDamage, STATGROUP_AutoBattle, AUTOBATTLEDEMO_API);
+
+// --- 模拟的各阶段（每步一次） ---
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Sim Step"), STAT_AutoBattle_SimStep, STATGROUP_AutoBattle, AUTOBATTLEDEMO_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Sim Avoidance"), STAT_AutoBattle_SimAvoidance, STATGROUP_AutoBattle, AUTOBATTLEDEMO_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Sim Projectiles"), STAT_AutoBattle_SimProjectiles, STATGROUP_AutoBattle, AUTOBATTLEDEMO_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Sim Replans"), STAT_AutoBattle_SimReplans, STATGROUP_AutoBattle, AUTOBATTLEDEMO_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Sim Units"), STAT_AutoBattle_SimUnits, STATGROUP_AutoBattle, AUTOBATTLEDEMO_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Sim Towers"), STAT_AutoBattle_SimTowers, STATGROUP_AutoBattle, AUTOBATTLEDEMO_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Sim Damage"), STAT_AutoBattle_SimDamage, STATGROUP_AutoBattle, AUTOBATTLEDEMO_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Units ticked"), STAT_AutoBattle_UnitsTicked, STATGROUP_AutoBattle, AUTOBATTLEDEMO_API);
+
+// --- GameMode ---
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Apply simulation to actors"), STAT_AutoBattle_ApplySimulation, STATGROUP_AutoBattle, AUTOBATTLEDEMO_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("TryBuyUnit"), STAT_AutoBattle_TryBuyUnit, STATGROUP_AutoBattle, AUTOBATTLEDEMO_API);
+
+// --- HUD（只含 HUD 自己的 NativePaint；子控件的 Prepass 排版和绘制看 stat slate） ---
+DECLARE_CYCLE_STAT_EXTERN(TEXT("HUD NativePaint"), STAT_AutoBattle_HUDPaint, STATGROUP_AutoBattle, AUTOBATTLEDEMO_API);
+
+// CSV 分类（-csvCategories=AutoBattle 或 csvcategory AutoBattle）：每个阶段一列，每帧一行
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(AUTOBATTLEDEMO_API, AutoBattle);
+
+// 每步一次的阶段同时记 stat 和 CSV（每个单位一次的函数只记 stat，CSV 逐次记太重）
+#define AUTOBATTLE_SCOPE_PHASE(Stat, CsvName) \
+    SCOPE_CYCLE_COUNTER(Stat); \
+    CSV_SCOPED_TIMING_STAT(AutoBattle, CsvName)
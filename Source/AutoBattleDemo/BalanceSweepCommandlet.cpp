@@ -0,0 +1,342 @@
+#include "BalanceSweepCommandlet.h"
+#include "BattleSimulation.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+    // 一个要扫描的属性：从 Min 到 Max 均匀取 Steps 个值
+    struct FSweepAxis
+    {
+        FString Stat;
+        float Min;
+        float Max;
+        int32 Steps;
+
+        float GetValue(int32 StepIndex) const
+        {
+            return Steps > 1 ? FMath::Lerp(Min, Max, (float)StepIndex / (Steps - 1)) : Min;
+        }
+    };
+
+    // 一场战斗的结果（每个 worker 只写自己的格子，不需要加锁）
+    struct FBattleSample
+    {
+        EBattleOutcome Outcome = EBattleOutcome::InProgress;
+        float Duration = 0.0f;
+    };
+
+    // 解析 "Damage:5:20:4,AttackRange:100:300:3"
+    bool ParseSweepAxes(const FString& Spec, TArray<FSweepAxis>& OutAxes)
+    {
+        TArray<FString> AxisSpecs;
+        Spec.ParseIntoArray(AxisSpecs, TEXT(","));
+        for (const FString& AxisSpec : AxisSpecs)
+        {
+            TArray<FString> Parts;
+            AxisSpec.ParseIntoArray(Parts, TEXT(":"));
+            if (Parts.Num() != 4)
+            {
+                UE_LOG(LogTemp, Error, TEXT("Bad sweep axis '%s', expected Stat:Min:Max:Steps"), *AxisSpec);
+                return false;
+            }
+
+            FSweepAxis& Axis = OutAxes.AddDefaulted_GetRef();
+            Axis.Stat = Parts[0];
+            Axis.Min = FCString::Atof(*Parts[1]);
+            Axis.Max = FCString::Atof(*Parts[2]);
+            Axis.Steps = FMath::Max(FCString::Atoi(*Parts[3]), 1);
+        }
+        return true;
+    }
+
+    // 按属性名改写布局里的数值
+    bool ApplyStat(FSimEntitySpawn& Spawn, const FString& Stat, float Value)
+    {
+        if (Stat == TEXT("Damage")) Spawn.Damage = Value;
+        else if (Stat == TEXT("AttackRange")) Spawn.AttackRange = Value;
+        else if (Stat == TEXT("AttackInterval")) Spawn.AttackInterval = Value;
+        else if (Stat == TEXT("MoveSpeed")) Spawn.MoveSpeed = Value;
+        else if (Stat == TEXT("MaxHealth")) Spawn.MaxHealth = Value;
+        else if (Stat == TEXT("ProjectileSpeed")) Spawn.ProjectileSpeed = Value;
+        else return false;
+        return true;
+    }
+
+    // 把被扫描的单位随机摆到空格子上（和 TryBuyUnit 一样占住所在格子）
+    void RandomizePlacements(FBattleSetup& Setup, const TArray<int32>& MovableIndices, FRandomStream& Random)
+    {
+        FGridMap& Grid = Setup.Grid;
+        const FVector& Origin = Grid.GetOrigin();
+
+        // 1. 先把原来占着的格子让出来（格子被占时 WorldToGrid 返回 false，但坐标照样算出来了）
+        //    整批一次提交，连通区域只重算一次，不是每个单位各算一次
+        TArray<FIntPoint> Tiles;
+        Tiles.Reserve(MovableIndices.Num());
+        for (int32 Index : MovableIndices)
+        {
+            int32 X, Y;
+            Grid.WorldToGrid(Setup.Entities[Index].Location, X, Y);
+            if (Grid.IsInBounds(X, Y))
+            {
+                Tiles.Add(FIntPoint(X, Y));
+            }
+        }
+        Grid.SetTilesBlocked(Tiles, false);
+
+        // 2. 收集所有空格子
+        TArray<FIntPoint> FreeTiles;
+        for (const FGridNode& Node : Grid.GetNodes())
+        {
+            if (!Node.bIsBlocked) FreeTiles.Add(FIntPoint(Node.X, Node.Y));
+        }
+
+        // 3. 每个单位抽一个空格子，抽完再一次性占住
+        Tiles.Reset();
+        for (int32 Index : MovableIndices)
+        {
+            if (FreeTiles.Num() == 0) break;
+
+            const int32 Pick = Random.RandHelper(FreeTiles.Num());
+            const FIntPoint Tile = FreeTiles[Pick];
+            FreeTiles.RemoveAtSwap(Pick);
+
+            FSimEntitySpawn& Spawn = Setup.Entities[Index];
+            const float HeightAboveGrid = Spawn.Location.Z - Origin.Z;
+            Spawn.Location = Grid.GridToWorld(Tile.X, Tile.Y);
+            Spawn.Location.Z += HeightAboveGrid;
+            Tiles.Add(Tile);
+        }
+        Grid.SetTilesBlocked(Tiles, true);
+    }
+
+    // Wilson 区间（95%），样本少或胜率接近 0/1 时比正态近似靠谱
+    void WilsonInterval(int32 Successes, int32 Trials, double& OutLow, double& OutHigh)
+    {
+        if (Trials <= 0)
+        {
+            OutLow = 0.0;
+            OutHigh = 1.0;
+            return;
+        }
+
+        const double Z = 1.96;
+        const double N = Trials;
+        const double P = Successes / N;
+        const double Denominator = 1.0 + Z * Z / N;
+        const double Center = (P + Z * Z / (2.0 * N)) / Denominator;
+        const double HalfWidth = Z * FMath::Sqrt(P * (1.0 - P) / N + Z * Z / (4.0 * N * N)) / Denominator;
+        OutLow = FMath::Max(0.0, Center - HalfWidth);
+        OutHigh = FMath::Min(1.0, Center + HalfWidth);
+    }
+}
+
+UBalanceSweepCommandlet::UBalanceSweepCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = false;
+    LogToConsole = true;
+}
+
+int32 UBalanceSweepCommandlet::Main(const FString& Params)
+{
+    // 1. 解析参数
+    FString SetupPath;
+    if (!FParse::Value(*Params, TEXT("setup="), SetupPath))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Usage: -run=BalanceSweep -setup=<file.bsetup> -sweep=Stat:Min:Max:Steps[,...] [-type=Soldier] [-team=Player] [-battles=100] [-randomize] [-seed=1] [-out=<csv>] [-scaling]"));
+        return 1;
+    }
+
+    FBattleSetup BaseSetup;
+    if (!BaseSetup.LoadFromFile(SetupPath))
+    {
+        return 1;
+    }
+
+    TArray<FSweepAxis> Axes;
+    FString SweepSpec;
+    if (FParse::Value(*Params, TEXT("sweep="), SweepSpec, false) && !ParseSweepAxes(SweepSpec, Axes))
+    {
+        return 1;
+    }
+
+    int32 BattlesPerPoint = 100;
+    int32 Seed = 1;
+    FParse::Value(*Params, TEXT("battles="), BattlesPerPoint);
+    FParse::Value(*Params, TEXT("seed="), Seed);
+    BattlesPerPoint = FMath::Max(BattlesPerPoint, 1);
+    const bool bRandomize = FParse::Param(*Params, TEXT("randomize"));
+    const bool bMeasureScaling = FParse::Param(*Params, TEXT("scaling"));
+
+    FString TeamName = TEXT("Player");
+    FParse::Value(*Params, TEXT("team="), TeamName);
+    const ETeam SweepTeam = TeamName == TEXT("Enemy") ? ETeam::Enemy : ETeam::Player;
+
+    // 不指定兵种就改这一方所有的兵
+    FString TypeName;
+    int64 SweepTypeValue = INDEX_NONE;
+    if (FParse::Value(*Params, TEXT("type="), TypeName))
+    {
+        SweepTypeValue = StaticEnum<EUnitType>()->GetValueByNameString(TypeName);
+        if (SweepTypeValue == INDEX_NONE)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Unknown unit type '%s'"), *TypeName);
+            return 1;
+        }
+    }
+
+    FString OutPath = FPaths::ProjectSavedDir() / TEXT("BalanceSweeps") / (FPaths::GetBaseFilename(SetupPath) + TEXT(".csv"));
+    FParse::Value(*Params, TEXT("out="), OutPath);
+
+    // 2. 找出被扫描的单位
+    TArray<int32> SweptIndices;
+    for (int32 i = 0; i < BaseSetup.Entities.Num(); i++)
+    {
+        const FSimEntitySpawn& Spawn = BaseSetup.Entities[i];
+        if (Spawn.bIsUnit && Spawn.Team == SweepTeam &&
+            (SweepTypeValue == INDEX_NONE || (int64)Spawn.UnitType == SweepTypeValue))
+        {
+            SweptIndices.Add(i);
+        }
+    }
+
+    // 3. 展开参数网格（笛卡尔积）
+    int32 NumPoints = 1;
+    for (const FSweepAxis& Axis : Axes)
+    {
+        NumPoints *= Axis.Steps;
+    }
+
+    TArray<TArray<float>> PointValues;
+    PointValues.SetNum(NumPoints);
+    for (int32 Point = 0; Point < NumPoints; Point++)
+    {
+        int32 Remainder = Point;
+        for (const FSweepAxis& Axis : Axes)
+        {
+            PointValues[Point].Add(Axis.GetValue(Remainder % Axis.Steps));
+            Remainder /= Axis.Steps;
+        }
+    }
+
+    for (const FSweepAxis& Axis : Axes)
+    {
+        FSimEntitySpawn Probe;
+        if (!ApplyStat(Probe, Axis.Stat, 0.0f))
+        {
+            UE_LOG(LogTemp, Error, TEXT("Unknown stat '%s' (Damage/AttackRange/AttackInterval/MoveSpeed/MaxHealth/ProjectileSpeed)"), *Axis.Stat);
+            return 1;
+        }
+    }
+
+    const int32 TotalBattles = NumPoints * BattlesPerPoint;
+    UE_LOG(LogTemp, Display, TEXT("Sweeping %d points x %d battles = %d battles, %d swept units, %d worker threads"),
+        NumPoints, BattlesPerPoint, TotalBattles, SweptIndices.Num(), FTaskGraphInterface::Get().GetNumWorkerThreads() + 1);
+
+    // 4. 并行模拟：每场战斗自己拷一份布局、自己建模拟器，互不共享可写状态
+    TArray<FBattleSample> Samples;
+    Samples.SetNum(TotalBattles);
+
+    auto RunBattle = [&](int32 BattleIndex)
+    {
+        const int32 Point = BattleIndex / BattlesPerPoint;
+
+        FBattleSetup Setup = BaseSetup;
+        for (int32 Index : SweptIndices)
+        {
+            for (int32 AxisIndex = 0; AxisIndex < Axes.Num(); AxisIndex++)
+            {
+                ApplyStat(Setup.Entities[Index], Axes[AxisIndex].Stat, PointValues[Point][AxisIndex]);
+            }
+        }
+
+        if (bRandomize)
+        {
+            // 随机种子只和战斗编号有关，线程怎么调度结果都一样
+            FRandomStream Random(Seed + BattleIndex);
+            RandomizePlacements(Setup, SweptIndices, Random);
+        }
+
+        FBattleSimulation Simulation;
+        Simulation.Init(Setup);
+        const FBattleResult Result = Simulation.RunToCompletion();
+
+        Samples[BattleIndex].Outcome = Result.Outcome;
+        Samples[BattleIndex].Duration = Result.Duration;
+    };
+
+    // 可选：先单线程跑一小批，作为加速比的基准
+    double SerialBattlesPerSecond = 0.0;
+    if (bMeasureScaling)
+    {
+        const int32 SerialCount = FMath::Min(TotalBattles, 500);
+        const double SerialStart = FPlatformTime::Seconds();
+        ParallelFor(SerialCount, RunBattle, true);
+        SerialBattlesPerSecond = SerialCount / FMath::Max(FPlatformTime::Seconds() - SerialStart, 1e-9);
+    }
+
+    const double StartTime = FPlatformTime::Seconds();
+    ParallelFor(TotalBattles, RunBattle);
+    const double WallSeconds = FPlatformTime::Seconds() - StartTime;
+
+    // 5. 汇总并写 CSV
+    FString Csv;
+    for (const FSweepAxis& Axis : Axes)
+    {
+        Csv += Axis.Stat + TEXT(",");
+    }
+    Csv += TEXT("Battles,PlayerWins,EnemyWins,Draws,PlayerWinRate,WinRateCI95Low,WinRateCI95High,AvgDuration\n");
+
+    for (int32 Point = 0; Point < NumPoints; Point++)
+    {
+        int32 PlayerWins = 0;
+        int32 EnemyWins = 0;
+        int32 Draws = 0;
+        double TotalDuration = 0.0;
+        for (int32 i = Point * BattlesPerPoint; i < (Point + 1) * BattlesPerPoint; i++)
+        {
+            switch (Samples[i].Outcome)
+            {
+            case EBattleOutcome::PlayerWins: PlayerWins++; break;
+            case EBattleOutcome::EnemyWins:  EnemyWins++; break;
+            default:                         Draws++; break;
+            }
+            TotalDuration += Samples[i].Duration;
+        }
+
+        double Low, High;
+        WilsonInterval(PlayerWins, BattlesPerPoint, Low, High);
+
+        for (float Value : PointValues[Point])
+        {
+            Csv += FString::Printf(TEXT("%g,"), Value);
+        }
+        Csv += FString::Printf(TEXT("%d,%d,%d,%d,%.4f,%.4f,%.4f,%.3f\n"),
+            BattlesPerPoint, PlayerWins, EnemyWins, Draws,
+            (double)PlayerWins / BattlesPerPoint, Low, High, TotalDuration / BattlesPerPoint);
+    }
+
+    if (!FFileHelper::SaveStringToFile(Csv, *OutPath))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Cannot write %s"), *OutPath);
+        return 1;
+    }
+
+    const double BattlesPerSecond = TotalBattles / FMath::Max(WallSeconds, 1e-9);
+    UE_LOG(LogTemp, Display, TEXT("Done: %d battles in %.2fs (%.1f battles/s), results in %s"),
+        TotalBattles, WallSeconds, BattlesPerSecond, *OutPath);
+    if (bMeasureScaling)
+    {
+        UE_LOG(LogTemp, Display, TEXT("Single-thread: %.1f battles/s, speedup %.2fx on %d threads"),
+            SerialBattlesPerSecond, BattlesPerSecond / FMath::Max(SerialBattlesPerSecond, 1e-9),
+            FTaskGraphInterface::Get().GetNumWorkerThreads() + 1);
+    }
+
+    return 0;
+}
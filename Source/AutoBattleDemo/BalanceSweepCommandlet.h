@@ -0,0 +1,22 @@
+// BalanceSweepCommandlet.h：多核并行的平衡性批量模拟
+// 用法：UE4Editor-Cmd AutoBattleDemo.uproject -run=BalanceSweep -setup=<布局文件>
+//       -sweep=Damage:5:20:4,AttackRange:100:300:3 [-type=Soldier] [-team=Player]
+//       [-battles=100] [-randomize] [-seed=1] [-out=<csv>] [-scaling] -nullrhi
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "BalanceSweepCommandlet.generated.h"
+
+UCLASS()
+class AUTOBATTLEDEMO_API UBalanceSweepCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UBalanceSweepCommandlet();
+
+    // 对参数网格的每个取值组合跑若干场独立战斗（每场一个 FBattleSimulation，不共享 UWorld），
+    // 汇总胜率和 95% 置信区间写成 CSV
+    virtual int32 Main(const FString& Params) override;
+};
@@ -3,8 +3,8 @@
 // 캯ʼĬֵ
 ABaseBuilding::ABaseBuilding()
 {
-    //  Actor ÿ֡ TickǾ̬ͨΪ false Żܣ
-    PrimaryActorTick.bCanEverTick = true;
+    // ̬Ҫ Tickսģ
+    PrimaryActorTick.bCanEverTick = false;
 
     // 1. ʼģ
     MeshComp = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("BuildingMesh"));
@@ -26,13 +26,6 @@ void ABaseBuilding::BeginPlay()
     }
 }
 
-// ÿִ֡
-void ABaseBuilding::Tick(float DeltaTime)
-{
-    Super::Tick(DeltaTime);
-
-}
-
 void ABaseBuilding::NotifyActorOnClicked(FKey ButtonPressed)
 {
     Super::NotifyActorOnClicked(ButtonPressed);
@@ -23,9 +23,6 @@ protected:
 	virtual void BeginPlay() override;
 
 public:
-	// ÿ֡
-	virtual void Tick(float DeltaTime) override;
-
 	// --- ı ---
 
 	// ӻģͣ
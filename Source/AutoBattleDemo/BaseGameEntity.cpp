@@ -1,5 +1,6 @@
 #include "BaseGameEntity.h"
 #include "RTSGameMode.h"
+#include "AutoBattleStats.h"
 #include "Kismet/GameplayStatics.h"
 #include "Components/StaticMeshComponent.h"
 #include "Components/WidgetComponent.h"
@@ -7,7 +8,8 @@
 
 ABaseGameEntity::ABaseGameEntity()
 {
-    PrimaryActorTick.bCanEverTick = true;
+    // ƶս GameMode ģʵԼҪÿ֡
+    PrimaryActorTick.bCanEverTick = false;
 
     // 
     RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("RootComponent"));
@@ -28,10 +30,33 @@ ABaseGameEntity::ABaseGameEntity()
     MaxHealth = 100.0f;
     CurrentHealth = MaxHealth;
     TeamID = ETeam::Enemy; // ĬΪˣ޸
+    FootprintSize = FIntPoint(0, 0);
+    TargetClass = ETargetClass::Building;
+    TowerRange = 0.0f;
+    TowerDamage = 0.0f;
+    TowerAttackInterval = 1.0f;
+    TowerSplashRadius = 0.0f;
+}
+
+void ABaseGameEntity::BeginPlay()
+{
+    Super::BeginPlay();
+
+    // 캯 MaxHealth  C++ ĬֵͼҪЧ
+    CurrentHealth = MaxHealth;
+
+    // ǼǵӪʤж HUD ٱ Actor
+    ARTSGameMode* GM = Cast<ARTSGameMode>(UGameplayStatics::GetGameMode(this));
+    if (GM)
+    {
+        GM->OnEntitySpawned(this);
+    }
 }
 
 float ABaseGameEntity::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
+    SCOPE_CYCLE_COUNTER(STAT_AutoBattle_TakeDamage);
+
     // øTakeDamageȡʵ˺ֵ
     float ActualDamage = Super::TakeDamage(DamageAmount, DamageEvent, EventInstigator, DamageCauser);
 
@@ -53,6 +78,12 @@ float ABaseGameEntity::TakeDamage(float DamageAmount, FDamageEvent const& Damage
     return ActualDamage;
 }
 
+void ABaseGameEntity::SetDormant(bool bDormant)
+{
+    SetActorHiddenInGame(bDormant);
+    SetActorEnableCollision(!bDormant);
+}
+
 void ABaseGameEntity::Die()
 {
     // ֪ͨ GameMode (ܺߣ˭ɱʱ)
@@ -12,6 +12,12 @@ class AUTOBATTLEDEMO_API ABaseGameEntity : public APawn
 public:
     ABaseGameEntity();
 
+protected:
+    // ͼĹ MaxHealth ĻҪѵǰѪͬ
+    virtual void BeginPlay() override;
+
+public:
+
     // ---  ---
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stats")
         float MaxHealth;
@@ -22,6 +28,29 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stats")
         ETeam TeamID; // һǵ
 
+    // ռأ Actor λΪģʱ鵲סĬ 0x0 ռӣߵǰ
+    // ʼֻռʱ 1 
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid")
+        FIntPoint FootprintSize;
+
+    // ʱһࣨǽԴ˺ķԶ࣬
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stats")
+        ETargetClass TargetClass;
+
+    // --- ֻԲǱʵЧ̻˺Ϊ 0 ֻǸĽ ---
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Defense")
+        float TowerRange;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Defense")
+        float TowerDamage;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Defense")
+        float TowerAttackInterval;
+
+    //  0 ʱǽȻڣеΧĵһ
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Defense")
+        float TowerSplashRadius;
+
         // --- ӿ ---
         // ߼
     virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, class AController* EventInstigator, AActor* DamageCauser) override;
@@ -29,6 +58,9 @@ public:
     // ߼ GameMode 
     virtual void Die();
 
+    // ߣءصײ٣սȿؿʱã
+    void SetDormant(bool bDormant);
+
     // ԼһίУʱ֪ͨ GameMode ʤ
     // FOnEntityDiedSignature OnDeath; 
     
@@ -1,42 +1,41 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "BaseGameEntity.h"
+#include "EntityRegistry.h"
 #include "BaseUnit.generated.h"
 
-// ʿ״̬
-UENUM()
-enum class EUnitState : uint8
-{
-    Idle,       // վ׮ս׶λĿ꣩
-    Moving,     // ·ƶ
-    Attacking   // 
-};
-
 UCLASS()
 class AUTOBATTLEDEMO_API ABaseUnit : public ABaseGameEntity
 {
     GENERATED_BODY()
 public:
     ABaseUnit();
-    virtual void Tick(float DeltaTime) override;
+
+protected:
+    // ӱֱȡѪ
+    virtual void BeginPlay() override;
+
+public:
 
     // ---  GameMode  ---
     // Ϸʼս AI
     UFUNCTION(BlueprintCallable)
         void SetUnitActive(bool bActive);
 
-    // ---  ---
-    UPROPERTY(EditAnywhere, Category = "Combat")
-        float AttackRange;
+    //  AUnitInstanceRenderer ƣעԼȾ
+    // ֻ false ָ
+    void SetRenderedByInstances(bool bInstanced);
 
-    UPROPERTY(EditAnywhere, Category = "Combat")
-        float Damage;
+    // ---  ---
+    // ֣TryBuyUnit ʱãؿڵĵͼ䣩ͬʱҲǱֱ±
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
+        EUnitType UnitType;
 
-    UPROPERTY(EditAnywhere, Category = "Movement")
-        float MoveSpeed;
+    // ̡ٵԲÿλһݣͳһ GameMode ıֱFUnitArchetype UnitType ȡ
 
-    UPROPERTY(EditAnywhere, Category = "Combat")
-        float AttackInterval;
+    // вԣȹĿʹ·ͬԱֱ
+    UFUNCTION(BlueprintCallable, Category = "Combat")
+        FTargetingPolicy GetTargetingPolicy() const;
 
     // ӽ
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
@@ -46,34 +45,7 @@ public:
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
         class UStaticMeshComponent* MeshComp;
 
-protected:
-    // --- ߼ ---
-    // 1. Ѱĵ ( ABaseGameEntity)
-    AActor* FindClosestEnemy();
-
-    // 2. · ( Member A  GridManager)
-    void RequestPathToTarget();
-
-    // 3. ·ƶ (Tick ִ)
-    void MoveAlongPath(float DeltaTime);
-
-    // 4. ִй
-    void PerformAttack();
-
-private:
-    EUnitState CurrentState;
-
-    // 浱ǰ·б
-    TArray<FVector> PathPoints;
-    int32 CurrentPathIndex;
-
-    // ǰĿ
-    UPROPERTY()
-        AActor* CurrentTarget;
-
-    // ʱ
-    float LastAttackTime;
-
-    //  GridManager (BeginPlay ȡ)
-    class AGridManager* GridManagerRef;
+    // սʵսʱ GameMode 䣬δսʱЧ
+    // ѰСѰ·ƶ FBattleSimulation ﰴִУActor ֻ
+    FEntityHandle EntityHandle;
 };
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include "BattlePerfReport.h"
+#include "Misc/FileHelper.h"
+#include "HAL/PlatformMemory.h"
+
+namespace
+{
+    // 查一次内存要走系统调用，没必要每帧都查
+    const int32 MemorySampleInterval = 30;
+}
+
+// ---------------------------------------------------------------------------
+// FPerfHistogram
+// ---------------------------------------------------------------------------
+
+void FPerfHistogram::Reset()
+{
+    FMemory::Memzero(Counts);
+    NumSamples = 0;
+    SumMs = 0.0;
+    MaxMs = 0.0;
+}
+
+void FPerfHistogram::AddSample(double Ms)
+{
+    int32 Bucket = 0;
+    if (Ms >= MinMs)
+    {
+        Bucket = FMath::Min(FMath::FloorToInt(FMath::Log2(Ms / MinMs) * BucketsPerOctave) + 1, NumBuckets - 1);
+    }
+
+    Counts[Bucket]++;
+    NumSamples++;
+    SumMs += Ms;
+    MaxMs = FMath::Max(MaxMs, Ms);
+}
+
+double FPerfHistogram::GetPercentile(double Fraction) const
+{
+    if (NumSamples == 0) return 0.0;
+
+    // 第一个累计数达到 Fraction * N 的桶
+    const int64 Rank = FMath::Max<int64>(1, (int64)FMath::CeilToDouble(FMath::Clamp(Fraction, 0.0, 1.0) * NumSamples));
+    int64 Cumulative = 0;
+    for (int32 Bucket = 0; Bucket < NumBuckets; Bucket++)
+    {
+        Cumulative += Counts[Bucket];
+        if (Cumulative >= Rank)
+        {
+            const double UpperMs = MinMs * FMath::Pow(2.0, (double)Bucket / BucketsPerOctave);
+            return FMath::Min(UpperMs, MaxMs);
+        }
+    }
+    return MaxMs;
+}
+
+// ---------------------------------------------------------------------------
+// FBattlePerfReport
+// ---------------------------------------------------------------------------
+
+FBattlePerfReport::FBattlePerfReport()
+    : bActive(false)
+    , PeakUnits(0)
+    , PeakUsedMemory(0)
+{
+}
+
+void FBattlePerfReport::Begin(const FString& InLabel)
+{
+    Label = InLabel;
+    bActive = true;
+    for (FPerfHistogram& Histogram : Histograms)
+    {
+        Histogram.Reset();
+    }
+    PeakUnits = 0;
+    PeakUsedMemory = 0;
+    SampleMemory();
+}
+
+void FBattlePerfReport::AddFrame(const double (&PhaseMs)[NumPhases], int32 NumUnits)
+{
+    if (!bActive) return;
+
+    for (int32 Phase = 0; Phase < NumPhases; Phase++)
+    {
+        Histograms[Phase].AddSample(PhaseMs[Phase]);
+    }
+    PeakUnits = FMath::Max(PeakUnits, NumUnits);
+
+    if (GetNumFrames() % MemorySampleInterval == 0)
+    {
+        SampleMemory();
+    }
+}
+
+void FBattlePerfReport::SampleMemory()
+{
+    PeakUsedMemory = FMath::Max<uint64>(PeakUsedMemory, FPlatformMemory::GetStats().UsedPhysical);
+}
+
+const TCHAR* FBattlePerfReport::GetPhaseName(EBattlePerfPhase Phase)
+{
+    switch (Phase)
+    {
+    case EBattlePerfPhase::Frame:       return TEXT("Frame");
+    case EBattlePerfPhase::AI:          return TEXT("AI");
+    case EBattlePerfPhase::Pathfinding: return TEXT("Pathfinding");
+    case EBattlePerfPhase::Movement:    return TEXT("Movement");
+    case EBattlePerfPhase::Combat:      return TEXT("Combat");
+    case EBattlePerfPhase::HUD:         return TEXT("HUD");
+    default:                            return TEXT("Unknown");
+    }
+}
+
+bool FBattlePerfReport::WriteJson(const FString& FilePath)
+{
+    SampleMemory();
+    bActive = false;
+
+    // 格式固定，直接拼字符串，不用 Json 模块
+    FString Json = TEXT("{\n");
+    Json += FString::Printf(TEXT("  \"label\": \"%s\",\n"), *Label.ReplaceCharWithEscapedChar());
+    Json += FString::Printf(TEXT("  \"frames\": %lld,\n"), GetNumFrames());
+    Json += FString::Printf(TEXT("  \"peak_units\": %d,\n"), PeakUnits);
+    Json += FString::Printf(TEXT("  \"peak_memory_mb\": %.1f,\n"), PeakUsedMemory / (1024.0 * 1024.0));
+    Json += TEXT("  \"phases\": {\n");
+    for (int32 Phase = 0; Phase < NumPhases; Phase++)
+    {
+        const FPerfHistogram& Histogram = Histograms[Phase];
+        Json += FString::Printf(TEXT("    \"%s\": { \"p50_ms\": %.4f, \"p90_ms\": %.4f, \"p99_ms\": %.4f, \"max_ms\": %.4f, \"mean_ms\": %.4f }%s\n"),
+            GetPhaseName((EBattlePerfPhase)Phase),
+            Histogram.GetPercentile(0.5), Histogram.GetPercentile(0.9), Histogram.GetPercentile(0.99),
+            Histogram.GetMaxMs(), Histogram.GetMeanMs(),
+            Phase + 1 < NumPhases ? TEXT(",") : TEXT(""));
+    }
+    Json += TEXT("  }\n}\n");
+
+    return FFileHelper::SaveStringToFile(Json, *FilePath);
+}
+
+bool FBattlePerfReport::WriteCsv(const FString& FilePath)
+{
+    SampleMemory();
+    bActive = false;
+
+    // 一个阶段一行，多份报告可以直接拼在一起比较
+    FString Csv = TEXT("Label,Phase,Frames,P50Ms,P90Ms,P99Ms,MaxMs,MeanMs,PeakUnits,PeakMemoryMB\n");
+    for (int32 Phase = 0; Phase < NumPhases; Phase++)
+    {
+        const FPerfHistogram& Histogram = Histograms[Phase];
+        Csv += FString::Printf(TEXT("%s,%s,%lld,%.4f,%.4f,%.4f,%.4f,%.4f,%d,%.1f\n"),
+            *Label, GetPhaseName((EBattlePerfPhase)Phase), Histogram.GetNumSamples(),
+            Histogram.GetPercentile(0.5), Histogram.GetPercentile(0.9), Histogram.GetPercentile(0.99),
+            Histogram.GetMaxMs(), Histogram.GetMeanMs(),
+            PeakUnits, PeakUsedMemory / (1024.0 * 1024.0));
+    }
+
+    return FFileHelper::SaveStringToFile(Csv, *FilePath);
+}
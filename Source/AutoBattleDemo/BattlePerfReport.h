@@ -0,0 +1,85 @@
+// BattlePerfReport.h：一场战斗从开战到分出胜负的逐帧耗时统计，结束时写成 JSON / CSV
+// 每个阶段一个固定大小的对数直方图，整场战斗不分配内存；无头模拟器和游戏内都用它出报告
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EBattlePerfPhase : uint8
+{
+    Frame,         // 整帧（DeltaSeconds）
+    AI,            // 索敌
+    Pathfinding,   // 寻路
+    Movement,      // 避让 + 移动
+    Combat,        // 攻击、弹道、防御塔、伤害结算
+    HUD,           // 把模拟结果同步到 Actor + 推给 HUD 的事件
+    Count
+};
+
+/**
+ * 耗时直方图：每 2 倍分 12 个桶（相邻桶差约 6%），从 0.001ms 到约 2.6s
+ * 百分位取所在桶的上界，误差不超过一个桶宽
+ */
+struct AUTOBATTLEDEMO_API FPerfHistogram
+{
+    static const int32 NumBuckets = 256;
+    static const int32 BucketsPerOctave = 12;
+    static constexpr double MinMs = 0.001;
+
+    FPerfHistogram() { Reset(); }
+
+    void Reset();
+    void AddSample(double Ms);
+
+    // Fraction 取 0~1（0.5 = p50），没有样本时返回 0
+    double GetPercentile(double Fraction) const;
+
+    int64 GetNumSamples() const { return NumSamples; }
+    double GetMaxMs() const { return MaxMs; }
+    double GetMeanMs() const { return NumSamples > 0 ? SumMs / NumSamples : 0.0; }
+
+private:
+    uint32 Counts[NumBuckets];   // 0 号桶放小于 MinMs 的样本，最后一个桶放所有超出范围的
+    int64 NumSamples;
+    double SumMs;
+    double MaxMs;
+};
+
+/**
+ * 一场战斗的性能报告
+ * Begin 之后每帧 AddFrame 一次，结束时 WriteJson / WriteCsv
+ */
+class AUTOBATTLEDEMO_API FBattlePerfReport
+{
+public:
+    static const int32 NumPhases = (int32)EBattlePerfPhase::Count;
+
+    FBattlePerfReport();
+
+    // 清空上一场的数据（Label 写进报告，一般是关卡名或布局文件名）
+    void Begin(const FString& InLabel);
+
+    /**
+     * @param PhaseMs 各阶段这一帧的耗时（毫秒，下标是 EBattlePerfPhase）
+     * @param NumUnits 这一帧场上活着的实体数
+     */
+    void AddFrame(const double (&PhaseMs)[NumPhases], int32 NumUnits);
+
+    bool IsActive() const { return bActive; }
+    int64 GetNumFrames() const { return Histograms[0].GetNumSamples(); }
+    const FPerfHistogram& GetHistogram(EBattlePerfPhase Phase) const { return Histograms[(int32)Phase]; }
+
+    // 写报告文件（目录不存在会自动建），之后 IsActive 为假
+    bool WriteJson(const FString& FilePath);
+    bool WriteCsv(const FString& FilePath);
+
+    static const TCHAR* GetPhaseName(EBattlePerfPhase Phase);
+
+private:
+    void SampleMemory();
+
+    FString Label;
+    bool bActive;
+    FPerfHistogram Histograms[NumPhases];
+    int32 PeakUnits;
+    uint64 PeakUsedMemory;   // 进程物理内存占用的峰值（每 30 帧采样一次）
+};
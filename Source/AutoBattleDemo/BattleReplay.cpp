@@ -0,0 +1,339 @@
+#include "BattleReplay.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "HAL/PlatformTime.h"
+
+namespace
+{
+    // 录像文件头
+    const uint32 ReplayMagic = 0x50524241; // "ABRP"
+    // 1：初版；2：关键帧里加入等待重新寻路的队列；3：关键帧里加入范围伤害统计
+    const uint32 ReplayVersion = 3;
+
+    // 变长无符号整数（每字节 7 位，最高位表示后面还有）
+    void WriteVarUint(TArray<uint8>& Out, uint32 Value)
+    {
+        while (Value >= 0x80)
+        {
+            Out.Add((uint8)(Value | 0x80));
+            Value >>= 7;
+        }
+        Out.Add((uint8)Value);
+    }
+
+    // 有符号差值先做 ZigZag，小的负数也只占一个字节
+    void WriteVarInt(TArray<uint8>& Out, int32 Value)
+    {
+        WriteVarUint(Out, ((uint32)Value << 1) ^ (uint32)(Value >> 31));
+    }
+}
+
+FArchive& operator<<(FArchive& Ar, FReplaySegment& Segment)
+{
+    Ar << Segment.StartStep << Segment.NumSteps << Segment.NumEvents;
+    Ar << Segment.Keyframe << Segment.Events;
+    return Ar;
+}
+
+// ---------------------------------------------------------------------------
+// FBattleRecorder
+// ---------------------------------------------------------------------------
+
+FBattleRecorder::FBattleRecorder(int32 InKeyframeInterval, int64 InMaxBytes)
+    : KeyframeInterval(FMath::Max(InKeyframeInterval, 1))
+    , MaxBytes(InMaxBytes)
+    , SegmentBytes(0)
+    , NumDroppedSegments(0)
+    , LastEventStep(0)
+    , RecordCycles(0)
+{
+}
+
+void FBattleRecorder::Begin(const FBattleSetup& Setup, FBattleSimulation& Simulation)
+{
+    const uint64 StartCycles = FPlatformTime::Cycles64();
+
+    Setup.SaveToBytes(SetupBytes);
+    Segments.Reset();
+    SegmentBytes = 0;
+    NumDroppedSegments = 0;
+    StepEvents.Reset();
+    StartSegment(Simulation);
+
+    RecordCycles = FPlatformTime::Cycles64() - StartCycles;
+}
+
+void FBattleRecorder::RecordTarget(int32 EntityIndex, int32 TargetIndex)
+{
+    StepEvents.Add({ EReplayEventType::TargetAcquired, EntityIndex, TargetIndex, 0.0f });
+}
+
+void FBattleRecorder::RecordDamage(int32 AttackerIndex, int32 VictimIndex, float Amount)
+{
+    StepEvents.Add({ EReplayEventType::Damage, AttackerIndex, VictimIndex, Amount });
+}
+
+void FBattleRecorder::RecordDeath(int32 EntityIndex)
+{
+    StepEvents.Add({ EReplayEventType::Death, EntityIndex, INDEX_NONE, 0.0f });
+}
+
+void FBattleRecorder::EndStep(FBattleSimulation& Simulation)
+{
+    if (Segments.Num() == 0) return;
+
+    const uint64 StartCycles = FPlatformTime::Cycles64();
+
+    // 1. 这一步的事件编码进当前段（没有事件的步什么都不写）
+    FReplaySegment& Segment = Segments.Last();
+    const int32 StepInSegment = Simulation.GetStepCount() - 1 - Segment.StartStep;
+    Segment.NumSteps = StepInSegment + 1;
+
+    if (StepEvents.Num() > 0)
+    {
+        const int32 NumBytesBefore = Segment.Events.Num();
+        WriteVarUint(Segment.Events, StepInSegment - LastEventStep);
+        WriteVarUint(Segment.Events, StepEvents.Num());
+
+        int32 PrevEntity = 0;
+        for (const FPendingEvent& Event : StepEvents)
+        {
+            Segment.Events.Add((uint8)Event.Type);
+            WriteVarInt(Segment.Events, Event.EntityIndex - PrevEntity);
+            PrevEntity = Event.EntityIndex;
+
+            if (Event.Type != EReplayEventType::Death)
+            {
+                WriteVarUint(Segment.Events, Event.OtherIndex);
+            }
+            if (Event.Type == EReplayEventType::Damage)
+            {
+                // 伤害保留原始浮点，回放校验时按位比较
+                Segment.Events.Append((const uint8*)&Event.Amount, sizeof(float));
+            }
+        }
+
+        Segment.NumEvents += StepEvents.Num();
+        SegmentBytes += Segment.Events.Num() - NumBytesBefore;
+        LastEventStep = StepInSegment;
+        StepEvents.Reset();
+    }
+
+    // 2. 到了关键帧间隔就开新段
+    if (Simulation.GetStepCount() % KeyframeInterval == 0 && !Simulation.IsFinished())
+    {
+        StartSegment(Simulation);
+        TrimToBudget();
+    }
+
+    RecordCycles += FPlatformTime::Cycles64() - StartCycles;
+}
+
+void FBattleRecorder::StartSegment(FBattleSimulation& Simulation)
+{
+    FReplaySegment& Segment = Segments.AddDefaulted_GetRef();
+    Segment.StartStep = Simulation.GetStepCount();
+
+    FMemoryWriter Writer(Segment.Keyframe);
+    Simulation.SerializeState(Writer);
+
+    SegmentBytes += Segment.Keyframe.Num();
+    LastEventStep = 0;
+}
+
+void FBattleRecorder::TrimToBudget()
+{
+    // 至少留下正在写的这一段
+    int32 NumToDrop = 0;
+    while (SegmentBytes > MaxBytes && NumToDrop < Segments.Num() - 1)
+    {
+        SegmentBytes -= Segments[NumToDrop].Keyframe.Num() + Segments[NumToDrop].Events.Num();
+        NumToDrop++;
+    }
+
+    if (NumToDrop > 0)
+    {
+        Segments.RemoveAt(0, NumToDrop, false);
+        NumDroppedSegments += NumToDrop;
+    }
+}
+
+bool FBattleRecorder::SaveToFile(const FString& FilePath) const
+{
+    TArray<uint8> Bytes;
+    FMemoryWriter Writer(Bytes);
+
+    uint32 Magic = ReplayMagic;
+    uint32 Version = ReplayVersion;
+    int32 Interval = KeyframeInterval;
+    Writer << Magic << Version << Interval;
+    Writer << const_cast<TArray<uint8>&>(SetupBytes);
+    Writer << const_cast<TArray<FReplaySegment>&>(Segments);
+
+    return FFileHelper::SaveArrayToFile(Bytes, *FilePath);
+}
+
+int64 FBattleRecorder::GetNumBytes() const
+{
+    return SetupBytes.Num() + SegmentBytes;
+}
+
+int64 FBattleRecorder::GetNumEvents() const
+{
+    int64 Total = 0;
+    for (const FReplaySegment& Segment : Segments)
+    {
+        Total += Segment.NumEvents;
+    }
+    return Total;
+}
+
+double FBattleRecorder::GetRecordSeconds() const
+{
+    return FPlatformTime::ToMilliseconds64(RecordCycles) / 1000.0;
+}
+
+// ---------------------------------------------------------------------------
+// FBattleReplay
+// ---------------------------------------------------------------------------
+
+FBattleReplay::FBattleReplay()
+    : KeyframeInterval(1)
+    , Accumulator(0.0f)
+{
+}
+
+bool FBattleReplay::LoadFromFile(const FString& FilePath)
+{
+    TArray<uint8> Bytes;
+    if (!FFileHelper::LoadFileToArray(Bytes, *FilePath))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Cannot read replay: %s"), *FilePath);
+        return false;
+    }
+
+    FMemoryReader Reader(Bytes);
+    uint32 Magic = 0;
+    uint32 Version = 0;
+    TArray<uint8> SetupBytes;
+    Reader << Magic << Version;
+    // 关键帧就是 FBattleSimulation::SerializeState 的原始字节，格式不同的版本没法读
+    if (Magic != ReplayMagic || Version != ReplayVersion)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Unsupported replay file: %s"), *FilePath);
+        return false;
+    }
+
+    Reader << KeyframeInterval << SetupBytes << Segments;
+    if (Reader.IsError() || Segments.Num() == 0 || !Setup.LoadFromBytes(SetupBytes))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Corrupt replay file: %s"), *FilePath);
+        return false;
+    }
+
+    // 实体和兵种表只建一次，之后跳转只覆盖动态状态
+    Simulation.SetRecorder(nullptr);
+    Simulation.Init(Setup);
+    return RestoreKeyframe(0);
+}
+
+float FBattleReplay::GetStartTime() const
+{
+    return Segments.Num() > 0 ? Segments[0].StartStep * Setup.TimeStep : 0.0f;
+}
+
+float FBattleReplay::GetEndTime() const
+{
+    return GetEndStep() * Setup.TimeStep;
+}
+
+int32 FBattleReplay::GetEndStep() const
+{
+    return Segments.Num() > 0 ? Segments.Last().StartStep + Segments.Last().NumSteps : 0;
+}
+
+bool FBattleReplay::RestoreKeyframe(int32 SegmentIndex)
+{
+    FMemoryReader Reader(Segments[SegmentIndex].Keyframe);
+    Simulation.SerializeState(Reader);
+    Accumulator = 0.0f;
+    return !Reader.IsError();
+}
+
+bool FBattleReplay::SeekTo(float TargetTime)
+{
+    if (Segments.Num() == 0) return false;
+
+    const int32 TargetStep = FMath::Clamp(FMath::FloorToInt(TargetTime / Setup.TimeStep + KINDA_SMALL_NUMBER), Segments[0].StartStep, GetEndStep());
+
+    // 1. 不晚于目标的最后一个关键帧
+    int32 SegmentIndex = 0;
+    while (SegmentIndex + 1 < Segments.Num() && Segments[SegmentIndex + 1].StartStep <= TargetStep)
+    {
+        SegmentIndex++;
+    }
+
+    // 2. 目标就在当前位置之后、中间没有更近的关键帧时直接往后走，否则恢复关键帧
+    const int32 CurrentStep = Simulation.GetStepCount();
+    if (CurrentStep > TargetStep || CurrentStep < Segments[SegmentIndex].StartStep)
+    {
+        if (!RestoreKeyframe(SegmentIndex)) return false;
+    }
+
+    while (Simulation.GetStepCount() < TargetStep && !Simulation.IsFinished())
+    {
+        Simulation.Step();
+    }
+    Accumulator = 0.0f;
+    return true;
+}
+
+void FBattleReplay::Advance(float DeltaSeconds, float Speed)
+{
+    Accumulator += DeltaSeconds * FMath::Max(Speed, 0.0f);
+
+    const int32 EndStep = GetEndStep();
+    while (Accumulator >= Setup.TimeStep && Simulation.GetStepCount() < EndStep && !Simulation.IsFinished())
+    {
+        Simulation.Step();
+        Accumulator -= Setup.TimeStep;
+    }
+
+    if (Simulation.GetStepCount() >= EndStep)
+    {
+        Accumulator = 0.0f;
+    }
+}
+
+int32 FBattleReplay::Verify()
+{
+    if (Segments.Num() == 0 || !RestoreKeyframe(0)) return 0;
+
+    // 1. 用同样的分段方式重新录一遍
+    FBattleRecorder Check(KeyframeInterval, MAX_int64);
+    Simulation.SetRecorder(&Check);
+    Check.Begin(Setup, Simulation);
+
+    const int32 EndStep = GetEndStep();
+    while (Simulation.GetStepCount() < EndStep && !Simulation.IsFinished())
+    {
+        Simulation.Step();
+    }
+    Simulation.SetRecorder(nullptr);
+
+    // 2. 逐段比较（关键帧对不上说明这一段开头就已经偏了，事件对不上说明偏在段内）
+    const TArray<FReplaySegment>& Resimulated = Check.GetSegments();
+    for (int32 i = 0; i < Segments.Num(); i++)
+    {
+        if (!Resimulated.IsValidIndex(i) || Resimulated[i].Keyframe != Segments[i].Keyframe)
+        {
+            return Segments[i].StartStep;
+        }
+        if (Resimulated[i].Events != Segments[i].Events)
+        {
+            return Segments[i].StartStep;
+        }
+    }
+    return INDEX_NONE;
+}
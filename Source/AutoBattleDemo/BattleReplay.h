@@ -0,0 +1,128 @@
+// BattleReplay.h：战斗录像（开局布局 + 增量编码的事件流 + 定期关键帧）和回放
+// 录像挂在 FBattleSimulation 上，游戏内和无头模拟器都能录；回放时从关键帧恢复后重新模拟，
+// 模拟是确定性的，所以回放出来的每一步都和录制时一样
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BattleSimulation.h"
+
+// 录像里的事件
+enum class EReplayEventType : uint8
+{
+    TargetAcquired,  // Entity 锁定了 Other
+    Damage,          // Entity 对 Other 造成 Amount 点伤害（克制之后）
+    Death            // Entity 死亡
+};
+
+/**
+ * 录像的一段：开头一个关键帧，后面是 KeyframeInterval 步以内的事件
+ * 环形缓冲按段丢弃，留下来的每一段都能独立回放
+ */
+struct FReplaySegment
+{
+    int32 StartStep = 0;
+    int32 NumSteps = 0;
+    int32 NumEvents = 0;
+    TArray<uint8> Keyframe;   // StartStep 时的 FBattleSimulation::SerializeState
+    TArray<uint8> Events;     // 只记有事件的步：步数差 + 事件数 + 事件（下标差用变长整数）
+
+    friend FArchive& operator<<(FArchive& Ar, FReplaySegment& Segment);
+};
+
+/**
+ * 录像机：事件先攒在当前步里，步结束时编码进当前段；总大小超过上限就丢掉最早的段
+ */
+class AUTOBATTLEDEMO_API FBattleRecorder
+{
+public:
+    /**
+     * @param InKeyframeInterval 每隔多少步存一个关键帧（默认 30 步/秒下 5 秒一个）
+     * @param InMaxBytes 环形缓冲的上限（字节）
+     */
+    explicit FBattleRecorder(int32 InKeyframeInterval = 150, int64 InMaxBytes = 32 * 1024 * 1024);
+
+    // --- 由模拟器调用 ---
+    void Begin(const FBattleSetup& Setup, FBattleSimulation& Simulation);
+    void RecordTarget(int32 EntityIndex, int32 TargetIndex);
+    void RecordDamage(int32 AttackerIndex, int32 VictimIndex, float Amount);
+    void RecordDeath(int32 EntityIndex);
+    void EndStep(FBattleSimulation& Simulation);
+
+    // 把缓冲里的录像写成文件（Saved/Replays/*.abrp）
+    bool SaveToFile(const FString& FilePath) const;
+
+    const TArray<FReplaySegment>& GetSegments() const { return Segments; }
+    int32 GetKeyframeInterval() const { return KeyframeInterval; }
+    int64 GetNumBytes() const;
+    int64 GetNumEvents() const;
+    int32 GetNumDroppedSegments() const { return NumDroppedSegments; }
+
+    // 录像本身花掉的时间（编码事件 + 存关键帧）
+    double GetRecordSeconds() const;
+
+private:
+    struct FPendingEvent
+    {
+        EReplayEventType Type;
+        int32 EntityIndex;
+        int32 OtherIndex;
+        float Amount;
+    };
+
+    void StartSegment(FBattleSimulation& Simulation);
+    void TrimToBudget();
+
+    int32 KeyframeInterval;
+    int64 MaxBytes;
+
+    TArray<uint8> SetupBytes;
+    TArray<FReplaySegment> Segments;
+    int64 SegmentBytes;
+    int32 NumDroppedSegments;
+
+    TArray<FPendingEvent> StepEvents;
+    int32 LastEventStep;        // 当前段里上一个有事件的步（相对段首）
+    uint64 RecordCycles;
+};
+
+/**
+ * 回放：按时间跳转（从最近的关键帧恢复再往后模拟）、按任意倍速推进、校验录像能否复现
+ */
+class AUTOBATTLEDEMO_API FBattleReplay
+{
+public:
+    FBattleReplay();
+
+    bool LoadFromFile(const FString& FilePath);
+
+    const FBattleSetup& GetSetup() const { return Setup; }
+    const TArray<FReplaySegment>& GetSegments() const { return Segments; }
+    const FBattleSimulation& GetSimulation() const { return Simulation; }
+
+    // 录像覆盖的时间范围（环形缓冲丢过段的话起点不是 0）
+    float GetStartTime() const;
+    float GetEndTime() const;
+
+    // 跳到指定时间：比当前晚且在同一段内就直接往后模拟，否则先恢复不晚于它的最近关键帧
+    bool SeekTo(float TargetTime);
+
+    // 按 Speed 倍速推进 DeltaSeconds 的真实时间（游戏里每帧调用），到录像结尾为止
+    void Advance(float DeltaSeconds, float Speed);
+
+    /**
+     * 从最早的关键帧开始重新模拟整段录像，逐段比对关键帧和事件流
+     * @return 第一处对不上的段的起始步，全部一致返回 INDEX_NONE
+     */
+    int32 Verify();
+
+private:
+    bool RestoreKeyframe(int32 SegmentIndex);
+    int32 GetEndStep() const;
+
+    FBattleSetup Setup;
+    int32 KeyframeInterval;
+    TArray<FReplaySegment> Segments;
+
+    FBattleSimulation Simulation;
+    float Accumulator;
+};
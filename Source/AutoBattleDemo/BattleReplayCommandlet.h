@@ -0,0 +1,19 @@
+// BattleReplayCommandlet.h：无头回放录像
+// 用法：UE4Editor-Cmd AutoBattleDemo.uproject -run=BattleReplay -replay=<录像文件> [-seek=<秒>] [-verify] -nullrhi
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "BattleReplayCommandlet.generated.h"
+
+UCLASS()
+class AUTOBATTLEDEMO_API UBattleReplayCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UBattleReplayCommandlet();
+
+    // 读录像，跳到指定时间打印当时的战况（统计跳转耗时），-verify 时重新模拟整段并比对，对不上返回 2
+    virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,289 @@
+#include "BattleSimCommandlet.h"
+#include "BattleSimulation.h"
+#include "BattleReplay.h"
+#include "BattlePerfReport.h"
+#include "BaseUnit.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/PlatformProcess.h"
+#include "Math/RandomStream.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+namespace
+{
+    // 弹道容量压测：让 NumProjectiles 支箭一直在飞（落地一支补一支），
+    // 每步推进 + 在落点查邻居格子，统计每步耗时
+    void RunProjectileBenchmark(const FBattleSetup& Setup, int32 NumProjectiles, int32 Steps)
+    {
+        const FGridMap& Grid = Setup.Grid;
+        const FVector2D BoundsMin(Grid.GetOrigin().X, Grid.GetOrigin().Y);
+        const FVector2D BoundsMax = BoundsMin + FVector2D(Grid.GetWidth(), Grid.GetHeight()) * Grid.GetTileSize();
+
+        // 1. 用布局里的实体建一次邻居格子（压测只看弹道本身，实体不动）
+        FCrowdAvoidance SpatialIndex;
+        SpatialIndex.Reset(Setup.Avoidance, BoundsMin, BoundsMax);
+        for (int32 i = 0; i < Setup.Entities.Num(); i++)
+        {
+            SpatialIndex.AddAgent(i, Setup.Entities[i].Location);
+        }
+        SpatialIndex.Finalize();
+
+        FRandomStream Random(12345);
+        auto RandomPoint = [&]()
+        {
+            return FVector(Random.FRandRange(BoundsMin.X, BoundsMax.X), Random.FRandRange(BoundsMin.Y, BoundsMax.Y), 0.0f);
+        };
+
+        FProjectileSystem Projectiles;
+        const float Speed = 1500.0f;
+        for (int32 i = 0; i < NumProjectiles; i++)
+        {
+            Projectiles.Spawn(0, (ETeam)(i & 1), RandomPoint(), RandomPoint(), Speed, 10.0f);
+        }
+
+        // 2. 定步长推进，只计推进和命中查询的时间
+        TArray<FProjectileImpact> Impacts;
+        int64 Hits = 0;
+        int64 Impacted = 0;
+        double AdvanceSeconds = 0.0;
+        double QuerySeconds = 0.0;
+        for (int32 Step = 0; Step < Steps; Step++)
+        {
+            Impacts.Reset();
+            const double AdvanceStart = FPlatformTime::Seconds();
+            Projectiles.Advance(Setup.TimeStep, Impacts);
+            const double QueryStart = FPlatformTime::Seconds();
+            AdvanceSeconds += QueryStart - AdvanceStart;
+
+            for (const FProjectileImpact& Impact : Impacts)
+            {
+                bool bHit = false;
+                SpatialIndex.ForEachAgentInRadius(Impact.Location, Setup.Avoidance.AgentRadius, [&](int32 EntityIndex, float DistSq)
+                {
+                    bHit |= Setup.Entities[EntityIndex].Team != Impact.OwnerTeam;
+                });
+                Hits += bHit ? 1 : 0;
+            }
+            QuerySeconds += FPlatformTime::Seconds() - QueryStart;
+            Impacted += Impacts.Num();
+
+            // 补满（不计时）
+            for (const FProjectileImpact& Impact : Impacts)
+            {
+                Projectiles.Spawn(0, Impact.OwnerTeam, RandomPoint(), RandomPoint(), Speed, 10.0f);
+            }
+        }
+
+        const double StepMicroseconds = (AdvanceSeconds + QuerySeconds) * 1e6 / FMath::Max(Steps, 1);
+        UE_LOG(LogTemp, Display, TEXT("Projectile bench: %d in flight, %d steps, %.3fus/step (advance %.3fus, impacts %.3fus), %lld impacts, %lld hits"),
+            NumProjectiles, Steps, StepMicroseconds,
+            AdvanceSeconds * 1e6 / FMath::Max(Steps, 1), QuerySeconds * 1e6 / FMath::Max(Steps, 1), Impacted, Hits);
+        UE_LOG(LogTemp, Display, TEXT("Projectile bench: %.0f projectiles per ms of step time (SIMD %s)"),
+            StepMicroseconds > 0.0 ? NumProjectiles * 1000.0 / StepMicroseconds : 0.0,
+            AUTOBATTLE_PROJECTILE_SIMD ? TEXT("on") : TEXT("off"));
+    }
+}
+
+UBattleSimCommandlet::UBattleSimCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = false;
+    LogToConsole = true;
+}
+
+int32 UBattleSimCommandlet::Main(const FString& Params)
+{
+    // 1. 解析参数
+    FString SetupPath;
+    if (!FParse::Value(*Params, TEXT("setup="), SetupPath))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Usage: -run=BattleSim -setup=<file.bsetup> [-runs=N] [-quiet] [-noavoidance] [-projectilebench=N] [-record=<file.abrp>] [-csv] [-perfreport[=<path>]]"));
+        return 1;
+    }
+
+    int32 Runs = 1;
+    FParse::Value(*Params, TEXT("runs="), Runs);
+    Runs = FMath::Max(Runs, 1);
+    const bool bQuiet = FParse::Param(*Params, TEXT("quiet"));
+    // 压测时用来对比开/关避让的效果
+    const bool bNoAvoidance = FParse::Param(*Params, TEXT("noavoidance"));
+
+    // 2. 读取布局
+    FBattleSetup Setup;
+    if (!Setup.LoadFromFile(SetupPath))
+    {
+        return 1;
+    }
+
+    if (bNoAvoidance)
+    {
+        Setup.Avoidance.bEnabled = false;
+    }
+
+    UE_LOG(LogTemp, Display, TEXT("Loaded %s: grid %dx%d, %d entities, step %.4fs"),
+        *SetupPath, Setup.Grid.GetWidth(), Setup.Grid.GetHeight(), Setup.Entities.Num(), Setup.TimeStep);
+
+    // 只压测弹道（例如 -projectilebench=10000）
+    int32 BenchProjectiles = 0;
+    if (FParse::Value(*Params, TEXT("projectilebench="), BenchProjectiles) && BenchProjectiles > 0)
+    {
+        RunProjectileBenchmark(Setup, BenchProjectiles, 1000);
+        return 0;
+    }
+
+    // 3. 全速模拟（跑多次取总时间，顺便确认每次结果一致）
+    FBattleResult FirstResult;
+    FSimulationStats FirstStats;
+    double TotalWallSeconds = 0.0;
+    double TotalSimSeconds = 0.0;
+
+    for (int32 Run = 0; Run < Runs; Run++)
+    {
+        FBattleSimulation Simulation;
+        Simulation.Init(Setup);
+
+        const double StartTime = FPlatformTime::Seconds();
+        const FBattleResult Result = Simulation.RunToCompletion();
+        TotalWallSeconds += FPlatformTime::Seconds() - StartTime;
+        TotalSimSeconds += Result.Duration;
+
+        if (Run == 0)
+        {
+            FirstResult = Result;
+            FirstStats = Simulation.GetStats();
+            if (!bQuiet)
+            {
+                Simulation.LogReport(TEXT("Headless"));
+            }
+        }
+        else if (Result.Outcome != FirstResult.Outcome || Result.Steps != FirstResult.Steps)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Run %d diverged: %s after %d steps (first run: %s after %d steps)"),
+                Run, FBattleSimulation::OutcomeToString(Result.Outcome), Result.Steps,
+                FBattleSimulation::OutcomeToString(FirstResult.Outcome), FirstResult.Steps);
+            return 2;
+        }
+    }
+
+    // 每个单位占多少内存：模拟状态 + 共用的兵种表 + 场景里的 Actor
+    {
+        FBattleSimulation Simulation;
+        Simulation.Init(Setup);
+        const int32 NumArchetypes = Simulation.GetArchetypes().Num();
+        UE_LOG(LogTemp, Display, TEXT("Memory: FSimEntity %d bytes/unit, %d archetypes x %d bytes shared, ABaseUnit %d bytes/actor"),
+            (int32)sizeof(FSimEntity), NumArchetypes, (int32)sizeof(FSimArchetype), (int32)sizeof(ABaseUnit));
+    }
+
+    // 4. 模拟速度：每秒真实时间能跑多少秒战斗
+    const double SimSecondsPerWallSecond = TotalWallSeconds > 0.0 ? TotalSimSeconds / TotalWallSeconds : 0.0;
+    UE_LOG(LogTemp, Display, TEXT("Result: %s, Duration: %.3fs, Runs: %d, Wall: %.3fms/run, Speed: %.1f sim-s per wall-s"),
+        FBattleSimulation::OutcomeToString(FirstResult.Outcome), FirstResult.Duration, Runs,
+        TotalWallSeconds * 1000.0 / Runs, SimSecondsPerWallSecond);
+    UE_LOG(LogTemp, Display, TEXT("Paths: %d, Overlapping unit-steps: %lld, Avoidance: %s, %.3fus/query"),
+        FirstStats.PathRequests, FirstStats.OverlapUnitSteps, Setup.Avoidance.bEnabled ? TEXT("on") : TEXT("off"),
+        FirstStats.AvoidanceQueries > 0 ? FPlatformTime::ToMilliseconds64(FirstStats.AvoidanceCycles) * 1000.0 / FirstStats.AvoidanceQueries : 0.0);
+
+    // 5. 录像（例如 -record=Saved/Replays/test.abrp）：再跑一遍带录像的，报告开销和文件大小
+    FString RecordPath;
+    if (FParse::Value(*Params, TEXT("record="), RecordPath))
+    {
+        FBattleRecorder Recorder;
+        FBattleSimulation Simulation;
+        Simulation.SetRecorder(&Recorder);
+        Simulation.Init(Setup);
+
+        const double StartTime = FPlatformTime::Seconds();
+        const FBattleResult Result = Simulation.RunToCompletion();
+        const double RecordedWallSeconds = FPlatformTime::Seconds() - StartTime;
+
+        if (!Recorder.SaveToFile(RecordPath))
+        {
+            UE_LOG(LogTemp, Error, TEXT("Cannot write replay %s"), *RecordPath);
+            return 1;
+        }
+
+        const double Minutes = FMath::Max(Result.Duration / 60.0, 1e-6);
+        UE_LOG(LogTemp, Display, TEXT("Replay: %s, %d units, %lld events, %d segments, %.1f KB (%.1f KB per battle minute)"),
+            *RecordPath, Setup.Entities.Num(), Recorder.GetNumEvents(), Recorder.GetSegments().Num(),
+            Recorder.GetNumBytes() / 1024.0, Recorder.GetNumBytes() / 1024.0 / Minutes);
+        UE_LOG(LogTemp, Display, TEXT("Replay: recording took %.3fms of %.3fms (%.2f%% overhead)"),
+            Recorder.GetRecordSeconds() * 1000.0, RecordedWallSeconds * 1000.0,
+            RecordedWallSeconds > 0.0 ? Recorder.GetRecordSeconds() * 100.0 / RecordedWallSeconds : 0.0);
+    }
+
+#if CSV_PROFILER
+    // 6. CSV 采集（-csv）：再跑一遍，每个模拟步算一帧，AutoBattle 分类下每个阶段一列
+    //    命令行没有引擎主循环，帧的起止由这里手动调用；文件写到 Saved/Profiling/CSV/<布局名>.csv
+    if (FParse::Param(*Params, TEXT("csv")))
+    {
+        FCsvProfiler* Csv = FCsvProfiler::Get();
+        Csv->BeginCapture(-1, FString(), FPaths::GetBaseFilename(SetupPath) + TEXT(".csv"));
+
+        FBattleSimulation Simulation;
+        Simulation.Init(Setup);
+        while (!Simulation.IsFinished())
+        {
+            Csv->BeginFrame();
+            Simulation.Step();
+            Csv->EndFrame();
+        }
+
+        // 结束请求要到下一帧末尾才处理，写文件在后台线程，等它写完再退出
+        Csv->EndCapture();
+        Csv->BeginFrame();
+        Csv->EndFrame();
+        while (Csv->IsWritingFile())
+        {
+            FPlatformProcess::Sleep(0.01f);
+        }
+        UE_LOG(LogTemp, Display, TEXT("CSV capture: %d frames written"), Simulation.GetStepCount());
+    }
+#endif
+
+    // 7. 性能报告（-perfreport 或 -perfreport=<不带扩展名的路径>）：再跑一遍，每个模拟步算一帧，
+    //    写出和游戏内同样格式的 .json / .csv，自动化跑一批布局就能收集一批报告
+    //    默认写到 Saved/Profiling/BattleReports/<布局名>-headless
+    FString ReportPath = FPaths::ProjectSavedDir() / TEXT("Profiling") / TEXT("BattleReports") / (FPaths::GetBaseFilename(SetupPath) + TEXT("-headless"));
+    if (FParse::Value(*Params, TEXT("perfreport="), ReportPath) || FParse::Param(*Params, TEXT("perfreport")))
+    {
+        FBattlePerfReport Report;
+        Report.Begin(FPaths::GetBaseFilename(SetupPath));
+
+        FBattleSimulation Simulation;
+        Simulation.SetCollectPhaseTimings(true);
+        Simulation.Init(Setup);
+
+        uint64 SimCycles[(int32)ESimPhase::Count];
+        double PhaseMs[FBattlePerfReport::NumPhases];
+        while (!Simulation.IsFinished())
+        {
+            const uint64 StartCycles = FPlatformTime::Cycles64();
+            Simulation.Step();
+            const uint64 StepCycles = FPlatformTime::Cycles64() - StartCycles;
+
+            // 没有 Actor 也没有 HUD，整帧就是这一步模拟
+            Simulation.ConsumePhaseTimings(SimCycles);
+            PhaseMs[(int32)EBattlePerfPhase::Frame] = FPlatformTime::ToMilliseconds64(StepCycles);
+            PhaseMs[(int32)EBattlePerfPhase::AI] = FPlatformTime::ToMilliseconds64(SimCycles[(int32)ESimPhase::AI]);
+            PhaseMs[(int32)EBattlePerfPhase::Pathfinding] = FPlatformTime::ToMilliseconds64(SimCycles[(int32)ESimPhase::Pathfinding]);
+            PhaseMs[(int32)EBattlePerfPhase::Movement] = FPlatformTime::ToMilliseconds64(SimCycles[(int32)ESimPhase::Movement]);
+            PhaseMs[(int32)EBattlePerfPhase::Combat] = FPlatformTime::ToMilliseconds64(SimCycles[(int32)ESimPhase::Combat]);
+            PhaseMs[(int32)EBattlePerfPhase::HUD] = 0.0;
+            Report.AddFrame(PhaseMs, Simulation.GetTeamAliveCount(ETeam::Player) + Simulation.GetTeamAliveCount(ETeam::Enemy));
+        }
+
+        const FPerfHistogram& Frame = Report.GetHistogram(EBattlePerfPhase::Frame);
+        UE_LOG(LogTemp, Display, TEXT("Perf report: %lld frames, frame p50 %.3fms p99 %.3fms max %.3fms"),
+            Report.GetNumFrames(), Frame.GetPercentile(0.5), Frame.GetPercentile(0.99), Frame.GetMaxMs());
+
+        if (!Report.WriteJson(ReportPath + TEXT(".json")) || !Report.WriteCsv(ReportPath + TEXT(".csv")))
+        {
+            UE_LOG(LogTemp, Error, TEXT("Cannot write perf report %s"), *ReportPath);
+            return 1;
+        }
+        UE_LOG(LogTemp, Display, TEXT("Perf report: %s.json / .csv"), *ReportPath);
+    }
+
+    return 0;
+}
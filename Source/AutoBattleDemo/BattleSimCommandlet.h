@@ -0,0 +1,19 @@
+// BattleSimCommandlet.h：无头战斗模拟器
+// 用法：UE4Editor-Cmd AutoBattleDemo.uproject -run=BattleSim -setup=<布局文件> [-runs=N] [-quiet] [-noavoidance] [-projectilebench=N] [-record=<录像文件>] [-csv] [-perfreport[=<报告路径>]] -nullrhi
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "BattleSimCommandlet.generated.h"
+
+UCLASS()
+class AUTOBATTLEDEMO_API UBattleSimCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UBattleSimCommandlet();
+
+    // 读取布局，按定步长全速跑完战斗，输出胜负、时长、每个单位的伤害统计和模拟速度
+    virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,1375 @@
+// BattleSimulation.cpp：单位 AI 状态机（从 ABaseUnit 迁移过来，行为保持一致）
+#include "BattleSimulation.h"
+#include "BattleReplay.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "HAL/PlatformTime.h"
+#include "PerfCounters.h"
+#include "AutoBattleStats.h"
+
+namespace
+{
+    // 布局文件头
+    const uint32 BattleSetupMagic = 0x54534241; // "ABST"
+    // 1：初版；2：加入避让参数；3：加入弹道速度；4：加入兵种克制表；5：加入建筑占地；6：加入溅射半径；
+    // 7：加入目标类别和索敌策略
+    const uint32 BattleSetupVersion = 7;
+
+    // 到达路径点的容差（10cm，距离平方）
+    const float PathPointToleranceSq = 100.0f;
+
+    // 文件里一个实体最少占的字节数（空名字 4 + 阵营 1 + 兵种 1 + bIsUnit 4 + 位置 12 + 五个属性 20）
+    const int64 MinSerializedSpawnBytes = 42;
+}
+
+FArchive& operator<<(FArchive& Ar, FSimEntitySpawn& Spawn)
+{
+    Ar << Spawn.Name << Spawn.Team << Spawn.UnitType << Spawn.bIsUnit << Spawn.Location;
+    Ar << Spawn.MaxHealth << Spawn.AttackRange << Spawn.Damage << Spawn.MoveSpeed << Spawn.AttackInterval;
+    return Ar;
+}
+
+void FBattleSetup::Serialize(FArchive& Ar, uint32 Version)
+{
+    Ar << Grid;
+    if (Ar.IsError()) return;
+
+    // 实体数同样先核对剩余长度再分配
+    if (Ar.IsLoading())
+    {
+        int32 NumEntities = 0;
+        Ar << NumEntities;
+        if (Ar.IsError() || NumEntities < 0
+            || (Ar.TotalSize() >= 0 && Ar.TotalSize() - Ar.Tell() < NumEntities * MinSerializedSpawnBytes))
+        {
+            Ar.SetError();
+            return;
+        }
+        Entities.Reset(NumEntities);
+        Entities.AddDefaulted(NumEntities);
+        for (FSimEntitySpawn& Spawn : Entities)
+        {
+            Ar << Spawn;
+        }
+    }
+    else
+    {
+        Ar << Entities;
+    }
+    Ar << TimeStep << MaxBattleTime;
+
+    if (Version >= 2)
+    {
+        Ar << Avoidance;
+    }
+    else if (Ar.IsLoading())
+    {
+        // 老布局录制时还没有避让，保持关闭才能复现当时的结果
+        Avoidance.bEnabled = false;
+    }
+
+    // 弹道速度单独追加在最后，老文件读进来全是 0（即时结算）
+    if (Version >= 3)
+    {
+        for (FSimEntitySpawn& Spawn : Entities)
+        {
+            Ar << Spawn.ProjectileSpeed;
+        }
+    }
+
+    if (Version >= 4)
+    {
+        Ar << DamageModifiers;
+    }
+
+    // 老文件里的建筑都不占格子
+    if (Version >= 5)
+    {
+        for (FSimEntitySpawn& Spawn : Entities)
+        {
+            Ar << Spawn.Footprint;
+        }
+    }
+
+    if (Version >= 6)
+    {
+        for (FSimEntitySpawn& Spawn : Entities)
+        {
+            Ar << Spawn.SplashRadius;
+        }
+    }
+
+    if (Version >= 7)
+    {
+        for (FSimEntitySpawn& Spawn : Entities)
+        {
+            Ar << Spawn.TargetClass << Spawn.Targeting;
+        }
+    }
+    else if (Ar.IsLoading())
+    {
+        // 老文件按原来的规则归类（策略为空，谁近打谁）
+        for (FSimEntitySpawn& Spawn : Entities)
+        {
+            Spawn.TargetClass = Spawn.bIsUnit ? ETargetClass::Unit
+                : Spawn.Damage > 0.0f && Spawn.AttackRange > 0.0f ? ETargetClass::Defense : ETargetClass::Building;
+        }
+    }
+}
+
+bool FBattleSetup::SaveToFile(const FString& FilePath) const
+{
+    TArray<uint8> Bytes;
+    SaveToBytes(Bytes);
+    return FFileHelper::SaveArrayToFile(Bytes, *FilePath);
+}
+
+bool FBattleSetup::LoadFromFile(const FString& FilePath)
+{
+    TArray<uint8> Bytes;
+    if (!FFileHelper::LoadFileToArray(Bytes, *FilePath))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Cannot read battle setup: %s"), *FilePath);
+        return false;
+    }
+
+    if (!LoadFromBytes(Bytes))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Unsupported battle setup file: %s"), *FilePath);
+        return false;
+    }
+    return true;
+}
+
+void FBattleSetup::SaveToBytes(TArray<uint8>& OutBytes) const
+{
+    OutBytes.Reset();
+    FMemoryWriter Writer(OutBytes);
+
+    uint32 Magic = BattleSetupMagic;
+    uint32 Version = BattleSetupVersion;
+    Writer << Magic << Version;
+    const_cast<FBattleSetup*>(this)->Serialize(Writer, Version);
+}
+
+bool FBattleSetup::LoadFromBytes(const TArray<uint8>& Bytes)
+{
+    FMemoryReader Reader(Bytes);
+    uint32 Magic = 0;
+    uint32 Version = 0;
+    Reader << Magic << Version;
+    if (Magic != BattleSetupMagic || Version == 0 || Version > BattleSetupVersion)
+    {
+        return false;
+    }
+
+    // 读进临时对象，完整读完才替换，坏文件不会留下半截布局
+    FBattleSetup Loaded;
+    Loaded.Serialize(Reader, Version);
+    if (Reader.IsError()) return false;
+
+    *this = MoveTemp(Loaded);
+    return true;
+}
+
+FBattleSimulation::FBattleSimulation()
+    : Time(0.0f)
+    , TimeStep(1.0f / 30.0f)
+    , MaxBattleTime(300.0f)
+    , StepCount(0)
+    , Outcome(EBattleOutcome::InProgress)
+    , bUsePathCache(true)
+    , ReplanSyncedRevision(0)
+    , MaxReplansPerStep(8)
+    , bHasSplash(false)
+    , Recorder(nullptr)
+    , bCollectEvents(false)
+    , bCollectPhaseTimings(false)
+    , ActivePhase(INDEX_NONE)
+    , ActivePhaseStart(0)
+{
+    TeamAliveCounts[0] = TeamAliveCounts[1] = 0;
+    TeamHealth[0] = TeamHealth[1] = 0.0f;
+    FMemory::Memzero(PhaseCycles);
+}
+
+FBattleSimulation::FPhaseScope::FPhaseScope(FBattleSimulation& InSimulation, ESimPhase Phase)
+    : Simulation(InSimulation.bCollectPhaseTimings ? &InSimulation : nullptr)
+    , ParentPhase(INDEX_NONE)
+{
+    if (!Simulation) return;
+
+    const uint64 Now = FPlatformTime::Cycles64();
+    ParentPhase = Simulation->ActivePhase;
+    if (ParentPhase != INDEX_NONE)
+    {
+        Simulation->PhaseCycles[ParentPhase] += Now - Simulation->ActivePhaseStart;
+    }
+    Simulation->ActivePhase = (int32)Phase;
+    Simulation->ActivePhaseStart = Now;
+}
+
+FBattleSimulation::FPhaseScope::~FPhaseScope()
+{
+    if (!Simulation) return;
+
+    const uint64 Now = FPlatformTime::Cycles64();
+    Simulation->PhaseCycles[Simulation->ActivePhase] += Now - Simulation->ActivePhaseStart;
+    Simulation->ActivePhase = ParentPhase;
+    Simulation->ActivePhaseStart = Now;
+}
+
+void FBattleSimulation::ConsumePhaseTimings(uint64 (&OutCycles)[(int32)ESimPhase::Count])
+{
+    FMemory::Memcpy(OutCycles, PhaseCycles);
+    FMemory::Memzero(PhaseCycles);
+}
+
+void FBattleSimulation::Init(const FBattleSetup& Setup)
+{
+    Grid = Setup.Grid;
+    SET_MEMORY_STAT(STAT_AutoBattle_SimGridMemory, Grid.GetAllocatedSize());
+    PathCache.Reset();
+    TimeStep = Setup.TimeStep;
+    MaxBattleTime = Setup.MaxBattleTime;
+    AvoidanceSettings = Setup.Avoidance;
+    Time = 0.0f;
+    StepCount = 0;
+    Outcome = EBattleOutcome::InProgress;
+    Stats = FSimulationStats();
+    FMemory::Memzero(PhaseCycles);
+    ActivePhase = INDEX_NONE;
+    PendingDeaths.Reset();
+    PendingPathUpdates.Reset();
+    Projectiles.Reset();
+    DamageModifiers.Build(Setup.DamageModifiers);
+    DamageQueue.Reset();
+
+    TeamAliveCounts[0] = TeamAliveCounts[1] = 0;
+    TeamHealth[0] = TeamHealth[1] = 0.0f;
+
+    Archetypes.Reset();
+    Entities.Reset(Setup.Entities.Num());
+    for (const FSimEntitySpawn& Spawn : Setup.Entities)
+    {
+        FSimEntity& Entity = Entities.AddDefaulted_GetRef();
+        Entity.Name = Spawn.Name;
+        Entity.Team = Spawn.Team;
+        Entity.UnitType = Spawn.UnitType;
+        Entity.bIsUnit = Spawn.bIsUnit;
+        Entity.bActive = true;
+        Entity.bAlive = true;
+        Entity.Location = Spawn.Location;
+        Entity.Rotation = FRotator::ZeroRotator;
+        Entity.Footprint = Spawn.Footprint;
+        Entity.TargetClass = Spawn.TargetClass;
+
+        Entity.MaxHealth = Spawn.MaxHealth;
+        Entity.CurrentHealth = Spawn.MaxHealth;
+        Entity.ArchetypeIndex = FindOrAddArchetype(Spawn);
+
+        Entity.State = EUnitState::Idle;
+        Entity.TargetIndex = INDEX_NONE;
+        Entity.CurrentPathIndex = 0;
+        // 开战后第一下可以立即出手（原来用的是关卡时间，开战时早已超过攻击间隔）
+        Entity.LastAttackTime = -Spawn.AttackInterval;
+
+        Entity.DamageDealt = 0.0f;
+        Entity.DamageTaken = 0.0f;
+        Entity.Kills = 0;
+        Entity.DeathTime = -1.0f;
+
+        TeamAliveCounts[(int32)Entity.Team]++;
+        TeamHealth[(int32)Entity.Team] += Entity.CurrentHealth;
+    }
+
+    // 会攻击的建筑交给防御塔系统
+    FVector2D BoundsMin;
+    FVector2D BoundsMax;
+    GetBattleBounds(BoundsMin, BoundsMax);
+    Towers.Reset(BoundsMin, BoundsMax);
+    for (int32 i = 0; i < Entities.Num(); i++)
+    {
+        const FSimEntity& Entity = Entities[i];
+        const FSimArchetype& Archetype = Archetypes[Entity.ArchetypeIndex];
+        if (!Entity.bIsUnit && Archetype.Damage > 0.0f && Archetype.AttackRange > 0.0f)
+        {
+            Towers.AddTower(i, Entity.Team, Entity.Location, Archetype.AttackRange, Archetype.AttackInterval, Entity.LastAttackTime);
+        }
+    }
+    Towers.FinalizeTowers();
+
+    RebuildTargetCandidates();
+
+    ReplanIndex.Reset(Grid.GetWidth(), Grid.GetHeight(), Entities.Num());
+    ReplanQueue.Reset();
+    ReplanQueued.Init(false, Entities.Num());
+    ReplanSyncedRevision = Grid.GetRevision();
+
+    AreaDamage.Reset(Entities.Num());
+    AreaDamage.ResetStats();
+    bHasSplash = Archetypes.ContainsByPredicate([](const FSimArchetype& Archetype) { return Archetype.SplashRadius > 0.0f; });
+
+    UpdateOutcome();
+
+    if (Recorder)
+    {
+        Recorder->Begin(Setup, *this);
+    }
+}
+
+int32 FBattleSimulation::FindOrAddArchetype(const FSimEntitySpawn& Spawn)
+{
+    FSimArchetype Archetype;
+    Archetype.AttackRange = Spawn.AttackRange;
+    Archetype.Damage = Spawn.Damage;
+    Archetype.MoveSpeed = Spawn.MoveSpeed;
+    Archetype.AttackInterval = Spawn.AttackInterval;
+    Archetype.ProjectileSpeed = Spawn.ProjectileSpeed;
+    Archetype.SplashRadius = Spawn.SplashRadius;
+    Archetype.Targeting = Spawn.Targeting;
+
+    // 兵种就那么几个，线性查找就够了
+    const int32 Existing = Archetypes.IndexOfByKey(Archetype);
+    return Existing != INDEX_NONE ? Existing : Archetypes.Add(Archetype);
+}
+
+void FBattleSimulation::Step()
+{
+    if (IsFinished()) return;
+
+    AUTOBATTLE_SCOPE_PHASE(STAT_AutoBattle_SimStep, SimStep);
+    FPerfCounters::Add(EPerfCounter::SimSteps, 1);
+
+    // 弹道落地和溅射都要查附近的实体，有箭在飞或有溅射兵种时即使关了避让也要建格子
+    if (AvoidanceSettings.bEnabled || Projectiles.Num() > 0 || bHasSplash)
+    {
+        FPerfScopeCycles Scope(EPerfCounter::PhaseAvoidanceCycles);
+        FPhaseScope PhaseScope(*this, ESimPhase::Movement);
+        AUTOBATTLE_SCOPE_PHASE(STAT_AutoBattle_SimAvoidance, Avoidance);
+        BuildAvoidanceGrid();
+    }
+
+    // 先结算上一步射出的箭，再让单位行动（这一步射出的箭下一步才开始飞）
+    {
+        FPerfScopeCycles Scope(EPerfCounter::PhaseProjectileCycles);
+        FPhaseScope PhaseScope(*this, ESimPhase::Combat);
+        AUTOBATTLE_SCOPE_PHASE(STAT_AutoBattle_SimProjectiles, Projectiles);
+        UpdateProjectiles();
+    }
+
+    // 上一步网格变化排进队列的单位，这一步先分一部分重新寻路
+    if (ReplanQueue.Num() > 0)
+    {
+        FPerfScopeCycles Scope(EPerfCounter::PhaseReplanCycles);
+        FPhaseScope PhaseScope(*this, ESimPhase::Pathfinding);
+        AUTOBATTLE_SCOPE_PHASE(STAT_AutoBattle_SimReplans, Replans);
+        ProcessReplanQueue();
+    }
+
+    // 按数组顺序更新，保证结果与 Actor 的 Tick 顺序无关
+    {
+        FPerfScopeCycles Scope(EPerfCounter::PhaseUnitCycles);
+        AUTOBATTLE_SCOPE_PHASE(STAT_AutoBattle_SimUnits, Units);
+        int32 NumTicked = 0;
+        for (int32 i = 0; i < Entities.Num(); i++)
+        {
+            if (Entities[i].bIsUnit && Entities[i].bAlive && Entities[i].bActive)
+            {
+                TickUnit(i);
+                NumTicked++;
+            }
+        }
+        FPerfCounters::Add(EPerfCounter::UnitsTicked, NumTicked);
+        INC_DWORD_STAT_BY(STAT_AutoBattle_UnitsTicked, NumTicked);
+        CSV_CUSTOM_STAT(AutoBattle, UnitsTicked, NumTicked, ECsvCustomStatOp::Accumulate);
+    }
+
+    if (Towers.Num() > 0)
+    {
+        FPerfScopeCycles Scope(EPerfCounter::PhaseTowerCycles);
+        FPhaseScope PhaseScope(*this, ESimPhase::Combat);
+        AUTOBATTLE_SCOPE_PHASE(STAT_AutoBattle_SimTowers, Towers);
+        UpdateTowers();
+    }
+
+    // 这一步的所有伤害一起结算，结果与实体更新顺序无关
+    {
+        FPerfScopeCycles Scope(EPerfCounter::PhaseDamageCycles);
+        FPhaseScope PhaseScope(*this, ESimPhase::Combat);
+        AUTOBATTLE_SCOPE_PHASE(STAT_AutoBattle_SimDamage, Damage);
+        ResolveDamage();
+    }
+
+    // 城墙倒了：找出受影响的单位，下一步起分批重新寻路
+    if (Grid.GetRevision() != ReplanSyncedRevision)
+    {
+        ScheduleReplans();
+    }
+
+    StepCount++;
+    // 用步数乘步长，避免浮点累加误差
+    Time = StepCount * TimeStep;
+
+    UpdateOutcome();
+
+    if (Recorder)
+    {
+        Recorder->EndStep(*this);
+    }
+}
+
+FBattleResult FBattleSimulation::RunToCompletion()
+{
+    while (!IsFinished())
+    {
+        Step();
+    }
+    return GetResult();
+}
+
+FBattleResult FBattleSimulation::GetResult() const
+{
+    FBattleResult Result;
+    Result.Outcome = Outcome;
+    Result.Duration = Time;
+    Result.Steps = StepCount;
+    return Result;
+}
+
+void FBattleSimulation::SetEntityActive(int32 EntityIndex, bool bActive)
+{
+    if (!Entities.IsValidIndex(EntityIndex)) return;
+
+    FSimEntity& Unit = Entities[EntityIndex];
+    Unit.bActive = bActive;
+    Unit.State = EUnitState::Idle;
+    Towers.SetTowerActive(EntityIndex, bActive);
+    if (!bActive)
+    {
+        // 停止所有行动
+        Unit.TargetIndex = INDEX_NONE;
+        Unit.PathPoints.Empty();
+        ReplanIndex.Unregister(EntityIndex);
+    }
+}
+
+void FBattleSimulation::SerializeState(FArchive& Ar)
+{
+    // 1. 时间、胜负和阵营计数
+    Ar << StepCount << Time << Outcome;
+    Ar << TeamAliveCounts[0] << TeamAliveCounts[1] << TeamHealth[0] << TeamHealth[1];
+
+    // 2. 每个实体会变的部分（实体数量必须和布局一致）
+    int32 NumEntities = Entities.Num();
+    Ar << NumEntities;
+    if (Ar.IsLoading() && NumEntities != Entities.Num())
+    {
+        Ar.SetError();
+        return;
+    }
+
+    for (FSimEntity& Entity : Entities)
+    {
+        Ar << Entity.bActive << Entity.bAlive << Entity.Location << Entity.Rotation << Entity.CurrentHealth;
+        Ar << Entity.State << Entity.TargetIndex << Entity.PathPoints << Entity.CurrentPathIndex << Entity.LastAttackTime;
+        Ar << Entity.DamageDealt << Entity.DamageTaken << Entity.Kills << Entity.DeathTime;
+    }
+
+    // 塔的目标和冷却就是实体上的 TargetIndex 和 LastAttackTime，读档后同步回防御塔系统
+    if (Ar.IsLoading())
+    {
+        for (int32 i = 0; i < Towers.Num(); i++)
+        {
+            const FSimEntity& Entity = Entities[Towers.GetTowerEntity(i)];
+            Towers.RestoreTower(i, Entity.TargetIndex, Entity.LastAttackTime, Entity.bAlive && Entity.bActive);
+        }
+
+        // 网格只有建筑占地会变（活着挡住、死了让开），按实体状态改回来，只动对不上的那几块
+        for (int32 i = 0; i < Entities.Num(); i++)
+        {
+            const FSimEntity& Entity = Entities[i];
+            const FIntRect& Footprint = Entity.Footprint;
+            if (Footprint.Area() > 0 && Grid.IsInBounds(Footprint.Min.X, Footprint.Min.Y) && IsFootprintBlocked(i) != Entity.bAlive)
+            {
+                Grid.SetFootprintBlocked(Footprint.Min.X, Footprint.Min.Y, Footprint.Width(), Footprint.Height(), Entity.bAlive);
+            }
+        }
+    }
+
+    // 3. 在飞的箭、等待重新寻路的队列和统计（耗时每次跑都不一样，不存）
+    Ar << Projectiles;
+    Ar << ReplanQueue;
+    Ar << Stats.PathRequests << Stats.OverlapUnitSteps << Stats.AvoidanceQueries;
+    Ar << Stats.ProjectilesFired << Stats.ProjectileHits << Stats.PeakProjectiles;
+    Ar << Stats.DamageEvents << Stats.SimultaneousKills;
+    Ar << Stats.ReplansScheduled << Stats.Replans;
+    Ar << Stats.AreaRequests << Stats.AreaHits;
+
+    // 反向索引和索敌索引由当前路径和位置决定，不存盘，读完重建
+    if (Ar.IsLoading() && !Ar.IsError())
+    {
+        RebuildReplanIndex();
+        RebuildTargetCandidates();
+    }
+}
+
+uint32 FBattleSimulation::ComputeStateHash() const
+{
+    const int32 Header[] = { StepCount, (int32)Outcome, Entities.Num(), Projectiles.Num() };
+    uint32 Crc = FCrc::MemCrc32(Header, sizeof(Header));
+
+    for (int32 i = 0; i < Entities.Num(); i++)
+    {
+        const FSimEntity& Entity = Entities[i];
+        const float Floats[] = { Entity.Location.X, Entity.Location.Y, Entity.Location.Z, Entity.Rotation.Yaw, Entity.CurrentHealth, Entity.LastAttackTime };
+        const int32 Ints[] = { Entity.TargetIndex, (int32)Entity.State, Entity.CurrentPathIndex, Entity.PathPoints.Num(), Entity.bAlive ? 1 : 0, Entity.bActive ? 1 : 0,
+            IsFootprintBlocked(i) ? 1 : 0 };
+        Crc = FCrc::MemCrc32(Floats, sizeof(Floats), Crc);
+        Crc = FCrc::MemCrc32(Ints, sizeof(Ints), Crc);
+    }
+
+    for (int32 i = 0; i < Projectiles.Num(); i++)
+    {
+        const FVector Location = Projectiles.GetLocation(i);
+        Crc = FCrc::MemCrc32(&Location, sizeof(FVector), Crc);
+    }
+    return Crc;
+}
+
+bool FBattleSimulation::IsFootprintBlocked(int32 EntityIndex) const
+{
+    const FIntRect& Footprint = Entities[EntityIndex].Footprint;
+    return Footprint.Area() > 0 && Grid.IsInBounds(Footprint.Min.X, Footprint.Min.Y)
+        && Grid.GetNode(Footprint.Min.X, Footprint.Min.Y).bIsBlocked;
+}
+
+void FBattleSimulation::ConsumeEvents(TArray<int32>& OutDeaths, TArray<int32>& OutPathUpdates)
+{
+    OutDeaths = MoveTemp(PendingDeaths);
+    OutPathUpdates = MoveTemp(PendingPathUpdates);
+    PendingDeaths.Reset();
+    PendingPathUpdates.Reset();
+}
+
+void FBattleSimulation::TickUnit(int32 UnitIndex)
+{
+    FSimEntity& Unit = Entities[UnitIndex];
+    const FSimArchetype& Archetype = Archetypes[Unit.ArchetypeIndex];
+
+    // 状态机
+    switch (Unit.State)
+    {
+    case EUnitState::Idle:
+        // 如果没目标，找目标
+        if (Unit.TargetIndex == INDEX_NONE)
+        {
+            {
+                FPhaseScope PhaseScope(*this, ESimPhase::AI);
+                Unit.TargetIndex = FindClosestEnemy(UnitIndex);
+            }
+            if (Unit.TargetIndex != INDEX_NONE)
+            {
+                if (Recorder) Recorder->RecordTarget(UnitIndex, Unit.TargetIndex);
+
+                // 检查目标是否在攻击范围内
+                float Distance = GetDistanceToEntity(Unit.Location, Unit.TargetIndex);
+                if (Distance <= Archetype.AttackRange)
+                {
+                    Unit.State = EUnitState::Attacking;
+                }
+                else
+                {
+                    RequestPathToTarget(UnitIndex);
+                    if (Unit.PathPoints.Num() > 0)
+                    {
+                        Unit.State = EUnitState::Moving;
+                    }
+                }
+            }
+        }
+        else
+        {
+            // 已经有目标，检查目标是否有效
+            if (!IsTargetAlive(Unit.TargetIndex))
+            {
+                Unit.TargetIndex = INDEX_NONE;
+            }
+        }
+        break;
+
+    case EUnitState::Moving:
+        if (Unit.PathPoints.Num() > 0)
+        {
+            MoveAlongPath(UnitIndex, TimeStep);
+
+            // 移动过程中检查是否进入攻击范围
+            if (Unit.TargetIndex != INDEX_NONE)
+            {
+                float Distance = GetDistanceToEntity(Unit.Location, Unit.TargetIndex);
+                if (Distance <= Archetype.AttackRange)
+                {
+                    Unit.State = EUnitState::Attacking;
+                    Unit.PathPoints.Empty(); // 清除路径
+                }
+            }
+        }
+        else
+        {
+            // 没有路径，回到Idle状态
+            Unit.State = EUnitState::Idle;
+        }
+        break;
+
+    case EUnitState::Attacking:
+        PerformAttack(UnitIndex);
+        break;
+    }
+}
+
+int32 FBattleSimulation::FindClosestEnemy(int32 UnitIndex) const
+{
+    const FSimEntity& Unit = Entities[UnitIndex];
+    const FSimArchetype& Archetype = Archetypes[Unit.ArchetypeIndex];
+    const ETeam EnemyTeam = Unit.Team == ETeam::Player ? ETeam::Enemy : ETeam::Player;
+    SCOPE_CYCLE_COUNTER(STAT_AutoBattle_FindClosestEnemy);
+    FPerfCounters::Add(EPerfCounter::TargetQueries, 1);
+
+    // 距离（城墙这类有占地的量到边缘）
+    auto GetDistance = [this, &Unit](int32 EntityIndex)
+    {
+        return GetDistanceToEntity(Unit.Location, EntityIndex);
+    };
+
+    // 1. 按优先顺序一类一类地找，只查这一类的索引
+    uint32 RemainingClasses = (1u << (int32)ETargetClass::Count) - 1;
+    for (ETargetClass Class : Archetype.Targeting.Priority)
+    {
+        const int32 Found = TargetCandidates.FindTarget(EnemyTeam, 1u << (int32)Class, Unit.Location, Archetype.AttackRange, GetDistance);
+        if (Found != INDEX_NONE)
+        {
+            return Found;
+        }
+        RemainingClasses &= ~(1u << (int32)Class);
+    }
+
+    // 2. 优先的类别都没有了：不允许退而求其次就原地待命
+    if (Archetype.Targeting.Priority.Num() > 0 && !Archetype.Targeting.bFallbackToAny)
+    {
+        return INDEX_NONE;
+    }
+
+    // 3. 剩下的类别合在一起，攻击范围内的优先，否则选最近的（和原来的全量扫描结果一样）
+    return TargetCandidates.FindTarget(EnemyTeam, RemainingClasses, Unit.Location, Archetype.AttackRange, GetDistance);
+}
+
+void FBattleSimulation::RequestPathToTarget(int32 UnitIndex)
+{
+    FSimEntity& Unit = Entities[UnitIndex];
+    if (Unit.TargetIndex == INDEX_NONE)
+    {
+        return;
+    }
+
+    // 调用寻路函数
+    FPhaseScope PhaseScope(*this, ESimPhase::Pathfinding);
+    Stats.PathRequests++;
+    const FVector Destination = GetApproachPoint(UnitIndex, Unit.TargetIndex);
+    Unit.PathPoints = bUsePathCache
+        ? PathCache.FindPath(Grid, Unit.Location, Destination)
+        : Grid.FindPath(Unit.Location, Destination);
+    Unit.CurrentPathIndex = 0;
+
+    if (Unit.PathPoints.Num() > 0)
+    {
+        // 确保起点正确（去掉第一个点如果是当前位置）
+        if (Unit.PathPoints.Num() > 1 && FVector::DistSquared(Unit.PathPoints[0], Unit.Location) < PathPointToleranceSq)
+        {
+            Unit.CurrentPathIndex = 1;
+        }
+
+        // 登记进反向索引：这条路经过的地方一改就要重新寻路
+        TArray<FIntPoint> Waypoints;
+        Waypoints.Reserve(Unit.PathPoints.Num());
+        for (const FVector& Point : Unit.PathPoints)
+        {
+            FIntPoint& Tile = Waypoints.AddDefaulted_GetRef();
+            Grid.WorldToGrid(Point, Tile.X, Tile.Y);
+        }
+        ReplanIndex.RegisterPath(UnitIndex, Waypoints);
+    }
+    else
+    {
+        // 走不通：等网格变化后连通了再试
+        ReplanIndex.RegisterBlocked(UnitIndex);
+    }
+
+    if (bCollectEvents)
+    {
+        PendingPathUpdates.Add(UnitIndex);
+    }
+}
+
+void FBattleSimulation::MoveAlongPath(int32 UnitIndex, float DeltaTime)
+{
+    SCOPE_CYCLE_COUNTER(STAT_AutoBattle_MoveAlongPath);
+    FPhaseScope PhaseScope(*this, ESimPhase::Movement);
+    FSimEntity& Unit = Entities[UnitIndex];
+    const FSimArchetype& Archetype = Archetypes[Unit.ArchetypeIndex];
+
+    // 检查是否还有路径
+    if (Unit.PathPoints.Num() == 0 || Unit.CurrentPathIndex >= Unit.PathPoints.Num())
+    {
+        Unit.State = EUnitState::Idle;
+        return;
+    }
+
+    // 检查目标是否还存在
+    if (!IsTargetAlive(Unit.TargetIndex))
+    {
+        Unit.State = EUnitState::Idle;
+        Unit.TargetIndex = INDEX_NONE;
+        Unit.PathPoints.Empty();
+        return;
+    }
+
+    // 获取当前目标点
+    FVector TargetPoint = Unit.PathPoints[Unit.CurrentPathIndex];
+
+    // 计算移动方向
+    FVector Direction = (TargetPoint - Unit.Location).GetSafeNormal();
+
+    // 移动（开了避让就在期望速度上叠加邻居的排斥力）
+    FVector Velocity = Direction * Archetype.MoveSpeed;
+    float ArrivalToleranceSq = PathPointToleranceSq;
+    if (AvoidanceSettings.bEnabled)
+    {
+        const uint64 StartCycles = FPlatformTime::Cycles64();
+        int32 Overlaps = 0;
+        Velocity = Avoidance.ComputeVelocity(UnitIndex, Unit.Location, Velocity, Archetype.MoveSpeed, Overlaps);
+        Stats.AvoidanceCycles += FPlatformTime::Cycles64() - StartCycles;
+        Stats.AvoidanceQueries++;
+        Stats.OverlapUnitSteps += Overlaps > 0 ? 1 : 0;
+
+        // 被挤开的单位很难精确踩到路径点，放宽到一个身位
+        ArrivalToleranceSq = FMath::Max(PathPointToleranceSq, FMath::Square(AvoidanceSettings.AgentRadius));
+    }
+    Unit.Location += Velocity * DeltaTime;
+    TargetCandidates.Move(UnitIndex, Unit.Location);
+
+    // 面向移动方向（用路径方向，避免被推来推去时左右抖动）
+    FaceDirection(Unit, Direction);
+
+    // 检查是否到达当前路径点
+    if (FVector::DistSquared(Unit.Location, TargetPoint) < ArrivalToleranceSq)
+    {
+        Unit.CurrentPathIndex++;
+
+        // 如果到达最后一个点，转为Idle状态
+        if (Unit.CurrentPathIndex >= Unit.PathPoints.Num())
+        {
+            // 检查是否在攻击范围内
+            float Distance = GetDistanceToEntity(Unit.Location, Unit.TargetIndex);
+            if (Distance <= Archetype.AttackRange)
+            {
+                Unit.State = EUnitState::Attacking;
+            }
+            else
+            {
+                // 重新寻路
+                RequestPathToTarget(UnitIndex);
+                if (Unit.PathPoints.Num() == 0)
+                {
+                    Unit.State = EUnitState::Idle;
+                }
+            }
+        }
+    }
+}
+
+void FBattleSimulation::PerformAttack(int32 UnitIndex)
+{
+    SCOPE_CYCLE_COUNTER(STAT_AutoBattle_PerformAttack);
+    FPhaseScope PhaseScope(*this, ESimPhase::Combat);
+    FSimEntity& Unit = Entities[UnitIndex];
+    const FSimArchetype& Archetype = Archetypes[Unit.ArchetypeIndex];
+
+    if (Unit.TargetIndex == INDEX_NONE)
+    {
+        Unit.State = EUnitState::Idle;
+        return;
+    }
+
+    // 检查目标是否死亡
+    if (!IsTargetAlive(Unit.TargetIndex))
+    {
+        Unit.TargetIndex = INDEX_NONE;
+        Unit.State = EUnitState::Idle;
+        return;
+    }
+
+    // 检查目标是否在攻击范围内
+    const FVector TargetLocation = Entities[Unit.TargetIndex].Location;
+    float Distance = GetDistanceToEntity(Unit.Location, Unit.TargetIndex);
+    if (Distance > Archetype.AttackRange)
+    {
+        // 目标跑出攻击范围，重新寻路
+        RequestPathToTarget(UnitIndex);
+        if (Unit.PathPoints.Num() > 0)
+        {
+            Unit.State = EUnitState::Moving;
+        }
+        return;
+    }
+
+    // 攻击冷却检查
+    if (Time - Unit.LastAttackTime >= Archetype.AttackInterval)
+    {
+        // 更新攻击时间
+        Unit.LastAttackTime = Time;
+
+        // 面向目标
+        FaceDirection(Unit, (TargetLocation - Unit.Location).GetSafeNormal());
+
+        // 远程单位射出弹道，落地时再结算；近战直接应用伤害
+        if (Archetype.ProjectileSpeed > 0.0f)
+        {
+            Projectiles.Spawn(UnitIndex, Unit.Team, Unit.Location, TargetLocation, Archetype.ProjectileSpeed, Archetype.Damage);
+            Stats.ProjectilesFired++;
+            Stats.PeakProjectiles = FMath::Max(Stats.PeakProjectiles, Projectiles.Num());
+        }
+        else
+        {
+            QueueHit(UnitIndex, Unit.TargetIndex, TargetLocation, Archetype.Damage);
+        }
+    }
+}
+
+void FBattleSimulation::QueueDamage(int32 AttackerIndex, int32 VictimIndex, float Amount)
+{
+    if (Amount <= 0.0f) return;
+
+    FSimDamageEvent& Event = DamageQueue.AddDefaulted_GetRef();
+    Event.AttackerIndex = AttackerIndex;
+    Event.VictimIndex = VictimIndex;
+    Event.Amount = Amount;
+    Event.AttackerType = Entities[AttackerIndex].UnitType;
+    Event.bArea = false;
+}
+
+void FBattleSimulation::QueueHit(int32 AttackerIndex, int32 VictimIndex, const FVector& Location, float Amount)
+{
+    const FSimEntity& Attacker = Entities[AttackerIndex];
+    const float SplashRadius = Archetypes[Attacker.ArchetypeIndex].SplashRadius;
+    if (SplashRadius > 0.0f)
+    {
+        // 只炸敌方：两个阵营的掩码去掉自己那一位
+        const uint8 EnemyMask = (FAreaDamageBatch::TeamBit(ETeam::Player) | FAreaDamageBatch::TeamBit(ETeam::Enemy)) & ~FAreaDamageBatch::TeamBit(Attacker.Team);
+        AreaDamage.Add({ AttackerIndex, Location, SplashRadius, Amount, EnemyMask });
+    }
+    else if (VictimIndex != INDEX_NONE)
+    {
+        QueueDamage(AttackerIndex, VictimIndex, Amount);
+    }
+}
+
+void FBattleSimulation::ResolveAreaDamage()
+{
+    const uint64 StartCycles = FPlatformTime::Cycles64();
+
+    Stats.AreaRequests += AreaDamage.Num();
+    AreaDamage.Resolve(Avoidance, [this](int32 EntityIndex)
+    {
+        const FSimEntity& Entity = Entities[EntityIndex];
+        return Entity.bAlive ? FAreaDamageBatch::TeamBit(Entity.Team) : (uint8)0;
+    }, AreaHits);
+    Stats.AreaHits += AreaHits.Num();
+
+    // 合计伤害排在单体伤害后面，和它们一起按顺序扣血、统一判定死亡
+    for (const FAreaDamageHit& Hit : AreaHits)
+    {
+        QueueDamage(Hit.SourceIndex, Hit.VictimIndex, Hit.Amount);
+        DamageQueue.Last().bArea = true;
+    }
+
+    Stats.AreaCycles += FPlatformTime::Cycles64() - StartCycles;
+}
+
+void FBattleSimulation::ResolveDamage()
+{
+    if (AreaDamage.Num() > 0)
+    {
+        ResolveAreaDamage();
+    }
+    if (DamageQueue.Num() == 0) return;
+
+    // 1. 按入队顺序扣血，血量第一次掉到 0 的那一下算击杀（之后的溢出伤害不再计入）
+    KilledThisStep.Reset();
+    for (const FSimDamageEvent& Event : DamageQueue)
+    {
+        FSimEntity& Victim = Entities[Event.VictimIndex];
+        if (!Victim.bAlive || Victim.CurrentHealth <= 0.0f) continue;
+
+        // 建筑不吃兵种克制，防御塔打人和范围伤害也不算克制
+        const float Amount = Victim.bIsUnit && Entities[Event.AttackerIndex].bIsUnit && !Event.bArea ? Event.Amount * DamageModifiers.Get(Event.AttackerType, Victim.UnitType) : Event.Amount;
+        if (Amount <= 0.0f) continue;
+
+        // 剩余总血量只扣到 0 为止
+        TeamHealth[(int32)Victim.Team] -= FMath::Min(Amount, Victim.CurrentHealth);
+        Victim.CurrentHealth -= Amount;
+        Victim.DamageTaken += Amount;
+        Entities[Event.AttackerIndex].DamageDealt += Amount;
+        if (Recorder) Recorder->RecordDamage(Event.AttackerIndex, Event.VictimIndex, Amount);
+
+        if (Victim.CurrentHealth <= 0.0f)
+        {
+            Entities[Event.AttackerIndex].Kills++;
+            KilledThisStep.Add(Event.VictimIndex);
+        }
+    }
+    Stats.DamageEvents += DamageQueue.Num();
+    FPerfCounters::Add(EPerfCounter::DamageEvents, DamageQueue.Num());
+    DamageQueue.Reset();
+
+    // 2. 本步死亡的实体按下标顺序统一标记（两个单位同一步互砍会一起倒下）
+    KilledThisStep.Sort();
+    for (int32 VictimIndex : KilledThisStep)
+    {
+        FSimEntity& Victim = Entities[VictimIndex];
+        if (Victim.TargetIndex != INDEX_NONE && Entities[Victim.TargetIndex].CurrentHealth <= 0.0f && Entities[Victim.TargetIndex].TargetIndex == VictimIndex)
+        {
+            Stats.SimultaneousKills++;
+        }
+
+        Victim.bAlive = false;
+        Victim.DeathTime = Time;
+        TeamAliveCounts[(int32)Victim.Team]--;
+        Victim.State = EUnitState::Idle;
+        Victim.TargetIndex = INDEX_NONE;
+        Victim.PathPoints.Empty();
+        Towers.SetTowerActive(VictimIndex, false);
+        ReplanIndex.Unregister(VictimIndex);
+        TargetCandidates.Remove(VictimIndex);
+
+        // 城墙、建筑倒下后让出占地（只产生一个脏矩形，步末统一安排重新寻路）
+        if (Victim.Footprint.Area() > 0)
+        {
+            Grid.SetFootprintBlocked(Victim.Footprint.Min.X, Victim.Footprint.Min.Y, Victim.Footprint.Width(), Victim.Footprint.Height(), false);
+        }
+
+        if (Recorder) Recorder->RecordDeath(VictimIndex);
+        if (bCollectEvents)
+        {
+            PendingDeaths.Add(VictimIndex);
+        }
+    }
+}
+
+void FBattleSimulation::BuildAvoidanceGrid()
+{
+    const uint64 StartCycles = FPlatformTime::Cycles64();
+
+    FVector2D BoundsMin;
+    FVector2D BoundsMax;
+    GetBattleBounds(BoundsMin, BoundsMax);
+    Avoidance.Reset(AvoidanceSettings, BoundsMin, BoundsMax);
+
+    // 静止的实体也要登记，移动的单位需要绕开它们
+    for (int32 i = 0; i < Entities.Num(); i++)
+    {
+        if (Entities[i].bAlive)
+        {
+            Avoidance.AddAgent(i, Entities[i].Location);
+        }
+    }
+    Avoidance.Finalize();
+
+    Stats.AvoidanceCycles += FPlatformTime::Cycles64() - StartCycles;
+}
+
+void FBattleSimulation::GetBattleBounds(FVector2D& OutMin, FVector2D& OutMax) const
+{
+    const FVector& Origin = Grid.GetOrigin();
+    OutMin = FVector2D(Origin.X, Origin.Y);
+    OutMax = OutMin + FVector2D(Grid.GetWidth(), Grid.GetHeight()) * Grid.GetTileSize();
+}
+
+void FBattleSimulation::UpdateTowers()
+{
+    // 1. 登记这一步还活着的兵（塔只打兵）
+    Towers.BeginTargets();
+    for (int32 i = 0; i < Entities.Num(); i++)
+    {
+        const FSimEntity& Entity = Entities[i];
+        if (Entity.bIsUnit && Entity.bAlive)
+        {
+            Towers.AddTarget(i, Entity.Team, Entity.Location);
+        }
+    }
+
+    // 2. 批量索敌 + 开火
+    TowerShots.Reset();
+    Towers.Update(Time, TowerShots);
+
+    for (const FTowerShot& Shot : TowerShots)
+    {
+        FSimEntity& Tower = Entities[Shot.TowerEntity];
+        const FSimArchetype& Archetype = Archetypes[Tower.ArchetypeIndex];
+        const FVector TargetLocation = Entities[Shot.TargetEntity].Location;
+        FaceDirection(Tower, (TargetLocation - Tower.Location).GetSafeNormal());
+
+        if (Archetype.ProjectileSpeed > 0.0f)
+        {
+            Projectiles.Spawn(Shot.TowerEntity, Tower.Team, Tower.Location, TargetLocation, Archetype.ProjectileSpeed, Archetype.Damage);
+            Stats.ProjectilesFired++;
+            Stats.PeakProjectiles = FMath::Max(Stats.PeakProjectiles, Projectiles.Num());
+        }
+        else
+        {
+            QueueHit(Shot.TowerEntity, Shot.TargetEntity, TargetLocation, Archetype.Damage);
+        }
+    }
+
+    // 3. 目标和冷却写回实体（录像、状态哈希和表现层都看实体）
+    for (int32 i = 0; i < Towers.Num(); i++)
+    {
+        if (!Towers.IsTowerActive(i)) continue;
+
+        FSimEntity& Tower = Entities[Towers.GetTowerEntity(i)];
+        const int32 NewTarget = Towers.GetTargetEntity(i);
+        if (NewTarget != Tower.TargetIndex && NewTarget != INDEX_NONE && Recorder)
+        {
+            Recorder->RecordTarget(Towers.GetTowerEntity(i), NewTarget);
+        }
+        Tower.TargetIndex = NewTarget;
+        Tower.LastAttackTime = Towers.GetLastFireTime(i);
+    }
+}
+
+void FBattleSimulation::UpdateProjectiles()
+{
+    if (Projectiles.Num() == 0) return;
+
+    const uint64 StartCycles = FPlatformTime::Cycles64();
+
+    PendingImpacts.Reset();
+    Projectiles.Advance(TimeStep, PendingImpacts);
+
+    // 命中判定半径：一个身位
+    const float HitRadius = AvoidanceSettings.AgentRadius;
+    for (const FProjectileImpact& Impact : PendingImpacts)
+    {
+        // 落点附近最近的存活敌人（距离相同取下标小的）
+        int32 VictimIndex = INDEX_NONE;
+        float VictimDistSq = FLT_MAX;
+        Avoidance.ForEachAgentInRadius(Impact.Location, HitRadius, [&](int32 EntityIndex, float DistSq)
+        {
+            const FSimEntity& Entity = Entities[EntityIndex];
+            if (Entity.Team == Impact.OwnerTeam || !Entity.bAlive) return;
+            if (DistSq < VictimDistSq || (DistSq == VictimDistSq && EntityIndex < VictimIndex))
+            {
+                VictimIndex = EntityIndex;
+                VictimDistSq = DistSq;
+            }
+        });
+
+        if (VictimIndex != INDEX_NONE)
+        {
+            Stats.ProjectileHits++;
+        }
+        QueueHit(Impact.OwnerIndex, VictimIndex, Impact.Location, Impact.Damage);
+    }
+
+    Stats.ProjectileCycles += FPlatformTime::Cycles64() - StartCycles;
+}
+
+FVector FBattleSimulation::GetApproachPoint(int32 UnitIndex, int32 TargetIndex) const
+{
+    const FSimEntity& Target = Entities[TargetIndex];
+    const FIntRect& Footprint = Target.Footprint;
+    if (Footprint.Area() <= 0)
+    {
+        return Target.Location;
+    }
+
+    // 占地外面一圈里离单位最近的可通行格子（一样近取先扫到的）
+    const FVector& From = Entities[UnitIndex].Location;
+    FVector Best = Target.Location;
+    float BestDistSq = FLT_MAX;
+    for (int32 Y = Footprint.Min.Y - 1; Y <= Footprint.Max.Y; Y++)
+    {
+        for (int32 X = Footprint.Min.X - 1; X <= Footprint.Max.X; X++)
+        {
+            const bool bOnRing = X < Footprint.Min.X || X >= Footprint.Max.X || Y < Footprint.Min.Y || Y >= Footprint.Max.Y;
+            if (!bOnRing || !Grid.IsTileValid(X, Y)) continue;
+
+            const FVector Candidate = Grid.GridToWorld(X, Y);
+            const float DistSq = FVector::DistSquared2D(From, Candidate);
+            if (DistSq < BestDistSq)
+            {
+                Best = Candidate;
+                BestDistSq = DistSq;
+            }
+        }
+    }
+    return Best;
+}
+
+float FBattleSimulation::GetDistanceToEntity(const FVector& From, int32 EntityIndex) const
+{
+    const FSimEntity& Entity = Entities[EntityIndex];
+    const FIntRect& Footprint = Entity.Footprint;
+    if (Footprint.Area() <= 0)
+    {
+        return FVector::Dist(From, Entity.Location);
+    }
+
+    const float HalfTile = Grid.GetTileSize() * 0.5f;
+    // 活着的建筑占地是挡住的，GridToWorld 会返回零向量，这里直接按坐标算
+    const FVector MinCorner = Grid.GetTileCenter(Footprint.Min.X, Footprint.Min.Y);
+    const FVector MaxCorner = Grid.GetTileCenter(Footprint.Max.X - 1, Footprint.Max.Y - 1);
+    const FBox2D Box(FVector2D(MinCorner.X - HalfTile, MinCorner.Y - HalfTile), FVector2D(MaxCorner.X + HalfTile, MaxCorner.Y + HalfTile));
+    return FMath::Sqrt(Box.ComputeSquaredDistanceToPoint(FVector2D(From.X, From.Y)));
+}
+
+void FBattleSimulation::ScheduleReplans()
+{
+    // 1. 路径经过改动范围的单位；范围往外扩一个粗格子，贴着城墙绕路的单位也算进来
+    ReplanCandidates.Reset();
+    FIntRect DirtyRect;
+    if (Grid.GetDirtyRectSince(ReplanSyncedRevision, DirtyRect))
+    {
+        DirtyRect.InflateRect(FPathReplanIndex::CellTiles);
+        ReplanIndex.CollectPathsInRect(DirtyRect, ReplanCandidates);
+    }
+    else
+    {
+        ReplanIndex.CollectAllPaths(ReplanCandidates);
+    }
+    ReplanSyncedRevision = Grid.GetRevision();
+
+    // 2. 原来找不到路的单位（是否连通在 IsReplanCandidate 里判断）
+    ReplanIndex.CollectBlocked(ReplanCandidates);
+
+    // 3. 按下标入队，和索引里的登记顺序无关
+    ReplanCandidates.Sort();
+    for (int32 i = 0; i < ReplanCandidates.Num(); i++)
+    {
+        const int32 UnitIndex = ReplanCandidates[i];
+        if ((i > 0 && ReplanCandidates[i - 1] == UnitIndex) || ReplanQueued[UnitIndex]) continue;
+        if (!IsReplanCandidate(UnitIndex)) continue;
+
+        ReplanQueue.Add(UnitIndex);
+        ReplanQueued[UnitIndex] = true;
+        Stats.ReplansScheduled++;
+    }
+}
+
+void FBattleSimulation::ProcessReplanQueue()
+{
+    int32 NumPopped = 0;
+    int32 NumReplans = 0;
+    while (NumPopped < ReplanQueue.Num() && NumReplans < MaxReplansPerStep)
+    {
+        const int32 UnitIndex = ReplanQueue[NumPopped++];
+        ReplanQueued[UnitIndex] = false;
+
+        // 排队期间已经开打、换了目标或者死掉的跳过，不占名额
+        if (!IsReplanCandidate(UnitIndex)) continue;
+
+        NumReplans++;
+        Stats.Replans++;
+        FSimEntity& Unit = Entities[UnitIndex];
+        RequestPathToTarget(UnitIndex);
+        Unit.State = Unit.PathPoints.Num() > 0 ? EUnitState::Moving : EUnitState::Idle;
+    }
+    ReplanQueue.RemoveAt(0, NumPopped, false);
+}
+
+bool FBattleSimulation::IsReplanCandidate(int32 UnitIndex) const
+{
+    const FSimEntity& Unit = Entities[UnitIndex];
+    if (!Unit.bIsUnit || !Unit.bAlive || !Unit.bActive || !IsTargetAlive(Unit.TargetIndex)) return false;
+
+    // 沿路径走着的：路径要么被挡住了，要么可能有更近的路
+    if (Unit.PathPoints.Num() > 0)
+    {
+        return Unit.State == EUnitState::Moving;
+    }
+
+    // 停着等路的：起点和终点进了同一个连通区域才值得再试（FindPath 也是这么判断的）
+    if (Unit.State != EUnitState::Idle) return false;
+
+    int32 StartX, StartY, EndX, EndY;
+    Grid.WorldToGrid(Unit.Location, StartX, StartY);
+    Grid.WorldToGrid(GetApproachPoint(UnitIndex, Unit.TargetIndex), EndX, EndY);
+    const int32 Region = Grid.GetRegion(StartX, StartY);
+    return Region != INDEX_NONE && Region == Grid.GetRegion(EndX, EndY);
+}
+
+void FBattleSimulation::RebuildTargetCandidates()
+{
+    // 粗格子取 4 个网格格子，和大多数兵的射程相当
+    FVector2D BoundsMin;
+    FVector2D BoundsMax;
+    GetBattleBounds(BoundsMin, BoundsMax);
+    TargetCandidates.Reset(BoundsMin, BoundsMax, Grid.GetTileSize() * 4.0f, Entities.Num());
+
+    for (int32 i = 0; i < Entities.Num(); i++)
+    {
+        const FSimEntity& Entity = Entities[i];
+        if (!Entity.bAlive) continue;
+
+        // 有占地的建筑：登记位置到占地最远角的距离
+        float Extent = 0.0f;
+        if (Entity.Footprint.Area() > 0)
+        {
+            const float HalfTile = Grid.GetTileSize() * 0.5f;
+            const FVector MinCorner = Grid.GetTileCenter(Entity.Footprint.Min.X, Entity.Footprint.Min.Y) - FVector(HalfTile, HalfTile, 0.0f);
+            const FVector MaxCorner = Grid.GetTileCenter(Entity.Footprint.Max.X - 1, Entity.Footprint.Max.Y - 1) + FVector(HalfTile, HalfTile, 0.0f);
+            const float ExtentX = FMath::Max(Entity.Location.X - MinCorner.X, MaxCorner.X - Entity.Location.X);
+            const float ExtentY = FMath::Max(Entity.Location.Y - MinCorner.Y, MaxCorner.Y - Entity.Location.Y);
+            Extent = FMath::Sqrt(ExtentX * ExtentX + ExtentY * ExtentY);
+        }
+        TargetCandidates.Add(i, Entity.Team, Entity.TargetClass, Entity.Location, Extent);
+    }
+}
+
+void FBattleSimulation::RebuildReplanIndex()
+{
+    ReplanIndex.Reset(Grid.GetWidth(), Grid.GetHeight(), Entities.Num());
+
+    TArray<FIntPoint> Waypoints;
+    for (int32 i = 0; i < Entities.Num(); i++)
+    {
+        const FSimEntity& Unit = Entities[i];
+        if (!Unit.bIsUnit || !Unit.bAlive) continue;
+
+        if (Unit.PathPoints.Num() > 0)
+        {
+            Waypoints.Reset();
+            for (const FVector& Point : Unit.PathPoints)
+            {
+                FIntPoint& Tile = Waypoints.AddDefaulted_GetRef();
+                Grid.WorldToGrid(Point, Tile.X, Tile.Y);
+            }
+            ReplanIndex.RegisterPath(i, Waypoints);
+        }
+        else if (Unit.State == EUnitState::Idle && Unit.TargetIndex != INDEX_NONE)
+        {
+            ReplanIndex.RegisterBlocked(i);
+        }
+    }
+
+    // 坏存档里的下标直接丢掉
+    ReplanQueue.RemoveAll([this](int32 UnitIndex) { return !Entities.IsValidIndex(UnitIndex); });
+    ReplanQueued.Init(false, Entities.Num());
+    for (int32 UnitIndex : ReplanQueue)
+    {
+        ReplanQueued[UnitIndex] = true;
+    }
+    ReplanSyncedRevision = Grid.GetRevision();
+}
+
+bool FBattleSimulation::IsTargetAlive(int32 TargetIndex) const
+{
+    return Entities.IsValidIndex(TargetIndex) && Entities[TargetIndex].bAlive && Entities[TargetIndex].CurrentHealth > 0;
+}
+
+void FBattleSimulation::FaceDirection(FSimEntity& Unit, const FVector& Direction)
+{
+    if (!Direction.IsNearlyZero())
+    {
+        FRotator NewRotation = Direction.Rotation();
+        NewRotation.Pitch = 0; // 保持水平
+        NewRotation.Roll = 0;
+        Unit.Rotation = NewRotation;
+    }
+}
+
+void FBattleSimulation::UpdateOutcome()
+{
+    // 双方存活数在结算伤害时已经增量更新好了，不用再扫一遍实体
+    const int32 PlayerAlive = GetTeamAliveCount(ETeam::Player);
+    const int32 EnemyAlive = GetTeamAliveCount(ETeam::Enemy);
+
+    if (PlayerAlive == 0 && EnemyAlive == 0)
+    {
+        Outcome = EBattleOutcome::Draw;
+    }
+    else if (PlayerAlive == 0)
+    {
+        Outcome = EBattleOutcome::EnemyWins;
+    }
+    else if (EnemyAlive == 0)
+    {
+        Outcome = EBattleOutcome::PlayerWins;
+    }
+    else if (Time >= MaxBattleTime)
+    {
+        Outcome = EBattleOutcome::Draw;
+    }
+}
+
+const TCHAR* FBattleSimulation::OutcomeToString(EBattleOutcome InOutcome)
+{
+    switch (InOutcome)
+    {
+    case EBattleOutcome::PlayerWins: return TEXT("PlayerWins");
+    case EBattleOutcome::EnemyWins:  return TEXT("EnemyWins");
+    case EBattleOutcome::Draw:       return TEXT("Draw");
+    default:                         return TEXT("InProgress");
+    }
+}
+
+void FBattleSimulation::LogReport(const FString& Label) const
+{
+    UE_LOG(LogTemp, Display, TEXT("[%s] Result: %s, Duration: %.3fs (%d steps @ %.4fs)"),
+        *Label, OutcomeToString(Outcome), Time, StepCount, TimeStep);
+
+    const double AvoidanceMicroseconds = FPlatformTime::ToMilliseconds64(Stats.AvoidanceCycles) * 1000.0;
+    UE_LOG(LogTemp, Display, TEXT("[%s] Paths: %d, Overlapping unit-steps: %lld, Avoidance: %s %.3fus/query (%lld queries)"),
+        *Label, Stats.PathRequests, Stats.OverlapUnitSteps,
+        AvoidanceSettings.bEnabled ? TEXT("on") : TEXT("off"),
+        Stats.AvoidanceQueries > 0 ? AvoidanceMicroseconds / Stats.AvoidanceQueries : 0.0, Stats.AvoidanceQueries);
+    if (bUsePathCache)
+    {
+        UE_LOG(LogTemp, Display, TEXT("[%s] Path cache: %lld hits, %lld misses, %lld invalidated"),
+            *Label, PathCache.GetHits(), PathCache.GetMisses(), PathCache.GetInvalidated());
+    }
+    UE_LOG(LogTemp, Display, TEXT("[%s] Survivors: Player %d (%.1f HP), Enemy %d (%.1f HP)"),
+        *Label, GetTeamAliveCount(ETeam::Player), GetTeamHealth(ETeam::Player),
+        GetTeamAliveCount(ETeam::Enemy), GetTeamHealth(ETeam::Enemy));
+    UE_LOG(LogTemp, Display, TEXT("[%s] Damage events: %lld, simultaneous kills: %d"),
+        *Label, Stats.DamageEvents, Stats.SimultaneousKills);
+    if (Stats.ReplansScheduled > 0)
+    {
+        UE_LOG(LogTemp, Display, TEXT("[%s] Grid changes: %d units scheduled for replanning, %d replans (max %d per step)"),
+            *Label, Stats.ReplansScheduled, Stats.Replans, MaxReplansPerStep);
+    }
+    UE_LOG(LogTemp, Display, TEXT("[%s] Target index: %lld distance checks"),
+        *Label, TargetCandidates.GetNumDistanceChecks());
+    if (Stats.AreaRequests > 0)
+    {
+        UE_LOG(LogTemp, Display, TEXT("[%s] Area damage: %lld explosions, %lld victims hit, %.3fms total"),
+            *Label, Stats.AreaRequests, Stats.AreaHits, FPlatformTime::ToMilliseconds64(Stats.AreaCycles));
+    }
+    if (Stats.ProjectilesFired > 0)
+    {
+        UE_LOG(LogTemp, Display, TEXT("[%s] Projectiles: %d fired, %d hits, peak %d in flight, %.3fms total"),
+            *Label, Stats.ProjectilesFired, Stats.ProjectileHits, Stats.PeakProjectiles,
+            FPlatformTime::ToMilliseconds64(Stats.ProjectileCycles));
+    }
+
+    for (int32 i = 0; i < Entities.Num(); i++)
+    {
+        const FSimEntity& Entity = Entities[i];
+        UE_LOG(LogTemp, Display, TEXT("[%s]   #%d %s Team=%s Dealt=%.1f Taken=%.1f Kills=%d HP=%.1f/%.1f %s"),
+            *Label, i, *Entity.Name,
+            Entity.Team == ETeam::Player ? TEXT("Player") : TEXT("Enemy"),
+            Entity.DamageDealt, Entity.DamageTaken, Entity.Kills,
+            FMath::Max(Entity.CurrentHealth, 0.0f), Entity.MaxHealth,
+            Entity.bAlive ? TEXT("Alive") : *FString::Printf(TEXT("Died@%.2fs"), Entity.DeathTime));
+    }
+}
@@ -0,0 +1,410 @@
+// BattleSimulation.h：不依赖 UWorld 的定步长战斗模拟
+// 游戏内由 ARTSGameMode 每帧按定步长推进，无头模拟器（UBattleSimCommandlet）直接跑到结束，
+// 两边执行的是同一份单位逻辑，所以同一个布局得到的结果完全一致
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RTSCoreTypes.h"
+#include "GridMap.h"
+#include "CrowdAvoidance.h"
+#include "ProjectileSystem.h"
+#include "DamageModifiers.h"
+#include "DefenseTowerSystem.h"
+#include "PathCache.h"
+#include "PathReplanIndex.h"
+#include "AreaDamage.h"
+#include "TargetCandidateIndex.h"
+
+// 战斗结果
+enum class EBattleOutcome : uint8
+{
+    InProgress,
+    PlayerWins,
+    EnemyWins,
+    Draw        // 双方同归于尽或超时
+};
+
+/**
+ * 布局中的一个实体（玩家用 TryBuyUnit 放下的兵、关卡里摆好的敌人等）
+ */
+struct FSimEntitySpawn
+{
+    FString Name;
+    ETeam Team = ETeam::Enemy;
+    EUnitType UnitType = EUnitType::Soldier;
+    // false：不会移动的建筑（比如敌方基地）；Damage 和 AttackRange 都大于 0 的建筑是防御塔
+    bool bIsUnit = true;
+    FVector Location = FVector::ZeroVector;
+
+    float MaxHealth = 100.0f;
+    float AttackRange = 150.0f;
+    float Damage = 10.0f;
+    float MoveSpeed = 300.0f;
+    float AttackInterval = 1.0f;
+    // 大于 0 时攻击会射出弹道，飞到后才结算伤害（文件版本 3 起）
+    float ProjectileSpeed = 0.0f;
+    // 建筑占地（格子坐标，Min 含、Max 不含），布局里的网格已经挡住了；死亡时让开（文件版本 5 起）
+    FIntRect Footprint;
+    // 大于 0 时攻击变成范围伤害，命中点这个半径内的敌人都受伤（文件版本 6 起）
+    float SplashRadius = 0.0f;
+    // 被索敌时的类别，和这个兵自己的索敌策略（文件版本 7 起）
+    ETargetClass TargetClass = ETargetClass::Unit;
+    FTargetingPolicy Targeting;
+
+    friend FArchive& operator<<(FArchive& Ar, FSimEntitySpawn& Spawn);
+};
+
+/**
+ * 一场战斗的完整初始状态：网格 + 障碍 + 所有实体 + 步长
+ */
+struct FBattleSetup
+{
+    FGridMap Grid;
+    TArray<FSimEntitySpawn> Entities;
+
+    // 定步长（秒），游戏内和无头模式必须一致
+    float TimeStep = 1.0f / 30.0f;
+    // 超过这个时间还没分出胜负就判平
+    float MaxBattleTime = 300.0f;
+
+    // 单位之间的局部避让（文件版本 2 起）
+    FCrowdAvoidanceSettings Avoidance;
+
+    // 兵种克制表（文件版本 4 起）
+    TArray<FDamageModifier> DamageModifiers;
+
+    bool SaveToFile(const FString& FilePath) const;
+    bool LoadFromFile(const FString& FilePath);
+
+    // 带文件头的字节流（录像文件里内嵌一份开局布局）
+    void SaveToBytes(TArray<uint8>& OutBytes) const;
+    bool LoadFromBytes(const TArray<uint8>& Bytes);
+
+    // 按文件版本读写（老版本文件缺的字段保持默认值）
+    void Serialize(FArchive& Ar, uint32 Version);
+};
+
+/**
+ * 战斗属性（享元）：Init 时把布局里相同的属性组合合并成一条，实体只存下标
+ * 同一兵种的单位共用一条，热循环读的是一张很小的表
+ */
+struct FSimArchetype
+{
+    float AttackRange = 150.0f;
+    float Damage = 10.0f;
+    float MoveSpeed = 300.0f;
+    float AttackInterval = 1.0f;
+    float ProjectileSpeed = 0.0f;   // 0 表示近战，伤害立即结算
+    float SplashRadius = 0.0f;      // 0 表示单体伤害
+    FTargetingPolicy Targeting;
+
+    bool operator==(const FSimArchetype& Other) const
+    {
+        return AttackRange == Other.AttackRange && Damage == Other.Damage && MoveSpeed == Other.MoveSpeed
+            && AttackInterval == Other.AttackInterval && ProjectileSpeed == Other.ProjectileSpeed
+            && SplashRadius == Other.SplashRadius && Targeting == Other.Targeting;
+    }
+};
+
+/**
+ * 模拟中的实体状态（原来散落在 ABaseUnit 里的战斗数据）
+ */
+struct FSimEntity
+{
+    FString Name;
+    ETeam Team;
+    EUnitType UnitType;
+    bool bIsUnit;
+    bool bActive;          // SetUnitActive(false) 后停止一切行动
+    bool bAlive;
+
+    FVector Location;
+    FRotator Rotation;
+    FIntRect Footprint;          // 占地（格子坐标），为空表示不占格子
+    ETargetClass TargetClass;
+
+    // --- 属性 ---
+    int32 ArchetypeIndex;        // FBattleSimulation::GetArchetypes() 的下标
+    float MaxHealth;
+    float CurrentHealth;
+
+    // --- 状态机 ---
+    EUnitState State;
+    int32 TargetIndex;           // 当前锁定的目标（INDEX_NONE 表示没有）
+    TArray<FVector> PathPoints;  // 当前的路径点列表
+    int32 CurrentPathIndex;
+    float LastAttackTime;        // 攻击计时器
+
+    // --- 统计（用于平衡性报告） ---
+    float DamageDealt;
+    float DamageTaken;
+    int32 Kills;
+    float DeathTime;
+};
+
+// 一次伤害（攻击和弹道落地时入队，每步末尾统一结算）
+struct FSimDamageEvent
+{
+    int32 AttackerIndex;
+    int32 VictimIndex;
+    float Amount;              // 克制倍率之前的原始伤害
+    EUnitType AttackerType;    // 查克制表用
+    bool bArea;                // 范围伤害的合计（几个来源合在一起，不吃克制）
+};
+
+// 运行时计数（压测时看避让的开销和效果）
+struct FSimulationStats
+{
+    int32 PathRequests = 0;        // 调用 FindPath 的次数（含重新寻路）
+    int64 OverlapUnitSteps = 0;    // 每步移动中与他人重叠的单位数之和
+    int64 AvoidanceQueries = 0;    // 计算分离力的次数
+    uint64 AvoidanceCycles = 0;    // 建邻居格子 + 计算分离力的总耗时（CPU 周期）
+    int32 ProjectilesFired = 0;
+    int32 ProjectileHits = 0;      // 落地时附近有敌人
+    int32 PeakProjectiles = 0;     // 同时在飞的最大数量
+    uint64 ProjectileCycles = 0;   // 推进弹道 + 结算命中的总耗时（CPU 周期）
+    int64 DamageEvents = 0;        // 结算过的伤害事件数
+    int32 SimultaneousKills = 0;   // 同一步里互相击杀（双方都死在同一步）的次数
+    int32 ReplansScheduled = 0;    // 网格变化后排队重新寻路的单位数
+    int32 Replans = 0;             // 实际执行的重新寻路次数
+    int64 AreaRequests = 0;        // 范围伤害（爆炸）次数
+    int64 AreaHits = 0;            // 合并后受到范围伤害的实体数（每步每个实体最多算一次）
+    uint64 AreaCycles = 0;         // 批量查询 + 合并的总耗时（CPU 周期）
+};
+
+// 分阶段耗时的归类（战斗性能报告用）
+enum class ESimPhase : uint8
+{
+    AI,            // 索敌
+    Pathfinding,   // 寻路（含网格变化后的重新寻路）
+    Movement,      // 建邻居格子 + 沿路径移动
+    Combat,        // 攻击、弹道、防御塔、伤害结算
+    Count
+};
+
+struct FBattleResult
+{
+    EBattleOutcome Outcome = EBattleOutcome::InProgress;
+    float Duration = 0.0f;   // 模拟时间（秒）
+    int32 Steps = 0;
+};
+
+/**
+ * 定步长战斗模拟器
+ * 实体按数组顺序更新，不受 Actor Tick 顺序影响
+ */
+class AUTOBATTLEDEMO_API FBattleSimulation
+{
+public:
+    FBattleSimulation();
+
+    // 用布局初始化（网格会拷贝一份，之后与游戏内的 AGridManager 互不影响）
+    void Init(const FBattleSetup& Setup);
+
+    // 推进一个定步长
+    void Step();
+
+    // 一直推进到分出胜负（或超时）
+    FBattleResult RunToCompletion();
+
+    bool IsFinished() const { return Outcome != EBattleOutcome::InProgress; }
+    FBattleResult GetResult() const;
+
+    // 对应 ABaseUnit::SetUnitActive
+    void SetEntityActive(int32 EntityIndex, bool bActive);
+
+    // 寻路结果按起终点格子缓存（默认打开，结果和不缓存逐位一致；确定性检查的基准会关掉它）
+    void SetUsePathCache(bool bUse) { bUsePathCache = bUse; }
+    const FPathCache& GetPathCache() const { return PathCache; }
+
+    // 网格变化（城墙被打掉）后每步最多重新寻路几个单位，其余的排到后面的步
+    void SetMaxReplansPerStep(int32 InMax) { MaxReplansPerStep = FMath::Max(InMax, 1); }
+    int32 GetPendingReplans() const { return ReplanQueue.Num(); }
+
+    // 录像：设置后 Init 和每一步都会把事件交给它（传空关闭），要在 Init 之前设置
+    void SetRecorder(class FBattleRecorder* InRecorder) { Recorder = InRecorder; }
+
+    /**
+     * 读写一步结束时的全部动态状态（位置、血量、状态机、弹道、统计），录像关键帧用
+     * 读取前必须已经用同一份布局 Init 过（兵种、阵营等不变的数据不在这里）
+     */
+    void SerializeState(FArchive& Ar);
+
+    // 当前状态的哈希：实体位置、朝向、血量、目标、状态机、占地阻挡和在飞的箭（浮点按位算）
+    // 不同实现（并行、缓存、存档恢复）每一步的哈希都必须和串行跑的一样
+    // 不含网格版本号：它是修改次数，读档时改回占地也会让它增加，同样的状态不一定是同一个值
+    uint32 ComputeStateHash() const;
+
+    // 建筑占地在网格里是否挡着（占地整块一起改，看左下角一格就够了；没有占地返回 false）
+    bool IsFootprintBlocked(int32 EntityIndex) const;
+
+    const TArray<FSimEntity>& GetEntities() const { return Entities; }
+    const TArray<FSimArchetype>& GetArchetypes() const { return Archetypes; }
+    const FGridMap& GetGrid() const { return Grid; }
+    float GetTime() const { return Time; }
+    int32 GetStepCount() const { return StepCount; }
+    float GetTimeStep() const { return TimeStep; }
+    const FSimulationStats& GetStats() const { return Stats; }
+    const FProjectileSystem& GetProjectiles() const { return Projectiles; }
+    const FDefenseTowerSystem& GetTowers() const { return Towers; }
+
+    // 每个阵营的存活实体数和剩余总血量（增量维护，O(1)）
+    int32 GetTeamAliveCount(ETeam Team) const { return TeamAliveCounts[(int32)Team]; }
+    float GetTeamHealth(ETeam Team) const { return TeamHealth[(int32)Team]; }
+
+    // 游戏内需要知道哪些实体死了、哪些重新寻路了（用于销毁 Actor 和调试绘制）
+    // 打开后事件会一直累积，直到调用 ConsumeEvents
+    void SetCollectEvents(bool bCollect) { bCollectEvents = bCollect; }
+    void ConsumeEvents(TArray<int32>& OutDeaths, TArray<int32>& OutPathUpdates);
+
+    /**
+     * 分阶段计时（默认关闭）：打开后每个单位的索敌、移动、攻击、寻路各多取两次时间
+     * 嵌套时只记最内层，移动途中触发的重新寻路算在寻路里
+     */
+    void SetCollectPhaseTimings(bool bCollect) { bCollectPhaseTimings = bCollect; }
+
+    // 取出上次调用以来各阶段的耗时（CPU 周期，下标是 ESimPhase）并清零
+    void ConsumePhaseTimings(uint64 (&OutCycles)[(int32)ESimPhase::Count]);
+
+    // 打印胜负、时长和每个实体的伤害统计
+    void LogReport(const FString& Label) const;
+
+    static const TCHAR* OutcomeToString(EBattleOutcome InOutcome);
+
+private:
+    // 合并相同的属性组合，返回享元下标
+    int32 FindOrAddArchetype(const FSimEntitySpawn& Spawn);
+
+    // --- 单位逻辑（原 ABaseUnit::Tick 状态机） ---
+    void TickUnit(int32 UnitIndex);
+
+    // 1. 按索敌策略寻找敌人（同一类里攻击范围内的优先，其次最近的）
+    int32 FindClosestEnemy(int32 UnitIndex) const;
+
+    // 2. 请求路径
+    void RequestPathToTarget(int32 UnitIndex);
+
+    // 3. 沿路径移动
+    void MoveAlongPath(int32 UnitIndex, float DeltaTime);
+
+    // 4. 执行攻击
+    void PerformAttack(int32 UnitIndex);
+
+    // 寻路的终点：有占地的目标取它周围离单位最近的可通行格子，其余就是目标位置
+    FVector GetApproachPoint(int32 UnitIndex, int32 TargetIndex) const;
+
+    // 到目标的距离：有占地的目标量到占地边缘（水平距离），其余量到中心
+    float GetDistanceToEntity(const FVector& From, int32 EntityIndex) const;
+
+    // --- 网格变化后的重新寻路 ---
+    // 网格改过以后：路径经过改动范围附近的单位和现在能走通的单位排队
+    void ScheduleReplans();
+
+    // 每步开头按队列顺序重新寻路，最多 MaxReplansPerStep 个
+    void ProcessReplanQueue();
+
+    // 单位现在是否值得重新寻路（沿路径走着的，或者停着等路的且已经和目标连通）
+    bool IsReplanCandidate(int32 UnitIndex) const;
+
+    // 读档后按实体当前的路径重建反向索引
+    void RebuildReplanIndex();
+
+    // 按存活实体的当前位置重建索敌索引（Init 和读档后）
+    void RebuildTargetCandidates();
+
+    // 伤害入队（这一步内受击方的血量不变，所有单位看到的是同一份状态）
+    void QueueDamage(int32 AttackerIndex, int32 VictimIndex, float Amount);
+
+    // 一次命中：有溅射的攻击者在 Location 处爆炸，否则只打 VictimIndex（可以为空，表示落空）
+    void QueueHit(int32 AttackerIndex, int32 VictimIndex, const FVector& Location, float Amount);
+
+    // 这一步攒下的爆炸批量查询，每个受击者的合计伤害并入伤害队列
+    void ResolveAreaDamage();
+
+    // 每步末尾按入队顺序一次性结算伤害，本步死亡的实体按下标顺序统一标记
+    // （对应原来的 ABaseGameEntity::TakeDamage + Die）
+    void ResolveDamage();
+
+    // 每步开始时把存活实体的位置登记进邻居格子（避让和弹道命中共用）
+    void BuildAvoidanceGrid();
+
+    // 推进所有在飞的弹道，落地的在落点附近找敌人结算伤害
+    void UpdateProjectiles();
+
+    // 防御塔统一索敌开火（在单位之后，伤害同样到本步末尾才结算）
+    void UpdateTowers();
+
+    // 网格覆盖的范围（XY）
+    void GetBattleBounds(FVector2D& OutMin, FVector2D& OutMax) const;
+
+    bool IsTargetAlive(int32 TargetIndex) const;
+    void FaceDirection(FSimEntity& Unit, const FVector& Direction);
+    void UpdateOutcome();
+
+    FGridMap Grid;
+    TArray<FSimEntity> Entities;
+    TArray<FSimArchetype> Archetypes;
+
+    float Time;
+    float TimeStep;
+    float MaxBattleTime;
+    int32 StepCount;
+    EBattleOutcome Outcome;
+
+    FCrowdAvoidanceSettings AvoidanceSettings;
+    FCrowdAvoidance Avoidance;
+    FSimulationStats Stats;
+
+    FProjectileSystem Projectiles;
+    TArray<FProjectileImpact> PendingImpacts;
+
+    FDefenseTowerSystem Towers;
+    TArray<FTowerShot> TowerShots;
+
+    FPathCache PathCache;
+    bool bUsePathCache;
+
+    FPathReplanIndex ReplanIndex;
+    TArray<int32> ReplanQueue;        // 按入队顺序处理（存档的一部分）
+    TArray<bool> ReplanQueued;        // 每个实体是否已经在队列里
+    TArray<int32> ReplanCandidates;
+    uint32 ReplanSyncedRevision;
+    int32 MaxReplansPerStep;
+
+    // 按阵营统计（下标是 ETeam），只在 Init 和结算伤害时改动
+    int32 TeamAliveCounts[2];
+    float TeamHealth[2];
+
+    FTargetCandidateIndex TargetCandidates;
+
+    FAreaDamageBatch AreaDamage;
+    TArray<FAreaDamageHit> AreaHits;
+    bool bHasSplash;                  // 有没有带溅射的兵种（有的话每步都要建邻居格子）
+
+    FDamageModifierTable DamageModifiers;
+    TArray<FSimDamageEvent> DamageQueue;
+    TArray<int32> KilledThisStep;
+
+    class FBattleRecorder* Recorder;
+
+    bool bCollectEvents;
+    TArray<int32> PendingDeaths;
+    TArray<int32> PendingPathUpdates;
+
+    // 阶段计时的作用域：进入时先把已经过去的时间记给外层阶段，退出时记给自己
+    class FPhaseScope
+    {
+    public:
+        FPhaseScope(FBattleSimulation& InSimulation, ESimPhase Phase);
+        ~FPhaseScope();
+
+    private:
+        FBattleSimulation* Simulation;   // 没开计时为空
+        int32 ParentPhase;
+    };
+
+    bool bCollectPhaseTimings;
+    uint64 PhaseCycles[(int32)ESimPhase::Count];
+    int32 ActivePhase;                   // 当前计时中的阶段（INDEX_NONE 表示不在任何阶段里）
+    uint64 ActivePhaseStart;
+};
@@ -0,0 +1,343 @@
+// BattleSimulationTests.cpp：战斗模拟确定性的自动化测试（AutoBattle.BattleSimulation）
+// 和 DeterminismCheck 命令行做的是同一类检查，这里用代码搭的小布局，不依赖存盘文件
+#include "Misc/AutomationTest.h"
+#include "BattleSimulation.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+    FSimEntitySpawn& AddUnit(FBattleSetup& Setup, const TCHAR* Name, ETeam Team, EUnitType Type, int32 GridX, int32 GridY)
+    {
+        FSimEntitySpawn& Spawn = Setup.Entities.AddDefaulted_GetRef();
+        Spawn.Name = Name;
+        Spawn.Team = Team;
+        Spawn.UnitType = Type;
+        Spawn.Location = Setup.Grid.GridToWorld(GridX, GridY);
+        switch (Type)
+        {
+        case EUnitType::Archer:
+            Spawn.MaxHealth = 60.0f;
+            Spawn.AttackRange = 500.0f;
+            Spawn.Damage = 8.0f;
+            Spawn.ProjectileSpeed = 1200.0f;
+            break;
+        case EUnitType::Tank:
+            Spawn.MaxHealth = 300.0f;
+            Spawn.MoveSpeed = 200.0f;
+            Spawn.Damage = 15.0f;
+            Spawn.AttackInterval = 1.5f;
+            Spawn.SplashRadius = 150.0f;
+            break;
+        default:
+            break;
+        }
+        return Spawn;
+    }
+
+    /**
+     * 两队各几个兵，中间一道留了缺口的墙，敌方有一座 2x2 的防御塔
+     * 覆盖寻路、避让、弹道、范围伤害、防御塔和占地让开这几条会改状态的路径
+     */
+    FBattleSetup MakeTestSetup()
+    {
+        FBattleSetup Setup;
+        Setup.Grid.Generate(24, 16, 100.0f, FVector(-1200.0f, -800.0f, 0.0f));
+        Setup.MaxBattleTime = 60.0f;
+
+        // 1. 中间的墙（第 6~9 行留缺口）
+        TArray<FIntPoint> Wall;
+        for (int32 Y = 0; Y < Setup.Grid.GetHeight(); Y++)
+        {
+            if (Y < 6 || Y > 9) Wall.Emplace(12, Y);
+        }
+        Setup.Grid.SetTilesBlocked(Wall, true);
+
+        // 2. 双方的兵
+        AddUnit(Setup, TEXT("P_Soldier_0"), ETeam::Player, EUnitType::Soldier, 2, 5);
+        AddUnit(Setup, TEXT("P_Soldier_1"), ETeam::Player, EUnitType::Soldier, 2, 7);
+        AddUnit(Setup, TEXT("P_Soldier_2"), ETeam::Player, EUnitType::Soldier, 2, 9);
+        AddUnit(Setup, TEXT("P_Archer_0"), ETeam::Player, EUnitType::Archer, 0, 6);
+        AddUnit(Setup, TEXT("P_Archer_1"), ETeam::Player, EUnitType::Archer, 0, 10);
+        AddUnit(Setup, TEXT("P_Tank_0"), ETeam::Player, EUnitType::Tank, 4, 8);
+
+        // 站在缺口外、塔在射程内的弓箭手，只打防御塔：开战就和塔对射
+        FSimEntitySpawn& TowerHunter = AddUnit(Setup, TEXT("P_Archer_Tower"), ETeam::Player, EUnitType::Archer, 13, 8);
+        TowerHunter.Targeting.Priority.Add(ETargetClass::Defense);
+
+        AddUnit(Setup, TEXT("E_Soldier_0"), ETeam::Enemy, EUnitType::Soldier, 20, 4);
+        AddUnit(Setup, TEXT("E_Soldier_1"), ETeam::Enemy, EUnitType::Soldier, 20, 8);
+        AddUnit(Setup, TEXT("E_Archer_0"), ETeam::Enemy, EUnitType::Archer, 22, 6);
+        AddUnit(Setup, TEXT("E_Tank_0"), ETeam::Enemy, EUnitType::Tank, 19, 11);
+
+        // 3. 防御塔：占地先挡进网格，倒下时模拟器再让开
+        const FIntRect Footprint(16, 7, 18, 9);
+        Setup.Grid.SetFootprintBlocked(Footprint.Min.X, Footprint.Min.Y, Footprint.Width(), Footprint.Height(), true);
+        FSimEntitySpawn& Tower = Setup.Entities.AddDefaulted_GetRef();
+        Tower.Name = TEXT("E_Tower_0");
+        Tower.Team = ETeam::Enemy;
+        Tower.bIsUnit = false;
+        Tower.Location = (Setup.Grid.GetTileCenter(Footprint.Min.X, Footprint.Min.Y) + Setup.Grid.GetTileCenter(Footprint.Max.X - 1, Footprint.Max.Y - 1)) * 0.5f;
+        Tower.MaxHealth = 250.0f;
+        Tower.AttackRange = 400.0f;
+        Tower.Damage = 12.0f;
+        Tower.MoveSpeed = 0.0f;
+        Tower.Footprint = Footprint;
+        Tower.TargetClass = ETargetClass::Defense;
+        return Setup;
+    }
+
+    // 跑完整场，记下 Init 之后和每一步的哈希
+    TArray<uint32> RecordHashes(FBattleSimulation& Simulation, const FBattleSetup& Setup)
+    {
+        TArray<uint32> Hashes;
+        Simulation.Init(Setup);
+        Hashes.Add(Simulation.ComputeStateHash());
+        while (!Simulation.IsFinished())
+        {
+            Simulation.Step();
+            Hashes.Add(Simulation.ComputeStateHash());
+        }
+        return Hashes;
+    }
+
+    int32 FindEntity(const FBattleSimulation& Simulation, const TCHAR* Name)
+    {
+        return Simulation.GetEntities().IndexOfByPredicate([Name](const FSimEntity& Entity) { return Entity.Name == Name; });
+    }
+
+    // 返回第一处不一样的步数（完全一样返回 INDEX_NONE）
+    int32 FindFirstMismatch(const TArray<uint32>& Expected, const TArray<uint32>& Actual)
+    {
+        for (int32 i = 0; i < Expected.Num() && i < Actual.Num(); i++)
+        {
+            if (Expected[i] != Actual[i]) return i;
+        }
+        return Expected.Num() == Actual.Num() ? INDEX_NONE : FMath::Min(Expected.Num(), Actual.Num());
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBattleSimulationRepeatableTest, "AutoBattle.BattleSimulation.Repeatable",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FBattleSimulationRepeatableTest::RunTest(const FString& Parameters)
+{
+    const FBattleSetup Setup = MakeTestSetup();
+
+    // 1. 基准：新对象跑一场
+    FBattleSimulation Baseline;
+    const TArray<uint32> Expected = RecordHashes(Baseline, Setup);
+    const FBattleResult ExpectedResult = Baseline.GetResult();
+    TestTrue(TEXT("Battle finishes"), Baseline.IsFinished());
+    TestTrue(TEXT("Battle runs more than a few steps"), Expected.Num() > 30);
+    TestNotEqual(TEXT("Hash changes once units start moving"), Expected[0], Expected[1]);
+
+    // 不只是和自己比：塔要摆在占地上，开战后和弓箭手互相打到
+    {
+        FBattleSimulation Probe;
+        Probe.Init(Setup);
+        const int32 TowerIndex = FindEntity(Probe, TEXT("E_Tower_0"));
+        const int32 HunterIndex = FindEntity(Probe, TEXT("P_Archer_Tower"));
+        if (!TestTrue(TEXT("Fixture has the tower and the tower hunter"), TowerIndex != INDEX_NONE && HunterIndex != INDEX_NONE))
+        {
+            return false;
+        }
+
+        int32 TowerX, TowerY;
+        Probe.GetGrid().WorldToGrid(Probe.GetEntities()[TowerIndex].Location, TowerX, TowerY);
+        TestTrue(TEXT("Tower stands on its footprint"), Probe.GetEntities()[TowerIndex].Footprint.Contains(FIntPoint(TowerX, TowerY)));
+        TestTrue(TEXT("Tower footprint is blocked at the start"), Probe.IsFootprintBlocked(TowerIndex));
+
+        // 3 秒内（箭飞 250 单位不到 0.3 秒）双方都应该掉血
+        for (int32 i = 0; i < 90 && !Probe.IsFinished(); i++)
+        {
+            Probe.Step();
+        }
+        const FSimEntity& TowerState = Probe.GetEntities()[TowerIndex];
+        const FSimEntity& HunterState = Probe.GetEntities()[HunterIndex];
+        TestTrue(TEXT("Tower takes damage within 90 steps"), !TowerState.bAlive || TowerState.CurrentHealth < TowerState.MaxHealth);
+        TestTrue(TEXT("Tower hits the archer within 90 steps"), !HunterState.bAlive || HunterState.CurrentHealth < HunterState.MaxHealth);
+    }
+
+    // 塔倒下以后占地要让开
+    const int32 BaselineTower = FindEntity(Baseline, TEXT("E_Tower_0"));
+    if (!Baseline.GetEntities()[BaselineTower].bAlive)
+    {
+        TestFalse(TEXT("Dead tower no longer blocks its footprint"), Baseline.IsFootprintBlocked(BaselineTower));
+    }
+
+    // 2. 另一个新对象、同一个对象重新 Init、关掉路径缓存，每一步的哈希都要一样
+    FBattleSimulation Fresh;
+    const int32 FreshMismatch = FindFirstMismatch(Expected, RecordHashes(Fresh, Setup));
+    TestEqual(TEXT("Second simulation matches at every step (first mismatch)"), FreshMismatch, (int32)INDEX_NONE);
+
+    const int32 ReusedMismatch = FindFirstMismatch(Expected, RecordHashes(Baseline, Setup));
+    TestEqual(TEXT("Re-initialised simulation matches at every step (first mismatch)"), ReusedMismatch, (int32)INDEX_NONE);
+
+    FBattleSimulation Uncached;
+    Uncached.SetUsePathCache(false);
+    const int32 UncachedMismatch = FindFirstMismatch(Expected, RecordHashes(Uncached, Setup));
+    TestEqual(TEXT("Simulation without path cache matches at every step (first mismatch)"), UncachedMismatch, (int32)INDEX_NONE);
+
+    const FBattleResult Result = Fresh.GetResult();
+    TestTrue(TEXT("Same outcome"), Result.Outcome == ExpectedResult.Outcome);
+    TestEqual(TEXT("Same step count"), Result.Steps, ExpectedResult.Steps);
+
+    // 3. 布局存成字节再读回来跑，结果也一样
+    TArray<uint8> SetupBytes;
+    Setup.SaveToBytes(SetupBytes);
+    FBattleSetup LoadedSetup;
+    if (!TestTrue(TEXT("Setup loads from bytes"), LoadedSetup.LoadFromBytes(SetupBytes)))
+    {
+        return false;
+    }
+    FBattleSimulation FromBytes;
+    const int32 LoadedMismatch = FindFirstMismatch(Expected, RecordHashes(FromBytes, LoadedSetup));
+    TestEqual(TEXT("Simulation from a saved setup matches at every step (first mismatch)"), LoadedMismatch, (int32)INDEX_NONE);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBattleSimulationKeyframeTest, "AutoBattle.BattleSimulation.KeyframeRestore",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FBattleSimulationKeyframeTest::RunTest(const FString& Parameters)
+{
+    const FBattleSetup Setup = MakeTestSetup();
+
+    FBattleSimulation Baseline;
+    const TArray<uint32> Expected = RecordHashes(Baseline, Setup);
+
+    // 在几个不同的时刻存关键帧，读进另一个模拟器接着跑到结束，之后每一步都要和基准一样
+    const int32 Keyframes[] = { 1, Expected.Num() / 4, Expected.Num() / 2, Expected.Num() - 2 };
+    for (const int32 KeyframeStep : Keyframes)
+    {
+        FBattleSimulation Source;
+        Source.Init(Setup);
+        while (Source.GetStepCount() < KeyframeStep && !Source.IsFinished())
+        {
+            Source.Step();
+        }
+
+        TArray<uint8> Bytes;
+        FMemoryWriter Writer(Bytes);
+        Source.SerializeState(Writer);
+
+        FBattleSimulation Restored;
+        Restored.Init(Setup);
+        FMemoryReader Reader(Bytes);
+        Restored.SerializeState(Reader);
+
+        TArray<uint32> Actual;
+        Actual.Add(Restored.ComputeStateHash());
+        while (!Restored.IsFinished())
+        {
+            Restored.Step();
+            Actual.Add(Restored.ComputeStateHash());
+        }
+
+        const TArray<uint32> ExpectedTail(Expected.GetData() + Source.GetStepCount(), Expected.Num() - Source.GetStepCount());
+        TestEqual(FString::Printf(TEXT("Restored from step %d matches at every step (first mismatch)"), Source.GetStepCount()),
+            FindFirstMismatch(ExpectedTail, Actual), (int32)INDEX_NONE);
+    }
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBattleSetupRejectCorruptTest, "AutoBattle.BattleSimulation.RejectCorruptSetup",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FBattleSetupRejectCorruptTest::RunTest(const FString& Parameters)
+{
+    const FBattleSetup Source = MakeTestSetup();
+    TArray<uint8> Bytes;
+    Source.SaveToBytes(Bytes);
+
+    // 文件头（魔数、版本）之后是网格：宽、高、格子尺寸、原点，然后每格 8 字节，再往后是实体数
+    const int32 WidthOffset = 2 * sizeof(uint32);
+    const int32 HeightOffset = WidthOffset + sizeof(int32);
+    const int32 NumEntitiesOffset = HeightOffset + sizeof(int32) + sizeof(float) + sizeof(FVector)
+        + Source.Grid.GetWidth() * Source.Grid.GetHeight() * 8;
+
+    auto ExpectRejected = [this](const TCHAR* What, const TArray<uint8>& Corrupt)
+    {
+        FBattleSetup Setup;
+        Setup.Grid.Generate(3, 2, 50.0f, FVector::ZeroVector);
+        Setup.Entities.AddDefaulted(1);
+        TestFalse(FString::Printf(TEXT("Rejects %s"), What), Setup.LoadFromBytes(Corrupt));
+        TestTrue(FString::Printf(TEXT("Setup unchanged after %s"), What),
+            Setup.Grid.GetWidth() == 3 && Setup.Grid.GetHeight() == 2 && Setup.Entities.Num() == 1);
+    };
+
+    auto Patched = [&Bytes](int32 Offset, int32 Value)
+    {
+        TArray<uint8> Corrupt = Bytes;
+        FMemory::Memcpy(&Corrupt[Offset], &Value, sizeof(int32));
+        return Corrupt;
+    };
+
+    FBattleSetup Loaded;
+    TestTrue(TEXT("Loads the intact setup"), Loaded.LoadFromBytes(Bytes));
+    TestEqual(TEXT("Intact setup keeps its entities"), Loaded.Entities.Num(), Source.Entities.Num());
+
+    ExpectRejected(TEXT("zero width"), Patched(WidthOffset, 0));
+    ExpectRejected(TEXT("negative height"), Patched(HeightOffset, -4));
+    ExpectRejected(TEXT("more cells than int32"), Patched(WidthOffset, MAX_int32));
+    ExpectRejected(TEXT("grid larger than the file"), Patched(HeightOffset, 40000));
+    ExpectRejected(TEXT("negative entity count"), Patched(NumEntitiesOffset, -1));
+    ExpectRejected(TEXT("entity count larger than the file"), Patched(NumEntitiesOffset, 100000000));
+
+    TArray<uint8> Truncated = Bytes;
+    Truncated.SetNum(Bytes.Num() - 1);
+    ExpectRejected(TEXT("truncated file"), Truncated);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBattleSimulationFootprintRangeTest, "AutoBattle.BattleSimulation.FootprintRange",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FBattleSimulationFootprintRangeTest::RunTest(const FString& Parameters)
+{
+    // 网格原点和占地都离世界原点很远：射程要量到占地边上，而不是原点附近
+    FBattleSetup Setup;
+    Setup.Grid.Generate(16, 12, 100.0f, FVector(2000.0f, 1500.0f, 0.0f));
+
+    const FIntRect Footprint(9, 5, 12, 7);
+    Setup.Grid.SetFootprintBlocked(Footprint.Min.X, Footprint.Min.Y, Footprint.Width(), Footprint.Height(), true);
+    FSimEntitySpawn& Wall = Setup.Entities.AddDefaulted_GetRef();
+    Wall.Name = TEXT("E_Wall_0");
+    Wall.Team = ETeam::Enemy;
+    Wall.bIsUnit = false;
+    Wall.Location = (Setup.Grid.GetTileCenter(Footprint.Min.X, Footprint.Min.Y) + Setup.Grid.GetTileCenter(Footprint.Max.X - 1, Footprint.Max.Y - 1)) * 0.5f;
+    Wall.MaxHealth = 1000.0f;
+    Wall.AttackRange = 0.0f;
+    Wall.Damage = 0.0f;
+    Wall.MoveSpeed = 0.0f;
+    Wall.Footprint = Footprint;
+    Wall.TargetClass = ETargetClass::Wall;
+
+    // 兵站在占地左边一格，到占地边缘半格，射程 150 够得着
+    FSimEntitySpawn& Soldier = Setup.Entities.AddDefaulted_GetRef();
+    Soldier.Name = TEXT("P_Soldier_0");
+    Soldier.Team = ETeam::Player;
+    Soldier.Location = Setup.Grid.GridToWorld(Footprint.Min.X - 1, Footprint.Min.Y);
+
+    FBattleSimulation Simulation;
+    Simulation.Init(Setup);
+    for (int32 i = 0; i < 10 && !Simulation.IsFinished(); i++)
+    {
+        Simulation.Step();
+    }
+
+    const FSimEntity& WallState = Simulation.GetEntities()[0];
+    const FSimEntity& SoldierState = Simulation.GetEntities()[1];
+    TestTrue(TEXT("Soldier next to the footprint hits the wall"), WallState.CurrentHealth < WallState.MaxHealth);
+    TestTrue(TEXT("Soldier already in range does not walk away"), FVector::Dist(SoldierState.Location, Soldier.Location) < 1.0f);
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,191 @@
+#include "CrowdAvoidance.h"
+
+FArchive& operator<<(FArchive& Ar, FCrowdAvoidanceSettings& Settings)
+{
+    Ar << Settings.bEnabled << Settings.AgentRadius << Settings.SeparationDistance;
+    Ar << Settings.SeparationWeight << Settings.MaxNeighbors;
+    return Ar;
+}
+
+FCrowdAvoidance::FCrowdAvoidance()
+    : GridMin(FVector2D::ZeroVector)
+    , CellSize(100.0f)
+    , CellsX(1)
+    , CellsY(1)
+{
+}
+
+void FCrowdAvoidance::Reset(const FCrowdAvoidanceSettings& InSettings, const FVector2D& BoundsMin, const FVector2D& BoundsMax)
+{
+    Settings = InSettings;
+    Settings.MaxNeighbors = FMath::Clamp(Settings.MaxNeighbors, 1, MaxNeighborsLimit);
+
+    // 格子边长等于分离距离，查询时只需要看周围 3x3 个格子
+    GridMin = BoundsMin;
+    CellSize = FMath::Max(Settings.SeparationDistance, 1.0f);
+    CellsX = FMath::Max(FMath::CeilToInt((BoundsMax.X - BoundsMin.X) / CellSize), 1);
+    CellsY = FMath::Max(FMath::CeilToInt((BoundsMax.Y - BoundsMin.Y) / CellSize), 1);
+
+    AgentX.Reset();
+    AgentY.Reset();
+    AgentEntity.Reset();
+    AgentCell.Reset();
+}
+
+void FCrowdAvoidance::AddAgent(int32 EntityIndex, const FVector& Location)
+{
+    AgentX.Add(Location.X);
+    AgentY.Add(Location.Y);
+    AgentEntity.Add(EntityIndex);
+    AgentCell.Add(GetCellIndex(Location.X, Location.Y));
+}
+
+void FCrowdAvoidance::Finalize()
+{
+    const int32 NumCells = CellsX * CellsY;
+    const int32 NumAgents = AgentX.Num();
+
+    // 1. 统计每个格子的数量
+    CellStart.Reset();
+    CellStart.AddZeroed(NumCells + 1);
+    for (int32 Cell : AgentCell)
+    {
+        CellStart[Cell + 1]++;
+    }
+
+    // 2. 前缀和得到每个格子的起始位置
+    for (int32 c = 0; c < NumCells; c++)
+    {
+        CellStart[c + 1] += CellStart[c];
+    }
+
+    // 3. 按格子写入（同一格子内保持登记顺序，结果稳定）
+    SortedX.SetNumUninitialized(NumAgents);
+    SortedY.SetNumUninitialized(NumAgents);
+    SortedEntity.SetNumUninitialized(NumAgents);
+
+    TArray<int32> WriteCursor;
+    WriteCursor.Append(CellStart.GetData(), NumCells);
+    for (int32 i = 0; i < NumAgents; i++)
+    {
+        const int32 Slot = WriteCursor[AgentCell[i]]++;
+        SortedX[Slot] = AgentX[i];
+        SortedY[Slot] = AgentY[i];
+        SortedEntity[Slot] = AgentEntity[i];
+    }
+}
+
+FVector FCrowdAvoidance::ComputeVelocity(int32 EntityIndex, const FVector& Location, const FVector& DesiredVelocity, float MaxSpeed, int32& OutOverlaps) const
+{
+    OutOverlaps = 0;
+
+    const float RadiusSq = Settings.SeparationDistance * Settings.SeparationDistance;
+    const float OverlapDistSq = FMath::Square(Settings.AgentRadius * 2.0f);
+
+    // 1. 收集最多 MaxNeighbors 个邻居的相对位置（按 16 对齐，方便 SIMD 一次读 4 个）
+    MS_ALIGN(16) float NeighborDX[MaxNeighborsLimit] GCC_ALIGN(16);
+    MS_ALIGN(16) float NeighborDY[MaxNeighborsLimit] GCC_ALIGN(16);
+    int32 NumNeighbors = 0;
+
+    const int32 CellX = FMath::Clamp(FMath::FloorToInt((Location.X - GridMin.X) / CellSize), 0, CellsX - 1);
+    const int32 CellY = FMath::Clamp(FMath::FloorToInt((Location.Y - GridMin.Y) / CellSize), 0, CellsY - 1);
+
+    for (int32 Y = FMath::Max(CellY - 1, 0); Y <= FMath::Min(CellY + 1, CellsY - 1) && NumNeighbors < Settings.MaxNeighbors; Y++)
+    {
+        for (int32 X = FMath::Max(CellX - 1, 0); X <= FMath::Min(CellX + 1, CellsX - 1) && NumNeighbors < Settings.MaxNeighbors; X++)
+        {
+            const int32 Cell = Y * CellsX + X;
+            for (int32 k = CellStart[Cell]; k < CellStart[Cell + 1]; k++)
+            {
+                if (SortedEntity[k] == EntityIndex) continue;
+
+                float DX = Location.X - SortedX[k];
+                float DY = Location.Y - SortedY[k];
+                const float DistSq = DX * DX + DY * DY;
+                if (DistSq >= RadiusSq) continue;
+
+                if (DistSq < OverlapDistSq)
+                {
+                    OutOverlaps++;
+                }
+
+                // 完全重合时没有方向，按下标大小往两边推，保证确定性
+                if (DistSq < KINDA_SMALL_NUMBER)
+                {
+                    DX = EntityIndex < SortedEntity[k] ? -1.0f : 1.0f;
+                    DY = 0.0f;
+                }
+
+                NeighborDX[NumNeighbors] = DX;
+                NeighborDY[NumNeighbors] = DY;
+                if (++NumNeighbors >= Settings.MaxNeighbors) break;
+            }
+        }
+    }
+
+    if (NumNeighbors == 0)
+    {
+        return DesiredVelocity;
+    }
+
+    // 2. 排斥力：方向远离邻居，大小随距离线性衰减（贴脸为 1，分离距离处为 0）
+    float ForceX = 0.0f;
+    float ForceY = 0.0f;
+    const float Range = Settings.SeparationDistance;
+
+#if AUTOBATTLE_AVOIDANCE_SIMD
+    // 补齐到 4 的倍数，多出来的放到分离距离之外，权重为 0
+    const int32 NumPadded = Align(NumNeighbors, 4);
+    for (int32 i = NumNeighbors; i < NumPadded; i++)
+    {
+        NeighborDX[i] = Range;
+        NeighborDY[i] = 0.0f;
+    }
+
+    const VectorRegister RangeVec = VectorSetFloat1(Range);
+    const VectorRegister InvRangeVec = VectorSetFloat1(1.0f / Range);
+    const VectorRegister EpsilonVec = VectorSetFloat1(KINDA_SMALL_NUMBER);
+    VectorRegister SumX = VectorZero();
+    VectorRegister SumY = VectorZero();
+    for (int32 i = 0; i < NumPadded; i += 4)
+    {
+        const VectorRegister DX = VectorLoadAligned(&NeighborDX[i]);
+        const VectorRegister DY = VectorLoadAligned(&NeighborDY[i]);
+        const VectorRegister DistSq = VectorAdd(VectorMultiplyAdd(DX, DX, VectorMultiply(DY, DY)), EpsilonVec);
+        const VectorRegister InvDist = VectorReciprocalSqrt(DistSq);
+        const VectorRegister Dist = VectorMultiply(DistSq, InvDist);
+        const VectorRegister Weight = VectorMultiply(VectorMax(VectorSubtract(RangeVec, Dist), VectorZero()), InvRangeVec);
+        const VectorRegister Scale = VectorMultiply(Weight, InvDist);
+        SumX = VectorMultiplyAdd(DX, Scale, SumX);
+        SumY = VectorMultiplyAdd(DY, Scale, SumY);
+    }
+
+    MS_ALIGN(16) float LanesX[4] GCC_ALIGN(16);
+    MS_ALIGN(16) float LanesY[4] GCC_ALIGN(16);
+    VectorStoreAligned(SumX, LanesX);
+    VectorStoreAligned(SumY, LanesY);
+    ForceX = (LanesX[0] + LanesX[1]) + (LanesX[2] + LanesX[3]);
+    ForceY = (LanesY[0] + LanesY[1]) + (LanesY[2] + LanesY[3]);
+#else
+    for (int32 i = 0; i < NumNeighbors; i++)
+    {
+        const float Dist = FMath::Sqrt(NeighborDX[i] * NeighborDX[i] + NeighborDY[i] * NeighborDY[i] + KINDA_SMALL_NUMBER);
+        const float Weight = FMath::Max(Range - Dist, 0.0f) / Range;
+        ForceX += NeighborDX[i] / Dist * Weight;
+        ForceY += NeighborDY[i] / Dist * Weight;
+    }
+#endif
+
+    // 3. 叠加到期望速度上，并限制在最大速度以内
+    FVector Velocity = DesiredVelocity;
+    Velocity.X += ForceX * Settings.SeparationWeight * MaxSpeed;
+    Velocity.Y += ForceY * Settings.SeparationWeight * MaxSpeed;
+    return Velocity.GetClampedToMaxSize(MaxSpeed);
+}
+
+int32 FCrowdAvoidance::GetCellIndex(float X, float Y) const
+{
+    const int32 CellX = FMath::Clamp(FMath::FloorToInt((X - GridMin.X) / CellSize), 0, CellsX - 1);
+    const int32 CellY = FMath::Clamp(FMath::FloorToInt((Y - GridMin.Y) / CellSize), 0, CellsY - 1);
+    return CellY * CellsX + CellX;
+}
@@ -0,0 +1,130 @@
+// CrowdAvoidance.h：单位之间的分离转向（轻量局部避让）
+// 每步把所有存活实体的位置按格子做一次计数排序，邻居数据按 SoA 连续存放，
+// 每个单位最多只看 MaxNeighbors 个邻居，所以开销和单位数量线性相关
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CrowdAvoidance.generated.h"
+
+// 是否用 SSE/NEON 一次算 4 个邻居的排斥力（关掉就走标量循环，结果只有浮点舍入上的差别）
+#ifndef AUTOBATTLE_AVOIDANCE_SIMD
+#define AUTOBATTLE_AVOIDANCE_SIMD 1
+#endif
+
+/**
+ * 避让参数（GameMode 上配置，跟着战斗布局一起存盘）
+ */
+USTRUCT(BlueprintType)
+struct FCrowdAvoidanceSettings
+{
+    GENERATED_BODY()
+
+    // 总开关
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Avoidance")
+        bool bEnabled = true;
+
+    // 单位的碰撞半径（两个单位中心距离小于 2 倍半径算重叠）
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Avoidance")
+        float AgentRadius = 40.0f;
+
+    // 在这个距离内的邻居会产生排斥力，同时也是邻居格子的边长
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Avoidance")
+        float SeparationDistance = 100.0f;
+
+    // 排斥力相对于移动速度的权重
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Avoidance")
+        float SeparationWeight = 1.0f;
+
+    // 每个单位最多考虑多少个邻居（上限 FCrowdAvoidance::MaxNeighborsLimit）
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Avoidance")
+        int32 MaxNeighbors = 8;
+
+    friend FArchive& operator<<(FArchive& Ar, FCrowdAvoidanceSettings& Settings);
+};
+
+/**
+ * 邻居格子 + 分离力计算
+ * 用法：每步 Reset -> AddAgent(...) -> Finalize，之后对每个要移动的单位调用 ComputeVelocity
+ * 计算只读这一步开始时的位置快照，单位的更新顺序不影响结果
+ */
+class AUTOBATTLEDEMO_API FCrowdAvoidance
+{
+public:
+    static const int32 MaxNeighborsLimit = 16;
+
+    FCrowdAvoidance();
+
+    // 开始新的一步：Bounds 为网格覆盖的范围（XY），范围外的单位归到边缘格子
+    void Reset(const FCrowdAvoidanceSettings& InSettings, const FVector2D& BoundsMin, const FVector2D& BoundsMax);
+
+    // 登记一个实体的位置（EntityIndex 用于排除自己以及打破重合时的对称）
+    void AddAgent(int32 EntityIndex, const FVector& Location);
+
+    // 计数排序，把同一格子的邻居排到一起
+    void Finalize();
+
+    /**
+     * 在期望速度上叠加分离力
+     * @param EntityIndex 当前单位
+     * @param Location 当前单位位置
+     * @param DesiredVelocity 沿路径的期望速度（只调整 XY，Z 保持不变）
+     * @param MaxSpeed 速度上限
+     * @param OutOverlaps 与当前单位重叠的邻居数量（统计用）
+     * @return 调整后的速度
+     */
+    FVector ComputeVelocity(int32 EntityIndex, const FVector& Location, const FVector& DesiredVelocity, float MaxSpeed, int32& OutOverlaps) const;
+
+    // 遍历 XY 平面上 Radius 以内登记过的实体（Finalize 之后可用），Func(EntityIndex, DistSq)
+    // 同一个格子里按登记顺序，格子之间按行优先顺序
+    template <typename FuncType>
+    void ForEachAgentInRadius(const FVector& Center, float Radius, FuncType Func) const
+    {
+        const int32 MinX = FMath::Clamp(FMath::FloorToInt((Center.X - Radius - GridMin.X) / CellSize), 0, CellsX - 1);
+        const int32 MaxX = FMath::Clamp(FMath::FloorToInt((Center.X + Radius - GridMin.X) / CellSize), 0, CellsX - 1);
+        const int32 MinY = FMath::Clamp(FMath::FloorToInt((Center.Y - Radius - GridMin.Y) / CellSize), 0, CellsY - 1);
+        const int32 MaxY = FMath::Clamp(FMath::FloorToInt((Center.Y + Radius - GridMin.Y) / CellSize), 0, CellsY - 1);
+        const float RadiusSq = Radius * Radius;
+
+        for (int32 Y = MinY; Y <= MaxY; Y++)
+        {
+            for (int32 X = MinX; X <= MaxX; X++)
+            {
+                const int32 Cell = Y * CellsX + X;
+                for (int32 k = CellStart[Cell]; k < CellStart[Cell + 1]; k++)
+                {
+                    const float DistSq = FMath::Square(Center.X - SortedX[k]) + FMath::Square(Center.Y - SortedY[k]);
+                    if (DistSq <= RadiusSq)
+                    {
+                        Func(SortedEntity[k], DistSq);
+                    }
+                }
+            }
+        }
+    }
+
+    bool IsEnabled() const { return Settings.bEnabled; }
+    const FCrowdAvoidanceSettings& GetSettings() const { return Settings; }
+
+private:
+    int32 GetCellIndex(float X, float Y) const;
+
+    FCrowdAvoidanceSettings Settings;
+
+    // 格子参数
+    FVector2D GridMin;
+    float CellSize;
+    int32 CellsX;
+    int32 CellsY;
+
+    // 登记阶段的数据（按 AddAgent 顺序）
+    TArray<float> AgentX;
+    TArray<float> AgentY;
+    TArray<int32> AgentEntity;
+    TArray<int32> AgentCell;
+
+    // 排序后的 SoA 数据：CellStart[c] ~ CellStart[c + 1] 是格子 c 里的邻居
+    TArray<int32> CellStart;
+    TArray<float> SortedX;
+    TArray<float> SortedY;
+    TArray<int32> SortedEntity;
+};
@@ -0,0 +1,25 @@
+#include "DamageModifiers.h"
+
+FArchive& operator<<(FArchive& Ar, FDamageModifier& Modifier)
+{
+    Ar << Modifier.AttackerType << Modifier.VictimType << Modifier.Multiplier;
+    return Ar;
+}
+
+FDamageModifierTable::FDamageModifierTable()
+{
+    Build(TArray<FDamageModifier>());
+}
+
+void FDamageModifierTable::Build(const TArray<FDamageModifier>& Modifiers)
+{
+    for (float& Multiplier : Multipliers)
+    {
+        Multiplier = 1.0f;
+    }
+
+    for (const FDamageModifier& Modifier : Modifiers)
+    {
+        Multipliers[(int32)Modifier.AttackerType * NumUnitTypes + (int32)Modifier.VictimType] = FMath::Max(Modifier.Multiplier, 0.0f);
+    }
+}
@@ -0,0 +1,50 @@
+// DamageModifiers.h：兵种克制表（攻击方兵种 x 受击方兵种 -> 伤害倍率）
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RTSCoreTypes.h"
+#include "DamageModifiers.generated.h"
+
+/**
+ * 一条克制关系（GameMode 上配置，跟着战斗布局一起存盘）
+ * 没配的组合倍率为 1，非兵单位（建筑）不受克制影响
+ */
+USTRUCT(BlueprintType)
+struct FDamageModifier
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Damage")
+        EUnitType AttackerType = EUnitType::Soldier;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Damage")
+        EUnitType VictimType = EUnitType::Soldier;
+
+    // 伤害倍率（比如弓箭手打肉盾 0.5）
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Damage")
+        float Multiplier = 1.0f;
+
+    friend FArchive& operator<<(FArchive& Ar, FDamageModifier& Modifier);
+};
+
+/**
+ * 展开成定长查找表，结算时只需要一次数组下标
+ */
+class AUTOBATTLEDEMO_API FDamageModifierTable
+{
+public:
+    static const int32 NumUnitTypes = (int32)EUnitType::Tank + 1;
+
+    FDamageModifierTable();
+
+    // 先全部重置为 1，再按顺序写入（同一组合配了多条的话后面的生效）
+    void Build(const TArray<FDamageModifier>& Modifiers);
+
+    float Get(EUnitType AttackerType, EUnitType VictimType) const
+    {
+        return Multipliers[(int32)AttackerType * NumUnitTypes + (int32)VictimType];
+    }
+
+private:
+    float Multipliers[NumUnitTypes * NumUnitTypes];
+};
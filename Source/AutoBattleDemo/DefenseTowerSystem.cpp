@@ -0,0 +1,328 @@
+#include "DefenseTowerSystem.h"
+
+namespace
+{
+    // 粗格子的最小边长（射程很短的塔也不会把战场切得太碎）
+    const float MinTowerCellSize = 200.0f;
+}
+
+FDefenseTowerSystem::FDefenseTowerSystem()
+    : GridMin(FVector2D::ZeroVector)
+    , GridMax(FVector2D::ZeroVector)
+    , CellSize(MinTowerCellSize)
+    , CellsX(1)
+    , CellsY(1)
+{
+}
+
+void FDefenseTowerSystem::Reset(const FVector2D& BoundsMin, const FVector2D& BoundsMax)
+{
+    Towers.Reset();
+    TowerByEntity.Reset();
+    WatchStart.Reset();
+    WatchTowers.Reset();
+    Stats = FDefenseTowerStats();
+
+    GridMin = BoundsMin;
+    GridMax = BoundsMax;
+    CellSize = MinTowerCellSize;
+    CellsX = CellsY = 1;
+}
+
+void FDefenseTowerSystem::AddTower(int32 EntityIndex, ETeam Team, const FVector& Location, float Range, float AttackInterval, float LastFireTime)
+{
+    FTower& Tower = Towers.AddDefaulted_GetRef();
+    Tower.X = Location.X;
+    Tower.Y = Location.Y;
+    Tower.Range = Range;
+    Tower.RangeSq = Range * Range;
+    Tower.AttackInterval = AttackInterval;
+    Tower.LastFireTime = LastFireTime;
+    Tower.EntityIndex = EntityIndex;
+    Tower.TargetEntity = INDEX_NONE;
+    Tower.Team = Team;
+    Tower.bActive = true;
+    Tower.bSleeping = false;
+
+    if (TowerByEntity.Num() <= EntityIndex)
+    {
+        const int32 NumOld = TowerByEntity.Num();
+        TowerByEntity.SetNumUninitialized(EntityIndex + 1);
+        for (int32 i = NumOld; i < TowerByEntity.Num(); i++)
+        {
+            TowerByEntity[i] = INDEX_NONE;
+        }
+    }
+    TowerByEntity[EntityIndex] = Towers.Num() - 1;
+}
+
+void FDefenseTowerSystem::FinalizeTowers()
+{
+    if (Towers.Num() == 0) return;
+
+    // 1. 格子边长取最大射程，一座塔的射程最多覆盖 3x3 个格子
+    float MaxRange = 0.0f;
+    for (const FTower& Tower : Towers)
+    {
+        MaxRange = FMath::Max(MaxRange, Tower.Range);
+    }
+    CellSize = FMath::Max(MaxRange, MinTowerCellSize);
+
+    const FVector2D Extent = GridMax - GridMin;
+    CellsX = FMath::Max(FMath::CeilToInt(Extent.X / CellSize), 1);
+    CellsY = FMath::Max(FMath::CeilToInt(Extent.Y / CellSize), 1);
+    const int32 NumCells = CellsX * CellsY;
+
+    // 2. 唤醒表（计数排序：先数每个格子有几座塔在看，再填）
+    WatchStart.Reset();
+    WatchStart.AddZeroed(NumCells + 1);
+    for (int32 Pass = 0; Pass < 2; Pass++)
+    {
+        TArray<int32> Cursor;
+        if (Pass == 1)
+        {
+            for (int32 c = 0; c < NumCells; c++)
+            {
+                WatchStart[c + 1] += WatchStart[c];
+            }
+            Cursor = WatchStart;
+            WatchTowers.SetNumUninitialized(WatchStart[NumCells]);
+        }
+
+        for (int32 t = 0; t < Towers.Num(); t++)
+        {
+            const FTower& Tower = Towers[t];
+            const int32 MinX = GetCellX(Tower.X - Tower.Range);
+            const int32 MaxX = GetCellX(Tower.X + Tower.Range);
+            const int32 MinY = GetCellY(Tower.Y - Tower.Range);
+            const int32 MaxY = GetCellY(Tower.Y + Tower.Range);
+            for (int32 Y = MinY; Y <= MaxY; Y++)
+            {
+                for (int32 X = MinX; X <= MaxX; X++)
+                {
+                    const int32 Cell = Y * CellsX + X;
+                    if (Pass == 0)
+                    {
+                        WatchStart[Cell + 1]++;
+                    }
+                    else
+                    {
+                        WatchTowers[Cursor[Cell]++] = t;
+                    }
+                }
+            }
+        }
+    }
+
+    for (FTeamTargets& Team : Targets)
+    {
+        Team.CellStart.Reset();
+        Team.CellStart.AddZeroed(NumCells + 1);
+    }
+}
+
+int32 FDefenseTowerSystem::GetCellX(float X) const
+{
+    return FMath::Clamp(FMath::FloorToInt((X - GridMin.X) / CellSize), 0, CellsX - 1);
+}
+
+int32 FDefenseTowerSystem::GetCellY(float Y) const
+{
+    return FMath::Clamp(FMath::FloorToInt((Y - GridMin.Y) / CellSize), 0, CellsY - 1);
+}
+
+void FDefenseTowerSystem::BeginTargets()
+{
+    for (FTeamTargets& Team : Targets)
+    {
+        Team.AddedX.Reset();
+        Team.AddedY.Reset();
+        Team.AddedEntity.Reset();
+        Team.AddedCell.Reset();
+    }
+}
+
+void FDefenseTowerSystem::AddTarget(int32 EntityIndex, ETeam Team, const FVector& Location)
+{
+    FTeamTargets& TeamTargets = Targets[(int32)Team];
+    TeamTargets.AddedX.Add(Location.X);
+    TeamTargets.AddedY.Add(Location.Y);
+    TeamTargets.AddedEntity.Add(EntityIndex);
+    TeamTargets.AddedCell.Add(GetCellY(Location.Y) * CellsX + GetCellX(Location.X));
+}
+
+void FDefenseTowerSystem::SortTargets(FTeamTargets& Team)
+{
+    const int32 NumCells = CellsX * CellsY;
+    const int32 NumTargets = Team.AddedEntity.Num();
+
+    // 1. 数每个格子的攻击者，顺便记下有人的格子（唤醒只看这些格子）
+    FMemory::Memzero(Team.CellStart.GetData(), Team.CellStart.Num() * sizeof(int32));
+    for (int32 Cell : Team.AddedCell)
+    {
+        Team.CellStart[Cell + 1]++;
+    }
+
+    Team.OccupiedCells.Reset();
+    for (int32 c = 0; c < NumCells; c++)
+    {
+        if (Team.CellStart[c + 1] > 0)
+        {
+            Team.OccupiedCells.Add(c);
+        }
+        Team.CellStart[c + 1] += Team.CellStart[c];
+    }
+
+    // 2. 按格子排好（同一格子内保持登记顺序）
+    Team.SortedX.SetNumUninitialized(NumTargets);
+    Team.SortedY.SetNumUninitialized(NumTargets);
+    Team.SortedEntity.SetNumUninitialized(NumTargets);
+
+    TArray<int32, TInlineAllocator<256>> Cursor;
+    Cursor.Append(Team.CellStart.GetData(), NumCells);
+    for (int32 i = 0; i < NumTargets; i++)
+    {
+        const int32 Slot = Cursor[Team.AddedCell[i]]++;
+        Team.SortedX[Slot] = Team.AddedX[i];
+        Team.SortedY[Slot] = Team.AddedY[i];
+        Team.SortedEntity[Slot] = Team.AddedEntity[i];
+
+        const int32 Entity = Team.AddedEntity[i];
+        if (TargetSlot.Num() <= Entity)
+        {
+            const int32 NumOld = TargetSlot.Num();
+            TargetSlot.SetNumUninitialized(Entity + 1);
+            for (int32 k = NumOld; k < TargetSlot.Num(); k++)
+            {
+                TargetSlot[k] = INDEX_NONE;
+            }
+        }
+        TargetSlot[Entity] = Slot;
+    }
+}
+
+void FDefenseTowerSystem::Update(float Time, TArray<FTowerShot>& OutShots)
+{
+    if (Towers.Num() == 0) return;
+
+    // 1. 攻击者按格子排好（上一步的登记先作废）
+    for (int32& Slot : TargetSlot)
+    {
+        Slot = INDEX_NONE;
+    }
+    SortTargets(Targets[0]);
+    SortTargets(Targets[1]);
+
+    // 2. 有攻击者的格子唤醒看着它的敌方塔
+    for (int32 Team = 0; Team < 2; Team++)
+    {
+        for (int32 Cell : Targets[Team].OccupiedCells)
+        {
+            for (int32 k = WatchStart[Cell]; k < WatchStart[Cell + 1]; k++)
+            {
+                FTower& Tower = Towers[WatchTowers[k]];
+                if (Tower.bSleeping && (int32)Tower.Team != Team)
+                {
+                    Tower.bSleeping = false;
+                    Stats.Wakeups++;
+                }
+            }
+        }
+    }
+
+    // 3. 醒着且冷却好了的塔：目标还有效就沿用，否则重新查询，查不到就睡
+    for (FTower& Tower : Towers)
+    {
+        if (!Tower.bActive) continue;
+        if (Tower.bSleeping)
+        {
+            Stats.SleepingTowerSteps++;
+            continue;
+        }
+        if (Time - Tower.LastFireTime < Tower.AttackInterval) continue;
+
+        if (Tower.TargetEntity != INDEX_NONE && IsTargetInRange(Tower, Tower.TargetEntity))
+        {
+            Stats.TargetsKept++;
+        }
+        else
+        {
+            Tower.TargetEntity = FindClosestTarget(Tower);
+            Stats.TargetQueries++;
+        }
+
+        if (Tower.TargetEntity == INDEX_NONE)
+        {
+            Tower.bSleeping = true;
+            continue;
+        }
+
+        Tower.LastFireTime = Time;
+        OutShots.Add({ Tower.EntityIndex, Tower.TargetEntity });
+        Stats.Shots++;
+    }
+}
+
+bool FDefenseTowerSystem::IsTargetInRange(const FTower& Tower, int32 TargetEntity) const
+{
+    if (!TargetSlot.IsValidIndex(TargetEntity) || TargetSlot[TargetEntity] == INDEX_NONE) return false;
+
+    const FTeamTargets& Enemies = Targets[1 - (int32)Tower.Team];
+    const int32 Slot = TargetSlot[TargetEntity];
+    if (!Enemies.SortedEntity.IsValidIndex(Slot) || Enemies.SortedEntity[Slot] != TargetEntity) return false;
+
+    const float DistSq = FMath::Square(Tower.X - Enemies.SortedX[Slot]) + FMath::Square(Tower.Y - Enemies.SortedY[Slot]);
+    return DistSq <= Tower.RangeSq;
+}
+
+int32 FDefenseTowerSystem::FindClosestTarget(const FTower& Tower) const
+{
+    const FTeamTargets& Enemies = Targets[1 - (int32)Tower.Team];
+    const int32 MinX = GetCellX(Tower.X - Tower.Range);
+    const int32 MaxX = GetCellX(Tower.X + Tower.Range);
+    const int32 MinY = GetCellY(Tower.Y - Tower.Range);
+    const int32 MaxY = GetCellY(Tower.Y + Tower.Range);
+
+    int32 BestEntity = INDEX_NONE;
+    float BestDistSq = Tower.RangeSq;
+    for (int32 Y = MinY; Y <= MaxY; Y++)
+    {
+        for (int32 X = MinX; X <= MaxX; X++)
+        {
+            const int32 Cell = Y * CellsX + X;
+            for (int32 k = Enemies.CellStart[Cell]; k < Enemies.CellStart[Cell + 1]; k++)
+            {
+                const float DistSq = FMath::Square(Tower.X - Enemies.SortedX[k]) + FMath::Square(Tower.Y - Enemies.SortedY[k]);
+                const int32 Entity = Enemies.SortedEntity[k];
+                if (DistSq < BestDistSq || (DistSq == BestDistSq && (BestEntity == INDEX_NONE || Entity < BestEntity)))
+                {
+                    BestDistSq = DistSq;
+                    BestEntity = Entity;
+                }
+            }
+        }
+    }
+    return BestEntity;
+}
+
+void FDefenseTowerSystem::SetTowerActive(int32 EntityIndex, bool bActive)
+{
+    if (!TowerByEntity.IsValidIndex(EntityIndex) || TowerByEntity[EntityIndex] == INDEX_NONE) return;
+
+    FTower& Tower = Towers[TowerByEntity[EntityIndex]];
+    Tower.bActive = bActive;
+    Tower.bSleeping = false;
+    if (!bActive)
+    {
+        Tower.TargetEntity = INDEX_NONE;
+    }
+}
+
+void FDefenseTowerSystem::RestoreTower(int32 TowerIndex, int32 TargetEntity, float LastFireTime, bool bActive)
+{
+    FTower& Tower = Towers[TowerIndex];
+    Tower.TargetEntity = TargetEntity;
+    Tower.LastFireTime = LastFireTime;
+    Tower.bActive = bActive;
+    Tower.bSleeping = false;
+}
@@ -0,0 +1,136 @@
+// DefenseTowerSystem.h：防御塔的批量索敌和开火
+// 所有塔放在一个紧凑数组里，每步统一处理一遍；攻击者按阵营分开登记进粗格子，
+// 塔只在当前目标死掉或离开射程时才重新查询，附近格子里没有敌人的塔直接睡眠
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RTSCoreTypes.h"
+
+// 一次开火（伤害或弹道由调用方处理）
+struct FTowerShot
+{
+    int32 TowerEntity;
+    int32 TargetEntity;
+};
+
+// 运行时计数（压测时看查询省了多少）
+struct FDefenseTowerStats
+{
+    int64 TargetQueries = 0;       // 在格子里重新找目标的次数
+    int64 TargetsKept = 0;         // 沿用上一个目标、不用查询的次数
+    int64 Wakeups = 0;             // 有敌人进入附近格子而醒来的次数
+    int64 SleepingTowerSteps = 0;  // 每步睡着的塔数之和
+    int64 Shots = 0;
+};
+
+/**
+ * 防御塔系统
+ * 用法：Reset -> AddTower(...) -> FinalizeTowers；之后每步 BeginTargets -> AddTarget(...) -> Update
+ * 射程按水平距离算；同样远的目标取实体下标小的，结果和登记顺序无关
+ */
+class AUTOBATTLEDEMO_API FDefenseTowerSystem
+{
+public:
+    FDefenseTowerSystem();
+
+    // 清空所有塔，Bounds 为战场范围（XY），范围外的位置归到边缘格子
+    void Reset(const FVector2D& BoundsMin, const FVector2D& BoundsMax);
+
+    /**
+     * 登记一座塔（塔不会移动）
+     * @param EntityIndex 塔对应的实体下标
+     * @param Team 塔的阵营（只打另一个阵营）
+     * @param Location 塔的位置
+     * @param Range 射程
+     * @param AttackInterval 两次开火的间隔（秒）
+     * @param LastFireTime 上次开火的时间（开局传 -AttackInterval，第一下可以立即出手）
+     */
+    void AddTower(int32 EntityIndex, ETeam Team, const FVector& Location, float Range, float AttackInterval, float LastFireTime);
+
+    // 塔登记完后调用：粗格子边长取最大射程，建“格子 -> 射程覆盖它的塔”的唤醒表
+    void FinalizeTowers();
+
+    // 每步开始登记攻击者
+    void BeginTargets();
+    void AddTarget(int32 EntityIndex, ETeam Team, const FVector& Location);
+
+    // 唤醒、校验目标、必要时重新查询、开火；开火按塔的登记顺序追加到 OutShots
+    void Update(float Time, TArray<FTowerShot>& OutShots);
+
+    // 塔死亡或被停用（停用时目标清空），不是塔的实体直接忽略
+    void SetTowerActive(int32 EntityIndex, bool bActive);
+
+    // 关键帧恢复后覆盖塔的目标和冷却；睡眠只是优化，恢复后先全部醒着
+    void RestoreTower(int32 TowerIndex, int32 TargetEntity, float LastFireTime, bool bActive);
+
+    int32 Num() const { return Towers.Num(); }
+    int32 GetTowerEntity(int32 TowerIndex) const { return Towers[TowerIndex].EntityIndex; }
+    int32 GetTargetEntity(int32 TowerIndex) const { return Towers[TowerIndex].TargetEntity; }
+    float GetLastFireTime(int32 TowerIndex) const { return Towers[TowerIndex].LastFireTime; }
+    bool IsTowerActive(int32 TowerIndex) const { return Towers[TowerIndex].bActive; }
+    const FDefenseTowerStats& GetStats() const { return Stats; }
+
+private:
+    struct FTower
+    {
+        float X;
+        float Y;
+        float Range;
+        float RangeSq;
+        float AttackInterval;
+        float LastFireTime;
+        int32 EntityIndex;
+        int32 TargetEntity;
+        ETeam Team;
+        bool bActive;
+        bool bSleeping;
+    };
+
+    // 一个阵营的攻击者：计数排序后同一格子的排在一起
+    struct FTeamTargets
+    {
+        TArray<float> AddedX;
+        TArray<float> AddedY;
+        TArray<int32> AddedEntity;
+        TArray<int32> AddedCell;
+
+        TArray<int32> CellStart;   // CellStart[c] ~ CellStart[c + 1] 是格子 c 里的攻击者
+        TArray<float> SortedX;
+        TArray<float> SortedY;
+        TArray<int32> SortedEntity;
+        TArray<int32> OccupiedCells;
+    };
+
+    int32 GetCellX(float X) const;
+    int32 GetCellY(float Y) const;
+
+    // 计数排序 + 记下每个实体的排序下标
+    void SortTargets(FTeamTargets& Targets);
+
+    // 目标还活着（这一步登记过）且在射程内
+    bool IsTargetInRange(const FTower& Tower, int32 TargetEntity) const;
+
+    // 射程内最近的敌人，没有返回 INDEX_NONE
+    int32 FindClosestTarget(const FTower& Tower) const;
+
+    TArray<FTower> Towers;
+    TArray<int32> TowerByEntity;   // 实体下标 -> 塔下标（不是塔为 INDEX_NONE）
+
+    // 粗格子
+    FVector2D GridMin;
+    FVector2D GridMax;
+    float CellSize;
+    int32 CellsX;
+    int32 CellsY;
+
+    // 唤醒表：WatchStart[c] ~ WatchStart[c + 1] 是射程覆盖格子 c 的塔
+    TArray<int32> WatchStart;
+    TArray<int32> WatchTowers;
+
+    // 下标是 ETeam
+    FTeamTargets Targets[2];
+    // 实体下标 -> 这一步在所属阵营 Sorted* 数组里的位置（没登记为 INDEX_NONE）
+    TArray<int32> TargetSlot;
+
+    FDefenseTowerStats Stats;
+};
@@ -0,0 +1,357 @@
+#include "DeterminismCheckCommandlet.h"
+#include "BattleSimulation.h"
+#include "Async/ParallelFor.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+
+namespace
+{
+    // 每种模式出现分歧时最多打印多少行差异
+    const int32 MaxDiffLines = 40;
+
+    bool BitsEqual(float A, float B)
+    {
+        return FMemory::Memcmp(&A, &B, sizeof(float)) == 0;
+    }
+
+    bool BitsEqual(const FVector& A, const FVector& B)
+    {
+        return FMemory::Memcmp(&A, &B, sizeof(FVector)) == 0;
+    }
+
+    // 逐字段比较两个模拟的当前状态，打印不一样的地方（浮点按位比较，和哈希一致）
+    void LogStateDiff(const FBattleSimulation& Expected, const FBattleSimulation& Actual)
+    {
+        int32 NumLines = 0;
+        auto AddLine = [&NumLines](const FString& Line)
+        {
+            if (NumLines++ < MaxDiffLines)
+            {
+                UE_LOG(LogTemp, Error, TEXT("  %s"), *Line);
+            }
+        };
+
+        const TArray<FSimEntity>& ExpectedEntities = Expected.GetEntities();
+        const TArray<FSimEntity>& ActualEntities = Actual.GetEntities();
+        for (int32 i = 0; i < ExpectedEntities.Num() && i < ActualEntities.Num(); i++)
+        {
+            const FSimEntity& A = ExpectedEntities[i];
+            const FSimEntity& B = ActualEntities[i];
+            const FString Prefix = FString::Printf(TEXT("[%d] %s"), i, *A.Name);
+
+            if (A.bAlive != B.bAlive || A.bActive != B.bActive)
+            {
+                AddLine(FString::Printf(TEXT("%s alive/active: %d/%d vs %d/%d"), *Prefix, A.bAlive, A.bActive, B.bAlive, B.bActive));
+            }
+            if (!BitsEqual(A.Location, B.Location))
+            {
+                AddLine(FString::Printf(TEXT("%s location: %s vs %s"), *Prefix, *A.Location.ToString(), *B.Location.ToString()));
+            }
+            if (!BitsEqual(A.Rotation.Yaw, B.Rotation.Yaw))
+            {
+                AddLine(FString::Printf(TEXT("%s yaw: %.6f vs %.6f"), *Prefix, A.Rotation.Yaw, B.Rotation.Yaw));
+            }
+            if (!BitsEqual(A.CurrentHealth, B.CurrentHealth))
+            {
+                AddLine(FString::Printf(TEXT("%s health: %.6f vs %.6f"), *Prefix, A.CurrentHealth, B.CurrentHealth));
+            }
+            if (A.TargetIndex != B.TargetIndex || A.State != B.State)
+            {
+                AddLine(FString::Printf(TEXT("%s state/target: %d/%d vs %d/%d"), *Prefix, (int32)A.State, A.TargetIndex, (int32)B.State, B.TargetIndex));
+            }
+            if (A.CurrentPathIndex != B.CurrentPathIndex || A.PathPoints.Num() != B.PathPoints.Num())
+            {
+                AddLine(FString::Printf(TEXT("%s path: %d/%d vs %d/%d"), *Prefix, A.CurrentPathIndex, A.PathPoints.Num(), B.CurrentPathIndex, B.PathPoints.Num()));
+            }
+            if (!BitsEqual(A.LastAttackTime, B.LastAttackTime))
+            {
+                AddLine(FString::Printf(TEXT("%s last attack: %.6f vs %.6f"), *Prefix, A.LastAttackTime, B.LastAttackTime));
+            }
+            if (Expected.IsFootprintBlocked(i) != Actual.IsFootprintBlocked(i))
+            {
+                AddLine(FString::Printf(TEXT("%s footprint blocked: %d vs %d"), *Prefix, Expected.IsFootprintBlocked(i), Actual.IsFootprintBlocked(i)));
+            }
+        }
+
+        const FProjectileSystem& ExpectedProjectiles = Expected.GetProjectiles();
+        const FProjectileSystem& ActualProjectiles = Actual.GetProjectiles();
+        if (ExpectedProjectiles.Num() != ActualProjectiles.Num())
+        {
+            AddLine(FString::Printf(TEXT("Projectiles in flight: %d vs %d"), ExpectedProjectiles.Num(), ActualProjectiles.Num()));
+        }
+        else
+        {
+            for (int32 i = 0; i < ExpectedProjectiles.Num(); i++)
+            {
+                if (!BitsEqual(ExpectedProjectiles.GetLocation(i), ActualProjectiles.GetLocation(i)))
+                {
+                    AddLine(FString::Printf(TEXT("Projectile %d: %s vs %s"), i,
+                        *ExpectedProjectiles.GetLocation(i).ToString(), *ActualProjectiles.GetLocation(i).ToString()));
+                }
+            }
+        }
+
+        if (NumLines == 0)
+        {
+            AddLine(TEXT("(no field differs; the hash covers something this diff does not print)"));
+        }
+        else if (NumLines > MaxDiffLines)
+        {
+            UE_LOG(LogTemp, Error, TEXT("  ... %d more differences"), NumLines - MaxDiffLines);
+        }
+    }
+
+    /**
+     * 一种被检查的运行方式：和基准同步推进，每步结束后拿 GetSimulation() 的哈希和基准比较
+     * 以后加了多线程、缓存的实现，在这里加一种模式即可
+     */
+    class FCheckMode
+    {
+    public:
+        explicit FCheckMode(const TCHAR* InName) : Name(InName) {}
+        virtual ~FCheckMode() {}
+
+        virtual void Init(const FBattleSetup& Setup) = 0;
+        virtual void Step() = 0;
+        virtual const FBattleSimulation& GetSimulation() const = 0;
+
+        const TCHAR* GetName() const { return Name; }
+
+    private:
+        const TCHAR* Name;
+    };
+
+    // 多份同样的战斗在工作线程上同时推进，查出对全局/静态状态的依赖和数据竞争
+    class FParallelMode : public FCheckMode
+    {
+    public:
+        explicit FParallelMode(int32 InNumCopies) : FCheckMode(TEXT("Parallel")), NumCopies(FMath::Max(InNumCopies, 2)) {}
+
+        virtual void Init(const FBattleSetup& Setup) override
+        {
+            Copies.Reset();
+            for (int32 i = 0; i < NumCopies; i++)
+            {
+                Copies.Add(MakeUnique<FBattleSimulation>());
+                Copies.Last()->SetUsePathCache(false);
+            }
+            ParallelFor(Copies.Num(), [this, &Setup](int32 Index) { Copies[Index]->Init(Setup); });
+        }
+
+        virtual void Step() override
+        {
+            ParallelFor(Copies.Num(), [this](int32 Index) { Copies[Index]->Step(); });
+
+            // 副本之间先互相比，不一样的那份交给基准去比
+            Divergent = 0;
+            const uint32 FirstHash = Copies[0]->ComputeStateHash();
+            for (int32 i = 1; i < Copies.Num(); i++)
+            {
+                if (Copies[i]->ComputeStateHash() != FirstHash)
+                {
+                    Divergent = i;
+                    break;
+                }
+            }
+        }
+
+        virtual const FBattleSimulation& GetSimulation() const override { return *Copies[Divergent]; }
+
+    private:
+        int32 NumCopies;
+        int32 Divergent = 0;
+        TArray<TUniquePtr<FBattleSimulation>> Copies;
+    };
+
+    // 每一步都把状态存成关键帧再读进另一个模拟器接着跑，查出 SerializeState 漏掉的状态
+    class FRestoredMode : public FCheckMode
+    {
+    public:
+        FRestoredMode() : FCheckMode(TEXT("Restored")) {}
+
+        virtual void Init(const FBattleSetup& Setup) override
+        {
+            Simulations[0].SetUsePathCache(false);
+            Simulations[1].SetUsePathCache(false);
+            Simulations[0].Init(Setup);
+            Simulations[1].Init(Setup);
+            Current = 0;
+        }
+
+        virtual void Step() override
+        {
+            Simulations[Current].Step();
+
+            Keyframe.Reset();
+            FMemoryWriter Writer(Keyframe);
+            Simulations[Current].SerializeState(Writer);
+
+            Current = 1 - Current;
+            FMemoryReader Reader(Keyframe);
+            Simulations[Current].SerializeState(Reader);
+        }
+
+        virtual const FBattleSimulation& GetSimulation() const override { return Simulations[Current]; }
+
+    private:
+        FBattleSimulation Simulations[2];
+        int32 Current = 0;
+        TArray<uint8> Keyframe;
+    };
+
+    // 打开寻路缓存（基准是不缓存的），缓存失效漏掉了哪块网格改动就会在这里对不上
+    class FCachedMode : public FCheckMode
+    {
+    public:
+        FCachedMode() : FCheckMode(TEXT("Cached")) {}
+
+        virtual void Init(const FBattleSetup& Setup) override
+        {
+            Simulation.SetUsePathCache(true);
+            Simulation.Init(Setup);
+        }
+
+        virtual void Step() override { Simulation.Step(); }
+        virtual const FBattleSimulation& GetSimulation() const override { return Simulation; }
+
+    private:
+        FBattleSimulation Simulation;
+    };
+
+    // 先用同一个对象完整跑一场再重新 Init（ARTSGameMode 快速重开时就是这样复用模拟器的），查出上一场残留的状态
+    class FReusedMode : public FCheckMode
+    {
+    public:
+        FReusedMode() : FCheckMode(TEXT("Reused")) {}
+
+        virtual void Init(const FBattleSetup& Setup) override
+        {
+            Simulation.SetUsePathCache(false);
+            Simulation.Init(Setup);
+            Simulation.RunToCompletion();
+            Simulation.Init(Setup);
+        }
+
+        virtual void Step() override { Simulation.Step(); }
+        virtual const FBattleSimulation& GetSimulation() const override { return Simulation; }
+
+    private:
+        FBattleSimulation Simulation;
+    };
+}
+
+UDeterminismCheckCommandlet::UDeterminismCheckCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = false;
+    LogToConsole = true;
+}
+
+int32 UDeterminismCheckCommandlet::Main(const FString& Params)
+{
+    // 1. 读布局
+    FString SetupPath;
+    if (!FParse::Value(*Params, TEXT("setup="), SetupPath))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Usage: -run=DeterminismCheck -setup=<file.bsetup> [-modes=Parallel,Restored,Cached,Reused] [-copies=4] [-maxsteps=N]"));
+        return 1;
+    }
+
+    FBattleSetup Setup;
+    if (!Setup.LoadFromFile(SetupPath))
+    {
+        return 1;
+    }
+
+    // 2. 选模式（默认全部）
+    FString ModeList = TEXT("Parallel,Restored,Cached,Reused");
+    FParse::Value(*Params, TEXT("modes="), ModeList, false);
+
+    int32 NumCopies = 4;
+    FParse::Value(*Params, TEXT("copies="), NumCopies);
+
+    TArray<TUniquePtr<FCheckMode>> Modes;
+    TArray<FString> ModeNames;
+    ModeList.ParseIntoArray(ModeNames, TEXT(","));
+    for (const FString& ModeName : ModeNames)
+    {
+        if (ModeName.Equals(TEXT("Parallel"), ESearchCase::IgnoreCase))
+        {
+            Modes.Add(MakeUnique<FParallelMode>(NumCopies));
+        }
+        else if (ModeName.Equals(TEXT("Restored"), ESearchCase::IgnoreCase))
+        {
+            Modes.Add(MakeUnique<FRestoredMode>());
+        }
+        else if (ModeName.Equals(TEXT("Cached"), ESearchCase::IgnoreCase))
+        {
+            Modes.Add(MakeUnique<FCachedMode>());
+        }
+        else if (ModeName.Equals(TEXT("Reused"), ESearchCase::IgnoreCase))
+        {
+            Modes.Add(MakeUnique<FReusedMode>());
+        }
+        else
+        {
+            UE_LOG(LogTemp, Error, TEXT("Unknown mode: %s"), *ModeName);
+            return 1;
+        }
+    }
+
+    // 3. 串行、不缓存的基准和所有模式同步推进，每步比较哈希
+    FBattleSimulation Baseline;
+    Baseline.SetUsePathCache(false);
+    Baseline.Init(Setup);
+    for (TUniquePtr<FCheckMode>& Mode : Modes)
+    {
+        Mode->Init(Setup);
+    }
+
+    int32 MaxSteps = MAX_int32;
+    FParse::Value(*Params, TEXT("maxsteps="), MaxSteps);
+
+    // 返回 false 表示有模式和基准不一致（已打印差异）
+    auto CheckModes = [&Baseline, &Modes]()
+    {
+        const uint32 ExpectedHash = Baseline.ComputeStateHash();
+        for (const TUniquePtr<FCheckMode>& Mode : Modes)
+        {
+            const FBattleSimulation& Simulation = Mode->GetSimulation();
+            const uint32 ActualHash = Simulation.ComputeStateHash();
+            if (ActualHash != ExpectedHash)
+            {
+                UE_LOG(LogTemp, Error, TEXT("%s diverged from Serial at step %d (%.2fs): hash %08x vs %08x"),
+                    Mode->GetName(), Baseline.GetStepCount(), Baseline.GetTime(), ExpectedHash, ActualHash);
+                LogStateDiff(Baseline, Simulation);
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // Init 之后（第 0 步）就要一致
+    if (!CheckModes())
+    {
+        return 3;
+    }
+
+    while (!Baseline.IsFinished() && Baseline.GetStepCount() < MaxSteps)
+    {
+        Baseline.Step();
+        for (TUniquePtr<FCheckMode>& Mode : Modes)
+        {
+            Mode->Step();
+        }
+
+        if (!CheckModes())
+        {
+            return 3;
+        }
+    }
+
+    UE_LOG(LogTemp, Display, TEXT("%d mode(s) identical to Serial for %d steps (%s, final hash %08x)"),
+        Modes.Num(), Baseline.GetStepCount(), FBattleSimulation::OutcomeToString(Baseline.GetResult().Outcome),
+        Baseline.ComputeStateHash());
+    return 0;
+}
@@ -0,0 +1,21 @@
+// DeterminismCheckCommandlet.h：战斗模拟的确定性检查（适合放进自动化流程，出现分歧时返回非 0）
+// 用法：UE4Editor-Cmd AutoBattleDemo.uproject -run=DeterminismCheck -setup=<file.bsetup>
+//       [-modes=Parallel,Restored,Cached,Reused] [-copies=4] [-maxsteps=N] -nullrhi
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DeterminismCheckCommandlet.generated.h"
+
+UCLASS()
+class AUTOBATTLEDEMO_API UDeterminismCheckCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UDeterminismCheckCommandlet();
+
+    // 串行跑一份作为基准，其余模式和它同步推进，每步比较状态哈希；
+    // 第一次对不上时打印步数和逐字段的状态差异，返回 3
+    virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,54 @@
+#include "EntityRegistry.h"
+#include "Algo/BinarySearch.h"
+
+namespace
+{
+    // 代数在 12 位里循环，跳过 0（0 留给空句柄）
+    uint32 NextGeneration(uint32 Generation)
+    {
+        const uint32 Next = (Generation + 1) & FEntityHandle::GenerationMask;
+        return Next == 0 ? 1 : Next;
+    }
+}
+
+void FEntityRegistry::Reset()
+{
+    FreeSlots.Reset(Records.Num());
+    for (int32 i = Records.Num() - 1; i >= 0; i--)
+    {
+        Records[i] = FEntityRecord();
+        Generations[i] = NextGeneration(Generations[i]);
+        FreeSlots.Add(i);
+    }
+}
+
+FEntityHandle FEntityRegistry::Add(const FEntityRecord& Record)
+{
+    int32 Index;
+    if (FreeSlots.Num() > 0)
+    {
+        Index = FreeSlots.Pop(false);
+    }
+    else
+    {
+        check(Records.Num() <= (int32)FEntityHandle::IndexMask);
+        Index = Records.Add(FEntityRecord());
+        Generations.Add(1);
+    }
+
+    Records[Index] = Record;
+    return FEntityHandle(Index, Generations[Index]);
+}
+
+void FEntityRegistry::Release(FEntityHandle Handle)
+{
+    if (!IsValid(Handle)) return;
+
+    const int32 Index = Handle.GetIndex();
+    Records[Index] = FEntityRecord();
+    Generations[Index] = NextGeneration(Generations[Index]);
+
+    // 保持栈顶是最小的下标，下次分配尽量紧凑
+    const int32 InsertAt = Algo::LowerBound(FreeSlots, Index, TGreater<int32>());
+    FreeSlots.Insert(Index, InsertAt);
+}
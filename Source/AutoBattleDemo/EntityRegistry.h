@@ -0,0 +1,80 @@
+// EntityRegistry.h：战斗实体的代数句柄 + 紧凑记录表
+// 句柄是 32 位整数（下标 + 代数），查找就是一次带边界检查的数组下标和一次代数比较，
+// 不用追 UObject 指针、不用 Cast；实体销毁后代数 +1，旧句柄自动失效
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RTSCoreTypes.h"
+
+/**
+ * 低 20 位是槽位下标，高 12 位是代数（代数从 1 开始，0 表示空句柄）
+ */
+struct FEntityHandle
+{
+    static const uint32 IndexBits = 20;
+    static const uint32 IndexMask = (1u << IndexBits) - 1;
+    static const uint32 GenerationMask = (1u << (32 - IndexBits)) - 1;
+
+    uint32 Value = 0;
+
+    FEntityHandle() {}
+    FEntityHandle(int32 Index, uint32 Generation)
+        : Value(((Generation & GenerationMask) << IndexBits) | ((uint32)Index & IndexMask))
+    {
+    }
+
+    int32 GetIndex() const { return (int32)(Value & IndexMask); }
+    uint32 GetGeneration() const { return Value >> IndexBits; }
+    bool IsSet() const { return Value != 0; }
+
+    bool operator==(const FEntityHandle& Other) const { return Value == Other.Value; }
+    bool operator!=(const FEntityHandle& Other) const { return Value != Other.Value; }
+    friend uint32 GetTypeHash(const FEntityHandle& Handle) { return Handle.Value; }
+};
+
+// 一个实体在表现层的快照（GameMode 每帧从模拟结果刷新）
+struct FEntityRecord
+{
+    ETeam Team = ETeam::Enemy;
+    float Health = 0.0f;
+    float MaxHealth = 0.0f;
+    FVector Position = FVector::ZeroVector;
+    TWeakObjectPtr<class ABaseGameEntity> Actor;  // 只在需要 Actor 时才解引用（销毁流程、点击）
+    int32 SimEntityIndex = INDEX_NONE;        // 在 FBattleSimulation 里的下标
+};
+
+/**
+ * 句柄分配 + 记录表
+ * 只在游戏线程上 Add / Release；两次修改之间工作线程可以随意并发读（IsValid / Find 只读数组）
+ */
+class AUTOBATTLEDEMO_API FEntityRegistry
+{
+public:
+    // 作废所有已发出的句柄（代数 +1），槽位全部回收
+    void Reset();
+
+    // 分配一个槽位（优先复用下标小的空槽）
+    FEntityHandle Add(const FEntityRecord& Record);
+
+    // 回收槽位，之后这个句柄以及它的所有拷贝都会失效
+    void Release(FEntityHandle Handle);
+
+    bool IsValid(FEntityHandle Handle) const
+    {
+        const int32 Index = Handle.GetIndex();
+        return Handle.IsSet() && Generations.IsValidIndex(Index) && Generations[Index] == Handle.GetGeneration();
+    }
+
+    // 句柄失效时返回 nullptr
+    const FEntityRecord* Find(FEntityHandle Handle) const { return IsValid(Handle) ? &Records[Handle.GetIndex()] : nullptr; }
+    FEntityRecord* Find(FEntityHandle Handle) { return IsValid(Handle) ? &Records[Handle.GetIndex()] : nullptr; }
+
+    int32 Num() const { return Records.Num() - FreeSlots.Num(); }
+
+private:
+    TArray<FEntityRecord> Records;
+    // 每个槽位当前的代数（槽位空着时代数已经 +1，所以旧句柄查不到）
+    TArray<uint32> Generations;
+    // 空槽下标，栈顶是最小的下标
+    TArray<int32> FreeSlots;
+};
@@ -0,0 +1,114 @@
+// EntityRegistryTests.cpp：实体句柄失效规则的自动化测试（AutoBattle.EntityRegistry）
+#include "Misc/AutomationTest.h"
+#include "EntityRegistry.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+    FEntityRecord MakeRecord(ETeam Team, float Health)
+    {
+        FEntityRecord Record;
+        Record.Team = Team;
+        Record.Health = Health;
+        Record.MaxHealth = Health;
+        return Record;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEntityRegistryReleaseTest, "AutoBattle.EntityRegistry.Release",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEntityRegistryReleaseTest::RunTest(const FString& Parameters)
+{
+    FEntityRegistry Registry;
+    TestFalse(TEXT("Empty handle is invalid"), Registry.IsValid(FEntityHandle()));
+
+    const FEntityHandle A = Registry.Add(MakeRecord(ETeam::Player, 100.0f));
+    const FEntityHandle B = Registry.Add(MakeRecord(ETeam::Enemy, 200.0f));
+    const FEntityHandle C = Registry.Add(MakeRecord(ETeam::Enemy, 300.0f));
+    TestEqual(TEXT("Three live entities"), Registry.Num(), 3);
+    TestTrue(TEXT("New handles are valid"), Registry.IsValid(A) && Registry.IsValid(B) && Registry.IsValid(C));
+    TestTrue(TEXT("Find returns the record"), Registry.Find(B) && Registry.Find(B)->Health == 200.0f);
+
+    // 1. 释放后句柄和它的拷贝都失效，其他句柄不受影响
+    const FEntityHandle CopyOfB = B;
+    Registry.Release(B);
+    TestFalse(TEXT("Released handle is invalid"), Registry.IsValid(B));
+    TestFalse(TEXT("Copy of released handle is invalid"), Registry.IsValid(CopyOfB));
+    TestNull(TEXT("Find on released handle"), Registry.Find(B));
+    TestTrue(TEXT("Other handles stay valid"), Registry.IsValid(A) && Registry.IsValid(C));
+    TestEqual(TEXT("Two live entities"), Registry.Num(), 2);
+
+    // 重复释放什么都不做
+    Registry.Release(B);
+    TestEqual(TEXT("Double release keeps the count"), Registry.Num(), 2);
+
+    // 2. 槽位复用后代数不同，旧句柄查不到新记录
+    const FEntityHandle D = Registry.Add(MakeRecord(ETeam::Player, 400.0f));
+    TestEqual(TEXT("Freed slot is reused"), D.GetIndex(), B.GetIndex());
+    TestNotEqual(TEXT("Reused slot has a new generation"), D.GetGeneration(), B.GetGeneration());
+    TestFalse(TEXT("Old handle stays invalid after reuse"), Registry.IsValid(B));
+    TestNull(TEXT("Find on old handle after reuse"), Registry.Find(B));
+    TestTrue(TEXT("Find on new handle returns the new record"), Registry.Find(D) && Registry.Find(D)->Health == 400.0f);
+
+    // 3. 空槽优先复用下标小的
+    Registry.Release(C);
+    Registry.Release(A);
+    const FEntityHandle E = Registry.Add(MakeRecord(ETeam::Enemy, 500.0f));
+    TestEqual(TEXT("Lowest free slot is reused first"), E.GetIndex(), A.GetIndex());
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEntityRegistryResetTest, "AutoBattle.EntityRegistry.Reset",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEntityRegistryResetTest::RunTest(const FString& Parameters)
+{
+    FEntityRegistry Registry;
+    TArray<FEntityHandle> Handles;
+    for (int32 i = 0; i < 8; i++)
+    {
+        Handles.Add(Registry.Add(MakeRecord(i % 2 ? ETeam::Enemy : ETeam::Player, 10.0f * (i + 1))));
+    }
+    Registry.Release(Handles[3]);
+
+    // 1. Reset 作废所有句柄（包括之前已经释放的）
+    Registry.Reset();
+    TestEqual(TEXT("No live entities after reset"), Registry.Num(), 0);
+    for (int32 i = 0; i < Handles.Num(); i++)
+    {
+        TestFalse(FString::Printf(TEXT("Handle %d is invalid after reset"), i), Registry.IsValid(Handles[i]));
+        TestNull(FString::Printf(TEXT("Find on handle %d after reset"), i), Registry.Find(Handles[i]));
+    }
+
+    // 2. 重新分配从下标 0 开始，新句柄和旧句柄不相等
+    for (int32 i = 0; i < Handles.Num(); i++)
+    {
+        const FEntityHandle Handle = Registry.Add(MakeRecord(ETeam::Player, 1.0f));
+        TestEqual(FString::Printf(TEXT("Slot %d reused in order"), i), Handle.GetIndex(), i);
+        TestNotEqual(FString::Printf(TEXT("Slot %d gets a new handle"), i), Handle, Handles[i]);
+        TestFalse(FString::Printf(TEXT("Old handle %d stays invalid"), i), Registry.IsValid(Handles[i]));
+    }
+
+    // 3. 代数在 12 位里循环但跳过 0，反复释放同一个槽位，句柄也不会变成空句柄
+    FEntityRegistry Cycling;
+    const FEntityHandle First = Cycling.Add(MakeRecord(ETeam::Player, 1.0f));
+    FEntityHandle Last = First;
+    for (uint32 i = 0; i <= FEntityHandle::GenerationMask; i++)
+    {
+        Cycling.Release(Last);
+        Last = Cycling.Add(MakeRecord(ETeam::Player, 1.0f));
+        if (!Last.IsSet() || Last.GetGeneration() == 0)
+        {
+            AddError(FString::Printf(TEXT("Generation wrapped to 0 after %u releases"), i + 1));
+            return false;
+        }
+    }
+    TestTrue(TEXT("Latest handle after wrap-around is valid"), Cycling.IsValid(Last));
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,107 @@
+#include "FormationBenchCommandlet.h"
+#include "FormationFile.h"
+#include "GridMap.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Paths.h"
+
+UFormationBenchCommandlet::UFormationBenchCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = false;
+    LogToConsole = true;
+}
+
+int32 UFormationBenchCommandlet::Main(const FString& Params)
+{
+    // 1. 解析参数
+    int32 Size = 1024;
+    int32 NumUnits = 10000;
+    int32 Seed = 1;
+    FParse::Value(*Params, TEXT("size="), Size);
+    FParse::Value(*Params, TEXT("units="), NumUnits);
+    FParse::Value(*Params, TEXT("seed="), Seed);
+    const bool bCosts = FParse::Param(*Params, TEXT("costs"));
+    FString FilePath = FPaths::ProjectSavedDir() / TEXT("Formations") / TEXT("FormationBench.abfm");
+    FParse::Value(*Params, TEXT("file="), FilePath);
+
+    // 压测只需要几百 MB 以内的网格
+    Size = FMath::Clamp(Size, 1, 16384);
+    NumUnits = FMath::Clamp(NumUnits, 0, Size * Size / 2);
+
+    // 2. 随机布局：约 20% 的格子是障碍，单位放在互不重复的空格子上
+    FRandomStream Random(Seed);
+    FFormationLayout Layout;
+    Layout.Init(Size, Size, 100.0f);
+    for (int32 Y = 0; Y < Size; Y++)
+    {
+        for (int32 X = 0; X < Size; X++)
+        {
+            if (Random.FRand() < 0.2f) Layout.SetBlocked(X, Y, true);
+        }
+    }
+    if (bCosts)
+    {
+        Layout.Costs.SetNumUninitialized(Size * Size);
+        for (float& Cost : Layout.Costs)
+        {
+            Cost = Random.FRandRange(1.0f, 4.0f);
+        }
+    }
+
+    TBitArray<> Occupied(false, Size * Size);
+    while (Layout.Units.Num() < NumUnits)
+    {
+        const int32 X = Random.RandHelper(Size);
+        const int32 Y = Random.RandHelper(Size);
+        if (Layout.IsBlocked(X, Y) || Occupied[Y * Size + X]) continue;
+
+        Occupied[Y * Size + X] = true;
+        Layout.AddUnit((EUnitType)Random.RandHelper((int32)EUnitType::Tank + 1), Random.FRand() < 0.5f ? ETeam::Player : ETeam::Enemy, X, Y);
+    }
+
+    // 3. 存盘
+    double StartTime = FPlatformTime::Seconds();
+    if (!Layout.SaveToFile(FilePath))
+    {
+        return 1;
+    }
+    const double SaveSeconds = FPlatformTime::Seconds() - StartTime;
+    const int64 FileSize = IFileManager::Get().FileSize(*FilePath);
+
+    // 4. 两种方式读回
+    FFormationLayout MappedLayout;
+    StartTime = FPlatformTime::Seconds();
+    const bool bMappedLoaded = MappedLayout.LoadFromFile(FilePath, true);
+    const double MappedSeconds = FPlatformTime::Seconds() - StartTime;
+
+    FFormationLayout StreamedLayout;
+    StartTime = FPlatformTime::Seconds();
+    const bool bStreamedLoaded = StreamedLayout.LoadFromFile(FilePath, false);
+    const double StreamedSeconds = FPlatformTime::Seconds() - StartTime;
+
+    // 5. 套到网格上再抓回来（游戏里读档走的就是这一步）
+    FGridMap Grid;
+    StartTime = FPlatformTime::Seconds();
+    MappedLayout.ApplyToGrid(Grid, FVector::ZeroVector);
+    const double ApplySeconds = FPlatformTime::Seconds() - StartTime;
+
+    FFormationLayout GridLayout;
+    GridLayout.CaptureGrid(Grid);
+    GridLayout.Units = MappedLayout.Units;
+
+    // 6. 报告
+    const bool bMappedMatch = bMappedLoaded && MappedLayout == Layout;
+    const bool bStreamedMatch = bStreamedLoaded && StreamedLayout == Layout;
+    const bool bGridMatch = GridLayout == Layout;
+
+    UE_LOG(LogTemp, Display, TEXT("Formation bench: %dx%d grid, %d units, costs %s, file %.2f MB"),
+        Size, Size, Layout.Units.Num(), bCosts ? TEXT("on") : TEXT("off"), FileSize / (1024.0 * 1024.0));
+    UE_LOG(LogTemp, Display, TEXT("  Save:           %.2f ms"), SaveSeconds * 1000.0);
+    UE_LOG(LogTemp, Display, TEXT("  Load (mapped):  %.2f ms  %s"), MappedSeconds * 1000.0, bMappedMatch ? TEXT("identical") : TEXT("MISMATCH"));
+    UE_LOG(LogTemp, Display, TEXT("  Load (stream):  %.2f ms  %s"), StreamedSeconds * 1000.0, bStreamedMatch ? TEXT("identical") : TEXT("MISMATCH"));
+    UE_LOG(LogTemp, Display, TEXT("  Apply to grid:  %.2f ms  %s"), ApplySeconds * 1000.0, bGridMatch ? TEXT("identical") : TEXT("MISMATCH"));
+
+    return (bMappedMatch && bStreamedMatch && bGridMatch) ? 0 : 1;
+}
@@ -0,0 +1,20 @@
+// FormationBenchCommandlet.h：阵型文件读写压测 + 往返校验
+// 用法：UE4Editor-Cmd AutoBattleDemo.uproject -run=FormationBench [-size=1024] [-units=10000] [-costs] [-seed=1] [-file=<路径>] -nullrhi
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "FormationBenchCommandlet.generated.h"
+
+UCLASS()
+class AUTOBATTLEDEMO_API UFormationBenchCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UFormationBenchCommandlet();
+
+    // 随机生成一份布局，存盘后分别用内存映射和流式读回，统计耗时并逐字段比较；
+    // 再把它套到 FGridMap 上抓回来，确认网格往返也一致。有任何不一致返回 1
+    virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,259 @@
+#include "FormationFile.h"
+#include "GridMap.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Async/MappedFileHandle.h"
+#include "Serialization/BufferReader.h"
+
+namespace
+{
+    // 布局文件头
+    const uint32 FormationMagic = 0x4D464241; // "ABFM"
+    // 1：初版
+    const uint32 FormationVersion = 1;
+
+    // 文件里带地形成本层
+    const uint32 FormationFlagCosts = 1 << 0;
+
+    // 单位坐标是 16 位的
+    const int32 MaxFormationSize = MAX_uint16;
+
+    int32 GetNumBitWords(int64 NumCells)
+    {
+        return (int32)((NumCells + 31) / 32);
+    }
+}
+
+void FFormationLayout::Init(int32 InWidth, int32 InHeight, float InTileSize)
+{
+    Width = FMath::Clamp(InWidth, 0, MaxFormationSize);
+    Height = FMath::Clamp(InHeight, 0, MaxFormationSize);
+    TileSize = InTileSize;
+
+    BlockedBits.Reset();
+    BlockedBits.AddZeroed(GetNumBitWords((int64)Width * Height));
+    Costs.Reset();
+    Units.Reset();
+}
+
+bool FFormationLayout::IsBlocked(int32 X, int32 Y) const
+{
+    if (X < 0 || X >= Width || Y < 0 || Y >= Height) return false;
+
+    const int32 Index = Y * Width + X;
+    return (BlockedBits[Index >> 5] & (1u << (Index & 31))) != 0;
+}
+
+void FFormationLayout::SetBlocked(int32 X, int32 Y, bool bBlocked)
+{
+    if (X < 0 || X >= Width || Y < 0 || Y >= Height) return;
+
+    const int32 Index = Y * Width + X;
+    if (bBlocked)
+    {
+        BlockedBits[Index >> 5] |= 1u << (Index & 31);
+    }
+    else
+    {
+        BlockedBits[Index >> 5] &= ~(1u << (Index & 31));
+    }
+}
+
+bool FFormationLayout::AddUnit(EUnitType Type, ETeam Team, int32 X, int32 Y)
+{
+    if (X < 0 || X >= Width || Y < 0 || Y >= Height) return false;
+
+    FFormationUnit& Unit = Units.AddDefaulted_GetRef();
+    Unit.X = (uint16)X;
+    Unit.Y = (uint16)Y;
+    Unit.UnitType = (uint8)Type;
+    Unit.Team = (uint8)Team;
+    Unit.Reserved = 0;
+    return true;
+}
+
+bool FFormationLayout::CaptureGrid(const FGridMap& Grid)
+{
+    // Init 会把尺寸截到 16 位，截断之后下面按节点写位图就越界了
+    if (Grid.GetWidth() > MaxFormationSize || Grid.GetHeight() > MaxFormationSize)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Grid %dx%d is too large for a formation file"), Grid.GetWidth(), Grid.GetHeight());
+        return false;
+    }
+
+    Init(Grid.GetWidth(), Grid.GetHeight(), Grid.GetTileSize());
+
+    // 1. 阻挡位图，顺便看看成本是不是全是默认值
+    const TArray<FGridNode>& Nodes = Grid.GetNodes();
+    bool bUniformCost = true;
+    for (int32 i = 0; i < Nodes.Num(); i++)
+    {
+        if (Nodes[i].bIsBlocked)
+        {
+            BlockedBits[i >> 5] |= 1u << (i & 31);
+        }
+        bUniformCost &= Nodes[i].Cost == 1.0f;
+    }
+
+    // 2. 只有改过地形成本的网格才存成本层
+    if (!bUniformCost)
+    {
+        Costs.SetNumUninitialized(Nodes.Num());
+        for (int32 i = 0; i < Nodes.Num(); i++)
+        {
+            Costs[i] = Nodes[i].Cost;
+        }
+    }
+    return true;
+}
+
+void FFormationLayout::ApplyToGrid(FGridMap& Grid, const FVector& Origin) const
+{
+    Grid.Generate(Width, Height, TileSize, Origin);
+
+    const bool bHasCosts = Costs.Num() == Width * Height;
+    for (int32 Y = 0; Y < Height; Y++)
+    {
+        for (int32 X = 0; X < Width; X++)
+        {
+            const int32 Index = Y * Width + X;
+            FGridNode& Node = Grid.GetNode(X, Y);
+            Node.bIsBlocked = (BlockedBits[Index >> 5] & (1u << (Index & 31))) != 0;
+            Node.Cost = bHasCosts ? Costs[Index] : 1.0f;
+        }
+    }
+    Grid.NotifyNodesChanged();
+}
+
+bool FFormationLayout::Serialize(FArchive& Ar)
+{
+    // 1. 文件头
+    uint32 Magic = FormationMagic;
+    uint32 Version = FormationVersion;
+    Ar << Magic << Version;
+    if (Ar.IsLoading() && (Magic != FormationMagic || Version == 0 || Version > FormationVersion))
+    {
+        Ar.SetError();
+        return false;
+    }
+
+    // 头部先读进局部变量，校验通过才写回成员，坏文件不会留下半截布局
+    int32 FileWidth = Width;
+    int32 FileHeight = Height;
+    float FileTileSize = TileSize;
+    uint32 Flags = Costs.Num() > 0 ? FormationFlagCosts : 0;
+    int32 NumUnits = Units.Num();
+    Ar << FileWidth << FileHeight << FileTileSize << Flags << NumUnits;
+
+    // 2. 读的时候先核对剩余长度再分配，坏文件不会要求分配几个 G
+    if (Ar.IsLoading())
+    {
+        if (Ar.IsError() || FileWidth < 0 || FileHeight < 0 || FileWidth > MaxFormationSize || FileHeight > MaxFormationSize || NumUnits < 0)
+        {
+            Ar.SetError();
+            return false;
+        }
+
+        const int64 NumCells = (int64)FileWidth * FileHeight;
+        if (NumCells > MAX_int32)
+        {
+            Ar.SetError();
+            return false;
+        }
+
+        const int64 NumCostCells = (Flags & FormationFlagCosts) ? NumCells : 0;
+        const int64 PayloadSize = GetNumBitWords(NumCells) * (int64)sizeof(uint32)
+            + NumCostCells * (int64)sizeof(float)
+            + NumUnits * (int64)sizeof(FFormationUnit);
+        if (Ar.TotalSize() - Ar.Tell() < PayloadSize)
+        {
+            Ar.SetError();
+            return false;
+        }
+
+        // 3. 三个数组整块读进临时数组（小端，和目标平台一致，不逐个元素处理），全部读完才替换
+        TArray<uint32> FileBlockedBits;
+        TArray<float> FileCosts;
+        TArray<FFormationUnit> FileUnits;
+        FileBlockedBits.SetNumUninitialized(GetNumBitWords(NumCells));
+        FileCosts.SetNumUninitialized((int32)NumCostCells);
+        FileUnits.SetNumUninitialized(NumUnits);
+        Ar.Serialize(FileBlockedBits.GetData(), FileBlockedBits.Num() * sizeof(uint32));
+        Ar.Serialize(FileCosts.GetData(), FileCosts.Num() * sizeof(float));
+        Ar.Serialize(FileUnits.GetData(), FileUnits.Num() * sizeof(FFormationUnit));
+        if (Ar.IsError()) return false;
+
+        Width = FileWidth;
+        Height = FileHeight;
+        TileSize = FileTileSize;
+        BlockedBits = MoveTemp(FileBlockedBits);
+        Costs = MoveTemp(FileCosts);
+        Units = MoveTemp(FileUnits);
+        return true;
+    }
+
+    // 3. 三个数组整块写出
+    Ar.Serialize(BlockedBits.GetData(), BlockedBits.Num() * sizeof(uint32));
+    Ar.Serialize(Costs.GetData(), Costs.Num() * sizeof(float));
+    Ar.Serialize(Units.GetData(), Units.Num() * sizeof(FFormationUnit));
+
+    return !Ar.IsError();
+}
+
+bool FFormationLayout::SaveToFile(const FString& FilePath) const
+{
+    TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*FilePath));
+    if (!Writer)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Cannot write formation: %s"), *FilePath);
+        return false;
+    }
+
+    const bool bSaved = const_cast<FFormationLayout*>(this)->Serialize(*Writer);
+    return Writer->Close() && bSaved;
+}
+
+bool FFormationLayout::LoadFromFile(const FString& FilePath, bool bMapped)
+{
+    bool bLoaded = false;
+
+    // 1. 内存映射：直接从映射的页里拷贝到数组，没有中间缓冲
+    if (bMapped)
+    {
+        TUniquePtr<IMappedFileHandle> MappedFile(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*FilePath));
+        TUniquePtr<IMappedFileRegion> Region(MappedFile ? MappedFile->MapRegion(0, MappedFile->GetFileSize()) : nullptr);
+        if (Region)
+        {
+            FBufferReader Reader(const_cast<uint8*>(Region->GetMappedPtr()), Region->GetMappedSize(), false);
+            bLoaded = Serialize(Reader);
+        }
+        else
+        {
+            bMapped = false;
+        }
+    }
+
+    // 2. 不支持映射的平台：流式读取
+    if (!bMapped)
+    {
+        TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*FilePath));
+        if (!Reader)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Cannot read formation: %s"), *FilePath);
+            return false;
+        }
+        bLoaded = Serialize(*Reader);
+    }
+
+    if (!bLoaded)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Unsupported or corrupt formation file: %s"), *FilePath);
+    }
+    return bLoaded;
+}
+
+bool FFormationLayout::operator==(const FFormationLayout& Other) const
+{
+    return Width == Other.Width && Height == Other.Height && TileSize == Other.TileSize
+        && BlockedBits == Other.BlockedBits && Costs == Other.Costs && Units == Other.Units;
+}
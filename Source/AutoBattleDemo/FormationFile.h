@@ -0,0 +1,67 @@
+// FormationFile.h：阵型/关卡布局的紧凑二进制格式（网格 + 单位摆放）
+// 和 FBattleSetup 不同，这里只存“摆在哪”，不存属性，读进来以后走 ARTSGameMode 的批量放置流程
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RTSCoreTypes.h"
+
+struct FGridMap;
+
+// 一个单位的摆放（8 字节，文件里整块读写）
+struct FFormationUnit
+{
+    uint16 X;
+    uint16 Y;
+    uint8 UnitType;   // EUnitType
+    uint8 Team;       // ETeam
+    uint16 Reserved;  // 对齐用，写 0
+
+    bool operator==(const FFormationUnit& Other) const
+    {
+        return X == Other.X && Y == Other.Y && UnitType == Other.UnitType && Team == Other.Team;
+    }
+};
+
+/**
+ * 布局文件：网格尺寸 + 阻挡位图 + 地形成本（可选）+ 单位列表
+ * 数组都是整块写入的，读的时候优先内存映射，1024x1024 的网格加上万个单位也只是几 MB
+ */
+struct AUTOBATTLEDEMO_API FFormationLayout
+{
+    int32 Width = 0;
+    int32 Height = 0;
+    float TileSize = 100.0f;
+
+    // 每格 1 位，按行排列（下标 Y * Width + X）
+    TArray<uint32> BlockedBits;
+    // 每格一个成本；全部是 1.0 时为空，文件里也不写
+    TArray<float> Costs;
+
+    TArray<FFormationUnit> Units;
+
+    // 按尺寸清空（全部可通行、成本 1.0、没有单位）
+    void Init(int32 InWidth, int32 InHeight, float InTileSize);
+
+    bool IsBlocked(int32 X, int32 Y) const;
+    void SetBlocked(int32 X, int32 Y, bool bBlocked);
+
+    // 越界或尺寸超过 16 位坐标时返回 false
+    bool AddUnit(EUnitType Type, ETeam Team, int32 X, int32 Y);
+
+    // 从网格抓取尺寸、阻挡和成本（单位列表会清空）；网格边长超过 16 位坐标时返回 false，布局不变
+    bool CaptureGrid(const FGridMap& Grid);
+
+    // 按布局重建网格（原点由调用方给，布局本身和关卡位置无关）
+    void ApplyToGrid(FGridMap& Grid, const FVector& Origin) const;
+
+    bool SaveToFile(const FString& FilePath) const;
+
+    // bMapped：优先用内存映射读取，平台不支持时自动退回流式读取
+    bool LoadFromFile(const FString& FilePath, bool bMapped = true);
+
+    // 读写整份布局（含文件头），出错时 Ar.IsError() 为真，读取失败时布局保持原样
+    bool Serialize(FArchive& Ar);
+
+    bool operator==(const FFormationLayout& Other) const;
+    bool operator!=(const FFormationLayout& Other) const { return !(*this == Other); }
+};
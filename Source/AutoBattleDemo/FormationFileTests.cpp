@@ -0,0 +1,175 @@
+// FormationFileTests.cpp：布局文件读写的自动化测试（AutoBattle.FormationFile）
+#include "Misc/AutomationTest.h"
+#include "FormationFile.h"
+#include "GridMap.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+    // 带障碍、成本层和两边单位的布局（宽度不是 32 的倍数，位图最后一个字只用了一部分）
+    FFormationLayout MakeTestLayout()
+    {
+        FRandomStream Random(1234);
+        FGridMap Grid;
+        Grid.Generate(37, 21, 100.0f, FVector::ZeroVector);
+        for (int32 Y = 0; Y < Grid.GetHeight(); Y++)
+        {
+            for (int32 X = 0; X < Grid.GetWidth(); X++)
+            {
+                FGridNode& Node = Grid.GetNode(X, Y);
+                Node.bIsBlocked = Random.FRand() < 0.2f;
+                Node.Cost = Random.FRand() < 0.1f ? 2.5f : 1.0f;
+            }
+        }
+        Grid.NotifyNodesChanged();
+
+        FFormationLayout Layout;
+        Layout.CaptureGrid(Grid);
+        Layout.AddUnit(EUnitType::Soldier, ETeam::Player, 0, 0);
+        Layout.AddUnit(EUnitType::Archer, ETeam::Player, 3, 5);
+        Layout.AddUnit(EUnitType::Tank, ETeam::Enemy, 36, 20);
+        Layout.AddUnit(EUnitType::Soldier, ETeam::Enemy, 20, 10);
+        return Layout;
+    }
+
+    TArray<uint8> SaveToBytes(FFormationLayout& Layout)
+    {
+        TArray<uint8> Bytes;
+        FMemoryWriter Writer(Bytes);
+        Layout.Serialize(Writer);
+        return Bytes;
+    }
+
+    bool LoadFromBytes(FFormationLayout& Layout, const TArray<uint8>& Bytes)
+    {
+        FMemoryReader Reader(Bytes);
+        return Layout.Serialize(Reader);
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFormationFileRoundTripTest, "AutoBattle.FormationFile.RoundTrip",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FFormationFileRoundTripTest::RunTest(const FString& Parameters)
+{
+    FFormationLayout Layout = MakeTestLayout();
+    TestTrue(TEXT("Test layout has a cost layer"), Layout.Costs.Num() == Layout.Width * Layout.Height);
+
+    // 1. 内存里写一遍读一遍
+    FFormationLayout Loaded;
+    TestTrue(TEXT("Loads from memory"), LoadFromBytes(Loaded, SaveToBytes(Layout)));
+    TestTrue(TEXT("Memory round trip keeps the layout"), Loaded == Layout);
+
+    // 2. 落盘后分别用内存映射和流式读取
+    const FString FilePath = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("FormationRoundTrip.abf"));
+    if (!TestTrue(TEXT("Saves to file"), Layout.SaveToFile(FilePath)))
+    {
+        return false;
+    }
+
+    FFormationLayout Mapped;
+    TestTrue(TEXT("Loads mapped"), Mapped.LoadFromFile(FilePath, true));
+    TestTrue(TEXT("Mapped load keeps the layout"), Mapped == Layout);
+
+    FFormationLayout Streamed;
+    TestTrue(TEXT("Loads streamed"), Streamed.LoadFromFile(FilePath, false));
+    TestTrue(TEXT("Streamed load keeps the layout"), Streamed == Layout);
+
+    IFileManager::Get().Delete(*FilePath);
+
+    // 3. 成本全是 1.0 的布局不写成本层，读回来也没有
+    FFormationLayout Uniform;
+    Uniform.Init(5, 4, 50.0f);
+    Uniform.SetBlocked(2, 3, true);
+    Uniform.AddUnit(EUnitType::Archer, ETeam::Enemy, 4, 3);
+    FFormationLayout UniformLoaded;
+    TestTrue(TEXT("Loads uniform-cost layout"), LoadFromBytes(UniformLoaded, SaveToBytes(Uniform)));
+    TestTrue(TEXT("Uniform-cost round trip keeps the layout"), UniformLoaded == Uniform && UniformLoaded.Costs.Num() == 0);
+
+    // 4. 应用到网格再抓回来，阻挡和成本一致
+    FGridMap Grid;
+    Layout.ApplyToGrid(Grid, FVector(100.0f, 200.0f, 0.0f));
+    FFormationLayout Captured;
+    TestTrue(TEXT("Captures the applied grid"), Captured.CaptureGrid(Grid));
+    Captured.Units = Layout.Units;
+    TestTrue(TEXT("Apply + capture keeps the layout"), Captured == Layout);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFormationFileRejectCorruptTest, "AutoBattle.FormationFile.RejectCorrupt",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FFormationFileRejectCorruptTest::RunTest(const FString& Parameters)
+{
+    FFormationLayout Source = MakeTestLayout();
+    const TArray<uint8> Bytes = SaveToBytes(Source);
+
+    // 每种坏文件都读进一份已有内容的布局，失败后布局必须原样不动
+    FFormationLayout Existing;
+    Existing.Init(3, 3, 75.0f);
+    Existing.SetBlocked(1, 1, true);
+    Existing.AddUnit(EUnitType::Tank, ETeam::Player, 0, 2);
+
+    auto ExpectRejected = [this, &Existing](const TCHAR* What, const TArray<uint8>& Corrupt)
+    {
+        FFormationLayout Layout = Existing;
+        TestFalse(FString::Printf(TEXT("Rejects %s"), What), LoadFromBytes(Layout, Corrupt));
+        TestTrue(FString::Printf(TEXT("Layout unchanged after %s"), What), Layout == Existing);
+    };
+
+    // 文件头：魔数、版本号；尺寸字段在魔数、版本号之后
+    const int32 WidthOffset = 2 * sizeof(uint32);
+    const int32 NumUnitsOffset = WidthOffset + 4 * sizeof(int32);
+
+    TArray<uint8> BadMagic = Bytes;
+    BadMagic[0] ^= 0xFF;
+    ExpectRejected(TEXT("bad magic"), BadMagic);
+
+    TArray<uint8> FutureVersion = Bytes;
+    FutureVersion[sizeof(uint32)] = 0xFF;
+    ExpectRejected(TEXT("unknown version"), FutureVersion);
+
+    TArray<uint8> HeaderOnly = Bytes;
+    HeaderOnly.SetNum(WidthOffset + 2);
+    ExpectRejected(TEXT("truncated header"), HeaderOnly);
+
+    TArray<uint8> Truncated = Bytes;
+    Truncated.SetNum(Bytes.Num() - 1);
+    ExpectRejected(TEXT("truncated payload"), Truncated);
+
+    TArray<uint8> NegativeWidth = Bytes;
+    const int32 BadWidth = -1;
+    FMemory::Memcpy(&NegativeWidth[WidthOffset], &BadWidth, sizeof(int32));
+    ExpectRejected(TEXT("negative width"), NegativeWidth);
+
+    TArray<uint8> OversizedWidth = Bytes;
+    const int32 HugeWidth = MAX_uint16 + 1;
+    FMemory::Memcpy(&OversizedWidth[WidthOffset], &HugeWidth, sizeof(int32));
+    ExpectRejected(TEXT("oversized width"), OversizedWidth);
+
+    // 单位数写得很大：长度不够，读之前就拒绝，不会去分配
+    TArray<uint8> HugeUnitCount = Bytes;
+    const int32 ManyUnits = MAX_int32 / (int32)sizeof(FFormationUnit);
+    FMemory::Memcpy(&HugeUnitCount[NumUnitsOffset], &ManyUnits, sizeof(int32));
+    ExpectRejected(TEXT("huge unit count"), HugeUnitCount);
+
+    ExpectRejected(TEXT("empty file"), TArray<uint8>());
+
+    // 边长超过 16 位坐标的网格存不进布局文件，布局保持原样
+    FGridMap WideGrid;
+    WideGrid.Generate(MAX_uint16 + 1, 1, 100.0f, FVector::ZeroVector);
+    FFormationLayout Layout = Existing;
+    AddExpectedError(TEXT("is too large for a formation file"), EAutomationExpectedErrorFlags::Contains, 1);
+    TestFalse(TEXT("Rejects a grid wider than 65535 tiles"), Layout.CaptureGrid(WideGrid));
+    TestTrue(TEXT("Layout unchanged after rejecting the grid"), Layout == Existing);
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -1,5 +1,7 @@
 // GridManager.cppʵָĽ
 #include "GridManager.h"
+#include "FormationFile.h"
+#include "AutoBattleStats.h"
 #include "Engine/World.h"
 #include "DrawDebugHelpers.h"
 #include "Containers/Queue.h"
@@ -41,55 +43,24 @@ void AGridManager::BeginPlay()
  */
 void AGridManager::GenerateGrid(int32 Width, int32 Height, float CellSize)
 {
-    GridWidthCount = Width;
-    GridHeightCount = Height;
-    TileSize = CellSize;
-    GridNodes.Empty();
-    GridNodes.Reserve(Width * Height);  // Ԥڴ棬ٶ̬ݿ
-
-    // ˫ѭʼи
-    for (int32 Y = 0; Y < Height; Y++)
-    {
-        for (int32 X = 0; X < Width; X++)
-        {
-            FGridNode NewNode;
-            NewNode.X = X;
-            NewNode.Y = Y;
-            NewNode.bIsBlocked = false;       // Ĭиӿͨ
-            NewNode.Cost = 1.0f;              // ĬϵγɱΪ1.0
-            // ĵ꣨ڹλã
-            NewNode.WorldLocation = GetActorLocation() + FVector(
-                X * TileSize + TileSize / 2,  // XƫƣһߴУ
-                Y * TileSize + TileSize / 2,  // YƫƣһߴУ
-                0.0f                         // ZĬΪ0Ը߶ȣ
-            );
-            GridNodes.Add(NewNode);
-
-            //// ԻƸӱ߿򣨽ڷǱ༭ҿʱ
-            //if (bDrawDebug && GetWorld()->GetName() != TEXT("EditorWorld"))
-            //{
-            //    DrawDebugBox(
-            //        GetWorld(),
-            //        NewNode.WorldLocation,
-            //        FVector(TileSize / 2 * 0.9f, TileSize / 2 * 0.9f, 1.0f),  // ΢Сһ߿ص
-            //        FColor::White,
-            //        true,                           // ʾ
-            //        -1.0f,                          // ô
-            //        0,
-            //        4.0f                            // ߿
-            //    );
-            //}
-        }
-    }
-
+    // ڵڹλ
+    Grid.Generate(Width, Height, CellSize, GetActorLocation());
+    SET_MEMORY_STAT(STAT_AutoBattle_GridMemory, Grid.GetAllocatedSize());
+}
 
+void AGridManager::LoadGridLayout(const FFormationLayout& Layout)
+{
+    Layout.ApplyToGrid(Grid, GetActorLocation());
+    SET_MEMORY_STAT(STAT_AutoBattle_GridMemory, Grid.GetAllocatedSize());
 }
 
 void AGridManager::DrawGridVisuals(int32 HoverX, int32 HoverY)
 {
+    SCOPE_CYCLE_COUNTER(STAT_AutoBattle_DrawGridVisuals);
     float LifeTime = GetWorld()->GetDeltaSeconds() * 2.0f;
 
-    for (const FGridNode& Node : GridNodes)
+    const float TileSize = Grid.GetTileSize();
+    for (const FGridNode& Node : Grid.GetNodes())
     {
         // Ĭ״̬ (ģ͸)
         // ʹûɫɫ
@@ -135,119 +106,8 @@ void AGridManager::DrawGridVisuals(int32 HoverX, int32 HoverY)
  */
 TArray<FVector> AGridManager::FindPath(const FVector& StartWorldLoc, const FVector& EndWorldLoc)
 {
-    TArray<FVector> Path;  // ·꣩
-    int32 StartX, StartY, EndX, EndY;
-
-    // 1. յתΪ겢У
-    if (!WorldToGrid(StartWorldLoc, StartX, StartY) || !WorldToGrid(EndWorldLoc, EndX, EndY))
-    {
-        UE_LOG(LogTemp, Warning, TEXT("Start or end position is out of grid bounds"));
-        return Path;  // 곬Χؿ·
-    }
-    if (!IsTileValid(StartX, StartY) || !IsTileValid(EndX, EndY))
-    {
-        UE_LOG(LogTemp, Warning, TEXT("Start or end tile is blocked"));
-        return Path;  // յ㱻赲ؿ·
-    }
-
-    // 2. A*㷨ʵ
-    // żĽڵ㣨Map洢ڲң
-    TMap<FIntPoint, TSharedPtr<FAStarNode>> OpenSet;
-    // رռѼĽڵ
-    TMap<FIntPoint, TSharedPtr<FAStarNode>> ClosedSet;
-    // ʼڵ
-    auto StartNode = MakeShareable(new FAStarNode(StartX, StartY));
-    OpenSet.Add(FIntPoint(StartX, StartY), StartNode);
-
-    // ѭżеĽڵ
-    while (OpenSet.Num() > 0)
-    {
-        // ҵżFֵСĽڵ㣨ܳɱͣ
-        TSharedPtr<FAStarNode> CurrentNode = nullptr;
-        FIntPoint CurrentKey;
-        for (const auto& Pair : OpenSet)
-        {
-            if (!CurrentNode || Pair.Value->F() < CurrentNode->F())
-            {
-                CurrentNode = Pair.Value;
-                CurrentKey = Pair.Key;
-            }
-        }
-
-        // յ㣬·
-        if (CurrentKey.X == EndX && CurrentKey.Y == EndY)
-        {
-            TArray<FIntPoint> RawPath;  // ԭʼ·꣩
-            // յݵ
-            while (CurrentNode.IsValid())
-            {
-                RawPath.Add(FIntPoint(CurrentNode->X, CurrentNode->Y));
-                CurrentNode = CurrentNode->Parent.Pin();  // ظڵ
-            }
-            // 滻 Algo::Reverse(RawPath); Ϊֶת
-            int32 PathLength = RawPath.Num();
-            for (int32 i = 0; i < PathLength / 2; ++i)
-            {
-                // i͵(PathLength-1-i)Ԫ
-                FIntPoint Temp = RawPath[i];
-                RawPath[i] = RawPath[PathLength - 1 - i];
-                RawPath[PathLength - 1 - i] = Temp;
-            }
-            OptimizePath(RawPath);  // Ż·Ƴ㣩
-
-            // תΪ
-            for (const auto& GridPos : RawPath)
-            {
-                Path.Add(GridToWorld(GridPos.X, GridPos.Y));
-            }
-            return Path;
-        }
-
-        // ǰڵӿżƵرռ
-        OpenSet.Remove(CurrentKey);
-        ClosedSet.Add(CurrentKey, CurrentNode);
-
-        // ǰڵھ
-        for (const auto& Neighbor : GetNeighborNodes(CurrentNode->X, CurrentNode->Y))
-        {
-            FIntPoint NeighborKey = Neighbor;
-            // ڹرռ򲻿ͨеĽڵ
-            if (ClosedSet.Contains(NeighborKey) || !IsTileValid(Neighbor.X, Neighbor.Y))
-            {
-                continue;
-            }
-
-            // 㵽ǰھӵʵʳɱ
-            float NewG = CurrentNode->G + GetHeuristicCost(
-                CurrentNode->X, CurrentNode->Y,
-                Neighbor.X, Neighbor.Y
-            ) * GridNodes[Neighbor.Y * GridWidthCount + Neighbor.X].Cost;
-
-            TSharedPtr<FAStarNode> NeighborNode;
-            // ھڿż
-            if (OpenSet.Contains(NeighborKey))
-            {
-                NeighborNode = OpenSet[NeighborKey];
-                // ·ɱߣ
-                if (NewG >= NeighborNode->G) continue;
-            }
-            // ھӲڿż½ڵ
-            else
-            {
-                NeighborNode = MakeShareable(new FAStarNode(Neighbor.X, Neighbor.Y));
-                OpenSet.Add(NeighborKey, NeighborNode);
-            }
-
-            // ھӽڵϢ
-            NeighborNode->G = NewG;  // ʵʳɱ
-            NeighborNode->H = GetHeuristicCost(Neighbor.X, Neighbor.Y, EndX, EndY);  // Ԥɱ
-            NeighborNode->Parent = CurrentNode;  // øڵ
-        }
-    }
-
-    // żΪδҵյ㣬Ѱ·ʧ
-    UE_LOG(LogTemp, Warning, TEXT("No path found between start and end"));
-    return Path;
+    // A* ʵ FGridMap սģϷڹ
+    return Grid.FindPath(StartWorldLoc, EndWorldLoc);
 }
 
 /**
@@ -258,19 +118,16 @@ TArray<FVector> AGridManager::FindPath(const FVector& StartWorldLoc, const FVect
  */
 void AGridManager::SetTileBlocked(int32 GridX, int32 GridY, bool bBlocked)
 {
-    // ǷЧ
-    if (!IsTileValid(GridX, GridY)) return;
-
-    // 赲״̬
-    int32 Index = GridY * GridWidthCount + GridX;
-    GridNodes[Index].bIsBlocked = bBlocked;
+    // ǷЧ赲״̬
+    if (!Grid.SetTileBlocked(GridX, GridY, bBlocked)) return;
 
-    // ʾ赲ĸʾɫ߿
+    // ʾ赲ĸʾɫ߿
     if (bDrawDebug)
     {
+        const float TileSize = Grid.GetTileSize();
         DrawDebugBox(
             GetWorld(),
-            GridNodes[Index].WorldLocation,
+            Grid.GetNode(GridX, GridY).WorldLocation,
             FVector(TileSize / 2 * 0.9f, TileSize / 2 * 0.9f, 2.0f),
             bBlocked ? FColor::Red : FColor::White,  // 赲Ϊɫɫ
             true,
@@ -281,6 +138,54 @@ void AGridManager::SetTileBlocked(int32 GridX, int32 GridY, bool bBlocked)
     }
 }
 
+bool AGridManager::SetTilesBlocked(const TArray<FIntPoint>& Tiles, bool bBlocked)
+{
+    if (!Grid.SetTilesBlocked(Tiles, bBlocked)) return false;
+
+    // ʾֻһΣ־ãʱٸ־߿֡ʣ
+    if (bDrawDebug)
+    {
+        const float TileSize = Grid.GetTileSize();
+        for (const FIntPoint& Tile : Tiles)
+        {
+            DrawDebugBox(
+                GetWorld(),
+                Grid.GetNode(Tile.X, Tile.Y).WorldLocation,
+                FVector(TileSize / 2 * 0.9f, TileSize / 2 * 0.9f, 2.0f),
+                bBlocked ? FColor::Red : FColor::White,
+                false,
+                30.0f,
+                0,
+                3.0f
+            );
+        }
+    }
+    return true;
+}
+
+bool AGridManager::SetFootprintBlocked(int32 GridX, int32 GridY, int32 SizeX, int32 SizeY, bool bBlocked)
+{
+    if (!Grid.SetFootprintBlocked(GridX, GridY, SizeX, SizeY, bBlocked)) return false;
+
+    // ʾռػһ
+    if (bDrawDebug)
+    {
+        const float TileSize = Grid.GetTileSize();
+        const FVector Center = (Grid.GetNode(GridX, GridY).WorldLocation + Grid.GetNode(GridX + SizeX - 1, GridY + SizeY - 1).WorldLocation) * 0.5f;
+        DrawDebugBox(
+            GetWorld(),
+            Center,
+            FVector(SizeX * TileSize / 2 * 0.95f, SizeY * TileSize / 2 * 0.95f, 2.0f),
+            bBlocked ? FColor::Red : FColor::White,
+            false,
+            30.0f,
+            0,
+            3.0f
+        );
+    }
+    return true;
+}
+
 /**
  * תΪ
  * @param GridX X
@@ -289,11 +194,7 @@ void AGridManager::SetTileBlocked(int32 GridX, int32 GridY, bool bBlocked)
  */
 FVector AGridManager::GridToWorld(int32 GridX, int32 GridY) const
 {
-    // ǷЧ
-    if (!IsTileValid(GridX, GridY)) return FVector::ZeroVector;
-
-    // Ԥ
-    return GridNodes[GridY * GridWidthCount + GridX].WorldLocation;
+    return Grid.GridToWorld(GridX, GridY);
 }
 
 /**
@@ -305,15 +206,7 @@ FVector AGridManager::GridToWorld(int32 GridX, int32 GridY) const
  */
 bool AGridManager::WorldToGrid(const FVector& WorldLoc, int32& OutGridX, int32& OutGridY) const
 {
-    // תΪı
-    FVector LocalLoc = WorldLoc - GetActorLocation();
-
-    // ꣨ȡ
-    OutGridX = FMath::FloorToInt(LocalLoc.X / TileSize);
-    OutGridY = FMath::FloorToInt(LocalLoc.Y / TileSize);
-
-    // ǷΧ
-    return IsTileValid(OutGridX, OutGridY);
+    return Grid.WorldToGrid(WorldLoc, OutGridX, OutGridY);
 }
 
 /**
@@ -324,98 +217,11 @@ bool AGridManager::WorldToGrid(const FVector& WorldLoc, int32& OutGridX, int32&
  */
 bool AGridManager::IsTileValid(int32 GridX, int32 GridY) const
 {
-    // ǷΧ
-    if (GridX < 0 || GridX >= GridWidthCount || GridY < 0 || GridY >= GridHeightCount)
-        return false;
-
-    // Ƿδ赲
-    return !GridNodes[GridY * GridWidthCount + GridX].bIsBlocked;
+    return Grid.IsTileValid(GridX, GridY);
 }
 
 bool AGridManager::IsTileWalkable(int32 X, int32 Y)
 {
-    // 1. Ƿ񳬳ΧԽ򲻿ߣ
-    if (X < 0 || X >= GridWidthCount || Y < 0 || Y >= GridHeightCount)
-    {
-        return false;
-    }
-
-    // 2. һάάתΪƽ
-    int32 Index = Y * GridWidthCount + X;
-
-    // 3. ЧԲǷߣ!bIsBlocked ʾߣ
-    if (GridNodes.IsValidIndex(Index))
-    {
-        return !GridNodes[Index].bIsBlocked;
-    }
-
-    // ЧʱĬϲ
-    return false;
-}
-/**
- * ʽɱپ룩
- * پ룺|x1-x2| + |y1-y2|ķƶ
- * @param X1 X
- * @param Y1 Y
- * @param X2 յX
- * @param Y2 յY
- * @return ʽɱֵ
- */
-float AGridManager::GetHeuristicCost(int32 X1, int32 Y1, int32 X2, int32 Y2) const
-{
-    return FMath::Abs(X1 - X2) + FMath::Abs(Y1 - Y2);
-}
-
-/**
- * ȡָӵЧھӽڵ㣨ķң
- * @param X X
- * @param Y Y
- * @return ھӽڵб
- */
-TArray<FIntPoint> AGridManager::GetNeighborNodes(int32 X, int32 Y) const
-{
-    TArray<FIntPoint> Neighbors;
-    // ķƫҡϡ£
-    const int32 Directions[4][2] = { {1,0}, {-1,0}, {0,1}, {0,-1} };
-
-    // ÿھǷЧ
-    for (const auto& Dir : Directions)
-    {
-        int32 NewX = X + Dir[0];
-        int32 NewY = Y + Dir[1];
-        if (IsTileValid(NewX, NewY))
-        {
-            Neighbors.Add(FIntPoint(NewX, NewY));
-        }
-    }
-    return Neighbors;
-}
-
-/**
- * Ż·Ƴڵ㣬ʹ·ƽ
- * ԭͬһֱʱмʡ
- * @param RawPath ԭʼ·
- */
-void AGridManager::OptimizePath(TArray<FIntPoint>& RawPath)
-{
-    // ·̫Ż
-    if (RawPath.Num() <= 2) return;
-
-    TArray<FIntPoint> Optimized;
-    Optimized.Add(RawPath[0]);  // 
-    FIntPoint PrevDir = RawPath[1] - RawPath[0];  // ʼ
-
-    // ԭʼ·ıĵ
-    for (int32 i = 2; i < RawPath.Num(); i++)
-    {
-        FIntPoint CurrentDir = RawPath[i] - RawPath[i - 1];
-        // ıʱǰһ
-        if (CurrentDir != PrevDir)
-        {
-            Optimized.Add(RawPath[i - 1]);
-            PrevDir = CurrentDir;
-        }
-    }
-    Optimized.Add(RawPath.Last());  // յ
-    RawPath = Optimized;  // ΪŻ·
+    // Խ赲Ϊ
+    return Grid.IsTileValid(X, Y);
 }
\ No newline at end of file
@@ -3,33 +3,9 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "GridMap.h"
 #include "GridManager.generated.h"
 
-/**
- * ڵṹ壬洢ӵ
- */
-USTRUCT(BlueprintType)
-struct FGridNode
-{
-    GENERATED_BODY()
-
-        // еX
-        UPROPERTY()
-        int32 X;
-    // еY
-    UPROPERTY()
-        int32 Y;
-    // Ƿ赲罨ϰ
-    UPROPERTY()
-        bool bIsBlocked;
-    // ĵ
-    UPROPERTY()
-        FVector WorldLocation;
-    // γɱӰƶģƽ1.0ȿֵ
-    UPROPERTY()
-        float Cost;
-};
-
 /**
  * ࣬ɡת·
  */
@@ -73,6 +49,27 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Grid")
         void SetTileBlocked(int32 GridX, int32 GridY, bool bBlocked);
 
+    /**
+     * 赲״̬һύ汾ֻһΣ
+     * @param Tiles б
+     * @param bBlocked Ƿ赲
+     * @return Ƿ޸ĳɹиԽʱһģ
+     */
+    UFUNCTION(BlueprintCallable, Category = "Grid")
+        bool SetTilesBlocked(const TArray<FIntPoint>& Tiles, bool bBlocked);
+
+    /**
+     * һռص赲״̬ǽһύֻһ
+     * @param GridX ռ½ǵĸX
+     * @param GridY ռ½ǵĸY
+     * @param SizeX Xռ
+     * @param SizeY Yռ
+     * @param bBlocked Ƿ赲
+     * @return Ƿ޸ĳɹռسʱһģ
+     */
+    UFUNCTION(BlueprintCallable, Category = "Grid")
+        bool SetFootprintBlocked(int32 GridX, int32 GridY, int32 SizeX, int32 SizeY, bool bBlocked);
+
     /**
      * תΪ
      * @param GridX X
@@ -97,24 +94,16 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Grid")
         void DrawGridVisuals(int32 HoverX, int32 HoverY);
 
-private:
-    /**
-     * A*㷨ڵṹ壬·
-     */
-    struct FAStarNode
-    {
-        int32 X;               // ڵX
-        int32 Y;               // ڵY
-        float G;               // 㵽ǰڵʵʳɱ
-        float H;               // ǰڵ㵽յԤɱʽ
-        TWeakPtr<FAStarNode> Parent;  // ڵ㣨ڻ·
-
-        // ܳɱF = G + H
-        float F() const { return G + H; }
-        // 캯
-        FAStarNode(int32 InX, int32 InY) : X(InX), Y(InY), G(0), H(0) {}
-    };
+    // ļؽ񣨳ߴ硢赲γɱڵڹλ
+    void LoadGridLayout(const struct FFormationLayout& Layout);
+
+    // ָ֮ǰ񣨿ؿãûĹʲô
+    void RestoreGridMap(const FGridMap& Snapshot) { Grid.RestoreFrom(Snapshot); }
 
+    // ײݣսģ´һ UWorld Ļʹã
+    const FGridMap& GetGridMap() const { return Grid; }
+
+private:
     /**
      * ǷЧΧδ赲
      * @param GridX X
@@ -123,42 +112,9 @@ private:
      */
     bool IsTileValid(int32 GridX, int32 GridY) const;
 
-    /**
-     * ʽɱپ룩
-     * @param X1 X
-     * @param Y1 Y
-     * @param X2 յX
-     * @param Y2 յY
-     * @return ʽɱֵ
-     */
-    float GetHeuristicCost(int32 X1, int32 Y1, int32 X2, int32 Y2) const;
+    // Ѱ·㷨ݣ Actor
+    FGridMap Grid;
 
-    /**
-     * ȡָӵЧھӽڵ㣨ķ
-     * @param X X
-     * @param Y Y
-     * @return ھӽڵб
-     */
-    TArray<FIntPoint> GetNeighborNodes(int32 X, int32 Y) const;
-
-    /**
-     * Ż·Ƴڵ㣬ʹ·ƽ
-     * @param RawPath ԭʼ·
-     */
-    void OptimizePath(TArray<FIntPoint>& RawPath);
-
-    // 洢ڵ㣨һάģά
-    UPROPERTY()
-        TArray<FGridNode> GridNodes;
-    // ȣX
-    UPROPERTY()
-        int32 GridWidthCount;
-    // ߶ȣY
-    UPROPERTY()
-        int32 GridHeightCount;
-    // ÿӵĳߴ磨絥λ
-    UPROPERTY()
-        float TileSize;
     // Իƿأģʽʹã
     UPROPERTY(EditAnywhere, Category = "Debug")
         bool bDrawDebug;
@@ -0,0 +1,529 @@
+// GridMap.cpp：从 AGridManager 中拆出来的网格数据（A* 本身在 GridPathCore.h，这里只做坐标和日志）
+#include "GridMap.h"
+#include "PerfCounters.h"
+#include "AutoBattleStats.h"
+
+namespace
+{
+    // 修改记录的条数上限（超过后最早的丢掉，落后太多的缓存整体重建）
+    const int32 MaxDirtyLog = 64;
+
+    // 区域编号快用完时整体重新编号
+    const int32 MaxRegionLabel = 1 << 30;
+
+    // 存盘时每个节点的字节数（bool 按 4 字节写 + 成本 float）
+    const int64 SerializedNodeBytes = 8;
+
+    // 一次 FindPath 的性能计数（浮层关着时什么都不做），不管从哪里返回都在析构时提交
+    struct FPathPerfScope
+    {
+        uint64 StartCycles = FPerfCounters::IsEnabled() ? FPlatformTime::Cycles64() : 0;
+        int32 NodesExpanded = 0;
+
+        ~FPathPerfScope()
+        {
+            if (StartCycles == 0) return;
+
+            const int64 Cycles = FPlatformTime::Cycles64() - StartCycles;
+            FPerfCounters::Add(EPerfCounter::PathRequests, 1);
+            FPerfCounters::Add(EPerfCounter::PathCycles, Cycles);
+            FPerfCounters::Max(EPerfCounter::PathMaxCycles, Cycles);
+            FPerfCounters::Add(EPerfCounter::PathNodesExpanded, NodesExpanded);
+        }
+    };
+}
+
+FGridMap::FGridMap()
+    : GridWidthCount(0)
+    , GridHeightCount(0)
+    , TileSize(100.0f)
+    , Origin(FVector::ZeroVector)
+    , Revision(0)
+    , DirtyLogStart(0)
+    , NextRegionLabel(0)
+{
+}
+
+/**
+ * 生成网格并初始化所有节点
+ */
+void FGridMap::Generate(int32 Width, int32 Height, float CellSize, const FVector& InOrigin)
+{
+    GridWidthCount = Width;
+    GridHeightCount = Height;
+    TileSize = CellSize;
+    Origin = InOrigin;
+    Revision++;
+    GridNodes.Empty();
+    GridNodes.Reserve(Width * Height);  // 预分配内存，减少动态扩容开销
+
+    // 双重循环初始化所有格子
+    for (int32 Y = 0; Y < Height; Y++)
+    {
+        for (int32 X = 0; X < Width; X++)
+        {
+            FGridNode NewNode;
+            NewNode.X = X;
+            NewNode.Y = Y;
+            NewNode.bIsBlocked = false;       // 默认所有格子可通行
+            NewNode.Cost = 1.0f;              // 默认地形成本为1.0
+            // 计算格子中心的世界坐标（基于管理器自身位置）
+            NewNode.WorldLocation = Origin + FVector(
+                X * TileSize + TileSize / 2,  // X方向偏移（加一半尺寸居中）
+                Y * TileSize + TileSize / 2,  // Y方向偏移（加一半尺寸居中）
+                0.0f                         // Z轴默认为0（忽略高度）
+            );
+            GridNodes.Add(NewNode);
+        }
+    }
+
+    ResetDirtyLog();
+    RebuildRegions();
+}
+
+/**
+ * 查找从起点到终点的路径（A*算法实现）
+ * @param StartWorldLoc 起点世界坐标
+ * @param EndWorldLoc 终点世界坐标
+ * @return 路径点列表（世界坐标）
+ */
+TArray<FVector> FGridMap::FindPath(const FVector& StartWorldLoc, const FVector& EndWorldLoc, FIntRect* OutSearchBounds) const
+{
+    TArray<FVector> Path;  // 最终路径（世界坐标）
+    int32 StartX, StartY, EndX, EndY;
+    SCOPE_CYCLE_COUNTER(STAT_AutoBattle_FindPath);
+    FPathPerfScope PerfScope;
+
+    // 没走到 A* 的情况结果取决于整张图（连通性），搜索范围按整张图算
+    if (OutSearchBounds)
+    {
+        *OutSearchBounds = FIntRect(0, 0, GridWidthCount, GridHeightCount);
+    }
+
+    // 1. 将起点和终点世界坐标转换为网格坐标并校验
+    if (!WorldToGrid(StartWorldLoc, StartX, StartY) || !WorldToGrid(EndWorldLoc, EndX, EndY))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Start or end position is out of grid bounds"));
+        return Path;  // 坐标超出网格范围，返回空路径
+    }
+    if (!IsTileValid(StartX, StartY) || !IsTileValid(EndX, EndY))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Start or end tile is blocked"));
+        return Path;  // 起点或终点被阻挡，返回空路径
+    }
+    if (GetRegion(StartX, StartY) != GetRegion(EndX, EndY))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("No path found between start and end"));
+        return Path;  // 不连通，A* 只会把起点所在区域搜完再失败
+    }
+
+    // 2. A* 在 GridPathCore 里；搜索缓冲每个线程一份（无头模拟会并行跑多场战斗），反复寻路不再分配
+    thread_local GridPathCore::FPathSearch Search;
+    thread_local std::vector<GridPathCore::FCell> CellPath;
+    GridPathCore::FCellRect SearchBounds;
+    const bool bFound = Search.FindPath(GetPathGrid(), { StartX, StartY }, { EndX, EndY }, CellPath, SearchBounds);
+    PerfScope.NodesExpanded = Search.GetStats().NodesExpanded;
+    SET_MEMORY_STAT(STAT_AutoBattle_PathScratchMemory, Search.GetStats().ScratchBytes);
+
+    if (!bFound)
+    {
+        // 开放集为空仍未找到终点，寻路失败
+        UE_LOG(LogTemp, Warning, TEXT("No path found between start and end"));
+        return Path;
+    }
+
+    if (OutSearchBounds)
+    {
+        *OutSearchBounds = FIntRect(SearchBounds.MinX, SearchBounds.MinY, SearchBounds.MaxX, SearchBounds.MaxY);
+    }
+
+    // 3. 将网格坐标转换为世界坐标
+    Path.Reserve((int32)CellPath.size());
+    for (const GridPathCore::FCell& Cell : CellPath)
+    {
+        Path.Add(GridToWorld(Cell.X, Cell.Y));
+    }
+    return Path;
+}
+
+bool FGridMap::SetTileBlocked(int32 GridX, int32 GridY, bool bBlocked)
+{
+    // 只检查范围：用 IsTileValid 的话已经被占的格子永远解不开
+    if (!IsInBounds(GridX, GridY)) return false;
+
+    GridNodes[GridY * GridWidthCount + GridX].bIsBlocked = bBlocked;
+    Revision++;
+    MarkDirty(FIntRect(GridX, GridY, GridX + 1, GridY + 1));
+    return true;
+}
+
+bool FGridMap::SetTilesBlocked(const TArray<FIntPoint>& Tiles, bool bBlocked)
+{
+    // 先整批检查，保证要么全改要么不改
+    for (const FIntPoint& Tile : Tiles)
+    {
+        if (!IsInBounds(Tile.X, Tile.Y)) return false;
+    }
+
+    if (Tiles.Num() == 0) return true;
+
+    FIntRect Rect(Tiles[0], Tiles[0] + FIntPoint(1, 1));
+    for (const FIntPoint& Tile : Tiles)
+    {
+        GridNodes[Tile.Y * GridWidthCount + Tile.X].bIsBlocked = bBlocked;
+        Rect.Include(Tile);
+        Rect.Include(Tile + FIntPoint(1, 1));
+    }
+    Revision++;
+    MarkDirty(Rect);
+    return true;
+}
+
+bool FGridMap::SetFootprintBlocked(int32 GridX, int32 GridY, int32 SizeX, int32 SizeY, bool bBlocked)
+{
+    if (SizeX <= 0 || SizeY <= 0) return false;
+    if (!IsInBounds(GridX, GridY) || !IsInBounds(GridX + SizeX - 1, GridY + SizeY - 1)) return false;
+
+    for (int32 Y = GridY; Y < GridY + SizeY; Y++)
+    {
+        for (int32 X = GridX; X < GridX + SizeX; X++)
+        {
+            GridNodes[Y * GridWidthCount + X].bIsBlocked = bBlocked;
+        }
+    }
+    Revision++;
+    MarkDirty(FIntRect(GridX, GridY, GridX + SizeX, GridY + SizeY));
+    return true;
+}
+
+void FGridMap::NotifyNodesChanged()
+{
+    Revision++;
+    ResetDirtyLog();
+    RebuildRegions();
+}
+
+void FGridMap::MarkDirty(const FIntRect& Rect)
+{
+    if (DirtyLog.Num() >= MaxDirtyLog)
+    {
+        DirtyLogStart = DirtyLog[0].Revision;
+        DirtyLog.RemoveAt(0, 1, false);
+    }
+    DirtyLog.Add({ Revision, Rect });
+
+    UpdateRegions(Rect);
+}
+
+void FGridMap::ResetDirtyLog()
+{
+    DirtyLog.Reset();
+    DirtyLogStart = Revision;
+}
+
+bool FGridMap::GetDirtyRectSince(uint32 SinceRevision, FIntRect& OutRect) const
+{
+    OutRect = FIntRect();
+    if (SinceRevision < DirtyLogStart || SinceRevision > Revision) return false;
+
+    bool bAny = false;
+    for (const FGridDirtyRect& Entry : DirtyLog)
+    {
+        if (Entry.Revision <= SinceRevision) continue;
+
+        if (!bAny)
+        {
+            OutRect = Entry.Rect;
+            bAny = true;
+        }
+        else
+        {
+            OutRect.Union(Entry.Rect);
+        }
+    }
+    return true;
+}
+
+int32 FGridMap::GetRegion(int32 GridX, int32 GridY) const
+{
+    if (!IsTileValid(GridX, GridY) || RegionLabels.Num() != GridNodes.Num()) return INDEX_NONE;
+    return RegionLabels[GridY * GridWidthCount + GridX];
+}
+
+void FGridMap::RebuildRegions()
+{
+    RegionLabels.Reset();
+    RegionLabels.Init(INDEX_NONE, GridNodes.Num());
+    NextRegionLabel = 0;
+
+    for (int32 i = 0; i < GridNodes.Num(); i++)
+    {
+        if (!GridNodes[i].bIsBlocked && RegionLabels[i] == INDEX_NONE)
+        {
+            FloodFillRegion(i, NextRegionLabel++);
+        }
+    }
+}
+
+void FGridMap::UpdateRegions(const FIntRect& Rect)
+{
+    if (RegionLabels.Num() != GridNodes.Num() || NextRegionLabel >= MaxRegionLabel)
+    {
+        RebuildRegions();
+        return;
+    }
+
+    // 外扩一格：被挡住的格子可能把旁边的区域切开，放开的格子可能把旁边的区域连起来
+    const int32 MinX = FMath::Max(Rect.Min.X - 1, 0);
+    const int32 MinY = FMath::Max(Rect.Min.Y - 1, 0);
+    const int32 MaxX = FMath::Min(Rect.Max.X + 1, GridWidthCount);
+    const int32 MaxY = FMath::Min(Rect.Max.Y + 1, GridHeightCount);
+
+    // 买兵、城墙倒下这类小修改通常不改变连通关系，只动范围内的格子
+    if (TryUpdateRegionsLocally(MinX, MinY, MaxX, MaxY))
+    {
+        return;
+    }
+
+    // 连通关系可能变了：和范围相接的区域整个重新填充
+    // 1. 范围内被挡住的格子不属于任何区域
+    for (int32 Y = MinY; Y < MaxY; Y++)
+    {
+        for (int32 X = MinX; X < MaxX; X++)
+        {
+            const int32 Index = Y * GridWidthCount + X;
+            if (GridNodes[Index].bIsBlocked) RegionLabels[Index] = INDEX_NONE;
+        }
+    }
+
+    // 2. 从范围内每个还没换过新编号的可通行格子重新填充；
+    //    原来的区域不管被切成几块，每一块都和这个范围相接，所以都会被重新编号
+    const int32 FirstNewLabel = NextRegionLabel;
+    for (int32 Y = MinY; Y < MaxY; Y++)
+    {
+        for (int32 X = MinX; X < MaxX; X++)
+        {
+            const int32 Index = Y * GridWidthCount + X;
+            if (!GridNodes[Index].bIsBlocked && RegionLabels[Index] < FirstNewLabel)
+            {
+                FloodFillRegion(Index, NextRegionLabel++);
+            }
+        }
+    }
+}
+
+bool FGridMap::TryUpdateRegionsLocally(int32 MinX, int32 MinY, int32 MaxX, int32 MaxY)
+{
+    // 不变量：挡住的格子编号是 INDEX_NONE，所以范围内编号还是 INDEX_NONE 的可通行格子就是刚放开的，
+    // 挡住了但还有编号的就是刚挡上的。范围外扩过一格，改过的格子的四邻居都在范围内
+    const int32 LocalWidth = MaxX - MinX;
+    const int32 LocalHeight = MaxY - MinY;
+    LocalComponents.Reset();
+    LocalComponents.Init(INDEX_NONE, LocalWidth * LocalHeight);
+    ComponentRegions.Reset();
+
+    // 1. 只在范围内走，给可通行格子分局部连通块；一个块里出现两个原来的区域编号说明连起来了
+    for (int32 LocalStart = 0; LocalStart < LocalComponents.Num(); LocalStart++)
+    {
+        if (LocalComponents[LocalStart] != INDEX_NONE) continue;
+        if (GridNodes[(MinY + LocalStart / LocalWidth) * GridWidthCount + MinX + LocalStart % LocalWidth].bIsBlocked) continue;
+
+        const int32 Component = ComponentRegions.Add(INDEX_NONE);
+        RegionQueue.Reset();
+        RegionQueue.Add(LocalStart);
+        LocalComponents[LocalStart] = Component;
+
+        for (int32 Head = 0; Head < RegionQueue.Num(); Head++)
+        {
+            const int32 Local = RegionQueue[Head];
+            const int32 LocalX = Local % LocalWidth;
+            const int32 LocalY = Local / LocalWidth;
+            const int32 Index = (MinY + LocalY) * GridWidthCount + MinX + LocalX;
+
+            const int32 OldRegion = RegionLabels[Index];
+            if (OldRegion != INDEX_NONE)
+            {
+                if (ComponentRegions[Component] == INDEX_NONE)
+                {
+                    ComponentRegions[Component] = OldRegion;
+                }
+                else if (ComponentRegions[Component] != OldRegion)
+                {
+                    return false;
+                }
+            }
+
+            const int32 Neighbors[4][2] = {
+                { LocalX + 1 < LocalWidth ? Local + 1 : INDEX_NONE, Index + 1 },
+                { LocalX > 0 ? Local - 1 : INDEX_NONE, Index - 1 },
+                { LocalY + 1 < LocalHeight ? Local + LocalWidth : INDEX_NONE, Index + GridWidthCount },
+                { LocalY > 0 ? Local - LocalWidth : INDEX_NONE, Index - GridWidthCount }
+            };
+            for (const auto& Neighbor : Neighbors)
+            {
+                if (Neighbor[0] != INDEX_NONE && LocalComponents[Neighbor[0]] == INDEX_NONE && !GridNodes[Neighbor[1]].bIsBlocked)
+                {
+                    LocalComponents[Neighbor[0]] = Component;
+                    RegionQueue.Add(Neighbor[0]);
+                }
+            }
+        }
+    }
+
+    // 2. 同一个区域分散在两个局部连通块里：范围外可能已经不连通了，交给整块重填
+    //    （每个区域都只落在一个块里时，原来穿过被挡格子的路都能在范围内绕过去）
+    RegionQueue = ComponentRegions;
+    RegionQueue.Sort();
+    for (int32 i = 1; i < RegionQueue.Num(); i++)
+    {
+        if (RegionQueue[i] != INDEX_NONE && RegionQueue[i] == RegionQueue[i - 1]) return false;
+    }
+
+    // 3. 连通关系没变：刚挡上的格子去掉编号，刚放开的格子跟着所在块的区域（全是新格子的块是新区域）
+    for (int32 Local = 0; Local < LocalComponents.Num(); Local++)
+    {
+        const int32 Index = (MinY + Local / LocalWidth) * GridWidthCount + MinX + Local % LocalWidth;
+        if (GridNodes[Index].bIsBlocked)
+        {
+            RegionLabels[Index] = INDEX_NONE;
+        }
+        else if (RegionLabels[Index] == INDEX_NONE)
+        {
+            int32& Region = ComponentRegions[LocalComponents[Local]];
+            if (Region == INDEX_NONE)
+            {
+                Region = NextRegionLabel++;
+            }
+            RegionLabels[Index] = Region;
+        }
+    }
+    return true;
+}
+
+void FGridMap::FloodFillRegion(int32 StartIndex, int32 Label)
+{
+    // 队列跨调用复用，单格修改不再每次分配
+    TArray<int32>& Queue = RegionQueue;
+    Queue.Reset();
+    Queue.Add(StartIndex);
+    RegionLabels[StartIndex] = Label;
+
+    for (int32 Head = 0; Head < Queue.Num(); Head++)
+    {
+        const int32 Index = Queue[Head];
+        const int32 X = Index % GridWidthCount;
+        const int32 Y = Index / GridWidthCount;
+
+        const int32 Neighbors[4] = {
+            X + 1 < GridWidthCount ? Index + 1 : INDEX_NONE,
+            X > 0 ? Index - 1 : INDEX_NONE,
+            Y + 1 < GridHeightCount ? Index + GridWidthCount : INDEX_NONE,
+            Y > 0 ? Index - GridWidthCount : INDEX_NONE
+        };
+        for (int32 Neighbor : Neighbors)
+        {
+            if (Neighbor != INDEX_NONE && !GridNodes[Neighbor].bIsBlocked && RegionLabels[Neighbor] != Label)
+            {
+                RegionLabels[Neighbor] = Label;
+                Queue.Add(Neighbor);
+            }
+        }
+    }
+}
+
+FVector FGridMap::GridToWorld(int32 GridX, int32 GridY) const
+{
+    // 检查格子是否有效
+    if (!IsTileValid(GridX, GridY)) return FVector::ZeroVector;
+
+    // 返回预计算的世界坐标
+    return GridNodes[GridY * GridWidthCount + GridX].WorldLocation;
+}
+
+FVector FGridMap::GetTileCenter(int32 GridX, int32 GridY) const
+{
+    // 和 Generate 里算 WorldLocation 的式子一样，结果逐位一致
+    return Origin + FVector(GridX * TileSize + TileSize / 2, GridY * TileSize + TileSize / 2, 0.0f);
+}
+
+bool FGridMap::WorldToGrid(const FVector& WorldLoc, int32& OutGridX, int32& OutGridY) const
+{
+    // 转换为相对于网格原点的本地坐标
+    FVector LocalLoc = WorldLoc - Origin;
+
+    // 计算网格坐标（向下取整）
+    OutGridX = GridPathCore::LocalToCell(LocalLoc.X, TileSize);
+    OutGridY = GridPathCore::LocalToCell(LocalLoc.Y, TileSize);
+
+    // 检查是否在网格范围内
+    return IsTileValid(OutGridX, OutGridY);
+}
+
+bool FGridMap::IsTileValid(int32 GridX, int32 GridY) const
+{
+    // 检查坐标是否在网格范围内
+    if (!IsInBounds(GridX, GridY))
+        return false;
+
+    // 检查格子是否未被阻挡
+    return !GridNodes[GridY * GridWidthCount + GridX].bIsBlocked;
+}
+
+bool FGridMap::IsInBounds(int32 GridX, int32 GridY) const
+{
+    return GridX >= 0 && GridX < GridWidthCount && GridY >= 0 && GridY < GridHeightCount;
+}
+
+void FGridMap::RestoreFrom(const FGridMap& Snapshot)
+{
+    if (Snapshot.Revision == Revision) return;
+
+    const uint32 NextRevision = Revision + 1;
+    *this = Snapshot;
+    Revision = NextRevision;
+    // 快照的连通区域跟着拷过来了，修改记录接不上，缓存整体重建
+    ResetDirtyLog();
+}
+
+FArchive& operator<<(FArchive& Ar, FGridMap& Grid)
+{
+    // 尺寸先读进局部变量，校验通过才动网格
+    int32 Width = Grid.GridWidthCount;
+    int32 Height = Grid.GridHeightCount;
+    float CellSize = Grid.TileSize;
+    FVector GridOrigin = Grid.Origin;
+    Ar << Width << Height << CellSize << GridOrigin;
+
+    if (Ar.IsLoading())
+    {
+        // 分配之前核对尺寸和剩余长度：坏文件或恶意文件不会要求分配几个 G
+        const int64 NumCells = (int64)Width * Height;
+        const int64 Remaining = Ar.TotalSize() - Ar.Tell();
+        if (Ar.IsError() || Width <= 0 || Height <= 0 || NumCells > MAX_int32 || !(CellSize > 0.0f)
+            || (Ar.TotalSize() >= 0 && Remaining < NumCells * SerializedNodeBytes))
+        {
+            Ar.SetError();
+            return Ar;
+        }
+
+        // 先按尺寸重建节点，再覆盖阻挡和成本
+        Grid.Generate(Width, Height, CellSize, GridOrigin);
+    }
+
+    for (FGridNode& Node : Grid.GridNodes)
+    {
+        Ar << Node.bIsBlocked << Node.Cost;
+    }
+
+    if (Ar.IsLoading())
+    {
+        Grid.NotifyNodesChanged();
+    }
+    return Ar;
+}
+
+SIZE_T FGridMap::GetAllocatedSize() const
+{
+    return GridNodes.GetAllocatedSize() + DirtyLog.GetAllocatedSize() + RegionLabels.GetAllocatedSize() + RegionQueue.GetAllocatedSize()
+        + LocalComponents.GetAllocatedSize() + ComponentRegions.GetAllocatedSize();
+}
@@ -0,0 +1,175 @@
+// GridMap.h：网格数据与寻路算法（不依赖 AActor / UWorld，可在无头模拟中直接使用）
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridPathCore.h"
+#include "GridMap.generated.h"
+
+/**
+ * 网格节点结构体，存储单个格子的所有数据
+ */
+USTRUCT(BlueprintType)
+struct FGridNode
+{
+    GENERATED_BODY()
+
+        // 格子在网格中的X坐标
+        UPROPERTY()
+        int32 X;
+    // 格子在网格中的Y坐标
+    UPROPERTY()
+        int32 Y;
+    // 是否被阻挡（如建筑、障碍物）
+    UPROPERTY()
+        bool bIsBlocked;
+    // 格子中心点的世界坐标
+    UPROPERTY()
+        FVector WorldLocation;
+    // 地形成本（影响移动消耗，平地1.0，沼泽等可设更高值）
+    UPROPERTY()
+        float Cost;
+};
+
+/**
+ * 一次阻挡修改影响的范围（格子坐标，Min 含、Max 不含），依赖网格的缓存只需要更新这个范围
+ */
+struct FGridDirtyRect
+{
+    uint32 Revision;   // 修改之后的版本号
+    FIntRect Rect;
+};
+
+/**
+ * 纯数据网格：节点数组 + 坐标转换 + A* 寻路（搜索本身在不依赖引擎的 GridPathCore 里）
+ * AGridManager 持有一份用于游戏内，战斗模拟器持有自己的拷贝，两边走的是同一套算法
+ */
+struct AUTOBATTLEDEMO_API FGridMap
+{
+public:
+    FGridMap();
+
+    /**
+     * 生成网格并初始化所有节点
+     * @param Width 网格宽度（X方向格子数量）
+     * @param Height 网格高度（Y方向格子数量）
+     * @param CellSize 每个格子的尺寸（世界单位）
+     * @param InOrigin 网格左下角的世界坐标
+     */
+    void Generate(int32 Width, int32 Height, float CellSize, const FVector& InOrigin);
+
+    /**
+     * 查找从起点到终点的路径（A*算法实现）
+     * 起点和终点不在同一个连通区域时直接返回，不再把整个区域搜一遍
+     * @param OutSearchBounds 可选：这次搜索读过的格子的包围框，框外的格子怎么改都不影响结果（路径缓存用）
+     * @return 路径点列表（世界坐标），若找不到路径则返回空数组
+     */
+    TArray<FVector> FindPath(const FVector& StartWorldLoc, const FVector& EndWorldLoc, FIntRect* OutSearchBounds = nullptr) const;
+
+    // 设置指定格子的阻挡状态（只改数据，不做调试绘制），返回是否修改成功
+    bool SetTileBlocked(int32 GridX, int32 GridY, bool bBlocked);
+
+    // 批量设置阻挡，整批只增加一次版本号；任何一个格子越界则什么都不改，返回 false
+    bool SetTilesBlocked(const TArray<FIntPoint>& Tiles, bool bBlocked);
+
+    /**
+     * 设置一块 SizeX x SizeY 的占地（建筑、城墙），只产生一个脏矩形
+     * @param GridX 占地左下角的格子X坐标
+     * @param GridY 占地左下角的格子Y坐标
+     * @return 是否修改成功（占地超出网格时一个都不改）
+     */
+    bool SetFootprintBlocked(int32 GridX, int32 GridY, int32 SizeX, int32 SizeY, bool bBlocked);
+
+    // 通过 GetNode 直接改了节点之后调用：版本号 +1，连通区域整体重算，之前的修改记录作废
+    void NotifyNodesChanged();
+
+    /**
+     * SinceRevision 之后所有阻挡修改的范围的并集（没有修改时 OutRect 为空）
+     * @return false 表示修改记录已经不够旧（重新生成过、恢复过快照或改动太多），调用方要整体重建
+     */
+    bool GetDirtyRectSince(uint32 SinceRevision, FIntRect& OutRect) const;
+
+    // 连通区域编号（4 方向相连的可通行格子编号相同，阻挡或越界返回 INDEX_NONE）
+    int32 GetRegion(int32 GridX, int32 GridY) const;
+    // 恢复成快照的内容（快照就是之前拷贝的一份）；版本号一致说明没改过，什么都不做
+    // 恢复后版本号继续往上加，不会回退到快照时的值
+    void RestoreFrom(const FGridMap& Snapshot);
+
+    // 阻挡数据的版本号（每次修改 +1），依赖阻挡状态的缓存用它判断是否过期
+    uint32 GetRevision() const { return Revision; }
+
+    // 网格坐标 -> 格子中心世界坐标（越界或被阻挡返回零向量）
+    FVector GridToWorld(int32 GridX, int32 GridY) const;
+
+    // 格子中心世界坐标，不检查范围和阻挡（建筑占地的格子都是挡住的，算占地范围用这个）
+    FVector GetTileCenter(int32 GridX, int32 GridY) const;
+
+    // 世界坐标 -> 网格坐标，返回坐标是否在网格内且可通行
+    bool WorldToGrid(const FVector& WorldLoc, int32& OutGridX, int32& OutGridY) const;
+
+    // 检查格子是否有效（在网格范围内且未被阻挡）
+    bool IsTileValid(int32 GridX, int32 GridY) const;
+
+    // 是否在网格范围内（不关心阻挡）
+    bool IsInBounds(int32 GridX, int32 GridY) const;
+
+    int32 GetWidth() const { return GridWidthCount; }
+    int32 GetHeight() const { return GridHeightCount; }
+    float GetTileSize() const { return TileSize; }
+    const FVector& GetOrigin() const { return Origin; }
+
+    const TArray<FGridNode>& GetNodes() const { return GridNodes; }
+
+    // 交给 GridPathCore 的只读视图（不拷贝节点；基准测试直接拿它跑不同的 A* 变体）
+    GridPathCore::TGridView<FGridNode> GetPathGrid() const { return { GridNodes.GetData(), GridWidthCount, GridHeightCount }; }
+
+    // 节点、修改记录和连通区域占的堆内存（stat AutoBattle 显示）
+    SIZE_T GetAllocatedSize() const;
+    FGridNode& GetNode(int32 GridX, int32 GridY) { return GridNodes[GridY * GridWidthCount + GridX]; }
+    const FGridNode& GetNode(int32 GridX, int32 GridY) const { return GridNodes[GridY * GridWidthCount + GridX]; }
+
+    // 序列化（战斗布局存盘用）
+    friend FArchive& operator<<(FArchive& Ar, FGridMap& Grid);
+
+private:
+    // 记一条修改并按范围更新连通区域
+    void MarkDirty(const FIntRect& Rect);
+
+    // 清空修改记录（此后只能从当前版本号开始查询）
+    void ResetDirtyLog();
+
+    // 连通区域：整体重算 / 只重算和 Rect（外扩一格）相接的区域
+    void RebuildRegions();
+    void UpdateRegions(const FIntRect& Rect);
+    void FloodFillRegion(int32 StartIndex, int32 Label);
+
+    // 快速路径：修改没有切开或连起任何区域时，只改范围内格子的编号并返回 true；
+    // 连通关系可能变了返回 false，什么都不改
+    bool TryUpdateRegionsLocally(int32 MinX, int32 MinY, int32 MaxX, int32 MaxY);
+
+    // 存储所有网格节点（一维数组模拟二维）
+    TArray<FGridNode> GridNodes;
+    // 网格宽度（X方向格子数量）
+    int32 GridWidthCount;
+    // 网格高度（Y方向格子数量）
+    int32 GridHeightCount;
+    // 每个格子的尺寸（世界单位）
+    float TileSize;
+    // 网格原点（AGridManager 的位置）
+    FVector Origin;
+    // 阻挡数据的版本号（不存盘）
+    uint32 Revision;
+
+    // 最近的修改记录（最多 MaxDirtyLog 条），DirtyLogStart 之后的修改都在里面
+    TArray<FGridDirtyRect> DirtyLog;
+    uint32 DirtyLogStart;
+
+    // 每个格子的连通区域编号；编号只增不减，重算过的区域换新编号
+    TArray<int32> RegionLabels;
+    int32 NextRegionLabel;
+
+    // 填充连通区域用的队列（只是缓冲，内容没有意义）
+    TArray<int32> RegionQueue;
+    // 快速路径的缓冲：范围内每个格子所在的局部连通块、每个局部连通块原来的区域编号
+    TArray<int32> LocalComponents;
+    TArray<int32> ComponentRegions;
+};
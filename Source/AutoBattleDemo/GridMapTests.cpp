@@ -0,0 +1,307 @@
+// GridMapTests.cpp：FGridMap 寻路的自动化测试（Session Frontend -> Automation -> AutoBattle.GridMap）
+// GridPathCore 换掉了最早基于 TMap 的 A*，这里把老实现原样留一份，随机网格上逐格对照
+#include "Misc/AutomationTest.h"
+#include "GridMap.h"
+#include "Algo/Reverse.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+    // 重构前 AGridManager::FindPath 的节点（F 值相同时按 TMap 槽位顺序取第一个）
+    struct FLegacyAStarNode
+    {
+        int32 X;
+        int32 Y;
+        float G;
+        float H;
+        TWeakPtr<FLegacyAStarNode> Parent;
+
+        float F() const { return G + H; }
+        FLegacyAStarNode(int32 InX, int32 InY) : X(InX), Y(InY), G(0), H(0) {}
+    };
+
+    float LegacyHeuristicCost(int32 X1, int32 Y1, int32 X2, int32 Y2)
+    {
+        return FMath::Abs(X1 - X2) + FMath::Abs(Y1 - Y2);
+    }
+
+    void LegacyOptimizePath(TArray<FIntPoint>& RawPath)
+    {
+        if (RawPath.Num() <= 2) return;
+
+        TArray<FIntPoint> Optimized;
+        Optimized.Add(RawPath[0]);
+        FIntPoint PrevDir = RawPath[1] - RawPath[0];
+        for (int32 i = 2; i < RawPath.Num(); i++)
+        {
+            FIntPoint CurrentDir = RawPath[i] - RawPath[i - 1];
+            if (CurrentDir != PrevDir)
+            {
+                Optimized.Add(RawPath[i - 1]);
+                PrevDir = CurrentDir;
+            }
+        }
+        Optimized.Add(RawPath.Last());
+        RawPath = Optimized;
+    }
+
+    /**
+     * 重构前的 A*（开放集是 TMap，每轮线性扫描取 F 最小的节点），只改了取网格数据的方式
+     * 额外按 GridPathCore 的约定算出搜索范围：起点终点的包围框，加上每个关闭节点外扩一格
+     */
+    bool LegacyFindPath(const FGridMap& Grid, FIntPoint Start, FIntPoint End, TArray<FIntPoint>& OutPath, FIntRect& OutBounds)
+    {
+        OutPath.Reset();
+        OutBounds = FIntRect(FMath::Min(Start.X, End.X), FMath::Min(Start.Y, End.Y),
+            FMath::Max(Start.X, End.X) + 1, FMath::Max(Start.Y, End.Y) + 1);
+
+        TMap<FIntPoint, TSharedPtr<FLegacyAStarNode>> OpenSet;
+        TMap<FIntPoint, TSharedPtr<FLegacyAStarNode>> ClosedSet;
+        OpenSet.Add(Start, MakeShareable(new FLegacyAStarNode(Start.X, Start.Y)));
+
+        const int32 Directions[4][2] = { {1,0}, {-1,0}, {0,1}, {0,-1} };
+        while (OpenSet.Num() > 0)
+        {
+            TSharedPtr<FLegacyAStarNode> CurrentNode = nullptr;
+            FIntPoint CurrentKey;
+            for (const auto& Pair : OpenSet)
+            {
+                if (!CurrentNode || Pair.Value->F() < CurrentNode->F())
+                {
+                    CurrentNode = Pair.Value;
+                    CurrentKey = Pair.Key;
+                }
+            }
+
+            if (CurrentKey == End)
+            {
+                while (CurrentNode.IsValid())
+                {
+                    OutPath.Add(FIntPoint(CurrentNode->X, CurrentNode->Y));
+                    CurrentNode = CurrentNode->Parent.Pin();
+                }
+                Algo::Reverse(OutPath);
+                LegacyOptimizePath(OutPath);
+                return true;
+            }
+
+            OpenSet.Remove(CurrentKey);
+            ClosedSet.Add(CurrentKey, CurrentNode);
+            OutBounds.Min.X = FMath::Max(FMath::Min(OutBounds.Min.X, CurrentKey.X - 1), 0);
+            OutBounds.Min.Y = FMath::Max(FMath::Min(OutBounds.Min.Y, CurrentKey.Y - 1), 0);
+            OutBounds.Max.X = FMath::Min(FMath::Max(OutBounds.Max.X, CurrentKey.X + 2), Grid.GetWidth());
+            OutBounds.Max.Y = FMath::Min(FMath::Max(OutBounds.Max.Y, CurrentKey.Y + 2), Grid.GetHeight());
+
+            for (const auto& Dir : Directions)
+            {
+                const FIntPoint NeighborKey(CurrentNode->X + Dir[0], CurrentNode->Y + Dir[1]);
+                if (ClosedSet.Contains(NeighborKey) || !Grid.IsTileValid(NeighborKey.X, NeighborKey.Y))
+                {
+                    continue;
+                }
+
+                float NewG = CurrentNode->G + LegacyHeuristicCost(CurrentNode->X, CurrentNode->Y, NeighborKey.X, NeighborKey.Y)
+                    * Grid.GetNode(NeighborKey.X, NeighborKey.Y).Cost;
+
+                TSharedPtr<FLegacyAStarNode> NeighborNode;
+                if (OpenSet.Contains(NeighborKey))
+                {
+                    NeighborNode = OpenSet[NeighborKey];
+                    if (NewG >= NeighborNode->G) continue;
+                }
+                else
+                {
+                    NeighborNode = MakeShareable(new FLegacyAStarNode(NeighborKey.X, NeighborKey.Y));
+                    OpenSet.Add(NeighborKey, NeighborNode);
+                }
+
+                NeighborNode->G = NewG;
+                NeighborNode->H = LegacyHeuristicCost(NeighborKey.X, NeighborKey.Y, End.X, End.Y);
+                NeighborNode->Parent = CurrentNode;
+            }
+        }
+        return false;
+    }
+
+    // 第一次见到 From 时记下对应的 To，之后必须一直对应同一个
+    bool MapsConsistently(TMap<int32, int32>& Mapping, int32 From, int32 To)
+    {
+        const int32* Existing = Mapping.Find(From);
+        if (Existing) return *Existing == To;
+        Mapping.Add(From, To);
+        return true;
+    }
+
+    // 随机挑一个可通行的格子（找不到返回 false）
+    bool PickWalkableTile(const FGridMap& Grid, FRandomStream& Random, FIntPoint& OutTile)
+    {
+        for (int32 Attempt = 0; Attempt < 64; Attempt++)
+        {
+            OutTile = FIntPoint(Random.RandRange(0, Grid.GetWidth() - 1), Random.RandRange(0, Grid.GetHeight() - 1));
+            if (Grid.IsTileValid(OutTile.X, OutTile.Y)) return true;
+        }
+        return false;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridMapFindPathMatchesLegacyTest, "AutoBattle.GridMap.FindPathMatchesLegacy",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FGridMapFindPathMatchesLegacyTest::RunTest(const FString& Parameters)
+{
+    const int32 NumGrids = 48;
+    const int32 QueriesPerGrid = 24;
+    int32 NumCompared = 0;
+
+    for (int32 Seed = 0; Seed < NumGrids; Seed++)
+    {
+        // 1. 随机网格：三种成本（全 1、整数、小数，小数最容易出现 F 值相同和浮点误差）
+        FRandomStream Random(Seed);
+        FGridMap Grid;
+        Grid.Generate(Random.RandRange(4, 40), Random.RandRange(4, 40), 100.0f, FVector(-500.0f, 300.0f, 0.0f));
+
+        const int32 CostMode = Seed % 3;
+        const float BlockChance = Random.FRandRange(0.0f, 0.35f);
+        for (int32 Y = 0; Y < Grid.GetHeight(); Y++)
+        {
+            for (int32 X = 0; X < Grid.GetWidth(); X++)
+            {
+                FGridNode& Node = Grid.GetNode(X, Y);
+                Node.bIsBlocked = Random.FRand() < BlockChance;
+                Node.Cost = CostMode == 0 ? 1.0f : CostMode == 1 ? (float)Random.RandRange(1, 4) : Random.FRandRange(0.5f, 3.0f);
+            }
+        }
+        Grid.NotifyNodesChanged();
+
+        // 2. 只比同一连通区域内的起点终点（不连通时新实现直接返回，老实现要搜完整个区域，结果都是空）
+        for (int32 Query = 0; Query < QueriesPerGrid; Query++)
+        {
+            FIntPoint Start, End;
+            if (!PickWalkableTile(Grid, Random, Start) || !PickWalkableTile(Grid, Random, End)) continue;
+            if (Grid.GetRegion(Start.X, Start.Y) != Grid.GetRegion(End.X, End.Y)) continue;
+
+            TArray<FIntPoint> LegacyCells;
+            FIntRect LegacyBounds;
+            if (!TestTrue(FString::Printf(TEXT("Legacy A* finds a path (seed %d, %s -> %s)"), Seed, *Start.ToString(), *End.ToString()),
+                LegacyFindPath(Grid, Start, End, LegacyCells, LegacyBounds)))
+            {
+                return false;
+            }
+
+            TArray<FVector> LegacyPath;
+            for (const FIntPoint& Cell : LegacyCells)
+            {
+                LegacyPath.Add(Grid.GridToWorld(Cell.X, Cell.Y));
+            }
+
+            // 3. FGridMap::FindPath（二叉堆）和直接调 GridPathCore 的线性扫描都要和老实现逐格一致
+            FIntRect SearchBounds;
+            const TArray<FVector> Path = Grid.FindPath(Grid.GridToWorld(Start.X, Start.Y), Grid.GridToWorld(End.X, End.Y), &SearchBounds);
+
+            GridPathCore::FPathSearch LinearSearch;
+            std::vector<GridPathCore::FCell> LinearCells;
+            GridPathCore::FCellRect LinearBounds;
+            LinearSearch.FindPath(Grid.GetPathGrid(), { Start.X, Start.Y }, { End.X, End.Y }, LinearCells, LinearBounds, GridPathCore::EOpenList::LinearScan);
+            TArray<FIntPoint> LinearPath;
+            for (const GridPathCore::FCell& Cell : LinearCells)
+            {
+                LinearPath.Emplace(Cell.X, Cell.Y);
+            }
+
+            const FString Context = FString::Printf(TEXT("seed %d, %s -> %s"), Seed, *Start.ToString(), *End.ToString());
+            if (Path != LegacyPath)
+            {
+                AddError(FString::Printf(TEXT("FindPath differs from legacy A* (%s): %d vs %d points"), *Context, Path.Num(), LegacyPath.Num()));
+                return false;
+            }
+            if (SearchBounds != LegacyBounds)
+            {
+                AddError(FString::Printf(TEXT("Search bounds differ from legacy A* (%s): %s vs %s"), *Context, *SearchBounds.ToString(), *LegacyBounds.ToString()));
+                return false;
+            }
+            if (LinearPath != LegacyCells)
+            {
+                AddError(FString::Printf(TEXT("Linear scan open list differs from legacy A* (%s)"), *Context));
+                return false;
+            }
+            NumCompared++;
+        }
+    }
+
+    return TestTrue(TEXT("Compared at least one path per grid on average"), NumCompared >= NumGrids);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridMapIncrementalRegionsTest, "AutoBattle.GridMap.IncrementalRegions",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FGridMapIncrementalRegionsTest::RunTest(const FString& Parameters)
+{
+    // 单格、占地、批量三种修改交替进行，每改一次都和整体重算的区域划分对照（编号可以不同，分组必须一样）
+    for (int32 Seed = 0; Seed < 64; Seed++)
+    {
+        FRandomStream Random(Seed);
+        FGridMap Grid;
+        Grid.Generate(Random.RandRange(1, 24), Random.RandRange(1, 24), 100.0f, FVector::ZeroVector);
+        const float BlockChance = Random.FRandRange(0.0f, 0.5f);
+        for (int32 Y = 0; Y < Grid.GetHeight(); Y++)
+        {
+            for (int32 X = 0; X < Grid.GetWidth(); X++)
+            {
+                Grid.GetNode(X, Y).bIsBlocked = Random.FRand() < BlockChance;
+            }
+        }
+        Grid.NotifyNodesChanged();
+
+        for (int32 Change = 0; Change < 80; Change++)
+        {
+            const bool bBlocked = Random.FRand() < 0.5f;
+            const int32 X = Random.RandRange(0, Grid.GetWidth() - 1);
+            const int32 Y = Random.RandRange(0, Grid.GetHeight() - 1);
+            const float Kind = Random.FRand();
+            if (Kind < 0.4f)
+            {
+                Grid.SetTileBlocked(X, Y, bBlocked);
+            }
+            else if (Kind < 0.7f)
+            {
+                const int32 SizeX = FMath::Min(Random.RandRange(1, 3), Grid.GetWidth() - X);
+                const int32 SizeY = FMath::Min(Random.RandRange(1, 3), Grid.GetHeight() - Y);
+                Grid.SetFootprintBlocked(X, Y, SizeX, SizeY, bBlocked);
+            }
+            else
+            {
+                TArray<FIntPoint> Tiles;
+                for (int32 i = Random.RandRange(1, 5); i > 0; i--)
+                {
+                    Tiles.Emplace(Random.RandRange(0, Grid.GetWidth() - 1), Random.RandRange(0, Grid.GetHeight() - 1));
+                }
+                Grid.SetTilesBlocked(Tiles, bBlocked);
+            }
+
+            FGridMap Rebuilt = Grid;
+            Rebuilt.NotifyNodesChanged();
+
+            TMap<int32, int32> IncrementalToRebuilt;
+            TMap<int32, int32> RebuiltToIncremental;
+            for (int32 TileY = 0; TileY < Grid.GetHeight(); TileY++)
+            {
+                for (int32 TileX = 0; TileX < Grid.GetWidth(); TileX++)
+                {
+                    const int32 A = Grid.GetRegion(TileX, TileY);
+                    const int32 B = Rebuilt.GetRegion(TileX, TileY);
+                    const bool bMatches = (A == INDEX_NONE) == (B == INDEX_NONE)
+                        && (A == INDEX_NONE || (MapsConsistently(IncrementalToRebuilt, A, B) && MapsConsistently(RebuiltToIncremental, B, A)));
+                    if (!bMatches)
+                    {
+                        AddError(FString::Printf(TEXT("Region partition differs from a full rebuild at (%d, %d) (seed %d, change %d)"), TileX, TileY, Seed, Change));
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,190 @@
+#include "GridPathBenchCommandlet.h"
+#include "GridMap.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+
+namespace
+{
+    struct FPathQuery
+    {
+        GridPathCore::FCell Start;
+        GridPathCore::FCell End;
+    };
+
+    bool SameBounds(const GridPathCore::FCellRect& A, const GridPathCore::FCellRect& B)
+    {
+        return A.MinX == B.MinX && A.MinY == B.MinY && A.MaxX == B.MaxX && A.MaxY == B.MaxY;
+    }
+}
+
+UGridPathBenchCommandlet::UGridPathBenchCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = false;
+    LogToConsole = true;
+}
+
+int32 UGridPathBenchCommandlet::Main(const FString& Params)
+{
+    // 1. 解析参数
+    int32 Size = 256;
+    int32 ObstaclePercent = 20;
+    int32 NumPaths = 1000;
+    int32 Seed = 1;
+    FParse::Value(*Params, TEXT("size="), Size);
+    FParse::Value(*Params, TEXT("obstacles="), ObstaclePercent);
+    FParse::Value(*Params, TEXT("paths="), NumPaths);
+    FParse::Value(*Params, TEXT("seed="), Seed);
+    const bool bCosts = FParse::Param(*Params, TEXT("costs"));
+
+    Size = FMath::Clamp(Size, 2, 4096);
+    ObstaclePercent = FMath::Clamp(ObstaclePercent, 0, 90);
+    NumPaths = FMath::Max(NumPaths, 1);
+
+    // 2. 随机网格（-costs 时地形成本取 1~3 的整数，F 值相同的节点少一些）
+    FRandomStream Random(Seed);
+    FGridMap Grid;
+    Grid.Generate(Size, Size, 100.0f, FVector::ZeroVector);
+    for (int32 Y = 0; Y < Size; Y++)
+    {
+        for (int32 X = 0; X < Size; X++)
+        {
+            FGridNode& Node = Grid.GetNode(X, Y);
+            Node.bIsBlocked = Random.RandHelper(100) < ObstaclePercent;
+            Node.Cost = bCosts ? (float)(1 + Random.RandHelper(3)) : 1.0f;
+        }
+    }
+    Grid.NotifyNodesChanged();
+
+    // 起点终点都可通行且连通（不连通的在 FGridMap 里就被挡掉了，不进 A*）
+    TArray<FPathQuery> Queries;
+    for (int32 Attempt = 0; Queries.Num() < NumPaths && Attempt < NumPaths * 100; Attempt++)
+    {
+        const FPathQuery Query = {
+            { Random.RandHelper(Size), Random.RandHelper(Size) },
+            { Random.RandHelper(Size), Random.RandHelper(Size) }
+        };
+        const int32 Region = Grid.GetRegion(Query.Start.X, Query.Start.Y);
+        if (Region != INDEX_NONE && Region == Grid.GetRegion(Query.End.X, Query.End.Y))
+        {
+            Queries.Add(Query);
+        }
+    }
+
+    UE_LOG(LogTemp, Display, TEXT("Grid %dx%d, %d%% obstacles, costs %s, %d connected queries"),
+        Size, Size, ObstaclePercent, bCosts ? TEXT("1-3") : TEXT("uniform"), Queries.Num());
+
+    // 3. A*：两种开放集跑同一批查询，逐条比较
+    const GridPathCore::TGridView<FGridNode> View = Grid.GetPathGrid();
+    GridPathCore::FPathSearch Search;
+    std::vector<GridPathCore::FCell> HeapPath;
+    std::vector<GridPathCore::FCell> LinearPath;
+    GridPathCore::FCellRect HeapBounds;
+    GridPathCore::FCellRect LinearBounds;
+    double HeapSeconds = 0.0;
+    double LinearSeconds = 0.0;
+    int64 NodesExpanded = 0;
+    int32 Mismatches = 0;
+
+    for (const FPathQuery& Query : Queries)
+    {
+        double StartTime = FPlatformTime::Seconds();
+        const bool bHeapFound = Search.FindPath(View, Query.Start, Query.End, HeapPath, HeapBounds, GridPathCore::EOpenList::BinaryHeap);
+        HeapSeconds += FPlatformTime::Seconds() - StartTime;
+        NodesExpanded += Search.GetStats().NodesExpanded;
+
+        StartTime = FPlatformTime::Seconds();
+        const bool bLinearFound = Search.FindPath(View, Query.Start, Query.End, LinearPath, LinearBounds, GridPathCore::EOpenList::LinearScan);
+        LinearSeconds += FPlatformTime::Seconds() - StartTime;
+
+        if (bHeapFound != bLinearFound || HeapPath != LinearPath || (bHeapFound && !SameBounds(HeapBounds, LinearBounds)))
+        {
+            if (Mismatches++ == 0)
+            {
+                UE_LOG(LogTemp, Error, TEXT("Path mismatch (%d,%d)->(%d,%d): heap %d points, linear %d points"),
+                    Query.Start.X, Query.Start.Y, Query.End.X, Query.End.Y, (int32)HeapPath.size(), (int32)LinearPath.size());
+            }
+        }
+    }
+
+    const int32 NumQueries = FMath::Max(Queries.Num(), 1);
+    UE_LOG(LogTemp, Display, TEXT("A* binary heap: %.2fus/path, linear scan: %.2fus/path (%.1fx), %.0f nodes expanded/path, scratch %.1f KB"),
+        HeapSeconds * 1e6 / NumQueries, LinearSeconds * 1e6 / NumQueries, HeapSeconds > 0.0 ? LinearSeconds / HeapSeconds : 0.0,
+        (double)NodesExpanded / NumQueries, Search.GetStats().ScratchBytes / 1024.0);
+
+    // 4. FGridMap::FindPath 全流程（坐标转换 + 连通判断 + A* + 转回世界坐标）
+    {
+        const double StartTime = FPlatformTime::Seconds();
+        int32 NumFound = 0;
+        for (const FPathQuery& Query : Queries)
+        {
+            NumFound += Grid.FindPath(Grid.GridToWorld(Query.Start.X, Query.Start.Y), Grid.GridToWorld(Query.End.X, Query.End.Y)).Num() > 0 ? 1 : 0;
+        }
+        UE_LOG(LogTemp, Display, TEXT("FGridMap::FindPath: %.2fus/path, %d/%d found"),
+            (FPlatformTime::Seconds() - StartTime) * 1e6 / NumQueries, NumFound, Queries.Num());
+    }
+
+    // 5. 邻居扫描：整张图每个格子扫一遍四邻居
+    {
+        const int32 Passes = 16;
+        int64 NumNeighbors = 0;
+        const double StartTime = FPlatformTime::Seconds();
+        for (int32 Pass = 0; Pass < Passes; Pass++)
+        {
+            for (int32 Y = 0; Y < Size; Y++)
+            {
+                for (int32 X = 0; X < Size; X++)
+                {
+                    GridPathCore::ForEachWalkableNeighbor(View, X, Y, [&NumNeighbors](int32_t, int32_t) { NumNeighbors++; });
+                }
+            }
+        }
+        const double Seconds = FPlatformTime::Seconds() - StartTime;
+        UE_LOG(LogTemp, Display, TEXT("Neighbour scan: %.2fns/cell, %.2f walkable neighbours/cell"),
+            Seconds * 1e9 / ((double)Passes * Size * Size), (double)NumNeighbors / ((double)Passes * Size * Size));
+    }
+
+    // 6. 世界坐标 -> 格子坐标：和原来的 FMath::FloorToInt 逐个比较（含网格外和负坐标）
+    {
+        const int32 NumPoints = 1000000;
+        TArray<FVector> Points;
+        Points.Reserve(NumPoints);
+        const float Extent = Size * Grid.GetTileSize();
+        for (int32 i = 0; i < NumPoints; i++)
+        {
+            Points.Add(FVector(Random.FRandRange(-0.5f * Extent, 1.5f * Extent), Random.FRandRange(-0.5f * Extent, 1.5f * Extent), 0.0f));
+        }
+
+        int64 NumInside = 0;
+        int32 X, Y;
+        const double StartTime = FPlatformTime::Seconds();
+        for (const FVector& Point : Points)
+        {
+            NumInside += Grid.WorldToGrid(Point, X, Y) ? 1 : 0;
+        }
+        const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+        int32 ConversionMismatches = 0;
+        for (const FVector& Point : Points)
+        {
+            Grid.WorldToGrid(Point, X, Y);
+            const FVector Local = Point - Grid.GetOrigin();
+            if (X != FMath::FloorToInt(Local.X / Grid.GetTileSize()) || Y != FMath::FloorToInt(Local.Y / Grid.GetTileSize()))
+            {
+                ConversionMismatches++;
+            }
+        }
+        Mismatches += ConversionMismatches;
+
+        UE_LOG(LogTemp, Display, TEXT("WorldToGrid: %.2fns/point, %.1f%% walkable, %d mismatches against FMath::FloorToInt"),
+            Seconds * 1e9 / NumPoints, NumInside * 100.0 / NumPoints, ConversionMismatches);
+    }
+
+    if (Mismatches > 0)
+    {
+        UE_LOG(LogTemp, Error, TEXT("%d mismatches"), Mismatches);
+        return 1;
+    }
+    return 0;
+}
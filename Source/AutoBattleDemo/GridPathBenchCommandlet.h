@@ -0,0 +1,20 @@
+// GridPathBenchCommandlet.h：寻路核心（GridPathCore）的微基准
+// 用法：UE4Editor-Cmd AutoBattleDemo.uproject -run=GridPathBench [-size=256] [-obstacles=20] [-paths=1000] [-seed=1] [-costs] -nullrhi
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "GridPathBenchCommandlet.generated.h"
+
+UCLASS()
+class AUTOBATTLEDEMO_API UGridPathBenchCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UGridPathBenchCommandlet();
+
+    // 在随机网格上分别测 A*（二叉堆 / 线性扫描开放集）、邻居扫描和世界坐标转换，
+    // 两种 A* 的路径和搜索范围逐条比较，坐标转换和 FMath::FloorToInt 逐个比较，不一致返回 1
+    virtual int32 Main(const FString& Params) override;
+};
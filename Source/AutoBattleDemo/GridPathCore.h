@@ -0,0 +1,411 @@
+// GridPathCore.h：网格寻路的核心算法（只依赖 C++ 标准库，不包含任何 UE 头文件）
+// FGridMap 把节点数组交给这里搜索；离开引擎也能单独编译，拿去跑基准或者用 perf / valgrind 分析
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+namespace GridPathCore
+{
+    // 格子坐标
+    struct FCell
+    {
+        int32_t X;
+        int32_t Y;
+
+        bool operator==(const FCell& Other) const { return X == Other.X && Y == Other.Y; }
+        bool operator!=(const FCell& Other) const { return !(*this == Other); }
+    };
+
+    // 格子范围（Min 含、Max 不含）
+    struct FCellRect
+    {
+        int32_t MinX;
+        int32_t MinY;
+        int32_t MaxX;
+        int32_t MaxY;
+    };
+
+    /**
+     * 网格的只读视图：节点按行排列（下标 Y * Width + X）
+     * NodeT 只要有 bIsBlocked 和 Cost 两个成员就行，FGridNode 直接用，不用拷贝
+     */
+    template <typename NodeT>
+    struct TGridView
+    {
+        const NodeT* Nodes;
+        int32_t Width;
+        int32_t Height;
+
+        bool IsInBounds(int32_t X, int32_t Y) const { return X >= 0 && X < Width && Y >= 0 && Y < Height; }
+        bool IsWalkable(int32_t X, int32_t Y) const { return IsInBounds(X, Y) && !Nodes[Y * Width + X].bIsBlocked; }
+        float GetCost(int32_t X, int32_t Y) const { return Nodes[Y * Width + X].Cost; }
+    };
+
+    // 相对网格原点的坐标 -> 格子坐标（向下取整）；超出 int 范围或 NaN 时给 -1，一定在网格外
+    inline int32_t LocalToCell(float Local, float TileSize)
+    {
+        const float Scaled = std::floor(Local / TileSize);
+        if (!(Scaled >= -1073741824.0f && Scaled < 1073741824.0f)) return -1;
+        return (int32_t)Scaled;
+    }
+
+    // 启发式成本：曼哈顿距离，适用于四方向移动
+    inline float HeuristicCost(int32_t X1, int32_t Y1, int32_t X2, int32_t Y2)
+    {
+        return (float)(std::abs(X1 - X2) + std::abs(Y1 - Y2));
+    }
+
+    // 四方向邻居的扫描顺序（右、左、上、下），A* 遇到 F 值相同的节点时结果依赖这个顺序
+    const int32_t NeighborOffsets[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+
+    // 对每个可通行的邻居调用 Func(X, Y)
+    template <typename NodeT, typename FuncT>
+    inline void ForEachWalkableNeighbor(const TGridView<NodeT>& Grid, int32_t X, int32_t Y, FuncT&& Func)
+    {
+        for (const auto& Offset : NeighborOffsets)
+        {
+            const int32_t NewX = X + Offset[0];
+            const int32_t NewY = Y + Offset[1];
+            if (Grid.IsWalkable(NewX, NewY))
+            {
+                Func(NewX, NewY);
+            }
+        }
+    }
+
+    /**
+     * 优化路径：连续三个点在同一直线上时去掉中间点，只留起点、拐点和终点
+     * 原地修改（写入位置永远落后于读取位置）
+     */
+    inline void OptimizePath(std::vector<FCell>& Path)
+    {
+        const size_t NumPoints = Path.size();
+        if (NumPoints <= 2) return;
+
+        size_t NumKept = 1;
+        int32_t PrevDirX = Path[1].X - Path[0].X;
+        int32_t PrevDirY = Path[1].Y - Path[0].Y;
+        for (size_t i = 2; i < NumPoints; i++)
+        {
+            const int32_t DirX = Path[i].X - Path[i - 1].X;
+            const int32_t DirY = Path[i].Y - Path[i - 1].Y;
+            if (DirX != PrevDirX || DirY != PrevDirY)
+            {
+                Path[NumKept++] = Path[i - 1];
+                PrevDirX = DirX;
+                PrevDirY = DirY;
+            }
+        }
+        Path[NumKept++] = Path[NumPoints - 1];
+        Path.resize(NumKept);
+    }
+
+    // 开放集的实现（两种结果完全一样，线性扫描留作对照和基准）
+    enum class EOpenList : uint8_t
+    {
+        BinaryHeap,   // 二叉堆，取最小值 O(log n)
+        LinearScan    // 每次把开放集扫一遍，和最早的 TMap 实现逐步一致
+    };
+
+    struct FSearchStats
+    {
+        int32_t NodesExpanded = 0;   // 关闭集节点数
+        size_t ScratchBytes = 0;     // 搜索缓冲占的内存
+    };
+
+    /**
+     * A* 搜索（四方向，邻居成本 = 曼哈顿距离 x 邻居格子的 Cost）
+     *
+     * 结果和最早基于 TMap 的实现逐格一致：那一版每次取开放集里第一个 F 最小的节点，
+     * 遍历顺序就是 TMap 元素槽位的顺序，删掉的槽位按后进先出复用。这里照样分配槽位，
+     * F 相同的节点按槽位从小到大取，二叉堆和线性扫描选出的节点都一样
+     *
+     * 缓冲按格子数分配一次，之后每次搜索只换一个批次号，不清空；一个对象不能同时给两个线程用
+     */
+    class FPathSearch
+    {
+    public:
+        /**
+         * @param Start 起点（调用方保证可通行）
+         * @param End 终点（调用方保证可通行）
+         * @param OutPath 找到时是优化过的路径（含起点和终点），找不到时为空
+         * @param OutSearchBounds 找到时是这次搜索读过的格子的包围框（关闭集节点和它们的四邻居）
+         * @return 是否找到路径
+         */
+        template <typename NodeT>
+        bool FindPath(const TGridView<NodeT>& Grid, FCell Start, FCell End, std::vector<FCell>& OutPath,
+            FCellRect& OutSearchBounds, EOpenList InMode = EOpenList::BinaryHeap)
+        {
+            BeginSearch(Grid.Width * Grid.Height, InMode);
+            OutPath.clear();
+
+            const int32_t EndIndex = End.Y * Grid.Width + End.X;
+            FCellRect SearchBounds = {
+                Start.X < End.X ? Start.X : End.X,
+                Start.Y < End.Y ? Start.Y : End.Y,
+                (Start.X > End.X ? Start.X : End.X) + 1,
+                (Start.Y > End.Y ? Start.Y : End.Y) + 1
+            };
+
+            const int32_t StartIndex = Start.Y * Grid.Width + Start.X;
+            FCellState& StartState = Touch(StartIndex);
+            StartState.G = 0.0f;
+            StartState.H = 0.0f;
+            StartState.Parent = -1;
+            AddToOpen(StartIndex);
+
+            int32_t Current;
+            while (PopBest(Current))
+            {
+                // 到达终点，沿父节点回溯
+                if (Current == EndIndex)
+                {
+                    for (int32_t Index = Current; Index != -1; Index = Cells[Index].Parent)
+                    {
+                        OutPath.push_back({ Index % Grid.Width, Index / Grid.Width });
+                    }
+                    for (size_t i = 0, j = OutPath.size() - 1; i < j; i++, j--)
+                    {
+                        const FCell Temp = OutPath[i];
+                        OutPath[i] = OutPath[j];
+                        OutPath[j] = Temp;
+                    }
+                    OptimizePath(OutPath);
+
+                    OutSearchBounds = SearchBounds;
+                    UpdateScratchBytes();
+                    return true;
+                }
+
+                CloseNode(Current);
+                Stats.NodesExpanded++;
+
+                const int32_t CurrentX = Current % Grid.Width;
+                const int32_t CurrentY = Current / Grid.Width;
+                const float CurrentG = Cells[Current].G;
+                SearchBounds.MinX = ClampMin0(CurrentX - 1 < SearchBounds.MinX ? CurrentX - 1 : SearchBounds.MinX);
+                SearchBounds.MinY = ClampMin0(CurrentY - 1 < SearchBounds.MinY ? CurrentY - 1 : SearchBounds.MinY);
+                SearchBounds.MaxX = ClampMax(CurrentX + 2 > SearchBounds.MaxX ? CurrentX + 2 : SearchBounds.MaxX, Grid.Width);
+                SearchBounds.MaxY = ClampMax(CurrentY + 2 > SearchBounds.MaxY ? CurrentY + 2 : SearchBounds.MaxY, Grid.Height);
+
+                ForEachWalkableNeighbor(Grid, CurrentX, CurrentY, [&](int32_t NeighborX, int32_t NeighborY)
+                {
+                    const int32_t NeighborIndex = NeighborY * Grid.Width + NeighborX;
+                    FCellState& Neighbor = Touch(NeighborIndex);
+                    if (Neighbor.State == StateClosed) return;
+
+                    const float NewG = CurrentG + HeuristicCost(CurrentX, CurrentY, NeighborX, NeighborY) * Grid.GetCost(NeighborX, NeighborY);
+                    const bool bWasOpen = Neighbor.State == StateOpen;
+                    if (bWasOpen && NewG >= Neighbor.G) return;
+
+                    Neighbor.G = NewG;
+                    Neighbor.H = HeuristicCost(NeighborX, NeighborY, End.X, End.Y);
+                    Neighbor.Parent = Current;
+                    if (bWasOpen)
+                    {
+                        // 槽位不变，F 只会变小；旧的堆元素留着，弹出时按过期跳过
+                        PushHeap(NeighborIndex);
+                    }
+                    else
+                    {
+                        AddToOpen(NeighborIndex);
+                    }
+                });
+            }
+
+            UpdateScratchBytes();
+            return false;
+        }
+
+        // 最近一次搜索的统计
+        const FSearchStats& GetStats() const { return Stats; }
+
+    private:
+        enum : uint8_t
+        {
+            StateNone,
+            StateOpen,
+            StateClosed
+        };
+
+        struct FCellState
+        {
+            float G;            // 起点到这里的实际成本
+            float H;            // 到终点的预估成本
+            int32_t Parent;     // 父节点格子下标（-1 表示起点）
+            int32_t Slot;       // 在开放集里的槽位
+            uint32_t Batch;     // 不等于当前批次号说明这次搜索还没碰过
+            uint8_t State;
+        };
+
+        struct FHeapEntry
+        {
+            float F;
+            int32_t Slot;
+            int32_t Cell;
+
+            bool operator<(const FHeapEntry& Other) const
+            {
+                return F < Other.F || (F == Other.F && Slot < Other.Slot);
+            }
+        };
+
+        static int32_t ClampMin0(int32_t Value) { return Value < 0 ? 0 : Value; }
+        static int32_t ClampMax(int32_t Value, int32_t Max) { return Value > Max ? Max : Value; }
+
+        void BeginSearch(int32_t NumCells, EOpenList InMode)
+        {
+            Mode = InMode;
+            if ((int32_t)Cells.size() != NumCells)
+            {
+                Cells.assign(NumCells, FCellState());
+            }
+            // 批次号绕回 0 时把所有格子标成没碰过
+            if (++Batch == 0)
+            {
+                for (FCellState& Cell : Cells)
+                {
+                    Cell.Batch = 0;
+                }
+                Batch = 1;
+            }
+            Heap.clear();
+            SlotCells.clear();
+            FreeSlots.clear();
+            Stats = FSearchStats();
+        }
+
+        FCellState& Touch(int32_t Index)
+        {
+            FCellState& Cell = Cells[Index];
+            if (Cell.Batch != Batch)
+            {
+                Cell.Batch = Batch;
+                Cell.State = StateNone;
+            }
+            return Cell;
+        }
+
+        // 分配槽位：优先复用最近释放的（和 TSparseArray 的空闲链表一样后进先出）
+        void AddToOpen(int32_t Index)
+        {
+            FCellState& Cell = Cells[Index];
+            Cell.State = StateOpen;
+            if (!FreeSlots.empty())
+            {
+                Cell.Slot = FreeSlots.back();
+                FreeSlots.pop_back();
+                SlotCells[Cell.Slot] = Index;
+            }
+            else
+            {
+                Cell.Slot = (int32_t)SlotCells.size();
+                SlotCells.push_back(Index);
+            }
+            PushHeap(Index);
+        }
+
+        void CloseNode(int32_t Index)
+        {
+            FCellState& Cell = Cells[Index];
+            Cell.State = StateClosed;
+            SlotCells[Cell.Slot] = -1;
+            FreeSlots.push_back(Cell.Slot);
+        }
+
+        void PushHeap(int32_t Index)
+        {
+            if (Mode != EOpenList::BinaryHeap) return;
+
+            const FCellState& Cell = Cells[Index];
+            Heap.push_back({ Cell.G + Cell.H, Cell.Slot, Index });
+
+            // 上浮（最小堆）
+            size_t Child = Heap.size() - 1;
+            while (Child > 0)
+            {
+                const size_t Parent = (Child - 1) / 2;
+                if (!(Heap[Child] < Heap[Parent])) break;
+                const FHeapEntry Temp = Heap[Child];
+                Heap[Child] = Heap[Parent];
+                Heap[Parent] = Temp;
+                Child = Parent;
+            }
+        }
+
+        void PopHeapTop()
+        {
+            Heap[0] = Heap.back();
+            Heap.pop_back();
+
+            // 下沉
+            const size_t Num = Heap.size();
+            size_t Parent = 0;
+            for (;;)
+            {
+                const size_t Left = Parent * 2 + 1;
+                if (Left >= Num) break;
+                const size_t Right = Left + 1;
+                const size_t Smallest = Right < Num && Heap[Right] < Heap[Left] ? Right : Left;
+                if (!(Heap[Smallest] < Heap[Parent])) break;
+                const FHeapEntry Temp = Heap[Smallest];
+                Heap[Smallest] = Heap[Parent];
+                Heap[Parent] = Temp;
+                Parent = Smallest;
+            }
+        }
+
+        // 取出 F 最小的开放节点（F 相同取槽位小的），开放集为空返回 false
+        bool PopBest(int32_t& OutIndex)
+        {
+            if (Mode == EOpenList::LinearScan)
+            {
+                OutIndex = -1;
+                float BestF = 0.0f;
+                for (int32_t Index : SlotCells)
+                {
+                    if (Index == -1) continue;
+                    const float F = Cells[Index].G + Cells[Index].H;
+                    if (OutIndex == -1 || F < BestF)
+                    {
+                        OutIndex = Index;
+                        BestF = F;
+                    }
+                }
+                return OutIndex != -1;
+            }
+
+            while (!Heap.empty())
+            {
+                const FHeapEntry Top = Heap[0];
+                PopHeapTop();
+
+                // 已经关闭，或者 G 后来又变小了（有一份更新的元素）
+                const FCellState& Cell = Cells[Top.Cell];
+                if (Cell.State != StateOpen || Top.F != Cell.G + Cell.H) continue;
+
+                OutIndex = Top.Cell;
+                return true;
+            }
+            return false;
+        }
+
+        void UpdateScratchBytes()
+        {
+            Stats.ScratchBytes = Cells.capacity() * sizeof(FCellState) + Heap.capacity() * sizeof(FHeapEntry)
+                + (SlotCells.capacity() + FreeSlots.capacity()) * sizeof(int32_t);
+        }
+
+        std::vector<FCellState> Cells;
+        uint32_t Batch = 0;
+        EOpenList Mode = EOpenList::BinaryHeap;
+        std::vector<FHeapEntry> Heap;
+        std::vector<int32_t> SlotCells;   // 槽位 -> 格子下标（-1 表示空）
+        std::vector<int32_t> FreeSlots;   // 释放的槽位，末尾是最近释放的
+        FSearchStats Stats;
+    };
+}
@@ -0,0 +1,83 @@
+#include "PathCache.h"
+
+namespace
+{
+    bool RectsOverlap(const FIntRect& A, const FIntRect& B)
+    {
+        return A.Min.X < B.Max.X && B.Min.X < A.Max.X && A.Min.Y < B.Max.Y && B.Min.Y < A.Max.Y;
+    }
+}
+
+FPathCache::FPathCache(int32 InMaxEntries)
+    : MaxEntries(FMath::Max(InMaxEntries, 1))
+    , SyncedRevision(0)
+    , bSynced(false)
+    , Hits(0)
+    , Misses(0)
+    , Invalidated(0)
+{
+}
+
+void FPathCache::Reset()
+{
+    Entries.Reset();
+    bSynced = false;
+    Hits = Misses = Invalidated = 0;
+}
+
+void FPathCache::Sync(const FGridMap& Grid)
+{
+    if (bSynced && SyncedRevision == Grid.GetRevision()) return;
+
+    FIntRect DirtyRect;
+    if (!bSynced || !Grid.GetDirtyRectSince(SyncedRevision, DirtyRect))
+    {
+        Invalidated += Entries.Num();
+        Entries.Reset();
+    }
+    else if (DirtyRect.Area() > 0)
+    {
+        for (auto It = Entries.CreateIterator(); It; ++It)
+        {
+            if (RectsOverlap(It.Value().SearchBounds, DirtyRect))
+            {
+                It.RemoveCurrent();
+                Invalidated++;
+            }
+        }
+    }
+
+    SyncedRevision = Grid.GetRevision();
+    bSynced = true;
+}
+
+TArray<FVector> FPathCache::FindPath(const FGridMap& Grid, const FVector& StartWorldLoc, const FVector& EndWorldLoc)
+{
+    // 起终点不在网格里的请求不缓存（结果就是空路径）
+    int32 StartX, StartY, EndX, EndY;
+    Grid.WorldToGrid(StartWorldLoc, StartX, StartY);
+    Grid.WorldToGrid(EndWorldLoc, EndX, EndY);
+    if (!Grid.IsInBounds(StartX, StartY) || !Grid.IsInBounds(EndX, EndY))
+    {
+        return Grid.FindPath(StartWorldLoc, EndWorldLoc);
+    }
+
+    Sync(Grid);
+
+    const uint64 Key = ((uint64)(StartY * Grid.GetWidth() + StartX) << 32) | (uint32)(EndY * Grid.GetWidth() + EndX);
+    if (const FEntry* Entry = Entries.Find(Key))
+    {
+        Hits++;
+        return Entry->Path;
+    }
+
+    Misses++;
+    if (Entries.Num() >= MaxEntries)
+    {
+        Entries.Reset();
+    }
+
+    FEntry& Entry = Entries.Add(Key);
+    Entry.Path = Grid.FindPath(StartWorldLoc, EndWorldLoc, &Entry.SearchBounds);
+    return Entry.Path;
+}
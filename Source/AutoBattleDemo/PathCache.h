@@ -0,0 +1,42 @@
+// PathCache.h：按起终点格子缓存 A* 结果，网格改动时只丢掉受影响的条目
+// 每条记下这次搜索读过的格子范围；网格的脏矩形和它不相交，重新搜一遍的结果必然一样，
+// 所以开不开缓存，模拟结果逐位一致
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridMap.h"
+
+class AUTOBATTLEDEMO_API FPathCache
+{
+public:
+    explicit FPathCache(int32 InMaxEntries = 4096);
+
+    // 清空（换了一张网格时必须调用：版本号相同不代表内容相同）
+    void Reset();
+
+    // 和 FGridMap::FindPath 的结果一样；缓存里没有或已失效时才真正搜索
+    TArray<FVector> FindPath(const FGridMap& Grid, const FVector& StartWorldLoc, const FVector& EndWorldLoc);
+
+    int64 GetHits() const { return Hits; }
+    int64 GetMisses() const { return Misses; }
+    int64 GetInvalidated() const { return Invalidated; }
+
+private:
+    struct FEntry
+    {
+        TArray<FVector> Path;
+        FIntRect SearchBounds;
+    };
+
+    // 跟上网格的修改：只丢掉搜索范围和脏矩形相交的条目，修改记录接不上就全部丢掉
+    void Sync(const FGridMap& Grid);
+
+    int32 MaxEntries;
+    TMap<uint64, FEntry> Entries;   // 起点格子下标 << 32 | 终点格子下标
+    uint32 SyncedRevision;
+    bool bSynced;
+
+    int64 Hits;
+    int64 Misses;
+    int64 Invalidated;
+};
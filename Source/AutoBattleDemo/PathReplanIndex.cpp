@@ -0,0 +1,135 @@
+#include "PathReplanIndex.h"
+
+FPathReplanIndex::FPathReplanIndex()
+    : CellsX(0)
+    , CellsY(0)
+{
+}
+
+void FPathReplanIndex::Reset(int32 GridWidth, int32 GridHeight, int32 NumUnits)
+{
+    CellsX = FMath::Max((GridWidth + CellTiles - 1) / CellTiles, 1);
+    CellsY = FMath::Max((GridHeight + CellTiles - 1) / CellTiles, 1);
+
+    Cells.Reset();
+    Cells.SetNum(CellsX * CellsY);
+    Stamps.Reset();
+    Stamps.AddZeroed(NumUnits);
+    Blocked.Reset();
+}
+
+void FPathReplanIndex::AddToCell(int32 CellIndex, const FEntry& Entry)
+{
+    FCell& Cell = Cells[CellIndex];
+
+    // 同一条路径在一个粗格子里拐弯时只登记一次
+    if (Cell.Entries.Num() > 0 && Cell.Entries.Last().Unit == Entry.Unit && Cell.Entries.Last().Stamp == Entry.Stamp)
+    {
+        return;
+    }
+    Cell.Entries.Add(Entry);
+
+    // 作废条目多了就压缩；下次压缩的阈值跟着有效条目数翻倍，摊下来每次登记 O(1)
+    if (Cell.Entries.Num() >= Cell.CompactAt)
+    {
+        Cell.Entries.RemoveAll([this](const FEntry& Existing) { return !IsValid(Existing); });
+        Cell.CompactAt = FMath::Max(16, Cell.Entries.Num() * 2);
+    }
+}
+
+void FPathReplanIndex::RegisterPath(int32 UnitIndex, const TArray<FIntPoint>& Waypoints)
+{
+    if (!Stamps.IsValidIndex(UnitIndex)) return;
+
+    const FEntry Entry = { UnitIndex, ++Stamps[UnitIndex] };
+
+    for (int32 i = 0; i < Waypoints.Num(); i++)
+    {
+        // 寻路只走四方向，优化后的相邻路径点在同一行或同一列，包围框就是这一段经过的格子
+        const FIntPoint& From = Waypoints[i > 0 ? i - 1 : 0];
+        const FIntPoint& To = Waypoints[i];
+        const int32 MinX = FMath::Clamp(FMath::Min(From.X, To.X) / CellTiles, 0, CellsX - 1);
+        const int32 MaxX = FMath::Clamp(FMath::Max(From.X, To.X) / CellTiles, 0, CellsX - 1);
+        const int32 MinY = FMath::Clamp(FMath::Min(From.Y, To.Y) / CellTiles, 0, CellsY - 1);
+        const int32 MaxY = FMath::Clamp(FMath::Max(From.Y, To.Y) / CellTiles, 0, CellsY - 1);
+
+        for (int32 Y = MinY; Y <= MaxY; Y++)
+        {
+            for (int32 X = MinX; X <= MaxX; X++)
+            {
+                AddToCell(Y * CellsX + X, Entry);
+            }
+        }
+    }
+}
+
+void FPathReplanIndex::RegisterBlocked(int32 UnitIndex)
+{
+    if (!Stamps.IsValidIndex(UnitIndex)) return;
+
+    Blocked.Add({ UnitIndex, ++Stamps[UnitIndex] });
+}
+
+void FPathReplanIndex::Unregister(int32 UnitIndex)
+{
+    if (!Stamps.IsValidIndex(UnitIndex)) return;
+
+    ++Stamps[UnitIndex];
+}
+
+void FPathReplanIndex::CollectPathsInRect(const FIntRect& Rect, TArray<int32>& OutUnits) const
+{
+    if (Rect.Area() <= 0 || Cells.Num() == 0) return;
+
+    const int32 MinX = FMath::Clamp(Rect.Min.X / CellTiles, 0, CellsX - 1);
+    const int32 MaxX = FMath::Clamp((Rect.Max.X - 1) / CellTiles, 0, CellsX - 1);
+    const int32 MinY = FMath::Clamp(Rect.Min.Y / CellTiles, 0, CellsY - 1);
+    const int32 MaxY = FMath::Clamp((Rect.Max.Y - 1) / CellTiles, 0, CellsY - 1);
+
+    for (int32 Y = MinY; Y <= MaxY; Y++)
+    {
+        for (int32 X = MinX; X <= MaxX; X++)
+        {
+            for (const FEntry& Entry : Cells[Y * CellsX + X].Entries)
+            {
+                if (IsValid(Entry))
+                {
+                    OutUnits.Add(Entry.Unit);
+                }
+            }
+        }
+    }
+}
+
+void FPathReplanIndex::CollectAllPaths(TArray<int32>& OutUnits) const
+{
+    for (const FCell& Cell : Cells)
+    {
+        for (const FEntry& Entry : Cell.Entries)
+        {
+            if (IsValid(Entry))
+            {
+                OutUnits.Add(Entry.Unit);
+            }
+        }
+    }
+}
+
+void FPathReplanIndex::CollectBlocked(TArray<int32>& OutUnits)
+{
+    Blocked.RemoveAll([this](const FEntry& Entry) { return !IsValid(Entry); });
+    for (const FEntry& Entry : Blocked)
+    {
+        OutUnits.Add(Entry.Unit);
+    }
+}
+
+int32 FPathReplanIndex::GetNumEntries() const
+{
+    int32 Total = 0;
+    for (const FCell& Cell : Cells)
+    {
+        Total += Cell.Entries.Num();
+    }
+    return Total;
+}
@@ -0,0 +1,70 @@
+// PathReplanIndex.h：粗格子 -> 当前路径经过它的单位（反向索引），加上找不到路的单位
+// 城墙打掉或新挡住一块地时，只把路径经过那附近的单位和原本走不通的单位排队重新寻路，
+// 不用让全场单位一起重算
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * 路径反向索引
+ * 单位每次拿到新路径时登记一次，旧的登记靠版本戳作废（不用逐格删除），
+ * 某个粗格子里作废的条目积累到一定数量时就地压缩
+ */
+class AUTOBATTLEDEMO_API FPathReplanIndex
+{
+public:
+    // 粗格子边长（格子数）
+    static const int32 CellTiles = 4;
+
+    FPathReplanIndex();
+
+    // 按网格尺寸和单位数量清空
+    void Reset(int32 GridWidth, int32 GridHeight, int32 NumUnits);
+
+    /**
+     * 登记单位的新路径（之前的登记作废）
+     * @param UnitIndex 单位下标
+     * @param Waypoints 路径点的格子坐标；相邻两点之间按直线段登记，经过的粗格子都算
+     */
+    void RegisterPath(int32 UnitIndex, const TArray<FIntPoint>& Waypoints);
+
+    // 单位找不到路（之前的登记作废），网格变化后由调用方判断是否值得再试
+    void RegisterBlocked(int32 UnitIndex);
+
+    // 单位死亡或不再需要路径
+    void Unregister(int32 UnitIndex);
+
+    // 路径经过 Rect（格子坐标，Min 含、Max 不含）所在粗格子的单位，追加到 OutUnits（无序、可能重复）
+    void CollectPathsInRect(const FIntRect& Rect, TArray<int32>& OutUnits) const;
+
+    // 所有有效登记过路径的单位（修改记录接不上、只能全部重算时用）
+    void CollectAllPaths(TArray<int32>& OutUnits) const;
+
+    // 当前登记为走不通的单位，追加到 OutUnits；顺便丢掉已经作废的登记
+    void CollectBlocked(TArray<int32>& OutUnits);
+
+    // 所有粗格子里的条目数（含还没压缩掉的作废条目）
+    int32 GetNumEntries() const;
+
+private:
+    struct FEntry
+    {
+        int32 Unit;
+        uint32 Stamp;   // 登记时单位的版本戳，和 Stamps[Unit] 不同说明已经作废
+    };
+
+    struct FCell
+    {
+        TArray<FEntry> Entries;
+        int32 CompactAt = 16;   // 条目数达到这个值时压缩一次
+    };
+
+    bool IsValid(const FEntry& Entry) const { return Stamps[Entry.Unit] == Entry.Stamp; }
+    void AddToCell(int32 CellIndex, const FEntry& Entry);
+
+    int32 CellsX;
+    int32 CellsY;
+    TArray<FCell> Cells;
+    TArray<uint32> Stamps;   // 每个单位当前登记的版本戳
+    TArray<FEntry> Blocked;
+};
@@ -0,0 +1,43 @@
+#include "PerfCounters.h"
+
+int64 FPerfCounters::Values[FPerfCounters::NumCounters] = {};
+int32 FPerfCounters::NumViewers = 0;
+
+void FPerfCounters::AddViewer()
+{
+    // 第一个浮层打开时清掉上次留下的数
+    if (FPlatformAtomics::InterlockedIncrement(&NumViewers) == 1)
+    {
+        int64 Discard[NumCounters];
+        ReadAndReset(Discard);
+    }
+}
+
+void FPerfCounters::RemoveViewer()
+{
+    FPlatformAtomics::InterlockedDecrement(&NumViewers);
+}
+
+void FPerfCounters::Max(EPerfCounter Counter, int64 Value)
+{
+    if (!IsEnabled()) return;
+
+    int64* Target = &Values[(int32)Counter];
+    int64 Current = FPlatformAtomics::AtomicRead(Target);
+    while (Value > Current)
+    {
+        const int64 Previous = FPlatformAtomics::InterlockedCompareExchange(Target, Value, Current);
+        if (Previous == Current) break;
+        Current = Previous;
+    }
+}
+
+void FPerfCounters::ReadAndReset(int64 (&OutValues)[NumCounters])
+{
+    for (int32 i = 0; i < NumCounters; i++)
+    {
+        OutValues[i] = IsGauge((EPerfCounter)i)
+            ? FPlatformAtomics::AtomicRead(&Values[i])
+            : FPlatformAtomics::InterlockedExchange(&Values[i], 0);
+    }
+}
@@ -0,0 +1,111 @@
+// PerfCounters.h：游戏内性能浮层用的计数器（全局、无锁）
+// 只有浮层打开时才计数，关着的时候每个埋点只读一个标志；浮层按自己的刷新间隔读出并清零
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformTime.h"
+
+// Shipping 下计数器整个关掉（IsEnabled 恒为 false，埋点被编译器去掉）
+#ifndef AUTOBATTLE_PERF_COUNTERS
+#define AUTOBATTLE_PERF_COUNTERS !UE_BUILD_SHIPPING
+#endif
+
+enum class EPerfCounter : uint8
+{
+    Frames,                 // GameMode Tick 的帧数
+    SimSteps,               // 模拟步数
+    UnitsTicked,            // 跑过状态机的单位数
+    PathRequests,           // 实际调用 FindPath 的次数（缓存命中不算）
+    PathCycles,             // FindPath 的总耗时（CPU 周期）
+    PathMaxCycles,          // 单次 FindPath 的最长耗时（取最大值）
+    PathNodesExpanded,      // A* 关闭集节点数之和
+    TargetQueries,          // 索敌次数
+    DamageEvents,           // 结算的伤害事件数
+    LiveActors,             // 场上活着的实体（取当前值，不清零）
+    PooledActors,           // 阵亡后休眠等复用的 Actor（取当前值，不清零）
+
+    // 模拟各阶段和把结果同步到 Actor 的耗时（CPU 周期）
+    PhaseAvoidanceCycles,
+    PhaseProjectileCycles,
+    PhaseReplanCycles,
+    PhaseUnitCycles,
+    PhaseTowerCycles,
+    PhaseDamageCycles,
+    PhaseSyncCycles,
+
+    Count
+};
+
+class AUTOBATTLEDEMO_API FPerfCounters
+{
+public:
+    static const int32 NumCounters = (int32)EPerfCounter::Count;
+
+    // 有浮层在看时才计数
+    static bool IsEnabled()
+    {
+#if AUTOBATTLE_PERF_COUNTERS
+        return FPlatformAtomics::AtomicRead(&NumViewers) > 0;
+#else
+        return false;
+#endif
+    }
+
+    // 浮层打开 / 关闭时调用（可以有多个）
+    static void AddViewer();
+    static void RemoveViewer();
+
+    static void Add(EPerfCounter Counter, int64 Delta)
+    {
+        if (IsEnabled())
+        {
+            FPlatformAtomics::InterlockedAdd(&Values[(int32)Counter], Delta);
+        }
+    }
+
+    // 取最大值（比较交换，多个线程同时写也不会丢）
+    static void Max(EPerfCounter Counter, int64 Value);
+
+    // 当前值类的计数（LiveActors 这种）直接覆盖
+    static void Set(EPerfCounter Counter, int64 Value)
+    {
+        if (IsEnabled())
+        {
+            FPlatformAtomics::InterlockedExchange(&Values[(int32)Counter], Value);
+        }
+    }
+
+    // 读出所有计数，累计类的同时清零（当前值类的保留）
+    static void ReadAndReset(int64 (&OutValues)[NumCounters]);
+
+private:
+    static bool IsGauge(EPerfCounter Counter) { return Counter == EPerfCounter::LiveActors || Counter == EPerfCounter::PooledActors; }
+
+    static int64 Values[NumCounters];
+    static int32 NumViewers;
+};
+
+/**
+ * 作用域计时：构造时计数器关着就什么都不做
+ */
+class FPerfScopeCycles
+{
+public:
+    explicit FPerfScopeCycles(EPerfCounter InCounter)
+        : Counter(InCounter)
+        , StartCycles(FPerfCounters::IsEnabled() ? FPlatformTime::Cycles64() : 0)
+    {
+    }
+
+    ~FPerfScopeCycles()
+    {
+        if (StartCycles != 0)
+        {
+            FPerfCounters::Add(Counter, FPlatformTime::Cycles64() - StartCycles);
+        }
+    }
+
+private:
+    EPerfCounter Counter;
+    uint64 StartCycles;
+};
@@ -0,0 +1,115 @@
+#include "ProjectileSystem.h"
+
+void FProjectileSystem::Reset()
+{
+    PosX.Reset();
+    PosY.Reset();
+    PosZ.Reset();
+    VelX.Reset();
+    VelY.Reset();
+    VelZ.Reset();
+    TimeLeft.Reset();
+    Target.Reset();
+    Owner.Reset();
+    Team.Reset();
+    Damage.Reset();
+}
+
+void FProjectileSystem::Spawn(int32 OwnerIndex, ETeam OwnerTeam, const FVector& From, const FVector& To, float Speed, float InDamage)
+{
+    const FVector Delta = To - From;
+    const float Distance = Delta.Size();
+    const FVector Velocity = Distance > KINDA_SMALL_NUMBER ? Delta / Distance * Speed : FVector::ZeroVector;
+
+    PosX.Add(From.X);
+    PosY.Add(From.Y);
+    PosZ.Add(From.Z);
+    VelX.Add(Velocity.X);
+    VelY.Add(Velocity.Y);
+    VelZ.Add(Velocity.Z);
+    TimeLeft.Add(Speed > 0.0f ? Distance / Speed : 0.0f);
+    Target.Add(To);
+    Owner.Add(OwnerIndex);
+    Team.Add(OwnerTeam);
+    Damage.Add(InDamage);
+}
+
+void FProjectileSystem::Advance(float DeltaTime, TArray<FProjectileImpact>& OutImpacts)
+{
+    const int32 Count = PosX.Num();
+    if (Count == 0) return;
+
+    // 1. 统一推进位置和剩余时间
+    int32 i = 0;
+#if AUTOBATTLE_PROJECTILE_SIMD
+    const VectorRegister DeltaVec = VectorSetFloat1(DeltaTime);
+    for (; i + 4 <= Count; i += 4)
+    {
+        VectorStore(VectorMultiplyAdd(VectorLoad(&VelX[i]), DeltaVec, VectorLoad(&PosX[i])), &PosX[i]);
+        VectorStore(VectorMultiplyAdd(VectorLoad(&VelY[i]), DeltaVec, VectorLoad(&PosY[i])), &PosY[i]);
+        VectorStore(VectorMultiplyAdd(VectorLoad(&VelZ[i]), DeltaVec, VectorLoad(&PosZ[i])), &PosZ[i]);
+        VectorStore(VectorSubtract(VectorLoad(&TimeLeft[i]), DeltaVec), &TimeLeft[i]);
+    }
+#endif
+    for (; i < Count; i++)
+    {
+        PosX[i] += VelX[i] * DeltaTime;
+        PosY[i] += VelY[i] * DeltaTime;
+        PosZ[i] += VelZ[i] * DeltaTime;
+        TimeLeft[i] -= DeltaTime;
+    }
+
+    // 2. 落地的箭输出命中事件，其余的往前挪（保持发射顺序，结算顺序稳定）
+    int32 Write = 0;
+    for (int32 Read = 0; Read < Count; Read++)
+    {
+        if (TimeLeft[Read] <= 0.0f)
+        {
+            FProjectileImpact& Impact = OutImpacts.AddDefaulted_GetRef();
+            Impact.OwnerIndex = Owner[Read];
+            Impact.OwnerTeam = Team[Read];
+            Impact.Damage = Damage[Read];
+            Impact.Location = Target[Read];
+            continue;
+        }
+
+        if (Write != Read)
+        {
+            PosX[Write] = PosX[Read];
+            PosY[Write] = PosY[Read];
+            PosZ[Write] = PosZ[Read];
+            VelX[Write] = VelX[Read];
+            VelY[Write] = VelY[Read];
+            VelZ[Write] = VelZ[Read];
+            TimeLeft[Write] = TimeLeft[Read];
+            Target[Write] = Target[Read];
+            Owner[Write] = Owner[Read];
+            Team[Write] = Team[Read];
+            Damage[Write] = Damage[Read];
+        }
+        Write++;
+    }
+
+    if (Write != Count)
+    {
+        PosX.SetNum(Write, false);
+        PosY.SetNum(Write, false);
+        PosZ.SetNum(Write, false);
+        VelX.SetNum(Write, false);
+        VelY.SetNum(Write, false);
+        VelZ.SetNum(Write, false);
+        TimeLeft.SetNum(Write, false);
+        Target.SetNum(Write, false);
+        Owner.SetNum(Write, false);
+        Team.SetNum(Write, false);
+        Damage.SetNum(Write, false);
+    }
+}
+
+FArchive& operator<<(FArchive& Ar, FProjectileSystem& System)
+{
+    Ar << System.PosX << System.PosY << System.PosZ;
+    Ar << System.VelX << System.VelY << System.VelZ << System.TimeLeft;
+    Ar << System.Target << System.Owner << System.Team << System.Damage;
+    return Ar;
+}
@@ -0,0 +1,67 @@
+// ProjectileSystem.h：远程单位的弹道（箭矢）池
+// 飞行中的弹道按 SoA 连续存放，每步统一推进一次；不生成 Actor，显示交给 AUnitInstanceRenderer
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RTSCoreTypes.h"
+
+// 是否用 SSE/NEON 一次推进 4 支箭（关掉走标量循环）
+#ifndef AUTOBATTLE_PROJECTILE_SIMD
+#define AUTOBATTLE_PROJECTILE_SIMD 1
+#endif
+
+// 一支箭落地（由模拟器决定打中了谁）
+struct FProjectileImpact
+{
+    int32 OwnerIndex;   // 射手的实体下标
+    ETeam OwnerTeam;
+    float Damage;
+    FVector Location;   // 落点
+};
+
+/**
+ * 直线飞行、不追踪的弹道
+ * 发射时瞄准目标当时的位置，飞到后在落点附近结算命中，目标跑开了就会落空
+ */
+class AUTOBATTLEDEMO_API FProjectileSystem
+{
+public:
+    void Reset();
+
+    /**
+     * 发射一支箭
+     * @param OwnerIndex 射手的实体下标
+     * @param OwnerTeam 射手阵营（只会打中敌方）
+     * @param From 发射位置
+     * @param To 瞄准点
+     * @param Speed 飞行速度（cm/s）
+     * @param Damage 命中伤害
+     */
+    void Spawn(int32 OwnerIndex, ETeam OwnerTeam, const FVector& From, const FVector& To, float Speed, float Damage);
+
+    // 推进 DeltaTime，这一步落地的箭按发射顺序追加到 OutImpacts
+    void Advance(float DeltaTime, TArray<FProjectileImpact>& OutImpacts);
+
+    int32 Num() const { return PosX.Num(); }
+    FVector GetLocation(int32 Index) const { return FVector(PosX[Index], PosY[Index], PosZ[Index]); }
+    FVector GetVelocity(int32 Index) const { return FVector(VelX[Index], VelY[Index], VelZ[Index]); }
+
+    // 录像关键帧用
+    friend FArchive& operator<<(FArchive& Ar, FProjectileSystem& System);
+
+private:
+    // 位置和速度（SIMD 推进的部分）
+    TArray<float> PosX;
+    TArray<float> PosY;
+    TArray<float> PosZ;
+    TArray<float> VelX;
+    TArray<float> VelY;
+    TArray<float> VelZ;
+    TArray<float> TimeLeft;     // 距离落地还剩多少秒
+
+    // 落地时才用到的数据
+    TArray<FVector> Target;
+    TArray<int32> Owner;
+    TArray<ETeam> Team;
+    TArray<float> Damage;
+};
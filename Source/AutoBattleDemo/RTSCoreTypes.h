@@ -28,4 +28,77 @@ enum class EUnitType : uint8
     Soldier, // ս
     Archer,  // Զ
     Tank     // 
+};
+
+// ʱĿģӪ + ֱ
+UENUM(BlueprintType)
+enum class ETargetClass : uint8
+{
+    Unit,       // 
+    Defense,    // 
+    Wall,       // ǽ
+    Resource,   // Դʥˮռ
+    Building,   // Ӫȣ
+    Count UMETA(Hidden)
+};
+
+// ԴࣨԴĲҵĿ棩
+UENUM(BlueprintType)
+enum class EResourceType : uint8
+{
+    Gold,    // 
+    Elixir   // ʥˮ
+};
+
+// вԣ˳ĳĿ꣬ûپҪҪ
+USTRUCT(BlueprintType)
+struct FTargetingPolicy
+{
+    GENERATED_BODY()
+
+    // ȹ𣨿ǰȣձʾ˭˭
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Targeting")
+        TArray<ETargetClass> Priority;
+
+    // ȵ𶼴ԺǷĴĿ꣨false ԭش
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Targeting")
+        bool bFallbackToAny = true;
+
+    bool operator==(const FTargetingPolicy& Other) const
+    {
+        return Priority == Other.Priority && bFallbackToAny == Other.bFallbackToAny;
+    }
+
+    friend FArchive& operator<<(FArchive& Ar, FTargetingPolicy& Policy)
+    {
+        return Ar << Policy.Priority << Policy.bFallbackToAny;
+    }
+};
+
+// ʿ״̬ABaseUnit սģã
+UENUM()
+enum class EUnitState : uint8
+{
+    Idle,       // վ׮ս׶λĿ꣩
+    Moving,     // ·ƶ
+    Attacking   // 
+};
+
+// ʱһλãģ GridX/GridY êƫƣ
+USTRUCT(BlueprintType)
+struct FUnitPlacement
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+        EUnitType Type = EUnitType::Soldier;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+        int32 GridX = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+        int32 GridY = 0;
+
+    FUnitPlacement() {}
+    FUnitPlacement(EUnitType InType, int32 InGridX, int32 InGridY) : Type(InType), GridX(InGridX), GridY(InGridY) {}
 };
\ No newline at end of file
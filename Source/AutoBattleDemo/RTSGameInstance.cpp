@@ -1,4 +1,105 @@
 #include "RTSGameInstance.h"
+#include "Containers/Ticker.h"
 
-// û̫߼Ҫд cpp Ҫ .h 
-// Ҫʼ Init() дĬֵ .h ༭
\ No newline at end of file
+// Ĭֵ .h ༭䣬ֻб仯֪ͨԴȡ߼
+
+void URTSGameInstance::SetPlayerGold(int32 Value)
+{
+    if (PlayerGold == Value) return;
+    PlayerGold = Value;
+    MarkPlayerDataChanged(EPlayerDataChange::Gold);
+}
+
+void URTSGameInstance::SetPlayerElixir(int32 Value)
+{
+    if (PlayerElixir == Value) return;
+    PlayerElixir = Value;
+    MarkPlayerDataChanged(EPlayerDataChange::Elixir);
+}
+
+void URTSGameInstance::SetCurrentPopulation(int32 Value)
+{
+    if (CurrentPopulation == Value) return;
+    CurrentPopulation = Value;
+    MarkPlayerDataChanged(EPlayerDataChange::Population);
+}
+
+void URTSGameInstance::MarkPlayerDataChanged(int32 ChangedMask)
+{
+    if (ChangedMask == 0) return;
+
+    // һ֡һα仯ʱһֻһε Tickerûб仯֡ʲô
+    if (PendingPlayerDataChanges == 0)
+    {
+        PlayerDataFlushHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &URTSGameInstance::FlushPlayerDataChanges));
+    }
+    PendingPlayerDataChanges |= ChangedMask;
+}
+
+bool URTSGameInstance::FlushPlayerDataChanges(float DeltaTime)
+{
+    // ٹ㲥صٸݵĻŵһ֡
+    const int32 ChangedMask = PendingPlayerDataChanges;
+    PendingPlayerDataChanges = 0;
+    PlayerDataFlushHandle.Reset();
+
+    OnPlayerDataChanged.Broadcast(ChangedMask);
+    return false;
+}
+
+void URTSGameInstance::Shutdown()
+{
+    if (PlayerDataFlushHandle.IsValid())
+    {
+        FTicker::GetCoreTicker().RemoveTicker(PlayerDataFlushHandle);
+        PlayerDataFlushHandle.Reset();
+    }
+    PendingPlayerDataChanges = 0;
+
+    Super::Shutdown();
+}
+
+int64 URTSGameInstance::GetEconomyTimeMs()
+{
+    return FDateTime::UtcNow().GetTicks() / ETimespan::TicksPerMillisecond;
+}
+
+void URTSGameInstance::RegisterProducer(FName Id, EResourceType Type, int32 RatePerHour, int32 Capacity)
+{
+    Economy.AddProducer(Id, Type, RatePerHour, Capacity, GetEconomyTimeMs());
+}
+
+int32 URTSGameInstance::GetUncollected(EResourceType Type) const
+{
+    return (int32)FMath::Min<int64>(Economy.GetTotalStored(Type, GetEconomyTimeMs()), MAX_int32);
+}
+
+int32 URTSGameInstance::CollectAll(EResourceType Type)
+{
+    const int64 Amount = Economy.CollectAll(Type, GetEconomyTimeMs());
+    AddResource(Type, Amount);
+    return (int32)FMath::Min<int64>(Amount, MAX_int32);
+}
+
+int32 URTSGameInstance::CollectProducer(FName Id)
+{
+    const FResourceProducer* Producer = Economy.Find(Id);
+    if (!Producer) return 0;
+
+    const EResourceType Type = Producer->Type;
+    const int64 Amount = Economy.Collect(Id, GetEconomyTimeMs());
+    AddResource(Type, Amount);
+    return (int32)FMath::Min<int64>(Amount, MAX_int32);
+}
+
+void URTSGameInstance::AddResource(EResourceType Type, int64 Amount)
+{
+    if (Type == EResourceType::Gold)
+    {
+        SetPlayerGold((int32)FMath::Min<int64>((int64)PlayerGold + Amount, MAX_int32));
+    }
+    else
+    {
+        SetPlayerElixir((int32)FMath::Min<int64>((int64)PlayerElixir + Amount, MAX_int32));
+    }
+}
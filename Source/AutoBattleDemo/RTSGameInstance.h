@@ -1,8 +1,24 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "Engine/GameInstance.h"
+#include "ResourceEconomy.h"
 #include "RTSGameInstance.generated.h"
 
+// Щλ
+namespace EPlayerDataChange
+{
+    enum Type : int32
+    {
+        Gold = 1 << 0,
+        Elixir = 1 << 1,
+        Population = 1 << 2,
+        All = Gold | Elixir | Population
+    };
+}
+
+// ͬһ֡Ķ޸ĺϲһι㲥ChangedMask  EPlayerDataChange 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnPlayerDataChanged, int32, ChangedMask);
+
 UCLASS()
 class AUTOBATTLEDEMO_API URTSGameInstance : public UGameInstance
 {
@@ -13,6 +29,8 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Player Data")
         int32 CurrentLevelIndex;
 
+    // 漸ĵʱ SetPlayerGold ЩͼֱӸĵĻһ MarkPlayerDataChangedHUD յõ֪ͨ
+
     // ҳеĽ (ؿ) ()
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Player Data")
         int32 PlayerGold = 5000;
@@ -27,4 +45,57 @@ public:
 
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Player Data")
         int32 MaxPopulation = 20;
+
+    void SetPlayerGold(int32 Value);
+    void SetPlayerElixir(int32 Value);
+    void SetCurrentPopulation(int32 Value);
+
+    // Щݱˣһ֡ͳһ㲥һ
+    UFUNCTION(BlueprintCallable, Category = "Player Data")
+        void MarkPlayerDataChanged(int32 ChangedMask);
+
+    // ҡʥˮ˿ڱ仯ÿ֡һΣ
+    UPROPERTY(BlueprintAssignable, Category = "Player Data")
+        FOnPlayerDataChanged OnPlayerDataChanged;
+
+    //  OpenLevel ؿʱµʱ䣨¹ؿ GameMode غʱ0 ʾû
+    double RestartRequestTime = 0.0;
+
+    // --- Դʱ㣬 Tick ---
+
+    /**
+     * ǼԴ BeginPlay ʱãص֮ǰĹؿʱͬһ Id ԭļʱ
+     * @param Id йؿΨһؿ + Actor 
+     */
+    void RegisterProducer(FName Id, EResourceType Type, int32 RatePerHour, int32 Capacity);
+
+    // ĳԴнﻹûȡʵʱ㣩
+    UFUNCTION(BlueprintCallable, Category = "Economy")
+        int32 GetUncollected(EResourceType Type) const;
+
+    // ȡͬԴнӽҿ棬յ
+    UFUNCTION(BlueprintCallable, Category = "Economy")
+        int32 CollectAll(EResourceType Type);
+
+    // ȡһʱ
+    int32 CollectProducer(FName Id);
+
+    const FResourceEconomy& GetEconomy() const { return Economy; }
+
+    // õʱӣUTC 룬ؿлͣӰ
+    static int64 GetEconomyTimeMs();
+
+    virtual void Shutdown() override;
+
+private:
+    void AddResource(EResourceType Type, int64 Amount);
+
+    // һ֡ͷ FTicker ã㲥ı仯 falseֻһΣ
+    bool FlushPlayerDataChanges(float DeltaTime);
+
+    FResourceEconomy Economy;
+
+    // һ֡û㲥ı仯
+    int32 PendingPlayerDataChanges = 0;
+    FDelegateHandle PlayerDataFlushHandle;
 };
\ No newline at end of file
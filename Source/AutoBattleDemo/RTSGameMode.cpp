@@ -2,16 +2,78 @@
 #include "RTSPlayerController.h"
 #include "GridManager.h"
 #include "BaseUnit.h"
+#include "UnitInstanceRenderer.h"
+#include "FormationFile.h"
 #include "RTSGameInstance.h"
+#include "PerfCounters.h"
+#include "AutoBattleStats.h"
 #include "Kismet/GameplayStatics.h"
 #include "EngineUtils.h"
+#include "DrawDebugHelpers.h"
+#include "Misc/Paths.h"
+#include "HAL/PlatformTime.h"
 #include "Components/CapsuleComponent.h"	// 
 
+namespace
+{
+	// һ֡׷ϵģⲽʱսҲҪԽԽ׷
+	const int32 MaxSimulationStepsPerFrame = 8;
+}
+
 ARTSGameMode::ARTSGameMode()
 {
 	// ĬϿ
 	PlayerControllerClass = ARTSPlayerController::StaticClass();
 	CurrentState = EGameState::Preparation;
+
+	// ս׶ GameMode ƽģ
+	PrimaryActorTick.bCanEverTick = true;
+	SimulationTimeStep = 1.0f / 30.0f;
+	MaxBattleTime = 300.0f;
+	bSaveBattleSetupOnStart = true;
+	bUseInstancedRendering = false;
+	SimulationAccumulator = 0.0f;
+	InstanceRenderer = nullptr;
+	TeamAliveCounts[0] = TeamAliveCounts[1] = 0;
+	TeamRemainingHealth[0] = TeamRemainingHealth[1] = 0.0f;
+	bTeamCountsDirty = false;
+	LastBattleClockSecond = -1;
+	ProjectileMesh = nullptr;
+	UnitArchetypeTable = nullptr;
+	bFastRestart = true;
+	bRecordReplay = false;
+	bWritePerfReport = true;
+}
+
+void ARTSGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	// ֱֻһΣ Actor  BeginPlay ֮ǰλʱܲ鵽
+	const UEnum* UnitTypeEnum = StaticEnum<EUnitType>();
+	const int32 NumUnitTypes = (int32)EUnitType::Tank + 1;
+	UnitArchetypes.Reset(NumUnitTypes);
+	for (int32 Type = 0; Type < NumUnitTypes; Type++)
+	{
+		const FUnitArchetype* Row = nullptr;
+		if (UnitArchetypeTable)
+		{
+			const FName RowName(*UnitTypeEnum->GetNameStringByValue(Type));
+			Row = UnitArchetypeTable->FindRow<FUnitArchetype>(RowName, TEXT("UnitArchetypes"), false);
+		}
+		UnitArchetypes.Add(Row ? *Row : FUnitArchetype::MakeDefault((EUnitType)Type));
+	}
+}
+
+const FUnitArchetype& ARTSGameMode::GetUnitArchetype(EUnitType Type) const
+{
+	check(UnitArchetypes.IsValidIndex((int32)Type));
+	return UnitArchetypes[(int32)Type];
+}
+
+int32 ARTSGameMode::GetUnitCost(EUnitType Type) const
+{
+	return GetUnitArchetype(Type).Cost;
 }
 
 void ARTSGameMode::BeginPlay()
@@ -20,30 +82,277 @@ void ARTSGameMode::BeginPlay()
 
 	//  GridManagerÿһ֡ȥ
 	GridManager = Cast<AGridManager>(UGameplayStatics::GetActorOfClass(GetWorld(), AGridManager::StaticClass()));
+
+	// ˿ֻͳƱطµı½ʱ
+	URTSGameInstance* GI = Cast<URTSGameInstance>(GetGameInstance());
+	if (GI)
+	{
+		GI->SetCurrentPopulation(0);
+
+		// һ OpenLevel ؿģ¼ػ˶ãͿؿԱ
+		if (GI->RestartRequestTime > 0.0)
+		{
+			UE_LOG(LogTemp, Log, TEXT("Level restart (OpenLevel) took %.1f ms"), (FPlatformTime::Seconds() - GI->RestartRequestTime) * 1000.0);
+			GI->RestartRequestTime = 0.0;
+		}
+	}
 }
 
-bool ARTSGameMode::TryBuyUnit(EUnitType Type, int32 Cost, int32 GridX, int32 GridY)
+void ARTSGameMode::Tick(float DeltaSeconds)
 {
+	Super::Tick(DeltaSeconds);
+
+	if (PendingFootprints.Num() > 0)
+	{
+		ApplyPendingFootprints();
+	}
+
+	// һ֡ĳ/ϲһ֪ͨHUD ÿ֡
+	uint64 HudStartCycles = FPlatformTime::Cycles64();
+	BroadcastTeamCountsIfChanged();
+	uint64 HudCycles = FPlatformTime::Cycles64() - HudStartCycles;
+
+	// ܸ㣺ߵ Actor Ƕ
+	if (FPerfCounters::IsEnabled())
+	{
+		FPerfCounters::Add(EPerfCounter::Frames, 1);
+		FPerfCounters::Set(EPerfCounter::LiveActors, TeamAliveCounts[0] + TeamAliveCounts[1]);
+		FPerfCounters::Set(EPerfCounter::PooledActors, SimHandles.Num() - EntityRegistry.Num());
+	}
+
+	if (CurrentState != EGameState::Battle || !Simulation.IsValid()) return;
+
+	// ƽ֡ôģߵĲӶһܺͷģʽԵ
+	SimulationAccumulator += DeltaSeconds;
+	const float StepTime = Simulation->GetTimeStep();
+	int32 StepsThisFrame = 0;
+	while (SimulationAccumulator >= StepTime && !Simulation->IsFinished())
+	{
+		Simulation->Step();
+		SimulationAccumulator -= StepTime;
+
+		if (++StepsThisFrame >= MaxSimulationStepsPerFrame)
+		{
+			// ׷ϾͶѹʱ䣨ֻӰӰ
+			SimulationAccumulator = 0.0f;
+			break;
+		}
+	}
+
+	// սеʣѪģΪ׼ڽ˺ʱά
+	TeamRemainingHealth[(int32)ETeam::Player] = Simulation->GetTeamHealth(ETeam::Player);
+	TeamRemainingHealth[(int32)ETeam::Enemy] = Simulation->GetTeamHealth(ETeam::Enemy);
+
+	HudStartCycles = FPlatformTime::Cycles64();
+	{
+		FPerfScopeCycles Scope(EPerfCounter::PhaseSyncCycles);
+		ApplySimulationToActors();
+	}
+
+	const int32 BattleSecond = FMath::FloorToInt(Simulation->GetTime());
+	if (BattleSecond != LastBattleClockSecond)
+	{
+		LastBattleClockSecond = BattleSecond;
+		OnBattleClockChanged.Broadcast(BattleSecond);
+	}
+	HudCycles += FPlatformTime::Cycles64() - HudStartCycles;
+
+	if (PerfReport.IsActive())
+	{
+		RecordPerfFrame(DeltaSeconds, HudCycles);
+	}
+
+	if (Simulation->IsFinished())
+	{
+		// ¼ûܽģʱƽ֣߳ϼģԲϣģĽΪ׼ƽְûӮ
+		if (CurrentState == EGameState::Battle)
+		{
+			const EBattleOutcome Outcome = Simulation->GetResult().Outcome;
+			CurrentState = Outcome == EBattleOutcome::PlayerWins ? EGameState::Victory : EGameState::Defeat;
+
+			const bool bTimedOut = Simulation->GetTeamAliveCount(ETeam::Player) > 0 && Simulation->GetTeamAliveCount(ETeam::Enemy) > 0;
+			UE_LOG(LogTemp, Log, TEXT("Battle %s: %s"), bTimedOut ? TEXT("timed out") : TEXT("finished"), FBattleSimulation::OutcomeToString(Outcome));
+		}
+
+		// ģŲͷţؿһֱ Initڴ涼ܸ
+		Simulation->LogReport(TEXT("InGame"));
+		CSV_EVENT(AutoBattle, TEXT("BattleEnd %s"), FBattleSimulation::OutcomeToString(Simulation->GetResult().Outcome));
+		if (Recorder.IsValid())
+		{
+			SaveReplay(FString());
+		}
+
+		if (PerfReport.IsActive())
+		{
+			const FString ReportPath = GetDefaultPerfReportPath();
+			const bool bSaved = PerfReport.WriteJson(ReportPath + TEXT(".json")) && PerfReport.WriteCsv(ReportPath + TEXT(".csv"));
+			UE_LOG(LogTemp, Log, TEXT("Perf report %s: %s.json (%lld frames)"), bSaved ? TEXT("saved") : TEXT("save failed"),
+				*ReportPath, PerfReport.GetNumFrames());
+		}
+	}
+}
+
+void ARTSGameMode::RecordPerfFrame(float DeltaSeconds, uint64 HudCycles)
+{
+	uint64 SimCycles[(int32)ESimPhase::Count];
+	Simulation->ConsumePhaseTimings(SimCycles);
+
+	double PhaseMs[FBattlePerfReport::NumPhases];
+	PhaseMs[(int32)EBattlePerfPhase::Frame] = DeltaSeconds * 1000.0;
+	PhaseMs[(int32)EBattlePerfPhase::AI] = FPlatformTime::ToMilliseconds64(SimCycles[(int32)ESimPhase::AI]);
+	PhaseMs[(int32)EBattlePerfPhase::Pathfinding] = FPlatformTime::ToMilliseconds64(SimCycles[(int32)ESimPhase::Pathfinding]);
+	PhaseMs[(int32)EBattlePerfPhase::Movement] = FPlatformTime::ToMilliseconds64(SimCycles[(int32)ESimPhase::Movement]);
+	PhaseMs[(int32)EBattlePerfPhase::Combat] = FPlatformTime::ToMilliseconds64(SimCycles[(int32)ESimPhase::Combat]);
+	PhaseMs[(int32)EBattlePerfPhase::HUD] = FPlatformTime::ToMilliseconds64(HudCycles);
+
+	PerfReport.AddFrame(PhaseMs, TeamAliveCounts[0] + TeamAliveCounts[1]);
+}
+
+bool ARTSGameMode::TryBuyUnit(EUnitType Type, int32 GridX, int32 GridY)
+{
+    // ֻһλ򣬼۸ͬӱֱȡ
+    TArray<FUnitPlacement> Placements;
+    Placements.Add(FUnitPlacement(Type, GridX, GridY));
+    return TryBuyUnits(Placements);
+}
+
+bool ARTSGameMode::TryBuyUnits(const TArray<FUnitPlacement>& Placements)
+{
+    // ܼ۰ֱ
+    int32 TotalCost = 0;
+    for (const FUnitPlacement& Placement : Placements)
+    {
+        TotalCost += GetUnitCost(Placement.Type);
+    }
+    return BuyUnits(Placements, TotalCost);
+}
+
+bool ARTSGameMode::TryBuyFormation(const TArray<FUnitPlacement>& Template, int32 OriginX, int32 OriginY)
+{
+    // ģĸêƫ
+    TArray<FUnitPlacement> Placements;
+    Placements.Reserve(Template.Num());
+    for (const FUnitPlacement& Slot : Template)
+    {
+        Placements.Add(FUnitPlacement(Slot.Type, OriginX + Slot.GridX, OriginY + Slot.GridY));
+    }
+    return TryBuyUnits(Placements);
+}
+
+bool ARTSGameMode::BuyUnits(const TArray<FUnitPlacement>& Placements, int32 TotalCost)
+{
+    SCOPE_CYCLE_COUNTER(STAT_AutoBattle_TryBuyUnit);
     // 1. 
-    if (CurrentState != EGameState::Preparation) return false;
+    if (CurrentState != EGameState::Preparation || !GridManager || Placements.Num() == 0) return false;
 
-    // 2. 
+    // 2. Һ˿ڣһ㣩
     URTSGameInstance* GI = Cast<URTSGameInstance>(GetGameInstance());
     int32 CurrentGold = GI ? GI->PlayerGold : 9999;
 
-    if (CurrentGold < Cost)
+    if (CurrentGold < TotalCost)
     {
         UE_LOG(LogTemp, Warning, TEXT("Buy failed: Not enough gold"));
         return false;
     }
 
-    // 3. ѡͼ
-    TSubclassOf<ABaseUnit> SpawnClass = nullptr;
-    if (Type == EUnitType::Soldier) SpawnClass = SoldierClass;
-    else if (Type == EUnitType::Archer) SpawnClass = ArcherClass;
+    if (GI && GI->CurrentPopulation + Placements.Num() > GI->MaxPopulation)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Buy failed: Population limit (%d + %d > %d)"), GI->CurrentPopulation, Placements.Num(), GI->MaxPopulation);
+        return false;
+    }
+
+    // 3. ɣӼ鲻һʧܾϣʱûǮ
+    TArray<ABaseUnit*> NewUnits;
+    if (!SpawnUnitBatch(Placements, ETeam::Player, NewUnits))
+    {
+        return false;
+    }
+
+    // 4. Ǯ˿
+    if (GI)
+    {
+        GI->SetPlayerGold(GI->PlayerGold - TotalCost);
+        GI->SetCurrentPopulation(GI->CurrentPopulation + NewUnits.Num());
+    }
+    return true;
+}
+
+bool ARTSGameMode::SpawnUnitBatch(const TArray<FUnitPlacement>& Placements, ETeam Team, TArray<ABaseUnit*>& OutUnits)
+{
+    OutUnits.Reset();
+
+    // 1. ӣҪţͬһﲻظ
+    TSet<FIntPoint> Tiles;
+    Tiles.Reserve(Placements.Num());
+    for (const FUnitPlacement& Placement : Placements)
+    {
+        const FIntPoint Tile(Placement.GridX, Placement.GridY);
+        if (!GridManager->IsTileWalkable(Tile.X, Tile.Y) || Tiles.Contains(Tile))
+        {
+            UE_LOG(LogTemp, Warning, TEXT("Spawn failed: Tile (%d, %d) is not available"), Tile.X, Tile.Y);
+            return false;
+        }
+        Tiles.Add(Tile);
+    }
+
+    // 2. ӳɣȰ Actor úӪͱ֣BeginPlay ʱܶȷıֱ
+    OutUnits.Reserve(Placements.Num());
+    TMap<EUnitType, float> SpawnHeights;  // ͬһֻһθ߶
+    for (const FUnitPlacement& Placement : Placements)
+    {
+        TSubclassOf<ABaseUnit> SpawnClass = GetUnitClass(Placement.Type);
+        ABaseUnit* NewUnit = nullptr;
+        if (SpawnClass)
+        {
+            float* SpawnZOffset = SpawnHeights.Find(Placement.Type);
+            if (!SpawnZOffset)
+            {
+                SpawnZOffset = &SpawnHeights.Add(Placement.Type, GetSpawnHeightOffset(SpawnClass));
+            }
 
-    if (!SpawnClass || !GridManager) return false;
+            FVector SpawnLoc = GridManager->GridToWorld(Placement.GridX, Placement.GridY);
+            SpawnLoc.Z += *SpawnZOffset;
 
+            NewUnit = GetWorld()->SpawnActorDeferred<ABaseUnit>(SpawnClass, FTransform(SpawnLoc), nullptr, nullptr,
+                ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+        }
+
+        if (!NewUnit)
+        {
+            // һʧܾϣû BeginPlayӪ
+            for (ABaseUnit* Unit : OutUnits)
+            {
+                Unit->Destroy();
+            }
+            OutUnits.Reset();
+            UE_LOG(LogTemp, Warning, TEXT("Spawn failed: Cannot spawn unit type %d"), (int32)Placement.Type);
+            return false;
+        }
+
+        NewUnit->TeamID = Team;
+        NewUnit->UnitType = Placement.Type;
+        OutUnits.Add(NewUnit);
+    }
+
+    // 3. ύɡһռסи
+    for (ABaseUnit* Unit : OutUnits)
+    {
+        Unit->FinishSpawning(Unit->GetActorTransform());
+    }
+
+    GridManager->SetTilesBlocked(Tiles.Array(), true);
+    return true;
+}
+
+TSubclassOf<ABaseUnit> ARTSGameMode::GetUnitClass(EUnitType Type) const
+{
+    if (Type == EUnitType::Soldier) return SoldierClass;
+    if (Type == EUnitType::Archer) return ArcherClass;
+    return nullptr;
+}
+
+float ARTSGameMode::GetSpawnHeightOffset(TSubclassOf<ABaseUnit> SpawnClass) const
+{
     // ---------------------------------------------------------
     // ͨø߶ȼ ( Pawn  Character)
     // ---------------------------------------------------------
@@ -73,59 +382,652 @@ bool ARTSGameMode::TryBuyUnit(EUnitType Type, int32 Cost, int32 GridX, int32 Gri
             }
         }
     }
+    return SpawnZOffset;
+}
+
+void ARTSGameMode::StartBattlePhase()
+{
+	if (!GridManager) return;
 
-    // 4. 
-    FVector SpawnLoc = GridManager->GridToWorld(GridX, GridY);
-    SpawnLoc.Z += SpawnZOffset; // ʹĸ߶
+	CurrentState = EGameState::Battle;
 
-    // 5. 
-    FActorSpawnParameters SpawnParams;
-    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-    ABaseUnit* NewUnit = GetWorld()->SpawnActor<ABaseUnit>(SpawnClass, SpawnLoc, FRotator::ZeroRotator, SpawnParams);
-    if (NewUnit)
-    {
-        if (GI) GI->PlayerGold -= Cost;
-        NewUnit->TeamID = ETeam::Player;
-        GridManager->SetTileBlocked(GridX, GridY, true);
-        return true;
-    }
+	// ûüסĽռύֺͿﶼҪ
+	ApplyPendingFootprints();
+
+	// 1. õǰɲ
+	FBattleSetup Setup;
+	TArray<ABaseGameEntity*> SetupActors;
+	BuildBattleSetup(Setup, &SetupActors);
+
+	// ±ս׶ε״̬ؿʱԭػָ
+	CapturePreparationSnapshot(SetupActors);
+
+	if (bSaveBattleSetupOnStart)
+	{
+		Setup.SaveToFile(GetDefaultBattleSetupPath());
+	}
 
-    return false;
+	// 2. ģеλģĬϾǼ״̬
+	if (!Simulation.IsValid())
+	{
+		Simulation = MakeUnique<FBattleSimulation>();
+	}
+	Simulation->SetCollectEvents(true);
+	Simulation->SetCollectPhaseTimings(bWritePerfReport);
+
+	// ¼Ҫ Init ֮ǰϣֵĹؼ֡ Init 
+	if (bRecordReplay && !Recorder.IsValid())
+	{
+		Recorder = MakeUnique<FBattleRecorder>();
+	}
+	Simulation->SetRecorder(bRecordReplay ? Recorder.Get() : nullptr);
+	Simulation->Init(Setup);
+	SimulationAccumulator = 0.0f;
+	LastBattleClockSecond = -1;
+
+	if (bWritePerfReport)
+	{
+		PerfReport.Begin(UGameplayStatics::GetCurrentLevelName(this));
+	}
+
+	// 3. ÿʵActor סԼľ
+	EntityRegistry.Reset();
+	SimHandles.Reset(SetupActors.Num());
+	for (int32 i = 0; i < SetupActors.Num(); i++)
+	{
+		ABaseGameEntity* Entity = SetupActors[i];
+
+		FEntityRecord Record;
+		Record.Team = Entity->TeamID;
+		Record.Health = Entity->CurrentHealth;
+		Record.MaxHealth = Entity->MaxHealth;
+		Record.Position = Entity->GetActorLocation();
+		Record.Actor = Entity;
+		Record.SimEntityIndex = i;
+		SimHandles.Add(EntityRegistry.Add(Record));
+
+		ABaseUnit* Unit = Cast<ABaseUnit>(Entity);
+		if (Unit) Unit->EntityHandle = SimHandles[i];
+	}
+
+	// 4. ʵƣÿһΣλԼעʸҲʵ
+	if ((bUseInstancedRendering || ProjectileMesh) && !InstanceRenderer)
+	{
+		InstanceRenderer = GetWorld()->SpawnActor<AUnitInstanceRenderer>();
+		if (bUseInstancedRendering)
+		{
+			InstanceRenderer->SetUnitClass(EUnitType::Soldier, SoldierClass);
+			InstanceRenderer->SetUnitClass(EUnitType::Archer, ArcherClass);
+		}
+		InstanceRenderer->SetProjectileMesh(ProjectileMesh, nullptr);
+	}
+
+	if (InstanceRenderer)
+	{
+		for (ABaseGameEntity* Entity : SetupActors)
+		{
+			ABaseUnit* Unit = Cast<ABaseUnit>(Entity);
+			if (Unit && InstanceRenderer->HasUnitMesh(Unit->UnitType))
+			{
+				Unit->SetRenderedByInstances(true);
+			}
+		}
+		InstanceRenderer->UpdateInstances(Simulation->GetEntities());
+	}
+
+	// CSV ɼÿսֹ¼з־ÿķֽ׶κʱ
+	CSV_EVENT(AutoBattle, TEXT("BattleStart %d units"), Setup.Entities.Num());
+	UE_LOG(LogTemp, Log, TEXT("Battle Phase Started!"));
 }
 
-void ARTSGameMode::StartBattlePhase()
+void ARTSGameMode::SetSimEntityActive(FEntityHandle Handle, bool bActive)
 {
-	CurrentState = EGameState::Battle;
+	const FEntityRecord* Record = EntityRegistry.Find(Handle);
+	if (Record && Simulation.IsValid())
+	{
+		Simulation->SetEntityActive(Record->SimEntityIndex, bActive);
+	}
+}
+
+void ARTSGameMode::BuildBattleSetup(FBattleSetup& OutSetup, TArray<ABaseGameEntity*>* OutActors)
+{
+	OutSetup.Grid = GridManager->GetGridMap();
+	OutSetup.TimeStep = SimulationTimeStep;
+	OutSetup.MaxBattleTime = MaxBattleTime;
+	OutSetup.Avoidance = AvoidanceSettings;
+	OutSetup.DamageModifiers = DamageModifiers;
+	OutSetup.Entities.Reset();
+	if (OutActors) OutActors->Reset();
+
+	// лŵʵ壨ıؿڵĵ˺ͽ
+	for (TActorIterator<ABaseGameEntity> It(GetWorld()); It; ++It)
+	{
+		ABaseGameEntity* Entity = *It;
+		if (!Entity || Entity->IsPendingKill() || Entity->CurrentHealth <= 0) continue;
+
+		FSimEntitySpawn& Spawn = OutSetup.Entities.AddDefaulted_GetRef();
+		Spawn.Name = Entity->GetName();
+		Spawn.Team = Entity->TeamID;
+		Spawn.Location = Entity->GetActorLocation();
+		Spawn.MaxHealth = Entity->MaxHealth;
+
+		ABaseUnit* Unit = Cast<ABaseUnit>(Entity);
+		if (Unit)
+		{
+			// ԴӱֱȡļȻ棬ƽɨ赥ĳЩλ
+			const FUnitArchetype& Archetype = GetUnitArchetype(Unit->UnitType);
+			Spawn.bIsUnit = true;
+			Spawn.UnitType = Unit->UnitType;
+			Spawn.AttackRange = Archetype.AttackRange;
+			Spawn.Damage = Archetype.Damage;
+			Spawn.MoveSpeed = Archetype.MoveSpeed;
+			Spawn.AttackInterval = Archetype.AttackInterval;
+			Spawn.ProjectileSpeed = Archetype.ProjectileSpeed;
+			Spawn.SplashRadius = Archetype.SplashRadius;
+			Spawn.TargetClass = ETargetClass::Unit;
+			Spawn.Targeting = Archetype.Targeting;
+		}
+		else
+		{
+			// Ǳʵ岻ᶯ̺˺ǷģͳһУ
+			Spawn.bIsUnit = false;
+			Spawn.AttackRange = Entity->TowerRange;
+			Spawn.Damage = Entity->TowerRange > 0.0f ? Entity->TowerDamage : 0.0f;
+			Spawn.AttackInterval = Entity->TowerAttackInterval;
+			Spawn.SplashRadius = Entity->TowerSplashRadius;
+			Spawn.MoveSpeed = 0.0f;
+			Spawn.TargetClass = Spawn.Damage > 0.0f && Spawn.AttackRange > 0.0f ? ETargetClass::Defense : Entity->TargetClass;
+
+			// ռڱս׶Ѿˣģﵹʱÿ
+			if (Entity->FootprintSize.X > 0 && Entity->FootprintSize.Y > 0)
+			{
+				int32 GridX, GridY;
+				GetFootprintOrigin(Entity, GridX, GridY);
+				Spawn.Footprint = FIntRect(GridX, GridY, GridX + Entity->FootprintSize.X, GridY + Entity->FootprintSize.Y);
+			}
+		}
+
+		if (OutActors) OutActors->Add(Entity);
+	}
+}
+
+bool ARTSGameMode::SaveBattleSetup(const FString& FilePath)
+{
+	if (!GridManager) return false;
+
+	const FString SavePath = FilePath.IsEmpty() ? GetDefaultBattleSetupPath() : FilePath;
+
+	FBattleSetup Setup;
+	BuildBattleSetup(Setup);
 
-	// еλ AI
+	const bool bSaved = Setup.SaveToFile(SavePath);
+	UE_LOG(LogTemp, Log, TEXT("Battle setup %s: %s"), bSaved ? TEXT("saved") : TEXT("save failed"), *SavePath);
+	return bSaved;
+}
+
+FString ARTSGameMode::GetDefaultBattleSetupPath() const
+{
+	return FPaths::ProjectSavedDir() / TEXT("BattleSetups") / (UGameplayStatics::GetCurrentLevelName(this) + TEXT(".bsetup"));
+}
+
+bool ARTSGameMode::SaveFormation(const FString& FilePath)
+{
+	if (!GridManager || CurrentState != EGameState::Preparation) return false;
+
+	const FString SavePath = FilePath.IsEmpty() ? GetDefaultFormationPath() : FilePath;
+
+	// 1. 赲λͼ + γɱ
+	FFormationLayout Layout;
+	if (!Layout.CaptureGrid(GridManager->GetGridMap()))
+	{
+		return false;
+	}
+
+	// 2. ϵıռŵĸӼǳɿյģʱռס
 	for (TActorIterator<ABaseUnit> It(GetWorld()); It; ++It)
 	{
-		if (*It) (*It)->SetUnitActive(true);
+		ABaseUnit* Unit = *It;
+		if (!Unit || Unit->IsPendingKill()) continue;
+
+		int32 GridX, GridY;
+		GridManager->WorldToGrid(Unit->GetActorLocation(), GridX, GridY);
+		if (Layout.AddUnit(Unit->UnitType, Unit->TeamID, GridX, GridY))
+		{
+			Layout.SetBlocked(GridX, GridY, false);
+		}
 	}
 
-	UE_LOG(LogTemp, Log, TEXT("Battle Phase Started!"));
+	const bool bSaved = Layout.SaveToFile(SavePath);
+	UE_LOG(LogTemp, Log, TEXT("Formation %s: %s (%d units)"), bSaved ? TEXT("saved") : TEXT("save failed"), *SavePath, Layout.Units.Num());
+	return bSaved;
+}
+
+bool ARTSGameMode::LoadFormation(const FString& FilePath)
+{
+	if (!GridManager || CurrentState != EGameState::Preparation) return false;
+
+	const FString LoadPath = FilePath.IsEmpty() ? GetDefaultFormationPath() : FilePath;
+
+	FFormationLayout Layout;
+	if (!Layout.LoadFromFile(LoadPath))
+	{
+		return false;
+	}
+
+	// 1. Ӫ
+	TArray<FUnitPlacement> Placements[2];
+	for (const FFormationUnit& Unit : Layout.Units)
+	{
+		if (Unit.Team > (uint8)ETeam::Enemy || Unit.UnitType > (uint8)EUnitType::Tank) continue;
+		Placements[Unit.Team].Add(FUnitPlacement((EUnitType)Unit.UnitType, Unit.X, Unit.Y));
+	}
+
+	// 2. ֮ǰȰݲּһ飬оʲôģϵıҡ񶼱ԭ
+	URTSGameInstance* GI = Cast<URTSGameInstance>(GetGameInstance());
+	if (!CanApplyFormation(Layout, Placements[(int32)ETeam::Player], Placements[(int32)ETeam::Enemy]))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Formation %s: rejected, the board was left unchanged"), *LoadPath);
+		return false;
+	}
+
+	// 3. ϵıҵǮ˿ڣ
+	for (TActorIterator<ABaseUnit> It(GetWorld()); It; ++It)
+	{
+		ABaseUnit* Unit = *It;
+		if (!Unit || Unit->IsPendingKill()) continue;
+
+		if (GI && Unit->TeamID == ETeam::Player)
+		{
+			GI->SetPlayerGold(GI->PlayerGold + GetUnitCost(Unit->UnitType));
+			GI->SetCurrentPopulation(FMath::Max(GI->CurrentPopulation - 1, 0));
+		}
+		RemoveFromTeamCounts(Unit);
+		Unit->Destroy();
+	}
+
+	// 4. ؽӪһãֱɣҵıճ۽Һ˿
+	GridManager->LoadGridLayout(Layout);
+
+	TArray<ABaseUnit*> EnemyUnits;
+	if (Placements[(int32)ETeam::Enemy].Num() > 0 && !SpawnUnitBatch(Placements[(int32)ETeam::Enemy], ETeam::Enemy, EnemyUnits))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Formation %s: enemy units could not be placed"), *LoadPath);
+		return false;
+	}
+
+	if (Placements[(int32)ETeam::Player].Num() > 0 && !TryBuyUnits(Placements[(int32)ETeam::Player]))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Formation %s: player army could not be bought"), *LoadPath);
+		return false;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Formation loaded: %s (%dx%d, %d units)"), *LoadPath, Layout.Width, Layout.Height, Layout.Units.Num());
+	return true;
+}
+
+bool ARTSGameMode::CanApplyFormation(const FFormationLayout& Layout, const TArray<FUnitPlacement>& PlayerPlacements,
+	const TArray<FUnitPlacement>& EnemyPlacements) const
+{
+	// 1. ÿҪڲĿոϡͼӪ֮Ҳص
+	TSet<FIntPoint> Tiles;
+	Tiles.Reserve(PlayerPlacements.Num() + EnemyPlacements.Num());
+	for (const TArray<FUnitPlacement>* TeamPlacements : { &PlayerPlacements, &EnemyPlacements })
+	{
+		for (const FUnitPlacement& Placement : *TeamPlacements)
+		{
+			const FIntPoint Tile(Placement.GridX, Placement.GridY);
+			if (Placement.GridX < 0 || Placement.GridX >= Layout.Width || Placement.GridY < 0 || Placement.GridY >= Layout.Height
+				|| Layout.IsBlocked(Tile.X, Tile.Y) || Tiles.Contains(Tile))
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Formation: tile (%d, %d) is not available"), Tile.X, Tile.Y);
+				return false;
+			}
+			if (!GetUnitClass(Placement.Type))
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Formation: no class for unit type %d"), (int32)Placement.Type);
+				return false;
+			}
+			Tiles.Add(Tile);
+		}
+	}
+
+	// 2. ҵıϳЩ˻Ǯ˿ڣٿ
+	const URTSGameInstance* GI = Cast<URTSGameInstance>(GetGameInstance());
+	if (!GI) return true;
+
+	int32 Gold = GI->PlayerGold;
+	int32 Population = GI->CurrentPopulation;
+	for (TActorIterator<ABaseUnit> It(GetWorld()); It; ++It)
+	{
+		const ABaseUnit* Unit = *It;
+		if (Unit && !Unit->IsPendingKill() && Unit->TeamID == ETeam::Player)
+		{
+			Gold += GetUnitCost(Unit->UnitType);
+			Population = FMath::Max(Population - 1, 0);
+		}
+	}
+
+	int32 TotalCost = 0;
+	for (const FUnitPlacement& Placement : PlayerPlacements)
+	{
+		TotalCost += GetUnitCost(Placement.Type);
+	}
+
+	if (Gold < TotalCost || Population + PlayerPlacements.Num() > GI->MaxPopulation)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Formation: player army needs %d gold and %d population (have %d gold, %d/%d population after refunds)"),
+			TotalCost, PlayerPlacements.Num(), Gold, Population, GI->MaxPopulation);
+		return false;
+	}
+	return true;
+}
+
+bool ARTSGameMode::SaveReplay(const FString& FilePath)
+{
+	if (!Recorder.IsValid() || Recorder->GetSegments().Num() == 0) return false;
+
+	const FString SavePath = FilePath.IsEmpty() ? GetDefaultReplayPath() : FilePath;
+	const bool bSaved = Recorder->SaveToFile(SavePath);
+	UE_LOG(LogTemp, Log, TEXT("Replay %s: %s (%.1f KB, %lld events)"), bSaved ? TEXT("saved") : TEXT("save failed"),
+		*SavePath, Recorder->GetNumBytes() / 1024.0, Recorder->GetNumEvents());
+	return bSaved;
+}
+
+FString ARTSGameMode::GetDefaultReplayPath() const
+{
+	return FPaths::ProjectSavedDir() / TEXT("Replays") / (UGameplayStatics::GetCurrentLevelName(this) + TEXT(".abrp"));
+}
+
+FString ARTSGameMode::GetDefaultPerfReportPath() const
+{
+	return FPaths::ProjectSavedDir() / TEXT("Profiling") / TEXT("BattleReports") /
+		(UGameplayStatics::GetCurrentLevelName(this) + TEXT("-") + FDateTime::Now().ToString());
+}
+
+FString ARTSGameMode::GetDefaultFormationPath() const
+{
+	return FPaths::ProjectSavedDir() / TEXT("Formations") / (UGameplayStatics::GetCurrentLevelName(this) + TEXT(".abfm"));
+}
+
+void ARTSGameMode::ApplySimulationToActors()
+{
+	AUTOBATTLE_SCOPE_PHASE(STAT_AutoBattle_ApplySimulation, ApplySimulation);
+	TArray<int32> Deaths;
+	TArray<int32> PathUpdates;
+	Simulation->ConsumeEvents(Deaths, PathUpdates);
+
+	const TArray<FSimEntity>& SimEntities = Simulation->GetEntities();
+
+	// 1. ͬλáѪдд Actor
+	for (int32 i = 0; i < SimHandles.Num(); i++)
+	{
+		FEntityRecord* Record = EntityRegistry.Find(SimHandles[i]);
+		const FSimEntity& Entity = SimEntities[i];
+		if (!Record || !Entity.bAlive) continue;
+
+		Record->Health = Entity.CurrentHealth;
+		Record->Position = Entity.Location;
+
+		ABaseGameEntity* Actor = Record->Actor.Get();
+		if (!Actor) continue;
+
+		Actor->CurrentHealth = Entity.CurrentHealth;
+		if (Entity.bIsUnit)
+		{
+			Actor->SetActorLocationAndRotation(Entity.Location, Entity.Rotation);
+		}
+	}
+
+#if WITH_EDITOR
+	// 2. ԣʾ·
+	for (int32 Index : PathUpdates)
+	{
+		const TArray<FVector>& PathPoints = SimEntities[Index].PathPoints;
+		for (int32 i = 0; i + 1 < PathPoints.Num(); i++)
+		{
+			DrawDebugLine(GetWorld(), PathPoints[i], PathPoints[i + 1], FColor::Green, false, 2.0f, 0, 2.0f);
+		}
+	}
+#endif
+
+	// ʵƣеλı任һύ
+	if (InstanceRenderer)
+	{
+		InstanceRenderer->UpdateInstances(SimEntities);
+		InstanceRenderer->UpdateProjectiles(Simulation->GetProjectiles());
+	}
+
+	// 3. ģʵԭ̣֪ͨ GameMode ٣֮ʧЧ
+	for (int32 Index : Deaths)
+	{
+		FEntityRecord* Record = EntityRegistry.Find(SimHandles[Index]);
+		ABaseGameEntity* Actor = Record ? Record->Actor.Get() : nullptr;
+		EntityRegistry.Release(SimHandles[Index]);
+
+		if (Actor && !Actor->IsPendingKill())
+		{
+			// ԭ֪ͨ٣ؿʱֱӸ Actor
+			Actor->CurrentHealth = SimEntities[Index].CurrentHealth;
+			OnActorKilled(Actor, nullptr);
+			Actor->SetDormant(true);
+		}
+
+		// ǽ£ģóռأؿʱɱսջָ
+		const FIntRect& Footprint = SimEntities[Index].Footprint;
+		if (Footprint.Area() > 0 && GridManager)
+		{
+			GridManager->SetFootprintBlocked(Footprint.Min.X, Footprint.Min.Y, Footprint.Width(), Footprint.Height(), false);
+		}
+	}
 }
 
 void ARTSGameMode::RestartLevel()
 {
+	// ؿԭػָսǰعؿ
+	if (bFastRestart && CurrentState != EGameState::Preparation)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		if (RestorePreparationSnapshot())
+		{
+			UE_LOG(LogTemp, Log, TEXT("Level restart (in place) took %.3f ms"), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+			return;
+		}
+	}
+
+	URTSGameInstance* GI = Cast<URTSGameInstance>(GetGameInstance());
+	if (GI) GI->RestartRequestTime = FPlatformTime::Seconds();
+
 	// ¼صǰؿ
 	UGameplayStatics::OpenLevel(this, FName(*GetWorld()->GetName()), false);
 }
 
+void ARTSGameMode::CapturePreparationSnapshot(const TArray<ABaseGameEntity*>& Entities)
+{
+	PreparationSnapshot.Grid = GridManager->GetGridMap();
+
+	PreparationSnapshot.Entities.Reset(Entities.Num());
+	for (ABaseGameEntity* Entity : Entities)
+	{
+		FPreparationSnapshot::FEntityState& State = PreparationSnapshot.Entities.AddDefaulted_GetRef();
+		State.Actor = Entity;
+		State.Transform = Entity->GetActorTransform();
+		State.Health = Entity->CurrentHealth;
+	}
+
+	URTSGameInstance* GI = Cast<URTSGameInstance>(GetGameInstance());
+	PreparationSnapshot.PlayerGold = GI ? GI->PlayerGold : 0;
+	PreparationSnapshot.PlayerElixir = GI ? GI->PlayerElixir : 0;
+	PreparationSnapshot.CurrentPopulation = GI ? GI->CurrentPopulation : 0;
+
+	for (int32 Team = 0; Team < 2; Team++)
+	{
+		PreparationSnapshot.TeamAliveCounts[Team] = TeamAliveCounts[Team];
+		PreparationSnapshot.TeamRemainingHealth[Team] = TeamRemainingHealth[Team];
+	}
+	PreparationSnapshot.bValid = true;
+}
+
+bool ARTSGameMode::RestorePreparationSnapshot()
+{
+	if (!PreparationSnapshot.bValid || !GridManager) return false;
+
+	// 1.  Actor һûˣ类ͼ٣ûԭػָ OpenLevel
+	for (const FPreparationSnapshot::FEntityState& State : PreparationSnapshot.Entities)
+	{
+		if (!State.Actor.IsValid()) return false;
+	}
+
+	// 2. ͣսģţһã
+	CurrentState = EGameState::Preparation;
+	SimulationAccumulator = 0.0f;
+	LastBattleClockSecond = -1;
+	EntityRegistry.Reset();
+	SimHandles.Reset();
+	if (InstanceRenderer)
+	{
+		InstanceRenderer->ClearInstances();
+	}
+
+	// 3. ʵصսǰλúѪʾ
+	for (const FPreparationSnapshot::FEntityState& State : PreparationSnapshot.Entities)
+	{
+		ABaseGameEntity* Entity = State.Actor.Get();
+		Entity->SetActorTransform(State.Transform);
+		Entity->CurrentHealth = State.Health;
+		Entity->SetDormant(false);
+
+		ABaseUnit* Unit = Cast<ABaseUnit>(Entity);
+		if (Unit)
+		{
+			Unit->EntityHandle = FEntityHandle();
+			Unit->SetRenderedByInstances(false);
+		}
+	}
+
+	// 4. ֻбĹſȥûĹĻ汾ŵĻ涼Ч
+	GridManager->RestoreGridMap(PreparationSnapshot.Grid);
+
+	// 5. ҡʥˮ˿ںӪ
+	URTSGameInstance* GI = Cast<URTSGameInstance>(GetGameInstance());
+	if (GI)
+	{
+		GI->SetPlayerGold(PreparationSnapshot.PlayerGold);
+		GI->SetPlayerElixir(PreparationSnapshot.PlayerElixir);
+		GI->SetCurrentPopulation(PreparationSnapshot.CurrentPopulation);
+	}
+
+	for (int32 Team = 0; Team < 2; Team++)
+	{
+		TeamAliveCounts[Team] = PreparationSnapshot.TeamAliveCounts[Team];
+		TeamRemainingHealth[Team] = PreparationSnapshot.TeamRemainingHealth[Team];
+	}
+	bTeamCountsDirty = true;
+	OnBattleClockChanged.Broadcast(0);
+	OnPreparationRestored.Broadcast();
+	return true;
+}
+
 void ARTSGameMode::OnActorKilled(AActor* Victim, AActor* Killer)
 {
 	if (!Victim) return;
 
 	UE_LOG(LogTemp, Log, TEXT("Actor Killed: %s"), *Victim->GetName());
 
+	// Ӫ
+	RemoveFromTeamCounts(Cast<ABaseGameEntity>(Victim));
+
 	// ʤ
 	CheckWinCondition();
 }
 
+void ARTSGameMode::RemoveFromTeamCounts(ABaseGameEntity* Entity)
+{
+	if (!Entity) return;
+
+	const int32 Team = (int32)Entity->TeamID;
+	TeamAliveCounts[Team] = FMath::Max(TeamAliveCounts[Team] - 1, 0);
+	TeamRemainingHealth[Team] = FMath::Max(TeamRemainingHealth[Team] - FMath::Max(Entity->CurrentHealth, 0.0f), 0.0f);
+	bTeamCountsDirty = true;
+}
+
+void ARTSGameMode::BroadcastTeamCountsIfChanged()
+{
+	if (!bTeamCountsDirty) return;
+
+	bTeamCountsDirty = false;
+	OnTeamCountsChanged.Broadcast();
+}
+
+void ARTSGameMode::OnEntitySpawned(ABaseGameEntity* Entity)
+{
+	if (!Entity) return;
+
+	const int32 Team = (int32)Entity->TeamID;
+	TeamAliveCounts[Team]++;
+	TeamRemainingHealth[Team] += Entity->CurrentHealth;
+	bTeamCountsDirty = true;
+
+	// ڹʱѾռ˸ӣռصĽ׼Ժ鵲ס
+	if (!Cast<ABaseUnit>(Entity) && Entity->FootprintSize.X > 0 && Entity->FootprintSize.Y > 0)
+	{
+		PendingFootprints.Add(Entity);
+	}
+}
+
+void ARTSGameMode::GetFootprintOrigin(const ABaseGameEntity* Entity, int32& OutGridX, int32& OutGridY) const
+{
+	const float TileSize = GridManager->GetGridMap().GetTileSize();
+	const FIntPoint Size = Entity->FootprintSize;
+	const FVector Corner = Entity->GetActorLocation() - FVector((Size.X - 1) * TileSize * 0.5f, (Size.Y - 1) * TileSize * 0.5f, 0.0f);
+
+	// ӱռʱ WorldToGrid  false
+	GridManager->WorldToGrid(Corner, OutGridX, OutGridY);
+}
+
+void ARTSGameMode::ApplyPendingFootprints()
+{
+	if (!GridManager) return;
+
+	for (const TWeakObjectPtr<ABaseGameEntity>& Ptr : PendingFootprints)
+	{
+		ABaseGameEntity* Entity = Ptr.Get();
+		if (!Entity || Entity->IsPendingKill()) continue;
+
+		int32 GridX, GridY;
+		GetFootprintOrigin(Entity, GridX, GridY);
+		if (!GridManager->SetFootprintBlocked(GridX, GridY, Entity->FootprintSize.X, Entity->FootprintSize.Y, true))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("%s: footprint %dx%d at (%d, %d) is outside the grid"),
+				*Entity->GetName(), Entity->FootprintSize.X, Entity->FootprintSize.Y, GridX, GridY);
+		}
+	}
+	PendingFootprints.Reset();
+}
+
+int32 ARTSGameMode::GetTeamAliveCount(ETeam Team) const
+{
+	return TeamAliveCounts[(int32)Team];
+}
+
+float ARTSGameMode::GetTeamRemainingHealth(ETeam Team) const
+{
+	return TeamRemainingHealth[(int32)Team];
+}
+
 void ARTSGameMode::CheckWinCondition()
 {
-	// ʾ߼
-	// 1. ͳƳϻʣٵ
-	// 2. ͳƳϻʣҵλ
-	// 3. ĳһΪ 0 FinishGame()
+	// ֻս׶жս׶ɾ㣩
+	if (CurrentState != EGameState::Battle) return;
+
+	// һ˵µһ֡ͽ㣻ͬھʧ
+	if (TeamAliveCounts[(int32)ETeam::Player] == 0)
+	{
+		CurrentState = EGameState::Defeat;
+		UE_LOG(LogTemp, Log, TEXT("Defeat!"));
+	}
+	else if (TeamAliveCounts[(int32)ETeam::Enemy] == 0)
+	{
+		CurrentState = EGameState::Victory;
+		UE_LOG(LogTemp, Log, TEXT("Victory!"));
+	}
 }
\ No newline at end of file
@@ -3,8 +3,22 @@
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
 #include "RTSCoreTypes.h"
+#include "BattleSimulation.h"
+#include "BattleReplay.h"
+#include "BattlePerfReport.h"
+#include "EntityRegistry.h"
+#include "UnitArchetype.h"
 #include "RTSGameMode.generated.h"
 
+// Ӫ仯ͬһ֡Ķα仯ϲһΣ
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnTeamCountsChanged);
+
+// սʱÿһ㲥һ
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnBattleClockChanged, int32, ElapsedSeconds);
+
+// ؿѳָ˿սǰUI Ҫѱս׶εİťʾ
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnPreparationRestored);
+
 UCLASS()
 class AUTOBATTLEDEMO_API ARTSGameMode : public AGameModeBase
 {
@@ -12,19 +26,29 @@ class AUTOBATTLEDEMO_API ARTSGameMode : public AGameModeBase
 
 public:
 	ARTSGameMode();
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
 	virtual void BeginPlay() override;
+	virtual void Tick(float DeltaSeconds) override;
 
 	// --- ̿ API ( UI ) ---
 
-	// 1. Թ򲢷õλ (ע⣺ﲹȫ GridX  GridY )
+	// 1. Թ򲢷õλ۸񰴱ֱ㣬һ£
+	UFUNCTION(BlueprintCallable, Category = "GameFlow")
+		bool TryBuyUnit(EUnitType Type, int32 GridX, int32 GridY);
+
+	// 1.1 һһͣҡ˿ڡȫͨɣһ
 	UFUNCTION(BlueprintCallable, Category = "GameFlow")
-		bool TryBuyUnit(EUnitType Type, int32 Cost, int32 GridX, int32 GridY);
+		bool TryBuyUnits(const TArray<FUnitPlacement>& Placements);
+
+	// 1.2 ģ幺ģ Origin ƫƣ
+	UFUNCTION(BlueprintCallable, Category = "GameFlow")
+		bool TryBuyFormation(const TArray<FUnitPlacement>& Template, int32 OriginX, int32 OriginY);
 
 	// 2. ҵʼս
 	UFUNCTION(BlueprintCallable, Category = "GameFlow")
 		void StartBattlePhase();
 
-	// 3. ¿ʼ
+	// 3. ¿ʼأ bFastRestart ʱԭػָսǰ¼عؿ
 	UFUNCTION(BlueprintCallable, Category = "GameFlow")
 		void RestartLevel();
 
@@ -33,9 +57,68 @@ public:
 	// 4. λʱô˺ (ղűȱٵĺ)
 	void OnActorKilled(AActor* Victim, AActor* Killer);
 
-	// 5. Ƿʤ
+	// 5. ǷʤֻӪO(1)
 	void CheckWinCondition();
 
+	// ʵʱǼǵӪABaseGameEntity::BeginPlay ã
+	void OnEntitySpawned(class ABaseGameEntity* Entity);
+
+	// --- ֱ ---
+
+	// ȡԣInitGame ʱ UnitArchetypeTable ãûıĬֵ
+	const FUnitArchetype& GetUnitArchetype(EUnitType Type) const;
+
+	// ̵۸񣨸 UI ʾã
+	UFUNCTION(BlueprintPure, Category = "Units")
+		int32 GetUnitCost(EUnitType Type) const;
+
+	// --- ӪͳƣάHUD ֱӶñ Actor ---
+
+	UFUNCTION(BlueprintPure, Category = "GameFlow")
+		int32 GetTeamAliveCount(ETeam Team) const;
+
+	UFUNCTION(BlueprintPure, Category = "GameFlow")
+		float GetTeamRemainingHealth(ETeam Team) const;
+
+	// HUD ¼ÿ֡ȥ
+	UPROPERTY(BlueprintAssignable, Category = "GameFlow")
+		FOnTeamCountsChanged OnTeamCountsChanged;
+
+	UPROPERTY(BlueprintAssignable, Category = "GameFlow")
+		FOnBattleClockChanged OnBattleClockChanged;
+
+	UPROPERTY(BlueprintAssignable, Category = "GameFlow")
+		FOnPreparationRestored OnPreparationRestored;
+
+	// --- սģ ---
+
+	// Ӧ ABaseUnit::SetUnitActive
+	void SetSimEntityActive(FEntityHandle Handle, bool bActive);
+
+	// սʵľHUDȰӪ/Ѫ/λã Actor
+	const FEntityRegistry& GetEntityRegistry() const { return EntityRegistry; }
+
+	// õǰϰеλһս֣ͷģľ
+	// OutActors ʵ˳򷵻ضӦ Actorѡ
+	void BuildBattleSetup(FBattleSetup& OutSetup, TArray<class ABaseGameEntity*>* OutActors = nullptr);
+
+	// ѵǰִ̣Ĭϴ浽 Saved/BattleSetups/<ͼ>.bsetup
+	UFUNCTION(BlueprintCallable, Category = "GameFlow")
+		bool SaveBattleSetup(const FString& FilePath);
+
+	// /ļ + ˫λİڷţĬ Saved/Formations/<ͼ>.abfmֻڱս׶
+	// ȡ滻еλֱɣҵı TryBuyUnitsԭеıǮ
+	// ַŲ£ӱռԽ磩Ǯ֮ʱ falseʲô
+	UFUNCTION(BlueprintCallable, Category = "GameFlow")
+		bool SaveFormation(const FString& FilePath);
+
+	UFUNCTION(BlueprintCallable, Category = "GameFlow")
+		bool LoadFormation(const FString& FilePath);
+
+	// ѵǰսģս¼̣Ĭ Saved/Replays/<ͼ>.abrp -run=BattleReplay ط
+	UFUNCTION(BlueprintCallable, Category = "GameFlow")
+		bool SaveReplay(const FString& FilePath);
+
 protected:
 	// ǰϷ״̬
 	UPROPERTY(BlueprintReadOnly, Category = "GameFlow")
@@ -51,4 +134,160 @@ protected:
 
 	UPROPERTY(EditDefaultsOnly, Category = "Classes")
 		TSubclassOf<class ABaseUnit> ArcherClass;
+
+	// Աнṹ FUnitArchetypeΪ
+	UPROPERTY(EditDefaultsOnly, Category = "Units")
+		class UDataTable* UnitArchetypeTable;
+
+	// սģĶ룩ļͷģʽͬĲ
+	UPROPERTY(EditDefaultsOnly, Category = "Simulation")
+		float SimulationTimeStep;
+
+	// ʱƽ
+	UPROPERTY(EditDefaultsOnly, Category = "Simulation")
+		float MaxBattleTime;
+
+	// λ֮ķãֹһš·ڷѰ·
+	UPROPERTY(EditDefaultsOnly, Category = "Simulation")
+		FCrowdAvoidanceSettings AvoidanceSettings;
+
+	// ֿƣûϰ 1 ˺
+	UPROPERTY(EditDefaultsOnly, Category = "Simulation")
+		TArray<FDamageModifier> DamageModifiers;
+
+	// սʱԶ沼֣ȥͷģ
+	UPROPERTY(EditDefaultsOnly, Category = "Simulation")
+		bool bSaveBattleSetupOnStart;
+
+	// ¼ÿսؼ֡ + ¼ڻλսʱԶ
+	UPROPERTY(EditDefaultsOnly, Category = "Simulation")
+		bool bRecordReplay;
+
+	// ÿսͳ֡ʱ֡СѰ·ƶսHUDʱд Saved/Profiling/BattleReports
+	UPROPERTY(EditDefaultsOnly, Category = "Simulation")
+		bool bWritePerfReport;
+
+	// ս׶ʵƵλλܶʱѻѹλ
+	UPROPERTY(EditDefaultsOnly, Category = "Rendering")
+		bool bUseInstancedRendering;
+
+	// ʸģͣû ActorͳһʵƣΪʾ
+	UPROPERTY(EditDefaultsOnly, Category = "Rendering")
+		class UStaticMesh* ProjectileMesh;
+
+	// ؿʱ¼عؿǰѵλԴָսһ̣Actor ͸ֻ涼ã
+	UPROPERTY(EditDefaultsOnly, Category = "GameFlow")
+		bool bFastRestart;
+
+private:
+	// սһ̵ıս״̬ؿã
+	struct FPreparationSnapshot
+	{
+		struct FEntityState
+		{
+			TWeakObjectPtr<class ABaseGameEntity> Actor;
+			FTransform Transform;
+			float Health;
+		};
+
+		bool bValid = false;
+		FGridMap Grid;
+		TArray<FEntityState> Entities;
+		int32 PlayerGold = 0;
+		int32 PlayerElixir = 0;
+		int32 CurrentPopulation = 0;
+		int32 TeamAliveCounts[2] = { 0, 0 };
+		float TeamRemainingHealth[2] = { 0.0f, 0.0f };
+	};
+
+	// սʱ¿գ Actor ֻز٣ؿʱԭػָ
+	void CapturePreparationSnapshot(const TArray<class ABaseGameEntity*>& Entities);
+	bool RestorePreparationSnapshot();
+
+	// ʵʵ֣ȫ顢ӳɡһԿǮռӣ
+	bool BuyUnits(const TArray<FUnitPlacement>& Placements, int32 TotalCost);
+
+	// ӳһλһռסӣܽҺ˿ڣӲûκһʧܶ
+	bool SpawnUnitBatch(const TArray<FUnitPlacement>& Placements, ETeam Team, TArray<class ABaseUnit*>& OutUnits);
+
+	// LoadFormation ֮ǰ飺ӡ֣Լ˵ҵı֮Һ˿ڹ
+	bool CanApplyFormation(const struct FFormationLayout& Layout, const TArray<FUnitPlacement>& PlayerPlacements,
+		const TArray<FUnitPlacement>& EnemyPlacements) const;
+
+	// Ӫһʵ壨ս׶αƳ
+	void RemoveFromTeamCounts(class ABaseGameEntity* Entity);
+
+	// 㲥һ֡µӪ仯ÿ֡ͷã
+	void BroadcastTeamCountsIfChanged();
+
+	// ؿĽռصסӣһ֡ͳһύʱ GridManager ϶Ѿɺ
+	void ApplyPendingFootprints();
+
+	// ռ½ǵĸӣռ Actor λΪģ
+	void GetFootprintOrigin(const class ABaseGameEntity* Entity, int32& OutGridX, int32& OutGridY) const;
+
+	//  -> ͼࣨû䷵ؿգ
+	TSubclassOf<class ABaseUnit> GetUnitClass(EUnitType Type) const;
+
+	// ʱҪ̧ߵľ루߻Χи߶ȣõλվڵ
+	float GetSpawnHeightOffset(TSubclassOf<class ABaseUnit> SpawnClass) const;
+
+	// ģͬ ActorλáѪ
+	void ApplySimulationToActors();
+
+	// Saved/BattleSetups/<ͼ>.bsetup
+	FString GetDefaultBattleSetupPath() const;
+
+	// Saved/Formations/<ͼ>.abfm
+	FString GetDefaultFormationPath() const;
+
+	// Saved/Replays/<ͼ>.abrp
+	FString GetDefaultReplayPath() const;
+
+	// Saved/Profiling/BattleReports/<ͼ>-<ʱ>չ.json  .csv дһݣ
+	FString GetDefaultPerfReportPath() const;
+
+	// һ֡ĸ׶κʱǽܱ棨HudCycles ͬ Actor  HUD ¼ʱ䣩
+	void RecordPerfFrame(float DeltaSeconds, uint64 HudCycles);
+
+	// սеģս׶Ϊգ
+	TUniquePtr<FBattleSimulation> Simulation;
+
+	//  bRecordReplay ʱ¼糡ã
+	TUniquePtr<FBattleRecorder> Recorder;
+
+	//  bWritePerfReport ʱǰսܱ棨ֱͼǶģڴ棩
+	FBattlePerfReport PerfReport;
+
+	// չıֱ± EUnitType
+	TArray<FUnitArchetype> UnitArchetypes;
+
+	// սʵľսʱģʵ˳
+	FEntityRegistry EntityRegistry;
+
+	// ģʵ± -> ʵʧЧ
+	TArray<FEntityHandle> SimHandles;
+
+	// ۻʣʱ
+	float SimulationAccumulator;
+
+	// ÿӪĴʵʣѪ± ETeam
+	// ս׶ɳ/¼άսѪģļͬ
+	int32 TeamAliveCounts[2];
+	float TeamRemainingHealth[2];
+
+	// ӪĹû㲥
+	bool bTeamCountsDirty;
+
+	// ϴι㲥ս-1 ʾû㲥
+	int32 LastBattleClockSecond;
+
+	FPreparationSnapshot PreparationSnapshot;
+
+	// BeginPlay ʱǼǡûסӵĽ
+	TArray<TWeakObjectPtr<class ABaseGameEntity>> PendingFootprints;
+
+	//  bUseInstancedRendering ʱеλ
+	UPROPERTY()
+		class AUnitInstanceRenderer* InstanceRenderer;
 };
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "RTSPlayerController.h"
 #include "RTSGameMode.h"
 #include "RTSGameInstance.h"
+#include "AutoBattleStats.h"
 
 void URTSMainHUD::NativeConstruct()
 {
@@ -23,28 +24,111 @@ void URTSMainHUD::NativeConstruct()
     {
         Btn_StartBattle->OnClicked.AddDynamic(this, &URTSMainHUD::OnClickStartBattle);
     }
+    if (Btn_CollectAll)
+    {
+        Btn_CollectAll->OnClicked.AddDynamic(this, &URTSMainHUD::OnClickCollectAll);
+    }
+
+    // ݱ仯ȰǰֵʾһΣֻ֮ڱ仯ʱˢ£Ҫ NativeTick
+    URTSGameInstance* GI = Cast<URTSGameInstance>(GetGameInstance());
+    if (GI)
+    {
+        GI->OnPlayerDataChanged.AddUniqueDynamic(this, &URTSMainHUD::OnPlayerDataChanged);
+        OnPlayerDataChanged(EPlayerDataChange::All);
+    }
+
+    ARTSGameMode* GM = Cast<ARTSGameMode>(UGameplayStatics::GetGameMode(this));
+    if (GM)
+    {
+        GM->OnTeamCountsChanged.AddUniqueDynamic(this, &URTSMainHUD::OnTeamCountsChanged);
+        GM->OnBattleClockChanged.AddUniqueDynamic(this, &URTSMainHUD::OnBattleClockChanged);
+        GM->OnPreparationRestored.AddUniqueDynamic(this, &URTSMainHUD::OnPreparationRestored);
+        OnTeamCountsChanged();
+        OnBattleClockChanged(0);
+    }
+}
+
+void URTSMainHUD::NativeDestruct()
+{
+    URTSGameInstance* GI = Cast<URTSGameInstance>(GetGameInstance());
+    if (GI)
+    {
+        GI->OnPlayerDataChanged.RemoveDynamic(this, &URTSMainHUD::OnPlayerDataChanged);
+    }
+
+    ARTSGameMode* GM = Cast<ARTSGameMode>(UGameplayStatics::GetGameMode(this));
+    if (GM)
+    {
+        GM->OnTeamCountsChanged.RemoveDynamic(this, &URTSMainHUD::OnTeamCountsChanged);
+        GM->OnBattleClockChanged.RemoveDynamic(this, &URTSMainHUD::OnBattleClockChanged);
+        GM->OnPreparationRestored.RemoveDynamic(this, &URTSMainHUD::OnPreparationRestored);
+    }
+
+    Super::NativeDestruct();
 }
 
-// RTSMainHUD.cpp
+int32 URTSMainHUD::NativePaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect,
+    FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+    SCOPE_CYCLE_COUNTER(STAT_AutoBattle_HUDPaint);
+    return Super::NativePaint(Args, AllottedGeometry, MyCullingRect, OutDrawElements, LayerId, InWidgetStyle, bParentEnabled);
+}
 
-void URTSMainHUD::NativeTick(const FGeometry& MyGeometry, float InDeltaTime)
+void URTSMainHUD::SetCachedText(UTextBlock* TextBlock, int32& CachedValue, int32 NewValue, const TCHAR* Format)
 {
-    Super::NativeTick(MyGeometry, InDeltaTime);
+    if (!TextBlock || CachedValue == NewValue) return;
+
+    CachedValue = NewValue;
+    TextBlock->SetText(FText::FromString(FString::Printf(Format, NewValue)));
+}
 
+void URTSMainHUD::OnPlayerDataChanged(int32 ChangedMask)
+{
     URTSGameInstance* GI = Cast<URTSGameInstance>(GetGameInstance());
-    if (GI)
+    if (!GI) return;
+
+    if (ChangedMask & EPlayerDataChange::Gold)
     {
-        // ½
-        if (Text_GoldInfo)
-        {
-            Text_GoldInfo->SetText(FText::FromString(FString::Printf(TEXT("Gold: %d"), GI->PlayerGold)));
-        }
+        SetCachedText(Text_GoldInfo, ShownGold, GI->PlayerGold, TEXT("Gold: %d"));
+    }
+    if (ChangedMask & EPlayerDataChange::Elixir)
+    {
+        SetCachedText(Text_ElixirInfo, ShownElixir, GI->PlayerElixir, TEXT("Elixir: %d"));
+    }
+    if (ChangedMask & EPlayerDataChange::Population)
+    {
+        SetCachedText(Text_PopulationInfo, ShownPopulation, GI->CurrentPopulation, TEXT("Population: %d"));
+    }
+}
 
-        // ʥˮ (Elixir)
-        if (Text_ElixirInfo)
-        {
-            Text_ElixirInfo->SetText(FText::FromString(FString::Printf(TEXT("Elixir: %d"), GI->PlayerElixir)));
-        }
+void URTSMainHUD::OnTeamCountsChanged()
+{
+    ARTSGameMode* GM = Cast<ARTSGameMode>(UGameplayStatics::GetGameMode(this));
+    if (!GM || !Text_UnitCounts) return;
+
+    const int32 PlayerAlive = GM->GetTeamAliveCount(ETeam::Player);
+    const int32 EnemyAlive = GM->GetTeamAliveCount(ETeam::Enemy);
+    if (PlayerAlive == ShownAliveCounts[0] && EnemyAlive == ShownAliveCounts[1]) return;
+
+    ShownAliveCounts[0] = PlayerAlive;
+    ShownAliveCounts[1] = EnemyAlive;
+    Text_UnitCounts->SetText(FText::FromString(FString::Printf(TEXT("Units: %d vs %d"), PlayerAlive, EnemyAlive)));
+}
+
+void URTSMainHUD::OnBattleClockChanged(int32 ElapsedSeconds)
+{
+    if (!Text_BattleTimer || ElapsedSeconds == ShownBattleSeconds) return;
+
+    ShownBattleSeconds = ElapsedSeconds;
+    Text_BattleTimer->SetText(FText::FromString(FString::Printf(TEXT("%d:%02d"), ElapsedSeconds / 60, ElapsedSeconds % 60)));
+}
+
+void URTSMainHUD::OnPreparationRestored()
+{
+    // սʱ˿ʼťԭؿؽ HUDҪʾ
+    if (Btn_StartBattle)
+    {
+        Btn_StartBattle->SetVisibility(ESlateVisibility::Visible);
     }
 }
 
@@ -90,4 +174,15 @@ void URTSMainHUD::OnClickStartBattle()
             Btn_StartBattle->SetVisibility(ESlateVisibility::Hidden);
         }
     }
-}
\ No newline at end of file
+}
+
+void URTSMainHUD::OnClickCollectAll()
+{
+    // ֻһΣԴ TickHUD Ҳÿ֡ȥʣ
+    URTSGameInstance* GI = Cast<URTSGameInstance>(GetGameInstance());
+    if (GI)
+    {
+        GI->CollectAll(EResourceType::Gold);
+        GI->CollectAll(EResourceType::Elixir);
+    }
+}
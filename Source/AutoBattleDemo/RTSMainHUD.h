@@ -17,10 +17,14 @@ public:
     // ʼ ( BeginPlay)
     virtual void NativeConstruct() override;
 
-    // ÿ֡ ( Tick)
-    virtual void NativeTick(const FGeometry& MyGeometry, float InDeltaTime) override;
+    //  GameInstance / GameMode ¼
+    virtual void NativeDestruct() override;
 
 protected:
+    //  stat AutoBattle  HUD ƺʱӿؼ֮ǰѾ꣬ Slate  stat slate
+    virtual int32 NativePaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect,
+        FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+
     // --- ļɣBindWidget ---
     // ֻҪͼѰťΪ "Btn_BuySoldier"C++ ͻԶ
 
@@ -43,6 +47,13 @@ protected:
     UFUNCTION()
         void OnClickStartBattle();
 
+    // ȡԴͼûťҲУ
+    UPROPERTY(meta = (BindWidgetOptional))
+        UButton* Btn_CollectAll;
+
+    UFUNCTION()
+        void OnClickCollectAll();
+
     // ʾ
     UPROPERTY(meta = (BindWidget))
         UTextBlock* Text_GoldInfo;
@@ -50,4 +61,39 @@ protected:
     // ʾʥˮ
     UPROPERTY(meta = (BindWidget))
         UTextBlock* Text_ElixirInfo;
+
+    // ʾ˿ڡ˫սʱͼԲţ
+    UPROPERTY(meta = (BindWidgetOptional))
+        UTextBlock* Text_PopulationInfo;
+
+    UPROPERTY(meta = (BindWidgetOptional))
+        UTextBlock* Text_UnitCounts;
+
+    UPROPERTY(meta = (BindWidgetOptional))
+        UTextBlock* Text_BattleTimer;
+
+    // --- ¼ˢ£ݱ˲¸ʽ֣û֡ Slate ---
+    UFUNCTION()
+        void OnPlayerDataChanged(int32 ChangedMask);
+
+    UFUNCTION()
+        void OnTeamCountsChanged();
+
+    UFUNCTION()
+        void OnBattleClockChanged(int32 ElapsedSeconds);
+
+    // ؿصս׶Σʾʼť
+    UFUNCTION()
+        void OnPreparationRestored();
+
+private:
+    // ֵϴʾһͲ SetTextSetText ²Ű棩
+    static void SetCachedText(UTextBlock* TextBlock, int32& CachedValue, int32 NewValue, const TCHAR* Format);
+
+    // ϴʾֵ-1 ʾûʾ
+    int32 ShownGold = -1;
+    int32 ShownElixir = -1;
+    int32 ShownPopulation = -1;
+    int32 ShownBattleSeconds = -1;
+    int32 ShownAliveCounts[2] = { -1, -1 };
 };
\ No newline at end of file
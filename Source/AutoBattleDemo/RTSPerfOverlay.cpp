@@ -0,0 +1,90 @@
+#include "RTSPerfOverlay.h"
+#include "Blueprint/WidgetTree.h"
+#include "Components/TextBlock.h"
+#include "TimerManager.h"
+#include "Engine/World.h"
+
+void URTSPerfOverlay::NativeOnInitialized()
+{
+    Super::NativeOnInitialized();
+
+    if (!Text_Stats && WidgetTree && !WidgetTree->RootWidget)
+    {
+        Text_Stats = WidgetTree->ConstructWidget<UTextBlock>(UTextBlock::StaticClass(), TEXT("Text_Stats"));
+        WidgetTree->RootWidget = Text_Stats;
+    }
+
+    // 只显示，不挡鼠标点击
+    SetVisibility(ESlateVisibility::HitTestInvisible);
+}
+
+void URTSPerfOverlay::NativeConstruct()
+{
+    Super::NativeConstruct();
+
+    FPerfCounters::AddViewer();
+    LastRefreshTime = FPlatformTime::Seconds();
+
+    if (GetWorld())
+    {
+        GetWorld()->GetTimerManager().SetTimer(RefreshTimer, FTimerDelegate::CreateUObject(this, &URTSPerfOverlay::Refresh), FMath::Max(RefreshInterval, 0.1f), true);
+    }
+    if (Text_Stats)
+    {
+        Text_Stats->SetText(FText::FromString(TEXT("Collecting...")));
+    }
+}
+
+void URTSPerfOverlay::NativeDestruct()
+{
+    if (GetWorld())
+    {
+        GetWorld()->GetTimerManager().ClearTimer(RefreshTimer);
+    }
+    FPerfCounters::RemoveViewer();
+
+    Super::NativeDestruct();
+}
+
+void URTSPerfOverlay::Refresh()
+{
+    // 1. 读出这段时间的计数（同时清零），按真实时间和帧数折算
+    FPerfCounters::ReadAndReset(Values);
+
+    const double Now = FPlatformTime::Seconds();
+    const double Seconds = FMath::Max(Now - LastRefreshTime, 1e-3);
+    LastRefreshTime = Now;
+
+    auto Get = [this](EPerfCounter Counter) { return Values[(int32)Counter]; };
+    auto CyclesToMs = [](int64 Cycles) { return FPlatformTime::ToMilliseconds64(Cycles); };
+
+    const int64 Frames = FMath::Max<int64>(Get(EPerfCounter::Frames), 1);
+    const int64 Paths = Get(EPerfCounter::PathRequests);
+
+    // 2. 只在刷新时重排一次文字
+    FString Text;
+    Text += FString::Printf(TEXT("Frames: %.0f/s, sim steps/frame: %.2f\n"),
+        Get(EPerfCounter::Frames) / Seconds, (double)Get(EPerfCounter::SimSteps) / Frames);
+    Text += FString::Printf(TEXT("Units ticked/frame: %.1f\n"), (double)Get(EPerfCounter::UnitsTicked) / Frames);
+    Text += FString::Printf(TEXT("FindPath: %.1f/s, avg %.1fus, max %.1fus, %.1f nodes/path\n"),
+        Paths / Seconds,
+        Paths > 0 ? CyclesToMs(Get(EPerfCounter::PathCycles)) * 1000.0 / Paths : 0.0,
+        CyclesToMs(Get(EPerfCounter::PathMaxCycles)) * 1000.0,
+        Paths > 0 ? (double)Get(EPerfCounter::PathNodesExpanded) / Paths : 0.0);
+    Text += FString::Printf(TEXT("Targeting queries: %.0f/s\n"), Get(EPerfCounter::TargetQueries) / Seconds);
+    Text += FString::Printf(TEXT("Damage events/frame: %.1f\n"), (double)Get(EPerfCounter::DamageEvents) / Frames);
+    Text += FString::Printf(TEXT("Actors: %lld live, %lld pooled\n"), Get(EPerfCounter::LiveActors), Get(EPerfCounter::PooledActors));
+    Text += FString::Printf(TEXT("Game thread ms/frame: avoidance %.3f, projectiles %.3f, replans %.3f, units %.3f, towers %.3f, damage %.3f, sync %.3f"),
+        CyclesToMs(Get(EPerfCounter::PhaseAvoidanceCycles)) / Frames,
+        CyclesToMs(Get(EPerfCounter::PhaseProjectileCycles)) / Frames,
+        CyclesToMs(Get(EPerfCounter::PhaseReplanCycles)) / Frames,
+        CyclesToMs(Get(EPerfCounter::PhaseUnitCycles)) / Frames,
+        CyclesToMs(Get(EPerfCounter::PhaseTowerCycles)) / Frames,
+        CyclesToMs(Get(EPerfCounter::PhaseDamageCycles)) / Frames,
+        CyclesToMs(Get(EPerfCounter::PhaseSyncCycles)) / Frames);
+
+    if (Text_Stats)
+    {
+        Text_Stats->SetText(FText::FromString(Text));
+    }
+}
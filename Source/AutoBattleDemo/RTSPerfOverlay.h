@@ -0,0 +1,39 @@
+// RTSPerfOverlay.h：性能浮层（和 URTSMainHUD 一样是 UUserWidget，控制台输入 TogglePerfOverlay 开关）
+// 打开期间 FPerfCounters 才计数，按 RefreshInterval 读一次计数、重排一次文字，不每帧刷新
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "PerfCounters.h"
+#include "RTSPerfOverlay.generated.h"
+
+class UTextBlock;
+
+UCLASS()
+class AUTOBATTLEDEMO_API URTSPerfOverlay : public UUserWidget
+{
+    GENERATED_BODY()
+
+public:
+    // 刷新间隔（秒）
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Perf")
+        float RefreshInterval = 0.5f;
+
+protected:
+    // 没有蓝图布局（直接用这个 C++ 类创建）时自己建一个 TextBlock
+    virtual void NativeOnInitialized() override;
+
+    // 打开：开始计数、启动刷新定时器；关闭：停止计数
+    virtual void NativeConstruct() override;
+    virtual void NativeDestruct() override;
+
+    UPROPERTY(meta = (BindWidgetOptional))
+        UTextBlock* Text_Stats;
+
+private:
+    void Refresh();
+
+    FTimerHandle RefreshTimer;
+    double LastRefreshTime = 0.0;
+    int64 Values[FPerfCounters::NumCounters];
+};
@@ -4,6 +4,7 @@
 #include "Kismet/GameplayStatics.h"
 #include "Blueprint/UserWidget.h"
 #include "RTSMainHUD.h"
+#include "RTSPerfOverlay.h"
 #include "DrawDebugHelpers.h"
 
 ARTSPlayerController::ARTSPlayerController()
@@ -14,6 +15,8 @@ ARTSPlayerController::ARTSPlayerController()
     PrimaryActorTick.bCanEverTick = true;
     bIsPlacingUnit = false;
     PendingUnitType = EUnitType::Soldier;
+    PerfOverlayClass = URTSPerfOverlay::StaticClass();
+    PerfOverlayInstance = nullptr;
 }
 
 void ARTSPlayerController::BeginPlay()
@@ -112,12 +115,9 @@ void ARTSPlayerController::HandleLeftClick()
             ARTSGameMode* GM = Cast<ARTSGameMode>(GetWorld()->GetAuthGameMode());
             if (GM)
             {
-                // 򵥵ļ۸ (ʵĿдñ)
-                int32 Cost = (PendingUnitType == EUnitType::Soldier) ? 50 : 100;
-
                 // --- Ǹ Success ---
-                // òУ
-                bool bSuccess = GM->TryBuyUnit(PendingUnitType, Cost, X, Y);
+                // òУ۸ GameMode ֱ㣩
+                bool bSuccess = GM->TryBuyUnit(PendingUnitType, X, Y);
 
                 if (bSuccess)
                 {
@@ -224,5 +224,29 @@ void ARTSPlayerController::SetupInputComponent()
 {
     Super::SetupInputComponent();
     InputComponent->BindAction("LeftClick", IE_Pressed, this, &ARTSPlayerController::HandleLeftClick);
+    InputComponent->BindAction("TogglePerfOverlay", IE_Pressed, this, &ARTSPlayerController::TogglePerfOverlay);
+}
+
+void ARTSPlayerController::TogglePerfOverlay()
+{
+    if (!IsLocalPlayerController()) return;
+
+    // أƳӿڣͣ
+    if (PerfOverlayInstance)
+    {
+        PerfOverlayInstance->RemoveFromParent();
+        PerfOverlayInstance = nullptr;
+        return;
+    }
+
+    // 
+    if (PerfOverlayClass)
+    {
+        PerfOverlayInstance = CreateWidget<URTSPerfOverlay>(this, PerfOverlayClass);
+        if (PerfOverlayInstance)
+        {
+            PerfOverlayInstance->AddToViewport(10);
+        }
+    }
 }
 
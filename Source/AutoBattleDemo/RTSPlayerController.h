@@ -5,6 +5,7 @@
 #include "RTSPlayerController.generated.h"
 
 class URTSMainHUD;
+class URTSPerfOverlay;
 
 UCLASS()
 class AUTOBATTLEDEMO_API ARTSPlayerController : public APlayerController
@@ -28,6 +29,10 @@ public:
     UFUNCTION(BlueprintCallable)
         void HandleLeftClick();
 
+    // ܸ㣨̨Ҳ TogglePerfOverlay 
+    UFUNCTION(Exec, BlueprintCallable)
+        void TogglePerfOverlay();
+
 private:
     // ǰڡק/ͣ׼õĵλ
     EUnitType PendingUnitType;
@@ -48,6 +53,14 @@ protected:
     UPROPERTY()
         URTSMainHUD* MainHUDInstance;
 
+    // ܸ㣨Ĭֱ C++ ࣬뻻ֿһͼࣩ
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "UI")
+        TSubclassOf<URTSPerfOverlay> PerfOverlayClass;
+
+    // ʱΪգصʱֱƳӿ
+    UPROPERTY()
+        URTSPerfOverlay* PerfOverlayInstance;
+
     //  Actor ʵ
     UPROPERTY()
         AActor* PreviewGhostActor;
@@ -0,0 +1,48 @@
+#include "ResourceCollector.h"
+#include "RTSGameInstance.h"
+#include "Kismet/GameplayStatics.h"
+
+AResourceCollector::AResourceCollector()
+{
+    // 产出按时间现算，不需要 Tick
+    PrimaryActorTick.bCanEverTick = false;
+
+    TargetClass = ETargetClass::Resource;
+    ResourceType = EResourceType::Gold;
+    ProductionPerHour = 3600;
+    Capacity = 1000;
+}
+
+void AResourceCollector::BeginPlay()
+{
+    Super::BeginPlay();
+
+    // 敌方基地的资源建筑只是挨打的目标，不产出
+    URTSGameInstance* GI = Cast<URTSGameInstance>(GetGameInstance());
+    if (!GI || TeamID != ETeam::Player || ProductionPerHour <= 0) return;
+
+    ProducerId = FName(*FString::Printf(TEXT("%s.%s"), *UGameplayStatics::GetCurrentLevelName(this), *GetName()));
+    GI->RegisterProducer(ProducerId, ResourceType, ProductionPerHour, Capacity);
+}
+
+int32 AResourceCollector::GetStored() const
+{
+    URTSGameInstance* GI = Cast<URTSGameInstance>(GetGameInstance());
+    if (!GI || ProducerId.IsNone()) return 0;
+
+    return (int32)FMath::Min<int64>(GI->GetEconomy().GetStored(ProducerId, URTSGameInstance::GetEconomyTimeMs()), MAX_int32);
+}
+
+void AResourceCollector::NotifyActorOnClicked(FKey ButtonPressed)
+{
+    Super::NotifyActorOnClicked(ButtonPressed);
+
+    URTSGameInstance* GI = Cast<URTSGameInstance>(GetGameInstance());
+    if (!GI || ProducerId.IsNone()) return;
+
+    const int32 Amount = GI->CollectProducer(ProducerId);
+    if (GEngine && Amount > 0)
+    {
+        GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::Yellow, FString::Printf(TEXT("+%d %s"), Amount, ResourceType == EResourceType::Gold ? TEXT("Gold") : TEXT("Elixir")));
+    }
+}
@@ -0,0 +1,43 @@
+// ResourceCollector.h：资源建筑（金矿、圣水收集器）
+// 自己不 Tick，也不存资源：开局把速度和上限登记到 GameInstance，存量由 FResourceEconomy 按时间现算
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BaseGameEntity.h"
+#include "ResourceCollector.generated.h"
+
+UCLASS()
+class AUTOBATTLEDEMO_API AResourceCollector : public ABaseGameEntity
+{
+    GENERATED_BODY()
+
+public:
+    AResourceCollector();
+
+    // 点击收取这一座的存量
+    virtual void NotifyActorOnClicked(FKey ButtonPressed = EKeys::LeftMouseButton) override;
+
+    // 当前存量（按经过的时间现算，不是玩家阵营的返回 0）
+    UFUNCTION(BlueprintCallable, Category = "Economy")
+        int32 GetStored() const;
+
+protected:
+    // 玩家阵营的资源建筑登记到 GameInstance
+    virtual void BeginPlay() override;
+
+public:
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Economy")
+        EResourceType ResourceType;
+
+    // 每小时产出
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Economy")
+        int32 ProductionPerHour;
+
+    // 存满以后不再产出，要收取才继续
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Economy")
+        int32 Capacity;
+
+private:
+    // 在 GameInstance 里的 Id（关卡名 + Actor 名），没登记时为 None
+    FName ProducerId;
+};
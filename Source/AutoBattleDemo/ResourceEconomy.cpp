@@ -0,0 +1,93 @@
+#include "ResourceEconomy.h"
+
+int64 FResourceEconomy::ComputeStored(const FResourceProducer& Producer, int64 NowMs, int64& OutNumerator)
+{
+    // 时钟往回跳（改了系统时间）时当作没过时间
+    const int64 ElapsedMs = FMath::Max<int64>(NowMs - Producer.LastCollectMs, 0);
+    OutNumerator = Producer.Remainder + Producer.RatePerHour * ElapsedMs;
+
+    // 每帧累加时存量始终是 min(上限, 存量 + 新产出)，产出都不为负，所以等于 min(上限, 总产出)
+    return FMath::Min(Producer.Capacity, Producer.Banked + OutNumerator / MillisecondsPerHour);
+}
+
+int64 FResourceEconomy::CollectFrom(FResourceProducer& Producer, int64 NowMs)
+{
+    int64 Numerator = 0;
+    const int64 Amount = ComputeStored(Producer, NowMs, Numerator);
+
+    // 零头不随收取清掉（每帧累加时零头也是一直结转的）
+    Producer.Remainder = Numerator % MillisecondsPerHour;
+    Producer.Banked = 0;
+    Producer.LastCollectMs = FMath::Max(NowMs, Producer.LastCollectMs);
+    return Amount;
+}
+
+void FResourceEconomy::AddProducer(FName Id, EResourceType Type, int64 RatePerHour, int64 Capacity, int64 NowMs)
+{
+    FResourceProducer* Existing = Producers.Find(Id);
+    if (Existing)
+    {
+        // 1. 先按旧速度结算到现在，存进 Banked，之后的时间按新速度算
+        int64 Numerator = 0;
+        Existing->Banked = ComputeStored(*Existing, NowMs, Numerator);
+        Existing->Remainder = Numerator % MillisecondsPerHour;
+        Existing->LastCollectMs = FMath::Max(NowMs, Existing->LastCollectMs);
+        Existing->Type = Type;
+        Existing->RatePerHour = FMath::Max<int64>(RatePerHour, 0);
+        Existing->Capacity = FMath::Max<int64>(Capacity, 0);
+        Existing->Banked = FMath::Min(Existing->Banked, Existing->Capacity);
+        return;
+    }
+
+    // 2. 新的产出点从现在开始计时
+    FResourceProducer& Producer = Producers.Add(Id);
+    Producer.Type = Type;
+    Producer.RatePerHour = FMath::Max<int64>(RatePerHour, 0);
+    Producer.Capacity = FMath::Max<int64>(Capacity, 0);
+    Producer.LastCollectMs = NowMs;
+}
+
+void FResourceEconomy::RemoveProducer(FName Id)
+{
+    Producers.Remove(Id);
+}
+
+int64 FResourceEconomy::GetStored(FName Id, int64 NowMs) const
+{
+    const FResourceProducer* Producer = Producers.Find(Id);
+    int64 Numerator = 0;
+    return Producer ? ComputeStored(*Producer, NowMs, Numerator) : 0;
+}
+
+int64 FResourceEconomy::GetTotalStored(EResourceType Type, int64 NowMs) const
+{
+    int64 Total = 0;
+    int64 Numerator = 0;
+    for (const TPair<FName, FResourceProducer>& Pair : Producers)
+    {
+        if (Pair.Value.Type == Type)
+        {
+            Total += ComputeStored(Pair.Value, NowMs, Numerator);
+        }
+    }
+    return Total;
+}
+
+int64 FResourceEconomy::Collect(FName Id, int64 NowMs)
+{
+    FResourceProducer* Producer = Producers.Find(Id);
+    return Producer ? CollectFrom(*Producer, NowMs) : 0;
+}
+
+int64 FResourceEconomy::CollectAll(EResourceType Type, int64 NowMs)
+{
+    int64 Total = 0;
+    for (TPair<FName, FResourceProducer>& Pair : Producers)
+    {
+        if (Pair.Value.Type == Type)
+        {
+            Total += CollectFrom(Pair.Value, NowMs);
+        }
+    }
+    return Total;
+}
@@ -0,0 +1,59 @@
+// ResourceEconomy.h：资源建筑（金矿、圣水收集器）的产出
+// 不逐帧累加：每个产出点只记上次收取的时间和速度，需要的时候按经过的时间算出当前存量（有上限），
+// 建筑本身不用 Tick，每帧的开销和基地里有多少资源建筑无关
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RTSCoreTypes.h"
+
+/**
+ * 一个产出点
+ * 时间是整数毫秒，产出按“每小时多少”给，零头以分子（产出 × 毫秒）的形式留着，
+ * 所以按时间一次算出来的量和每帧累加（零头结转到下一帧）的结果完全一样
+ */
+struct FResourceProducer
+{
+    EResourceType Type = EResourceType::Gold;
+    int64 RatePerHour = 0;
+    int64 Capacity = 0;
+
+    int64 LastCollectMs = 0;  // 上次收取（或改速度）的时间
+    int64 Remainder = 0;      // 当时不满 1 点的零头，单位是 产出 × 毫秒，小于 MillisecondsPerHour
+    int64 Banked = 0;         // 改速度之前已经产出、还没收取的量
+};
+
+/**
+ * 产出点表（不依赖 World，GameInstance 持有，跨关卡保留计时）
+ */
+class AUTOBATTLEDEMO_API FResourceEconomy
+{
+public:
+    static const int64 MillisecondsPerHour = 3600000;
+
+    /**
+     * 登记产出点；同一个 Id 已经登记过（回到这个关卡）时保留它的计时，只更新速度和上限
+     * @param NowMs 当前时间（毫秒），和之后查询、收取用同一个时钟
+     */
+    void AddProducer(FName Id, EResourceType Type, int64 RatePerHour, int64 Capacity, int64 NowMs);
+    void RemoveProducer(FName Id);
+
+    // 当前存量（还没收取的），没有这个产出点返回 0
+    int64 GetStored(FName Id, int64 NowMs) const;
+
+    // 某种资源所有产出点的存量合计（只在被问到时遍历一遍）
+    int64 GetTotalStored(EResourceType Type, int64 NowMs) const;
+
+    // 收取：返回收到的量，产出点从 NowMs 重新计时（零头保留）
+    int64 Collect(FName Id, int64 NowMs);
+    int64 CollectAll(EResourceType Type, int64 NowMs);
+
+    const FResourceProducer* Find(FName Id) const { return Producers.Find(Id); }
+    int32 Num() const { return Producers.Num(); }
+
+private:
+    // 截至 NowMs 的存量；OutNumerator 是上次收取以来的总产出分子（含零头）
+    static int64 ComputeStored(const FResourceProducer& Producer, int64 NowMs, int64& OutNumerator);
+    static int64 CollectFrom(FResourceProducer& Producer, int64 NowMs);
+
+    TMap<FName, FResourceProducer> Producers;
+};
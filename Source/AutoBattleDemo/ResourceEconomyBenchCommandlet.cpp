@@ -0,0 +1,154 @@
+#include "ResourceEconomyBenchCommandlet.h"
+#include "ResourceEconomy.h"
+#include "HAL/PlatformTime.h"
+
+namespace
+{
+    // 原来的做法：每个资源建筑每帧 Tick 一次，把这一帧的产出加进自己的存量（零头结转到下一帧）
+    struct FTickProducer
+    {
+        int64 RatePerHour;
+        int64 Capacity;
+        int64 Numerator;
+        int64 Stored;
+
+        void Tick(int64 DeltaMs)
+        {
+            Numerator += RatePerHour * DeltaMs;
+            Stored = FMath::Min(Capacity, Stored + Numerator / FResourceEconomy::MillisecondsPerHour);
+            Numerator %= FResourceEconomy::MillisecondsPerHour;
+        }
+    };
+
+    int64 RandomRate(FRandomStream& Random)
+    {
+        return 500 + Random.RandHelper(20000);
+    }
+}
+
+UResourceEconomyBenchCommandlet::UResourceEconomyBenchCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = false;
+    LogToConsole = true;
+}
+
+int32 UResourceEconomyBenchCommandlet::Main(const FString& Params)
+{
+    // 1. 解析参数
+    int32 NumProducers = 1000;
+    int32 NumFrames = 100000;
+    int32 Seed = 1;
+    FParse::Value(*Params, TEXT("producers="), NumProducers);
+    FParse::Value(*Params, TEXT("frames="), NumFrames);
+    FParse::Value(*Params, TEXT("seed="), Seed);
+    NumProducers = FMath::Max(NumProducers, 1);
+    NumFrames = FMath::Max(NumFrames, 1);
+
+    // 2. 两边登记同样的产出点（金矿、圣水各一半）
+    FRandomStream Random(Seed);
+    FResourceEconomy Economy;
+    TArray<FTickProducer> Ticked;
+    TArray<FName> Ids;
+    int64 NowMs = 0;
+    for (int32 i = 0; i < NumProducers; i++)
+    {
+        const int64 Rate = RandomRate(Random);
+        const int64 Capacity = 100 + Random.RandHelper(5000);
+        Ids.Add(FName(TEXT("Producer"), i + 1));
+        Economy.AddProducer(Ids[i], (EResourceType)(i & 1), Rate, Capacity, NowMs);
+        Ticked.Add({ Rate, Capacity, 0, 0 });
+    }
+
+    double TickSeconds = 0.0;
+    double LazySeconds = 0.0;
+    int64 NumCollects = 0;
+    int64 Collected = 0;
+    int32 MismatchFrame = INDEX_NONE;
+
+    for (int32 Frame = 0; Frame < NumFrames; Frame++)
+    {
+        // 3. 帧时长 5~50 ms
+        const int64 DeltaMs = 5 + Random.RandHelper(46);
+        NowMs += DeltaMs;
+
+        double StartTime = FPlatformTime::Seconds();
+        for (FTickProducer& Producer : Ticked)
+        {
+            Producer.Tick(DeltaMs);
+        }
+        TickSeconds += FPlatformTime::Seconds() - StartTime;
+
+        // 4. 偶尔收取一座，更少的时候升级一座（改速度和上限）
+        if (Random.RandHelper(10) == 0)
+        {
+            const int32 Index = Random.RandHelper(NumProducers);
+
+            StartTime = FPlatformTime::Seconds();
+            const int64 LazyAmount = Economy.Collect(Ids[Index], NowMs);
+            LazySeconds += FPlatformTime::Seconds() - StartTime;
+
+            const int64 TickAmount = Ticked[Index].Stored;
+            Ticked[Index].Stored = 0;
+
+            NumCollects++;
+            Collected += TickAmount;
+            if (MismatchFrame == INDEX_NONE && LazyAmount != TickAmount)
+            {
+                MismatchFrame = Frame;
+            }
+        }
+        if (Random.RandHelper(100) == 0)
+        {
+            const int32 Index = Random.RandHelper(NumProducers);
+            Ticked[Index].RatePerHour = RandomRate(Random);
+            Ticked[Index].Capacity += 100;
+            Ticked[Index].Stored = FMath::Min(Ticked[Index].Stored, Ticked[Index].Capacity);
+
+            StartTime = FPlatformTime::Seconds();
+            Economy.AddProducer(Ids[Index], (EResourceType)(Index & 1), Ticked[Index].RatePerHour, Ticked[Index].Capacity, NowMs);
+            LazySeconds += FPlatformTime::Seconds() - StartTime;
+        }
+    }
+
+    // 5. 结束时逐个比较存量，再比较两种资源的合计（HUD 问的就是这个）
+    for (int32 i = 0; i < NumProducers && MismatchFrame == INDEX_NONE; i++)
+    {
+        if (Economy.GetStored(Ids[i], NowMs) != Ticked[i].Stored)
+        {
+            MismatchFrame = NumFrames;
+        }
+    }
+
+    const double StartTime = FPlatformTime::Seconds();
+    const int64 LazyGold = Economy.GetTotalStored(EResourceType::Gold, NowMs);
+    const int64 LazyElixir = Economy.GetTotalStored(EResourceType::Elixir, NowMs);
+    const double QuerySeconds = FPlatformTime::Seconds() - StartTime;
+
+    int64 TickGold = 0;
+    int64 TickElixir = 0;
+    for (int32 i = 0; i < NumProducers; i++)
+    {
+        ((i & 1) ? TickElixir : TickGold) += Ticked[i].Stored;
+    }
+    if (MismatchFrame == INDEX_NONE && (LazyGold != TickGold || LazyElixir != TickElixir))
+    {
+        MismatchFrame = NumFrames;
+    }
+
+    // 6. 报告
+    UE_LOG(LogTemp, Display, TEXT("%d producers, %d frames (%.1f game hours): %lld collects, %lld collected, %lld gold + %lld elixir still stored"),
+        NumProducers, NumFrames, NowMs / (double)FResourceEconomy::MillisecondsPerHour, NumCollects, Collected, TickGold, TickElixir);
+    UE_LOG(LogTemp, Display, TEXT("Per-frame accumulation: %.4f ms/frame"), TickSeconds * 1000.0 / NumFrames);
+    UE_LOG(LogTemp, Display, TEXT("Timestamp-based:        %.4f ms/frame (collects and upgrades only), %.4f ms per HUD total query"),
+        LazySeconds * 1000.0 / NumFrames, QuerySeconds * 1000.0 / 2);
+
+    if (MismatchFrame != INDEX_NONE)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Timestamp-based amounts differ from per-frame accumulation at frame %d"), MismatchFrame);
+        return 1;
+    }
+    UE_LOG(LogTemp, Display, TEXT("Amounts identical: yes"));
+    return 0;
+}
@@ -0,0 +1,20 @@
+// ResourceEconomyBenchCommandlet.h：资源产出按时间现算 vs 每帧累加 的对比
+// 用法：UE4Editor-Cmd AutoBattleDemo.uproject -run=ResourceEconomyBench [-producers=1000] [-frames=100000] [-seed=1] -nullrhi
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ResourceEconomyBenchCommandlet.generated.h"
+
+UCLASS()
+class AUTOBATTLEDEMO_API UResourceEconomyBenchCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UResourceEconomyBenchCommandlet();
+
+    // 同一串帧时长、收取和升级分别交给 FResourceEconomy 和逐帧累加的参照实现，统计每帧耗时，
+    // 每次收取和结束时的存量都要完全一致，不一致返回 1
+    virtual int32 Main(const FString& Params) override;
+};
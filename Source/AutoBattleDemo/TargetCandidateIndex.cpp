@@ -0,0 +1,83 @@
+#include "TargetCandidateIndex.h"
+
+FTargetCandidateIndex::FTargetCandidateIndex()
+    : GridMin(FVector2D::ZeroVector)
+    , CellSize(1.0f)
+    , CellsX(1)
+    , CellsY(1)
+    , NumDistanceChecks(0)
+{
+}
+
+void FTargetCandidateIndex::Reset(const FVector2D& BoundsMin, const FVector2D& BoundsMax, float InCellSize, int32 NumEntities)
+{
+    GridMin = BoundsMin;
+    CellSize = FMath::Max(InCellSize, 1.0f);
+    CellsX = FMath::Clamp(FMath::CeilToInt((BoundsMax.X - BoundsMin.X) / CellSize), 1, 1024);
+    CellsY = FMath::Clamp(FMath::CeilToInt((BoundsMax.Y - BoundsMin.Y) / CellSize), 1, 1024);
+
+    Partitions.Reset();
+    Partitions.SetNum(2 * (int32)ETargetClass::Count);
+    for (FPartition& Partition : Partitions)
+    {
+        Partition.Cells.SetNum(CellsX * CellsY);
+    }
+
+    Slots.Reset();
+    Slots.SetNum(NumEntities);
+    NumDistanceChecks = 0;
+}
+
+int32 FTargetCandidateIndex::GetCellIndex(float X, float Y) const
+{
+    const int32 CellX = FMath::Clamp(FMath::FloorToInt((X - GridMin.X) / CellSize), 0, CellsX - 1);
+    const int32 CellY = FMath::Clamp(FMath::FloorToInt((Y - GridMin.Y) / CellSize), 0, CellsY - 1);
+    return CellY * CellsX + CellX;
+}
+
+void FTargetCandidateIndex::Add(int32 EntityIndex, ETeam Team, ETargetClass Class, const FVector& Location, float Extent)
+{
+    if (!Slots.IsValidIndex(EntityIndex) || Slots[EntityIndex].Partition != INDEX_NONE) return;
+
+    FSlot& Slot = Slots[EntityIndex];
+    Slot.Partition = GetPartitionIndex(Team, Class);
+    Slot.Cell = GetCellIndex(Location.X, Location.Y);
+
+    FPartition& Partition = Partitions[Slot.Partition];
+    Slot.IndexInCell = Partition.Cells[Slot.Cell].Add(EntityIndex);
+    Partition.Count++;
+    Partition.MaxExtent = FMath::Max(Partition.MaxExtent, Extent);
+}
+
+void FTargetCandidateIndex::RemoveFromCell(int32 EntityIndex)
+{
+    // 和桶里最后一个交换后删除，被换过来的实体更新自己的位置
+    const FSlot& Slot = Slots[EntityIndex];
+    TArray<int32>& Cell = Partitions[Slot.Partition].Cells[Slot.Cell];
+    const int32 LastEntity = Cell.Last();
+    Cell[Slot.IndexInCell] = LastEntity;
+    Slots[LastEntity].IndexInCell = Slot.IndexInCell;
+    Cell.Pop(false);
+}
+
+void FTargetCandidateIndex::Move(int32 EntityIndex, const FVector& Location)
+{
+    if (!Slots.IsValidIndex(EntityIndex) || Slots[EntityIndex].Partition == INDEX_NONE) return;
+
+    const int32 NewCell = GetCellIndex(Location.X, Location.Y);
+    FSlot& Slot = Slots[EntityIndex];
+    if (NewCell == Slot.Cell) return;
+
+    RemoveFromCell(EntityIndex);
+    Slot.Cell = NewCell;
+    Slot.IndexInCell = Partitions[Slot.Partition].Cells[NewCell].Add(EntityIndex);
+}
+
+void FTargetCandidateIndex::Remove(int32 EntityIndex)
+{
+    if (!Slots.IsValidIndex(EntityIndex) || Slots[EntityIndex].Partition == INDEX_NONE) return;
+
+    RemoveFromCell(EntityIndex);
+    Partitions[Slots[EntityIndex].Partition].Count--;
+    Slots[EntityIndex].Partition = INDEX_NONE;
+}
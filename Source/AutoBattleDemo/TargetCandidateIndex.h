@@ -0,0 +1,167 @@
+// TargetCandidateIndex.h：按阵营 + 目标类别分区的索敌索引
+// 每个分区一张粗格子，实体按格子分桶；单位移动跨格子、实体死亡时只改自己那一个桶，
+// 查询只碰策略需要的那几个分区，不再每次把全场实体扫一遍
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RTSCoreTypes.h"
+
+/**
+ * 索敌候选索引
+ * 用法：Reset -> Add(...)；之后单位移动时 Move，死亡时 Remove，随时 FindTarget
+ * 查询规则和原来的全量扫描一样：范围内有目标就取下标最小的，否则取最近的（一样近取下标小的），
+ * 所以结果和实体在桶里的顺序无关
+ */
+class AUTOBATTLEDEMO_API FTargetCandidateIndex
+{
+public:
+    FTargetCandidateIndex();
+
+    /**
+     * 清空
+     * @param BoundsMin 战场范围（XY），范围外的位置归到边缘格子
+     * @param BoundsMax
+     * @param InCellSize 粗格子边长
+     * @param NumEntities 实体下标上限
+     */
+    void Reset(const FVector2D& BoundsMin, const FVector2D& BoundsMax, float InCellSize, int32 NumEntities);
+
+    /**
+     * 登记一个可以被攻击的实体
+     * @param Extent 实体离登记位置最远的边缘距离（有占地的建筑），点状实体传 0
+     */
+    void Add(int32 EntityIndex, ETeam Team, ETargetClass Class, const FVector& Location, float Extent = 0.0f);
+
+    // 位置变了（只有跨格子时才换桶）
+    void Move(int32 EntityIndex, const FVector& Location);
+
+    // 死亡，从所在的桶里移除
+    void Remove(int32 EntityIndex);
+
+    int32 Num(ETeam Team, ETargetClass Class) const { return Partitions[GetPartitionIndex(Team, Class)].Count; }
+
+    /**
+     * 在 Team 阵营、ClassMask 里的类别中找目标
+     * @param ClassMask 类别掩码（1 << ETargetClass）
+     * @param From 查询位置
+     * @param Range 攻击范围
+     * @param GetDistance Func(EntityIndex) -> float 实际距离（必须不小于到登记位置的水平距离减去 Extent）
+     * @return 目标实体下标，分区里一个都没有时返回 INDEX_NONE
+     */
+    template <typename FuncType>
+    int32 FindTarget(ETeam Team, uint32 ClassMask, const FVector& From, float Range, FuncType GetDistance) const;
+
+    // 查询时实际算过距离的实体数（统计用）
+    int64 GetNumDistanceChecks() const { return NumDistanceChecks; }
+
+private:
+    struct FPartition
+    {
+        TArray<TArray<int32>> Cells;   // 每个格子里的实体下标（无序）
+        int32 Count = 0;
+        float MaxExtent = 0.0f;
+    };
+
+    struct FSlot
+    {
+        int32 Partition = INDEX_NONE;  // INDEX_NONE 表示不在索引里
+        int32 Cell = 0;
+        int32 IndexInCell = 0;
+    };
+
+    static int32 GetPartitionIndex(ETeam Team, ETargetClass Class) { return (int32)Team * (int32)ETargetClass::Count + (int32)Class; }
+    int32 GetCellIndex(float X, float Y) const;
+    void RemoveFromCell(int32 EntityIndex);
+
+    FVector2D GridMin;
+    float CellSize;
+    int32 CellsX;
+    int32 CellsY;
+
+    TArray<FPartition> Partitions;
+    TArray<FSlot> Slots;
+    mutable int64 NumDistanceChecks;
+};
+
+template <typename FuncType>
+int32 FTargetCandidateIndex::FindTarget(ETeam Team, uint32 ClassMask, const FVector& From, float Range, FuncType GetDistance) const
+{
+    // 1. 选出要查的分区
+    const FPartition* Selected[(int32)ETargetClass::Count];
+    int32 NumSelected = 0;
+    float MaxExtent = 0.0f;
+    for (int32 Class = 0; Class < (int32)ETargetClass::Count; Class++)
+    {
+        const FPartition& Partition = Partitions[GetPartitionIndex(Team, (ETargetClass)Class)];
+        if ((ClassMask & (1u << Class)) && Partition.Count > 0)
+        {
+            Selected[NumSelected++] = &Partition;
+            MaxExtent = FMath::Max(MaxExtent, Partition.MaxExtent);
+        }
+    }
+    if (NumSelected == 0) return INDEX_NONE;
+
+    const int32 CenterX = FMath::Clamp(FMath::FloorToInt((From.X - GridMin.X) / CellSize), 0, CellsX - 1);
+    const int32 CenterY = FMath::Clamp(FMath::FloorToInt((From.Y - GridMin.Y) / CellSize), 0, CellsY - 1);
+
+    // 2. 攻击范围内下标最小的（范围加上最大占地，按包围框挑格子）
+    const int32 RangeCells = FMath::CeilToInt((Range + MaxExtent) / CellSize);
+    int32 InRange = INDEX_NONE;
+    for (int32 Y = FMath::Max(CenterY - RangeCells, 0); Y <= FMath::Min(CenterY + RangeCells, CellsY - 1); Y++)
+    {
+        for (int32 X = FMath::Max(CenterX - RangeCells, 0); X <= FMath::Min(CenterX + RangeCells, CellsX - 1); X++)
+        {
+            for (int32 p = 0; p < NumSelected; p++)
+            {
+                for (int32 EntityIndex : Selected[p]->Cells[Y * CellsX + X])
+                {
+                    if (InRange != INDEX_NONE && EntityIndex > InRange) continue;
+
+                    NumDistanceChecks++;
+                    if (GetDistance(EntityIndex) <= Range)
+                    {
+                        InRange = EntityIndex;
+                    }
+                }
+            }
+        }
+    }
+    if (InRange != INDEX_NONE) return InRange;
+
+    // 3. 范围内没有：一圈一圈往外找最近的，这一圈的最近可能距离已经超过当前最优时停止
+    int32 Best = INDEX_NONE;
+    float BestDistance = FLT_MAX;
+    const int32 MaxRing = FMath::Max(CellsX, CellsY);
+    for (int32 Ring = 0; Ring <= MaxRing; Ring++)
+    {
+        if (Best != INDEX_NONE && (Ring - 1) * CellSize - MaxExtent > BestDistance) break;
+
+        for (int32 Y = CenterY - Ring; Y <= CenterY + Ring; Y++)
+        {
+            if (Y < 0 || Y >= CellsY) continue;
+
+            // 只走这一圈的边：上下两行整行，中间各行只取左右两格
+            const bool bEdgeRow = Y == CenterY - Ring || Y == CenterY + Ring;
+            const int32 StepX = bEdgeRow || Ring == 0 ? 1 : Ring * 2;
+            for (int32 X = CenterX - Ring; X <= CenterX + Ring; X += StepX)
+            {
+                if (X < 0 || X >= CellsX) continue;
+
+                for (int32 p = 0; p < NumSelected; p++)
+                {
+                    for (int32 EntityIndex : Selected[p]->Cells[Y * CellsX + X])
+                    {
+                        NumDistanceChecks++;
+                        const float Distance = GetDistance(EntityIndex);
+                        if (Distance < BestDistance || (Distance == BestDistance && EntityIndex < Best))
+                        {
+                            Best = EntityIndex;
+                            BestDistance = Distance;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return Best;
+}
@@ -0,0 +1,222 @@
+#include "TowerBenchCommandlet.h"
+#include "DefenseTowerSystem.h"
+#include "HAL/PlatformTime.h"
+
+namespace
+{
+    // 战场边长（cm）
+    const float BenchFieldSize = 20000.0f;
+    const float BenchStepTime = 1.0f / 30.0f;
+    const float BenchAttackerSpeed = 300.0f;
+    const float BenchAttackerHealth = 100.0f;
+    const float BenchTowerDamage = 10.0f;
+    const float BenchTowerInterval = 1.0f;
+
+    struct FBenchTower
+    {
+        FVector Location;
+        int32 Target;
+        float LastFireTime;
+    };
+
+    struct FBenchAttacker
+    {
+        FVector Location;
+        FVector Goal;
+        float Health;
+    };
+
+    // 进攻者朝各自的目标点走，到了就换一个（两种做法用同一个随机种子，走法完全一样）
+    void MoveAttackers(TArray<FBenchAttacker>& Attackers, const TArray<FBenchTower>& Towers, FRandomStream& Random)
+    {
+        for (FBenchAttacker& Attacker : Attackers)
+        {
+            if (Attacker.Health <= 0.0f) continue;
+
+            const FVector ToGoal = Attacker.Goal - Attacker.Location;
+            const float Step = BenchAttackerSpeed * BenchStepTime;
+            if (ToGoal.SizeSquared() <= Step * Step)
+            {
+                Attacker.Location = Attacker.Goal;
+                Attacker.Goal = Towers[Random.RandHelper(Towers.Num())].Location + FVector(Random.FRandRange(-1000.0f, 1000.0f), Random.FRandRange(-1000.0f, 1000.0f), 0.0f);
+            }
+            else
+            {
+                Attacker.Location += ToGoal.GetSafeNormal() * Step;
+            }
+        }
+    }
+
+    void ApplyShots(const TArray<FTowerShot>& Shots, int32 NumTowers, TArray<FBenchAttacker>& Attackers)
+    {
+        for (const FTowerShot& Shot : Shots)
+        {
+            Attackers[Shot.TargetEntity - NumTowers].Health -= BenchTowerDamage;
+        }
+    }
+
+    // 原来的做法：每座塔每帧扫一遍所有敌人找最近的，冷却好了再开火（目标还有效就沿用）
+    void UpdateTowersNaive(float Time, TArray<FBenchTower>& Towers, const TArray<FBenchAttacker>& Attackers, float Range, TArray<FTowerShot>& OutShots)
+    {
+        const float RangeSq = Range * Range;
+        const int32 NumTowers = Towers.Num();
+
+        for (int32 t = 0; t < NumTowers; t++)
+        {
+            FBenchTower& Tower = Towers[t];
+
+            int32 Closest = INDEX_NONE;
+            float ClosestDistSq = RangeSq;
+            for (int32 a = 0; a < Attackers.Num(); a++)
+            {
+                if (Attackers[a].Health <= 0.0f) continue;
+
+                const float DistSq = FVector::DistSquared2D(Tower.Location, Attackers[a].Location);
+                if (DistSq < ClosestDistSq || (DistSq == ClosestDistSq && Closest == INDEX_NONE))
+                {
+                    ClosestDistSq = DistSq;
+                    Closest = NumTowers + a;
+                }
+            }
+
+            if (Time - Tower.LastFireTime < BenchTowerInterval) continue;
+
+            const FBenchAttacker* Current = Tower.Target != INDEX_NONE ? &Attackers[Tower.Target - NumTowers] : nullptr;
+            if (!Current || Current->Health <= 0.0f || FVector::DistSquared2D(Tower.Location, Current->Location) > RangeSq)
+            {
+                Tower.Target = Closest;
+            }
+
+            if (Tower.Target != INDEX_NONE)
+            {
+                Tower.LastFireTime = Time;
+                OutShots.Add({ t, Tower.Target });
+            }
+        }
+    }
+}
+
+UTowerBenchCommandlet::UTowerBenchCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = false;
+    LogToConsole = true;
+}
+
+int32 UTowerBenchCommandlet::Main(const FString& Params)
+{
+    // 1. 解析参数
+    int32 NumTowers = 500;
+    int32 NumAttackers = 5000;
+    int32 NumSteps = 600;
+    float Range = 600.0f;
+    int32 Seed = 1;
+    FParse::Value(*Params, TEXT("towers="), NumTowers);
+    FParse::Value(*Params, TEXT("attackers="), NumAttackers);
+    FParse::Value(*Params, TEXT("steps="), NumSteps);
+    FParse::Value(*Params, TEXT("range="), Range);
+    FParse::Value(*Params, TEXT("seed="), Seed);
+    NumTowers = FMath::Max(NumTowers, 1);
+    NumAttackers = FMath::Max(NumAttackers, 0);
+
+    // 2. 塔随机散在战场上，进攻者从四条边出发
+    FRandomStream Random(Seed);
+    TArray<FBenchTower> InitialTowers;
+    for (int32 t = 0; t < NumTowers; t++)
+    {
+        InitialTowers.Add({ FVector(Random.FRandRange(0.0f, BenchFieldSize), Random.FRandRange(0.0f, BenchFieldSize), 0.0f), INDEX_NONE, -BenchTowerInterval });
+    }
+
+    TArray<FBenchAttacker> InitialAttackers;
+    for (int32 a = 0; a < NumAttackers; a++)
+    {
+        const float Along = Random.FRandRange(0.0f, BenchFieldSize);
+        const int32 Side = Random.RandHelper(4);
+        const FVector Start = Side == 0 ? FVector(Along, 0.0f, 0.0f) : Side == 1 ? FVector(Along, BenchFieldSize, 0.0f)
+            : Side == 2 ? FVector(0.0f, Along, 0.0f) : FVector(BenchFieldSize, Along, 0.0f);
+        InitialAttackers.Add({ Start, InitialTowers[Random.RandHelper(NumTowers)].Location, BenchAttackerHealth });
+    }
+
+    // 3. 批量系统
+    TArray<FBenchAttacker> Attackers = InitialAttackers;
+    FRandomStream MoveRandom(Seed + 1);
+
+    FDefenseTowerSystem System;
+    System.Reset(FVector2D::ZeroVector, FVector2D(BenchFieldSize, BenchFieldSize));
+    for (int32 t = 0; t < NumTowers; t++)
+    {
+        System.AddTower(t, ETeam::Player, InitialTowers[t].Location, Range, BenchTowerInterval, -BenchTowerInterval);
+    }
+    System.FinalizeTowers();
+
+    TArray<TArray<FTowerShot>> BatchedShots;
+    BatchedShots.SetNum(NumSteps);
+    double BatchedSeconds = 0.0;
+    for (int32 Step = 0; Step < NumSteps; Step++)
+    {
+        const double StartTime = FPlatformTime::Seconds();
+        System.BeginTargets();
+        for (int32 a = 0; a < Attackers.Num(); a++)
+        {
+            if (Attackers[a].Health > 0.0f)
+            {
+                System.AddTarget(NumTowers + a, ETeam::Enemy, Attackers[a].Location);
+            }
+        }
+        System.Update(Step * BenchStepTime, BatchedShots[Step]);
+        BatchedSeconds += FPlatformTime::Seconds() - StartTime;
+
+        ApplyShots(BatchedShots[Step], NumTowers, Attackers);
+        MoveAttackers(Attackers, InitialTowers, MoveRandom);
+    }
+
+    // 4. 逐塔全量扫描（同样的开局、同样的走法）
+    Attackers = InitialAttackers;
+    MoveRandom.Initialize(Seed + 1);
+    TArray<FBenchTower> Towers = InitialTowers;
+
+    int32 MismatchStep = INDEX_NONE;
+    double NaiveSeconds = 0.0;
+    TArray<FTowerShot> NaiveShots;
+    for (int32 Step = 0; Step < NumSteps; Step++)
+    {
+        NaiveShots.Reset();
+        const double StartTime = FPlatformTime::Seconds();
+        UpdateTowersNaive(Step * BenchStepTime, Towers, Attackers, Range, NaiveShots);
+        NaiveSeconds += FPlatformTime::Seconds() - StartTime;
+
+        if (MismatchStep == INDEX_NONE && (NaiveShots.Num() != BatchedShots[Step].Num()
+            || FMemory::Memcmp(NaiveShots.GetData(), BatchedShots[Step].GetData(), NaiveShots.Num() * sizeof(FTowerShot)) != 0))
+        {
+            MismatchStep = Step;
+        }
+
+        ApplyShots(NaiveShots, NumTowers, Attackers);
+        MoveAttackers(Attackers, InitialTowers, MoveRandom);
+    }
+
+    // 5. 报告
+    const FDefenseTowerStats& Stats = System.GetStats();
+    int32 Survivors = 0;
+    for (const FBenchAttacker& Attacker : Attackers)
+    {
+        if (Attacker.Health > 0.0f) Survivors++;
+    }
+
+    UE_LOG(LogTemp, Display, TEXT("%d towers vs %d attackers, %d steps, range %.0f: %lld shots, %d attackers left"),
+        NumTowers, NumAttackers, NumSteps, Range, Stats.Shots, Survivors);
+    UE_LOG(LogTemp, Display, TEXT("Per-tower scan: %.3f ms/step"), NaiveSeconds * 1000.0 / FMath::Max(NumSteps, 1));
+    UE_LOG(LogTemp, Display, TEXT("Batched:        %.3f ms/step (%.1fx), %lld queries, %lld targets kept, %lld wakeups, %.1f%% tower-steps asleep"),
+        BatchedSeconds * 1000.0 / FMath::Max(NumSteps, 1), NaiveSeconds / FMath::Max(BatchedSeconds, 1e-9),
+        Stats.TargetQueries, Stats.TargetsKept, Stats.Wakeups,
+        100.0 * Stats.SleepingTowerSteps / FMath::Max((int64)NumTowers * NumSteps, (int64)1));
+
+    if (MismatchStep != INDEX_NONE)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Batched shots differ from the per-tower scan at step %d"), MismatchStep);
+        return 1;
+    }
+    UE_LOG(LogTemp, Display, TEXT("Shots identical: yes"));
+    return 0;
+}
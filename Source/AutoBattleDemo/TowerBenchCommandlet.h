@@ -0,0 +1,20 @@
+// TowerBenchCommandlet.h：防御塔批量索敌压测（和每座塔每帧各扫一遍敌人的做法对比）
+// 用法：UE4Editor-Cmd AutoBattleDemo.uproject -run=TowerBench [-towers=500] [-attackers=5000] [-steps=600] [-range=600] [-seed=1] -nullrhi
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TowerBenchCommandlet.generated.h"
+
+UCLASS()
+class AUTOBATTLEDEMO_API UTowerBenchCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UTowerBenchCommandlet();
+
+    // 同一批进攻者分别交给 FDefenseTowerSystem 和逐塔全量扫描处理，统计索敌耗时，
+    // 并逐步比较两边的开火记录，不一致返回 1
+    virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,33 @@
+#include "UnitArchetype.h"
+
+FUnitArchetype FUnitArchetype::MakeDefault(EUnitType Type)
+{
+    FUnitArchetype Archetype;
+    switch (Type)
+    {
+    case EUnitType::Archer:
+        // 远程：血少、射程远、攻速慢
+        Archetype.MaxHealth = 80.0f;
+        Archetype.AttackRange = 600.0f;
+        Archetype.Damage = 8.0f;
+        Archetype.AttackInterval = 1.5f;
+        Archetype.ProjectileSpeed = 1500.0f;
+        Archetype.Cost = 100;
+        break;
+
+    case EUnitType::Tank:
+        // 肉盾：血厚、走得慢，先拆防御塔，拆完了再打别的
+        Archetype.MaxHealth = 300.0f;
+        Archetype.Damage = 15.0f;
+        Archetype.MoveSpeed = 200.0f;
+        Archetype.AttackInterval = 1.5f;
+        Archetype.Cost = 150;
+        Archetype.Targeting.Priority.Add(ETargetClass::Defense);
+        break;
+
+    default:
+        // 近战：原 ABaseUnit 构造函数里的默认值
+        break;
+    }
+    return Archetype;
+}
@@ -0,0 +1,52 @@
+// UnitArchetype.h：兵种属性表（享元）
+// 每个兵种一行，开局从 DataTable 读一次；单位身上只留兵种（= 表的下标）和血量等可变状态，
+// 改数值只要改表，不用重新编译蓝图
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "RTSCoreTypes.h"
+#include "UnitArchetype.generated.h"
+
+/**
+ * DataTable 的行结构，行名用兵种名（Soldier / Archer / Tank）
+ */
+USTRUCT(BlueprintType)
+struct FUnitArchetype : public FTableRowBase
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Stats")
+        float MaxHealth = 100.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Combat")
+        float AttackRange = 150.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Combat")
+        float Damage = 10.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement")
+        float MoveSpeed = 300.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Combat")
+        float AttackInterval = 1.0f;
+
+    // 远程单位的箭速，0 表示近战、伤害立即结算
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Combat")
+        float ProjectileSpeed = 0.0f;
+
+    // 溅射半径：大于 0 时命中点周围的敌人都受到同样的伤害（炸弹兵、投石车）
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Combat")
+        float SplashRadius = 0.0f;
+
+    // 索敌策略（比如巨人先打防御塔），默认谁近打谁
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Combat")
+        FTargetingPolicy Targeting;
+
+    // 商店价格（原来写死在 ARTSPlayerController::HandleLeftClick 里）
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Shop")
+        int32 Cost = 50;
+
+    // 没配表时用的默认值
+    static FUnitArchetype MakeDefault(EUnitType Type);
+};
@@ -0,0 +1,289 @@
+#include "UnitInstanceRenderer.h"
+#include "BaseUnit.h"
+#include "BattleSimulation.h"
+#include "ProjectileSystem.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Materials/MaterialInstanceDynamic.h"
+
+namespace
+{
+    const int32 NumUnitTypes = (int32)EUnitType::Tank + 1;
+    const int32 NumTeams = (int32)ETeam::Enemy + 1;
+
+    // 材质里用的参数：4.24 下是向量参数，4.25 起是 PerInstanceCustomData[0]（0 = 玩家，1 = 敌人）
+    const FName TeamColorParamName(TEXT("TeamColor"));
+    const FLinearColor PlayerTeamColor(0.1f, 0.3f, 1.0f);
+    const FLinearColor EnemyTeamColor(1.0f, 0.15f, 0.1f);
+}
+
+AUnitInstanceRenderer::AUnitInstanceRenderer()
+{
+    PrimaryActorTick.bCanEverTick = false;
+
+    RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("RootComponent"));
+    ProjectileComponent = nullptr;
+
+#if AUTOBATTLE_INSTANCE_CUSTOM_DATA
+    const int32 NumBatches = NumUnitTypes;
+#else
+    const int32 NumBatches = NumUnitTypes * NumTeams;
+#endif
+    Batches.SetNum(NumBatches);
+    BatchComponents.SetNumZeroed(NumBatches);
+}
+
+void AUnitInstanceRenderer::SetUnitClass(EUnitType Type, TSubclassOf<ABaseUnit> UnitClass)
+{
+    if (!UnitClass) return;
+
+    // 蓝图可能把模型配在 MeshComp 上，也可能配在基类的 StaticMeshComponent 上
+    const ABaseUnit* DefaultUnit = UnitClass->GetDefaultObject<ABaseUnit>();
+    const UStaticMeshComponent* MeshSource = nullptr;
+    if (DefaultUnit->MeshComp && DefaultUnit->MeshComp->GetStaticMesh())
+    {
+        MeshSource = DefaultUnit->MeshComp;
+    }
+    else if (DefaultUnit->StaticMeshComponent && DefaultUnit->StaticMeshComponent->GetStaticMesh())
+    {
+        MeshSource = DefaultUnit->StaticMeshComponent;
+    }
+
+    if (!MeshSource)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("%s has no static mesh, instanced rendering disabled for it"), *UnitClass->GetName());
+        return;
+    }
+
+    SetUnitMesh(Type, MeshSource->GetStaticMesh(), MeshSource->GetMaterial(0), MeshSource->GetRelativeTransform());
+}
+
+void AUnitInstanceRenderer::SetUnitMesh(EUnitType Type, UStaticMesh* Mesh, UMaterialInterface* Material, const FTransform& MeshOffset)
+{
+    if (!Mesh) return;
+
+    for (int32 Team = 0; Team < NumTeams; Team++)
+    {
+        const int32 BatchIndex = GetBatchIndex(Type, (ETeam)Team);
+        if (BatchComponents[BatchIndex]) continue;
+
+        UInstancedStaticMeshComponent* Component = NewObject<UInstancedStaticMeshComponent>(this);
+        Component->SetStaticMesh(Mesh);
+        // 点击检测交给单位自己的胶囊体，实例不参与碰撞
+        Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+        Component->SetMobility(EComponentMobility::Movable);
+        Component->SetupAttachment(RootComponent);
+
+#if AUTOBATTLE_INSTANCE_CUSTOM_DATA
+        Component->NumCustomDataFloats = 2;
+        if (Material) Component->SetMaterial(0, Material);
+#else
+        // 没有逐实例数据，每个阵营一个批次，颜色写在各自的材质实例上
+        UMaterialInterface* BaseMaterial = Material ? Material : Mesh->GetMaterial(0);
+        if (BaseMaterial)
+        {
+            UMaterialInstanceDynamic* TeamMaterial = UMaterialInstanceDynamic::Create(BaseMaterial, this);
+            TeamMaterial->SetVectorParameterValue(TeamColorParamName, (ETeam)Team == ETeam::Player ? PlayerTeamColor : EnemyTeamColor);
+            Component->SetMaterial(0, TeamMaterial);
+        }
+#endif
+
+        Component->RegisterComponent();
+        BatchComponents[BatchIndex] = Component;
+        Batches[BatchIndex].MeshOffset = MeshOffset;
+    }
+}
+
+bool AUnitInstanceRenderer::HasUnitMesh(EUnitType Type) const
+{
+    return BatchComponents[GetBatchIndex(Type, ETeam::Player)] != nullptr;
+}
+
+void AUnitInstanceRenderer::UpdateInstances(const TArray<FSimEntity>& Entities)
+{
+    // 1. 按批次收集存活单位的变换（批次内按实体下标排序，结果稳定）
+    TArray<int32> PreviousCounts;
+    PreviousCounts.SetNumUninitialized(Batches.Num());
+    for (int32 b = 0; b < Batches.Num(); b++)
+    {
+        PreviousCounts[b] = Batches[b].EntityIndices.Num();
+        Batches[b].EntityIndices.Reset();
+        Batches[b].Transforms.Reset();
+#if AUTOBATTLE_INSTANCE_CUSTOM_DATA
+        Batches[b].CustomData.Reset();
+#endif
+    }
+
+    for (int32 i = 0; i < Entities.Num(); i++)
+    {
+        const FSimEntity& Entity = Entities[i];
+        if (!Entity.bIsUnit || !Entity.bAlive) continue;
+
+        const int32 BatchIndex = GetBatchIndex(Entity.UnitType, Entity.Team);
+        if (!BatchComponents[BatchIndex]) continue;
+
+        FInstanceBatch& Batch = Batches[BatchIndex];
+        Batch.EntityIndices.Add(i);
+        Batch.Transforms.Add(Batch.MeshOffset * FTransform(Entity.Rotation, Entity.Location));
+#if AUTOBATTLE_INSTANCE_CUSTOM_DATA
+        Batch.CustomData.Add((float)Entity.Team);
+        Batch.CustomData.Add(Entity.MaxHealth > 0.0f ? Entity.CurrentHealth / Entity.MaxHealth : 0.0f);
+#endif
+    }
+
+    // 2. 一个批次一次提交
+    for (int32 b = 0; b < Batches.Num(); b++)
+    {
+        UInstancedStaticMeshComponent* Component = BatchComponents[b];
+        if (!Component) continue;
+
+        const FInstanceBatch& Batch = Batches[b];
+        const int32 NumInstances = Batch.Transforms.Num();
+
+        if (NumInstances == PreviousCounts[b] && NumInstances == Component->GetInstanceCount())
+        {
+            // 数量没变（绝大多数帧）：整批覆盖变换
+            if (NumInstances > 0)
+            {
+                Component->BatchUpdateInstancesTransforms(0, Batch.Transforms, true, false, true);
+            }
+        }
+        else
+        {
+            // 有单位死亡：实例下标会错位，整批重建
+            Component->ClearInstances();
+            for (const FTransform& InstanceTransform : Batch.Transforms)
+            {
+                Component->AddInstanceWorldSpace(InstanceTransform);
+            }
+        }
+
+#if AUTOBATTLE_INSTANCE_CUSTOM_DATA
+        for (int32 i = 0; i < NumInstances; i++)
+        {
+            Component->SetCustomDataValue(i, 0, Batch.CustomData[i * 2], false);
+            Component->SetCustomDataValue(i, 1, Batch.CustomData[i * 2 + 1], false);
+        }
+#endif
+
+        Component->MarkRenderStateDirty();
+    }
+}
+
+void AUnitInstanceRenderer::ClearInstances()
+{
+    for (int32 b = 0; b < Batches.Num(); b++)
+    {
+        Batches[b].EntityIndices.Reset();
+        if (BatchComponents[b])
+        {
+            BatchComponents[b]->ClearInstances();
+        }
+    }
+
+    if (ProjectileComponent)
+    {
+        ProjectileComponent->ClearInstances();
+    }
+}
+
+void AUnitInstanceRenderer::SetProjectileMesh(UStaticMesh* Mesh, UMaterialInterface* Material)
+{
+    if (!Mesh || ProjectileComponent) return;
+
+    ProjectileComponent = NewObject<UInstancedStaticMeshComponent>(this);
+    ProjectileComponent->SetStaticMesh(Mesh);
+    ProjectileComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+    ProjectileComponent->SetMobility(EComponentMobility::Movable);
+    ProjectileComponent->SetCastShadow(false);
+    ProjectileComponent->SetupAttachment(RootComponent);
+    if (Material) ProjectileComponent->SetMaterial(0, Material);
+    ProjectileComponent->RegisterComponent();
+}
+
+void AUnitInstanceRenderer::UpdateProjectiles(const FProjectileSystem& Projectiles)
+{
+    if (!ProjectileComponent) return;
+
+    // 1. 收集变换（朝向飞行方向）
+    const int32 NumProjectiles = Projectiles.Num();
+    ProjectileTransforms.Reset(NumProjectiles);
+    for (int32 i = 0; i < NumProjectiles; i++)
+    {
+        ProjectileTransforms.Add(FTransform(Projectiles.GetVelocity(i).Rotation(), Projectiles.GetLocation(i)));
+    }
+
+    // 2. 数量对齐：只动末尾，删最后一个实例不会让其它实例换位置
+    int32 NumInstances = ProjectileComponent->GetInstanceCount();
+    while (NumInstances > NumProjectiles)
+    {
+        ProjectileComponent->RemoveInstance(--NumInstances);
+    }
+    while (NumInstances < NumProjectiles)
+    {
+        ProjectileComponent->AddInstanceWorldSpace(ProjectileTransforms[NumInstances++]);
+    }
+
+    // 3. 整批覆盖变换
+    if (NumProjectiles > 0)
+    {
+        ProjectileComponent->BatchUpdateInstancesTransforms(0, ProjectileTransforms, true, false, true);
+    }
+    ProjectileComponent->MarkRenderStateDirty();
+}
+
+int32 AUnitInstanceRenderer::GetEntityIndex(const UPrimitiveComponent* Component, int32 InstanceIndex) const
+{
+    const int32 BatchIndex = BatchComponents.IndexOfByKey(Component);
+    if (BatchIndex == INDEX_NONE || !Batches[BatchIndex].EntityIndices.IsValidIndex(InstanceIndex))
+    {
+        return INDEX_NONE;
+    }
+    return Batches[BatchIndex].EntityIndices[InstanceIndex];
+}
+
+int32 AUnitInstanceRenderer::GetNumInstances() const
+{
+    int32 Total = 0;
+    for (const FInstanceBatch& Batch : Batches)
+    {
+        Total += Batch.EntityIndices.Num();
+    }
+    return Total;
+}
+
+int32 AUnitInstanceRenderer::GetNumBatches() const
+{
+    int32 Count = 0;
+    for (const UInstancedStaticMeshComponent* Component : BatchComponents)
+    {
+        if (Component) Count++;
+    }
+    return Count;
+}
+
+int32 AUnitInstanceRenderer::CountRenderComponents(const AActor* Actor)
+{
+    if (!Actor) return 0;
+
+    TInlineComponentArray<UPrimitiveComponent*> Primitives(Actor);
+    int32 Count = 0;
+    for (const UPrimitiveComponent* Primitive : Primitives)
+    {
+        if (Primitive->IsRegistered() && Primitive->IsVisible() && !Primitive->bHiddenInGame)
+        {
+            Count++;
+        }
+    }
+    return Count;
+}
+
+int32 AUnitInstanceRenderer::GetBatchIndex(EUnitType Type, ETeam Team) const
+{
+#if AUTOBATTLE_INSTANCE_CUSTOM_DATA
+    return (int32)Type;
+#else
+    return (int32)Type * NumTeams + (int32)Team;
+#endif
+}
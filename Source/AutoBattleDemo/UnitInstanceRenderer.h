@@ -0,0 +1,83 @@
+// UnitInstanceRenderer.h：战斗阶段用实例化网格批量绘制所有单位
+// 每个兵种（4.24 下是兵种 x 阵营）只有一个 UInstancedStaticMeshComponent，
+// 几百个单位也只有几个绘制批次；Actor 只保留胶囊体给鼠标点击用
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Runtime/Launch/Resources/Version.h"
+#include "RTSCoreTypes.h"
+#include "UnitInstanceRenderer.generated.h"
+
+// 逐实例自定义数据是 4.25 才有的，4.24 只能按阵营拆批次，用材质参数区分颜色
+#define AUTOBATTLE_INSTANCE_CUSTOM_DATA (ENGINE_MAJOR_VERSION > 4 || ENGINE_MINOR_VERSION >= 25)
+
+struct FSimEntity;
+class FProjectileSystem;
+
+UCLASS()
+class AUTOBATTLEDEMO_API AUnitInstanceRenderer : public AActor
+{
+    GENERATED_BODY()
+
+public:
+    AUnitInstanceRenderer();
+
+    // 用兵种蓝图的默认对象上的网格、材质和相对变换来绘制这个兵种
+    void SetUnitClass(EUnitType Type, TSubclassOf<class ABaseUnit> UnitClass);
+
+    // 直接指定网格（无头压测用，MeshOffset 是网格相对单位中心的变换）
+    void SetUnitMesh(EUnitType Type, class UStaticMesh* Mesh, class UMaterialInterface* Material, const FTransform& MeshOffset);
+
+    // 这个兵种有没有可用的网格（没有的话单位继续用自己的组件绘制）
+    bool HasUnitMesh(EUnitType Type) const;
+
+    /**
+     * 用模拟结果批量刷新所有实例（每帧调用一次）
+     * 数量没变时整批更新变换，有单位死亡时整批重建
+     * @param Entities 模拟器里的实体数组
+     */
+    void UpdateInstances(const TArray<FSimEntity>& Entities);
+
+    // 清空所有单位和箭矢的实例（战斗结束后快速重开时用，组件和网格保留）
+    void ClearInstances();
+
+    // 箭矢用的网格（模型的 +X 朝向飞行方向）
+    void SetProjectileMesh(class UStaticMesh* Mesh, class UMaterialInterface* Material);
+
+    // 同步所有在飞的弹道（数量每帧都在变，只在末尾增删实例，其余整批覆盖变换）
+    void UpdateProjectiles(const FProjectileSystem& Projectiles);
+
+    // 实例 -> 模拟实体下标（找不到返回 INDEX_NONE）
+    int32 GetEntityIndex(const UPrimitiveComponent* Component, int32 InstanceIndex) const;
+
+    int32 GetNumInstances() const;
+    int32 GetNumBatches() const;
+
+    // 统计一个 Actor 身上会生成渲染代理的组件数（已注册、游戏中可见的图元组件）
+    static int32 CountRenderComponents(const AActor* Actor);
+
+private:
+    // 每个批次一个组件
+    struct FInstanceBatch
+    {
+        FTransform MeshOffset;
+        TArray<int32> EntityIndices;     // 实例下标 -> 实体下标
+        TArray<FTransform> Transforms;   // 本帧收集的变换（复用内存）
+#if AUTOBATTLE_INSTANCE_CUSTOM_DATA
+        TArray<float> CustomData;        // 每个实例 2 个值：阵营、血量比例
+#endif
+    };
+
+    int32 GetBatchIndex(EUnitType Type, ETeam Team) const;
+
+    UPROPERTY()
+        TArray<class UInstancedStaticMeshComponent*> BatchComponents;
+
+    TArray<FInstanceBatch> Batches;
+
+    UPROPERTY()
+        class UInstancedStaticMeshComponent* ProjectileComponent;
+
+    TArray<FTransform> ProjectileTransforms;
+};
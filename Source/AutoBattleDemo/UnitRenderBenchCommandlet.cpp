@@ -0,0 +1,111 @@
+#include "UnitRenderBenchCommandlet.h"
+#include "UnitInstanceRenderer.h"
+#include "BattleSimulation.h"
+#include "BaseUnit.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Engine/StaticMesh.h"
+#include "RenderingThread.h"
+#include "HAL/PlatformTime.h"
+
+UUnitRenderBenchCommandlet::UUnitRenderBenchCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = false;
+    LogToConsole = true;
+}
+
+int32 UUnitRenderBenchCommandlet::Main(const FString& Params)
+{
+    // 1. 解析参数
+    FString SetupPath;
+    if (!FParse::Value(*Params, TEXT("setup="), SetupPath))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Usage: -run=UnitRenderBench -setup=<file.bsetup> [-frames=N] [-mesh=/Game/...]"));
+        return 1;
+    }
+
+    int32 MaxFrames = 1000;
+    FParse::Value(*Params, TEXT("frames="), MaxFrames);
+    FString MeshPath = TEXT("/Engine/BasicShapes/Cube.Cube");
+    FParse::Value(*Params, TEXT("mesh="), MeshPath);
+
+    FBattleSetup Setup;
+    if (!Setup.LoadFromFile(SetupPath))
+    {
+        return 1;
+    }
+
+    UStaticMesh* Mesh = LoadObject<UStaticMesh>(nullptr, *MeshPath);
+    if (!Mesh)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Failed to load mesh %s"), *MeshPath);
+        return 1;
+    }
+
+    // 2. 建一个空的游戏世界（-nullrhi 下也有场景，渲染线程照常处理实例数据）
+    UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+    FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+    WorldContext.SetCurrentWorld(World);
+    World->InitializeActorsForPlay(FURL());
+
+    // 3. 每个单位身上的渲染组件：原来的 Actor 绘制 vs 实例化绘制
+    ABaseUnit* SampleUnit = World->SpawnActor<ABaseUnit>();
+    const int32 ComponentsBefore = AUnitInstanceRenderer::CountRenderComponents(SampleUnit);
+    SampleUnit->SetRenderedByInstances(true);
+    const int32 ComponentsAfter = AUnitInstanceRenderer::CountRenderComponents(SampleUnit);
+    SampleUnit->Destroy();
+
+    AUnitInstanceRenderer* Renderer = World->SpawnActor<AUnitInstanceRenderer>();
+    for (int32 Type = 0; Type <= (int32)EUnitType::Tank; Type++)
+    {
+        Renderer->SetUnitMesh((EUnitType)Type, Mesh, nullptr, FTransform::Identity);
+    }
+
+    // 4. 跑模拟，每步当作一帧提交一次
+    FBattleSimulation Simulation;
+    Simulation.Init(Setup);
+    Renderer->UpdateInstances(Simulation.GetEntities());
+    FlushRenderingCommands();
+
+    const int32 PeakInstances = Renderer->GetNumInstances();
+    double UpdateSeconds = 0.0;
+    double FlushSeconds = 0.0;
+    int64 InstanceFrames = 0;
+    int32 Frames = 0;
+
+    while (!Simulation.IsFinished() && Frames < MaxFrames)
+    {
+        Simulation.Step();
+
+        // 游戏线程：收集变换 + 提交
+        const double UpdateStart = FPlatformTime::Seconds();
+        Renderer->UpdateInstances(Simulation.GetEntities());
+        World->SendAllEndOfFrameUpdates();
+        UpdateSeconds += FPlatformTime::Seconds() - UpdateStart;
+
+        // 渲染线程：重建实例缓冲（等它做完才算这一帧的完整开销）
+        const double FlushStart = FPlatformTime::Seconds();
+        FlushRenderingCommands();
+        FlushSeconds += FPlatformTime::Seconds() - FlushStart;
+
+        InstanceFrames += Renderer->GetNumInstances();
+        Frames++;
+    }
+
+    // 5. 报告
+    UE_LOG(LogTemp, Display, TEXT("Render components per unit: %d (actor) -> %d (instanced, collision capsule only)"),
+        ComponentsBefore, ComponentsAfter);
+    UE_LOG(LogTemp, Display, TEXT("Instanced batches: %d for %d units"), Renderer->GetNumBatches(), PeakInstances);
+    if (Frames > 0)
+    {
+        UE_LOG(LogTemp, Display, TEXT("Frames: %d, game thread: %.3fus/frame, render thread flush: %.3fus/frame, %.4fus/instance"),
+            Frames, UpdateSeconds * 1e6 / Frames, FlushSeconds * 1e6 / Frames,
+            InstanceFrames > 0 ? (UpdateSeconds + FlushSeconds) * 1e6 / InstanceFrames : 0.0);
+    }
+
+    GEngine->DestroyWorldContext(World);
+    World->DestroyWorld(false);
+    return 0;
+}
@@ -0,0 +1,20 @@
+// UnitRenderBenchCommandlet.h：实例化绘制的每帧开销压测
+// 用法：UE4Editor-Cmd AutoBattleDemo.uproject -run=UnitRenderBench -setup=<布局文件> [-frames=N] [-mesh=<网格路径>] -nullrhi
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "UnitRenderBenchCommandlet.generated.h"
+
+UCLASS()
+class AUTOBATTLEDEMO_API UUnitRenderBenchCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UUnitRenderBenchCommandlet();
+
+    // 按布局跑模拟，每步把结果提交给 AUnitInstanceRenderer，统计实例缓冲更新的耗时，
+    // 并对比单位改用实例绘制前后身上的渲染组件数
+    virtual int32 Main(const FString& Params) override;
+};